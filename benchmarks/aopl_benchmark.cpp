@@ -0,0 +1,416 @@
+// AOPL parser/compiler benchmark
+//
+// Generates synthetic AOPL corpora (entities with transforms, behaviors with
+// deep `→` chains over the full set of Unicode operators) and measures
+// Parser::Parse and Parser::Compile throughput, heap allocations and peak
+// heap usage. Results are written as JSON.
+//
+// Usage: aopl_benchmark [--entities 1000,10000,...] [--depth N]
+//                       [--iterations N] [--output results.json]
+
+#include "gaia_matrix.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+// Heap accounting. Every allocation carries a header with its size so
+// frees can be subtracted from the live total.
+std::atomic<uint64_t> s_Allocations{0};
+std::atomic<uint64_t> s_AllocatedBytes{0};
+std::atomic<int64_t> s_LiveBytes{0};
+std::atomic<int64_t> s_PeakBytes{0};
+
+constexpr size_t HEADER_SIZE = alignof(std::max_align_t) > sizeof(size_t) ? alignof(std::max_align_t) : sizeof(size_t);
+
+void* CountedAlloc(size_t size) {
+    auto* block = static_cast<unsigned char*>(std::malloc(size + HEADER_SIZE));
+    if (!block) {
+        return nullptr;
+    }
+    *reinterpret_cast<size_t*>(block) = size;
+    s_Allocations.fetch_add(1, std::memory_order_relaxed);
+    s_AllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    int64_t live = s_LiveBytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed) + size;
+    int64_t peak = s_PeakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !s_PeakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+    return block + HEADER_SIZE;
+}
+
+void CountedFree(void* pointer) {
+    if (!pointer) {
+        return;
+    }
+    auto* block = static_cast<unsigned char*>(pointer) - HEADER_SIZE;
+    s_LiveBytes.fetch_sub(static_cast<int64_t>(*reinterpret_cast<size_t*>(block)), std::memory_order_relaxed);
+    std::free(block);
+}
+
+} // namespace
+
+void* operator new(size_t size) {
+    if (void* pointer = CountedAlloc(size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    if (void* pointer = CountedAlloc(size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+    CountedFree(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    CountedFree(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    CountedFree(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+    CountedFree(pointer);
+}
+
+namespace {
+
+using namespace gaia_matrix;
+
+struct CorpusConfig {
+    size_t entities = 1000;
+    size_t entitiesPerBehavior = 16;
+    size_t depth = 16;          // `→` stages per handler
+    size_t variables = 32;      // Distinct script variables, shared by all behaviors
+};
+
+struct Corpus {
+    std::string source;
+    size_t bytes = 0;
+    size_t lines = 0;
+    size_t behaviors = 0;
+    size_t stages = 0;
+};
+
+/**
+ * @brief Generate a valid AOPL corpus of the requested size
+ *
+ * Every entity references one behavior; each behavior has four handlers
+ * whose chains cycle through guards, conditions, assignments, axis
+ * offsets, stores, copies and integrations. The variable pool is bounded
+ * so the slot count, and with it the template size, stays constant.
+ */
+Corpus GenerateCorpus(const CorpusConfig& config) {
+    static const char* const KEYS[] = {"W", "A", "S", "D", "Space", "Shift", "Left", "Right"};
+    static const char* const AXES[] = {"x", "y", "z"};
+    static const char* const HANDLERS[] = {"Move", "Jump", "Turn", "Land"};
+
+    Corpus corpus;
+    std::ostringstream out;
+    size_t behaviors = std::max<size_t>(1, config.entities / std::max<size_t>(1, config.entitiesPerBehavior));
+    corpus.behaviors = behaviors;
+
+    auto variable = [&config](size_t index) {
+        return "energy" + std::to_string(index % std::max<size_t>(1, config.variables));
+    };
+
+    out << "# Synthetic AOPL corpus: " << config.entities << " entities, " << behaviors
+        << " behaviors, depth " << config.depth << "\n";
+    corpus.lines = 1;
+
+    for (size_t b = 0; b < behaviors; ++b) {
+        out << "N〈Behavior" << b << "〉: V ⊢ I → F Move → F Turn → A Jump → C Land\n";
+        ++corpus.lines;
+        for (size_t h = 0; h < 4; ++h) {
+            out << HANDLERS[h] << ": I.K " << KEYS[(b + h) % 8];
+            for (size_t s = 1; s < config.depth; ++s) {
+                size_t k = b * 7 + h * 3 + s;
+                out << " → ";
+                switch (k % 8) {
+                    case 0: out << "⊿ " << (k % 3 ? "" : "!") << variable(k); break;
+                    case 1: out << "⊸ " << variable(k) << " " << (k % 5); break;
+                    case 2: out << "T.P " << AXES[k % 3] << "+ 0." << (k % 9 + 1); break;
+                    case 3: out << "T.R " << AXES[k % 3] << "- 0." << (k % 9 + 1); break;
+                    case 4: out << "V." << AXES[k % 3] << " " << (k % 7); break;
+                    case 5: out << "T.P += V * dt"; break;
+                    case 6: out << "V T.R"; break;
+                    default: out << "⊸ grounded " << (k % 2 ? "true" : "false"); break;
+                }
+            }
+            out << "\n";
+            ++corpus.lines;
+            corpus.stages += config.depth;
+        }
+    }
+
+    for (size_t e = 0; e < config.entities; ++e) {
+        out << "N ⊢ E〈Entity" << e << "〉〈T⊕C⊕I〉\n";
+        out << "T: P " << (e % 97) << " " << (e % 13) << " " << (e % 89) << " → R 0 " << (e % 360)
+            << " 0 → S 1 1 1\n";
+        out << "C: F Behavior" << (e % behaviors) << " → ⊻ OnUpdate OnCollision\n";
+        out << "I: ⊢ K → M → G\n";
+        corpus.lines += 4;
+    }
+
+    corpus.source = out.str();
+    corpus.bytes = corpus.source.size();
+    return corpus;
+}
+
+struct Counters {
+    uint64_t allocations;
+    uint64_t bytes;
+    int64_t live;
+};
+
+Counters Snapshot() {
+    return {s_Allocations.load(), s_AllocatedBytes.load(), s_LiveBytes.load()};
+}
+
+struct PhaseResult {
+    double bestSeconds = 0.0;
+    double meanSeconds = 0.0;
+    uint64_t allocations = 0;
+    uint64_t allocatedBytes = 0;
+    int64_t peakHeapBytes = 0;  // Above the live heap at the start of the phase
+};
+
+struct SizeResult {
+    size_t entities = 0;
+    Corpus corpus;
+    PhaseResult parse;
+    PhaseResult compile;
+    size_t handlers = 0;
+    size_t instructions = 0;
+    uint16_t slots = 0;
+    std::vector<std::string> errors;
+};
+
+// Run one phase, recording time and heap counters
+template <typename Phase>
+bool Measure(Phase phase, PhaseResult& result, size_t iteration, size_t iterations) {
+    Counters before = Snapshot();
+    s_PeakBytes.store(before.live);
+
+    auto start = std::chrono::steady_clock::now();
+    bool ok = phase();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    Counters after = Snapshot();
+    if (iteration == 0) {
+        result.bestSeconds = seconds;
+        result.allocations = after.allocations - before.allocations;
+        result.allocatedBytes = after.bytes - before.bytes;
+        result.peakHeapBytes = s_PeakBytes.load() - before.live;
+    }
+    result.bestSeconds = std::min(result.bestSeconds, seconds);
+    result.meanSeconds += seconds / iterations;
+    return ok;
+}
+
+SizeResult RunSize(const CorpusConfig& config, size_t iterations) {
+    SizeResult result;
+    result.entities = config.entities;
+    result.corpus = GenerateCorpus(config);
+
+    for (size_t i = 0; i < iterations; ++i) {
+        // Destroy the previous parser outside the measured phases
+        auto parser = std::make_unique<aopl::Parser>();
+        bool parsed = Measure([&]() { return parser->Parse(result.corpus.source); }, result.parse, i, iterations);
+        if (!parsed) {
+            result.errors = parser->GetErrors();
+            break;
+        }
+        bool compiled = Measure([&]() { return parser->Compile(); }, result.compile, i, iterations);
+        if (!compiled) {
+            result.errors = parser->GetErrors();
+            break;
+        }
+        if (i == 0) {
+            auto module = parser->GetModule();
+            result.handlers = module->handlers.size();
+            result.slots = module->slotCount;
+            for (const auto& handler : module->handlers) {
+                result.instructions += handler.code.size();
+            }
+        }
+    }
+    return result;
+}
+
+long PeakResidentKilobytes() {
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+        return usage.ru_maxrss / 1024;
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+#endif
+    return -1;
+}
+
+std::string EscapeJson(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        switch (c) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            default: escaped += c; break;
+        }
+    }
+    return escaped;
+}
+
+void WritePhase(std::ostream& out, const char* name, const PhaseResult& phase, const SizeResult& size) {
+    double megabytes = size.corpus.bytes / (1024.0 * 1024.0);
+    double seconds = std::max(phase.bestSeconds, 1e-9);
+    out << "      \"" << name << "\": {\n"
+        << "        \"best_seconds\": " << phase.bestSeconds << ",\n"
+        << "        \"mean_seconds\": " << phase.meanSeconds << ",\n"
+        << "        \"mb_per_second\": " << megabytes / seconds << ",\n"
+        << "        \"entities_per_second\": " << size.entities / seconds << ",\n"
+        << "        \"allocations\": " << phase.allocations << ",\n"
+        << "        \"allocated_bytes\": " << phase.allocatedBytes << ",\n"
+        << "        \"peak_heap_bytes\": " << phase.peakHeapBytes << "\n"
+        << "      }";
+}
+
+void WriteJson(std::ostream& out, const std::vector<SizeResult>& results, const CorpusConfig& config,
+               size_t iterations) {
+    out.precision(6);
+    out << "{\n"
+        << "  \"benchmark\": \"aopl_parser_compiler\",\n"
+        << "  \"version\": \"" << gaia_matrix::Version::GetVersionString() << "\",\n"
+        << "  \"depth\": " << config.depth << ",\n"
+        << "  \"iterations\": " << iterations << ",\n"
+        << "  \"peak_rss_kb\": " << PeakResidentKilobytes() << ",\n"
+        << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const SizeResult& result = results[i];
+        out << "    {\n"
+            << "      \"entities\": " << result.entities << ",\n"
+            << "      \"behaviors\": " << result.corpus.behaviors << ",\n"
+            << "      \"stages\": " << result.corpus.stages << ",\n"
+            << "      \"lines\": " << result.corpus.lines << ",\n"
+            << "      \"bytes\": " << result.corpus.bytes << ",\n"
+            << "      \"ok\": " << (result.errors.empty() ? "true" : "false") << ",\n";
+        if (!result.errors.empty()) {
+            out << "      \"error\": \"" << EscapeJson(result.errors.front()) << "\",\n";
+        }
+        out << "      \"handlers\": " << result.handlers << ",\n"
+            << "      \"instructions\": " << result.instructions << ",\n"
+            << "      \"slots\": " << result.slots << ",\n";
+        WritePhase(out, "parse", result.parse, result);
+        out << ",\n";
+        WritePhase(out, "compile", result.compile, result);
+        out << "\n    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+bool ParseSizes(const std::string& text, std::vector<size_t>& sizes) {
+    sizes.clear();
+    std::istringstream in(text);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        char* end = nullptr;
+        unsigned long long value = std::strtoull(item.c_str(), &end, 10);
+        if (item.empty() || *end != '\0' || value == 0) {
+            return false;
+        }
+        sizes.push_back(static_cast<size_t>(value));
+    }
+    return !sizes.empty();
+}
+
+void PrintUsage() {
+    std::cout << "Usage: aopl_benchmark [options]\n"
+              << "  --entities <list>   Comma-separated corpus sizes (default 1000,10000,100000)\n"
+              << "  --depth <n>         Stages per handler chain (default 16)\n"
+              << "  --iterations <n>    Runs per size; the best time is reported (default 3)\n"
+              << "  --output <file>     Write JSON to a file instead of stdout\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    CorpusConfig config;
+    std::vector<size_t> sizes = {1000, 10000, 100000};
+    size_t iterations = 3;
+    std::string outputPath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--entities" && hasValue) {
+            if (!ParseSizes(argv[++i], sizes)) {
+                std::cerr << "Invalid entity counts: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--depth" && hasValue) {
+            config.depth = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--iterations" && hasValue) {
+            iterations = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        } else if (arg == "--output" && hasValue) {
+            outputPath = argv[++i];
+        } else if (arg == "--help") {
+            PrintUsage();
+            return 0;
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    std::vector<SizeResult> results;
+    bool ok = true;
+    for (size_t entities : sizes) {
+        config.entities = entities;
+        std::cerr << "Benchmarking " << entities << " entities..." << std::endl;
+        results.push_back(RunSize(config, iterations));
+        for (const auto& error : results.back().errors) {
+            std::cerr << "AOPL error: " << error << std::endl;
+            ok = false;
+        }
+        // Release the corpus before generating the next, larger one
+        std::string().swap(results.back().corpus.source);
+    }
+
+    if (outputPath.empty()) {
+        WriteJson(std::cout, results, config, iterations);
+    } else {
+        std::ofstream file(outputPath);
+        if (!file) {
+            std::cerr << "Failed to write " << outputPath << std::endl;
+            return 1;
+        }
+        WriteJson(file, results, config, iterations);
+        std::cerr << "Results written to " << outputPath << std::endl;
+    }
+    return ok ? 0 : 1;
+}
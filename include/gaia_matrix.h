@@ -3,7 +3,20 @@
 // Core engine headers
 #include "gaia_matrix/core.h"
 #include "gaia_matrix/aopl.h"
+#include "gaia_matrix/aopl_runtime.h"
+#include "gaia_matrix/aopl_aot.h"
+#include "gaia_matrix/aopl_cache.h"
+#include "gaia_matrix/aopl_dataflow.h"
+#include "gaia_matrix/aopl_profiler.h"
+#include "gaia_matrix/aopl_hot_reload.h"
+#include "gaia_matrix/aopl_project.h"
 #include "gaia_matrix/neural_engine.h"
+#include "gaia_matrix/neural_batcher.h"
+#include "gaia_matrix/neural_graph.h"
+#include "gaia_matrix/neural_executor.h"
+#include "gaia_matrix/neural_kernels.h"
+#include "gaia_matrix/neural_quantize.h"
+#include "gaia_matrix/neural_tensor.h"
 #include "gaia_matrix/renderer.h"
 #include "gaia_matrix/editor.h"
 #include "gaia_matrix/platform.h"
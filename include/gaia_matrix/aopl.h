@@ -4,6 +4,8 @@
 #include <memory>
 #include <unordered_map>
 #include <vector>
+#include <array>
+#include <cstdint>
 
 namespace gaia_matrix {
 namespace aopl {
@@ -14,6 +16,9 @@ class Entity;
 class Component;
 class Transform;
 class Function;
+class Behavior;
+class AINode;
+struct Module;
 
 /**
  * @brief AOPL Symbol definitions
@@ -24,16 +29,167 @@ namespace Symbol {
     constexpr char COMPONENT = 'C';          // Component
     constexpr char TRANSFORM = 'T';          // Transform
     constexpr char FUNCTION = 'F';           // Function
+    constexpr char INPUT = 'I';              // Input
+    constexpr char VELOCITY = 'V';           // Velocity
     constexpr const char* EVENT = "⊻";       // Event handler
     constexpr const char* CONDITIONAL = "⊿"; // Conditional
     constexpr const char* ASSIGNMENT = "⊸";  // Assignment
+    constexpr const char* WAIT = "⧖";        // Suspend a handler: `⧖ 2s`, or `⧖` for one tick
     constexpr const char* DATAFLOW = "→";    // Data flow
+    constexpr const char* DECLARATION = "⊢"; // Declaration
+    constexpr const char* COMPOSITION = "⊕"; // Composition
+    constexpr const char* ANGLE_OPEN = "〈";  // Name/type list open
+    constexpr const char* ANGLE_CLOSE = "〉"; // Name/type list close
     constexpr const char* NEURAL_NET = "NN"; // Neural network
     constexpr const char* REINFORCE = "RL";  // Reinforcement learning
     constexpr const char* MODEL_PROC = "MCP";// Model-controlled procedural generation
     constexpr const char* GENETIC = "GA";    // Genetic algorithm
 }
 
+/**
+ * @brief Location of a construct in AOPL source (1-based line)
+ */
+struct SourceLocation {
+    int line = 0;
+    int stage = 0;  // 0-based index of the `→` stage within the line
+};
+
+/**
+ * @brief One `→`-separated segment of a data flow chain
+ */
+struct Stage {
+    std::vector<std::string> tokens;
+    SourceLocation location;
+};
+
+/**
+ * @brief Handler binding inside a behavior node, e.g. `Move: I.K W → T.P z+ 0.1`
+ */
+struct Binding {
+    std::string handler;
+    std::vector<Stage> stages;
+    SourceLocation location;
+};
+
+/**
+ * @brief Replacement of a range of source text, as produced by an editor
+ *
+ * Lines are 1-based like SourceLocation; columns are 0-based byte offsets
+ * into the line. The range is half-open: [start, end).
+ */
+struct TextEdit {
+    int startLine = 1;
+    int startColumn = 0;
+    int endLine = 1;
+    int endColumn = 0;
+    std::string text;
+};
+
+/**
+ * @brief What an incremental Parser::ApplyEdit() changed
+ */
+struct ParseChanges {
+    std::vector<std::string> changedEntities;  // Entities added, removed or modified
+    std::vector<std::string> changedBehaviors; // Behaviors whose header or bindings changed
+    std::vector<std::string> changedHandlers;  // "Behavior.Handler" for each changed handler
+    std::vector<std::string> changedAINodes;   // AI nodes added, removed or modified
+    uint32_t blocksReparsed = 0;
+    uint32_t blocksReused = 0;
+
+    bool Empty() const {
+        return changedEntities.empty() && changedBehaviors.empty() && changedHandlers.empty() &&
+               changedAINodes.empty();
+    }
+};
+
+/**
+ * @brief Optimizer passes run by Parser::Compile() after lowering
+ */
+struct OptimizerConfig {
+    bool constantFolding = true;     // Fold and propagate constants, resolve known guards
+    bool commonSubexpressions = true;// Drop repeated guards and copies
+    bool deadStores = true;          // Drop writes that are overwritten before being read
+    bool deadCode = true;            // Drop no-ops, trailing guards and empty handlers
+    bool flowFusion = true;          // Fuse each behavior's handlers into one pass over the world
+};
+
+/**
+ * @brief Counters reported by the optimizer passes
+ */
+struct OptimizerStats {
+    uint32_t instructionsBefore = 0;
+    uint32_t instructionsAfter = 0;
+    uint32_t constantsFolded = 0;
+    uint32_t guardsFolded = 0;
+    uint32_t guardsDeduplicated = 0;
+    uint32_t copiesDeduplicated = 0;
+    uint32_t deadStoresRemoved = 0;
+    uint32_t deadInstructionsRemoved = 0;
+    uint32_t handlersRemoved = 0;
+    uint32_t handlersFused = 0;
+};
+
+/**
+ * @brief Static type of an AOPL value (see "Data Types" in the reference)
+ */
+enum class ValueType : uint8_t {
+    Unknown,
+    Number,     // N
+    Bool,       // B
+    Vector,     // V, with 2-4 components
+    String,     // S
+    Entity      // E
+};
+
+/**
+ * @brief Inferred type of a named value
+ */
+struct TypeInfo {
+    ValueType type = ValueType::Unknown;
+    uint8_t width = 0;          // Float slots occupied: 1 for N/B, 2-4 for V, 0 if not numeric or unknown
+    SourceLocation location;    // Site that fixed the type
+};
+
+/**
+ * @brief Problem found by type inference
+ */
+struct TypeDiagnostic {
+    std::string name;
+    std::string message;
+    SourceLocation location;
+};
+
+/**
+ * @brief Result of type inference over a parsed script
+ */
+struct TypeTable {
+    std::unordered_map<std::string, TypeInfo> values;   // Built-in slots, script variables and entity names
+    std::vector<TypeDiagnostic> errors;                 // Conflicting uses; compilation fails
+    std::vector<TypeDiagnostic> ambiguities;            // Sites whose type could not be resolved
+
+    /**
+     * @brief Find the type of a value
+     * @param name Value name such as "T.P" or "grounded"
+     * @return Type or nullptr if the name never occurs
+     */
+    const TypeInfo* Find(const std::string& name) const;
+};
+
+/**
+ * @brief Format a type for messages, e.g. "vec3" or "bool"
+ * @param info Type to format
+ * @return Type name
+ */
+std::string FormatType(const TypeInfo& info);
+
+/**
+ * @brief Split a line of AOPL into `→`-separated stages of whitespace tokens
+ * @param text Text to split (without the leading `Name:` label)
+ * @param line Source line number recorded on each stage
+ * @return Stages in flow order
+ */
+std::vector<Stage> SplitFlow(const std::string& text, int line);
+
 /**
  * @brief Parser for the AI-Optimized Programming Language (AOPL)
  */
@@ -45,25 +201,151 @@ public:
     /**
      * @brief Parse AOPL code from string
      * @param code AOPL code to parse
-     * @return True if parsing was successful
+     * @return True if parsing was successful; otherwise GetErrors() lists the problems
      */
     bool Parse(const std::string& code);
 
+    /**
+     * @brief Apply an editor change to the source of the last Parse()
+     *
+     * Source is split into blocks, each starting at a node declaration line.
+     * Only the blocks touched by the edit are reparsed; nodes of the other
+     * blocks are kept (and their line numbers shifted). The compiled module
+     * is dropped, as with Parse().
+     * @param edit Range to replace and its replacement text
+     * @param changes Receives the entities, behaviors and handlers that changed
+     * @return True if the edit was applied and the blocks it reparsed have no
+     *         errors. A valid range is applied even when they do, so a later
+     *         edit can fix them; GetErrors() lists the problems.
+     */
+    bool ApplyEdit(const TextEdit& edit, ParseChanges& changes);
+
+    /**
+     * @brief Get the current source text, including applied edits
+     * @return Source text
+     */
+    std::string GetSource() const;
+
     /**
      * @brief Get parsed entities
      * @return Vector of parsed entities
      */
     const std::vector<std::shared_ptr<Entity>>& GetEntities() const;
 
+    /**
+     * @brief Get parsed behavior nodes (`N〈Name〉: ...` blocks)
+     * @return Vector of parsed behaviors
+     */
+    const std::vector<std::shared_ptr<Behavior>>& GetBehaviors() const;
+
+    /**
+     * @brief Get parsed AI nodes (NN, RL, GA and MCP blocks)
+     * @return Vector of parsed AI nodes
+     */
+    const std::vector<std::shared_ptr<AINode>>& GetAINodes() const;
+
+    /**
+     * @brief Look up any parsed node by name
+     * @param name Node name
+     * @return Node or nullptr if not found
+     */
+    std::shared_ptr<Node> FindNode(const std::string& name) const;
+
     /**
      * @brief Compile AOPL code to executable format
-     * @return True if compilation was successful
+     * @return True if compilation was successful; false if the source has parse errors
      */
     bool Compile();
 
+    /**
+     * @brief Select the optimizer passes used by Compile()
+     * @param config Optimizer configuration
+     */
+    void SetOptimizerConfig(const OptimizerConfig& config);
+
+    /**
+     * @brief Get optimizer counters from the last successful Compile()
+     * @return Optimizer statistics
+     */
+    const OptimizerStats& GetOptimizerStats() const;
+
+    /**
+     * @brief Get the module produced by the last successful Compile()
+     * @return Compiled module or nullptr
+     */
+    std::shared_ptr<const Module> GetModule() const;
+
+    /**
+     * @brief Get the types inferred by the last Compile()
+     * @return Type table
+     */
+    const TypeTable& GetTypes() const;
+
+    /**
+     * @brief Get warnings of the last Compile(), such as values whose type could not be inferred
+     * @return Warning messages prefixed with their source line
+     */
+    const std::vector<std::string>& GetWarnings() const;
+
+    /**
+     * @brief Get errors reported by the last Parse() or Compile()
+     * @return Error messages prefixed with their source line
+     */
+    const std::vector<std::string>& GetErrors() const;
+
 private:
+    /**
+     * @brief Parse a single trimmed, comment-free line
+     * @param line Line text
+     * @param lineNumber 1-based line number
+     */
+    void ParseLine(const std::string& line, int lineNumber);
+
+    /**
+     * @brief Run of source lines starting at a node declaration (or at line 1)
+     */
+    struct Block {
+        int firstLine = 1;
+        int lineCount = 0;
+        std::shared_ptr<Node> node;
+        std::vector<std::string> errors;
+    };
+
+    /**
+     * @brief Split lines [firstLine, endLine) into blocks
+     */
+    std::vector<Block> SplitBlocks(int firstLine, int endLine) const;
+
+    /**
+     * @brief Parse the lines of one block, filling in its node and errors
+     */
+    void ParseBlock(Block& block);
+
+    /**
+     * @brief Rebuild node lists, registry and errors from m_Blocks
+     */
+    void RebuildFromBlocks();
+
+    /**
+     * @brief Reset m_Errors to the parse errors of m_Blocks
+     */
+    void CollectBlockErrors();
+
+    std::vector<std::string> m_Lines;
+    std::vector<Block> m_Blocks;
     std::vector<std::shared_ptr<Entity>> m_Entities;
+    std::vector<std::shared_ptr<Behavior>> m_Behaviors;
+    std::vector<std::shared_ptr<AINode>> m_AINodes;
     std::unordered_map<std::string, std::shared_ptr<Node>> m_NodeRegistry;
+    std::shared_ptr<Entity> m_CurrentEntity;
+    std::shared_ptr<Behavior> m_CurrentBehavior;
+    std::shared_ptr<AINode> m_CurrentAINode;
+    std::shared_ptr<const Module> m_Module;
+    OptimizerConfig m_OptimizerConfig;
+    OptimizerStats m_OptimizerStats;
+    TypeTable m_Types;
+    std::vector<std::string> m_Warnings;
+    std::vector<std::string> m_Errors;
     bool m_IsParsed = false;
 };
 
@@ -81,8 +363,73 @@ public:
      */
     const std::string& GetName() const;
 
+    /**
+     * @brief Get the source location of the node declaration
+     * @return Source location
+     */
+    const SourceLocation& GetLocation() const;
+
+    /**
+     * @brief Set the source location of the node declaration
+     * @param location Source location
+     */
+    void SetLocation(const SourceLocation& location);
+
+    /**
+     * @brief Move the node and everything it owns by a number of source lines
+     * @param delta Lines to add to every source location
+     */
+    virtual void ShiftLines(int delta);
+
 private:
     std::string m_Name;
+    SourceLocation m_Location;
+};
+
+/**
+ * @brief Component attached to an entity (`T`, `C`, `I`, ...)
+ */
+class Component : public Node {
+public:
+    Component(char type, const std::vector<Stage>& stages = {});
+    ~Component() override = default;
+
+    /**
+     * @brief Get the component type symbol
+     * @return Component type character
+     */
+    char GetType() const;
+
+    /**
+     * @brief Get the flow stages declared on the component line
+     * @return Stages
+     */
+    const std::vector<Stage>& GetStages() const;
+
+    /**
+     * @brief Replace the flow stages declared on the component line
+     * @param stages Stages
+     */
+    void SetStages(const std::vector<Stage>& stages);
+
+    void ShiftLines(int delta) override;
+
+private:
+    char m_Type;
+    std::vector<Stage> m_Stages;
+};
+
+/**
+ * @brief Transform component (`T: P x y z → R x y z → S x y z`)
+ */
+class Transform : public Component {
+public:
+    Transform();
+    ~Transform() override = default;
+
+    std::array<float, 3> position = {0.0f, 0.0f, 0.0f};
+    std::array<float, 3> rotation = {0.0f, 0.0f, 0.0f};
+    std::array<float, 3> scale = {1.0f, 1.0f, 1.0f};
 };
 
 /**
@@ -111,10 +458,100 @@ public:
      */
     std::shared_ptr<Transform> GetTransform() const;
 
+    /**
+     * @brief Get component by type symbol
+     * @param type Component type character
+     * @return Component or nullptr
+     */
+    std::shared_ptr<Component> GetComponent(char type) const;
+
+    void ShiftLines(int delta) override;
+
 private:
     std::vector<std::shared_ptr<Component>> m_Components;
     std::shared_ptr<Transform> m_Transform;
 };
 
+/**
+ * @brief Behavior node (`N〈PlayerController〉: V ⊢ I → F Move → ...`) holding handler bindings
+ */
+class Behavior : public Node {
+public:
+    Behavior(const std::string& name, const std::vector<Stage>& flow);
+    ~Behavior() override = default;
+
+    /**
+     * @brief Add a handler binding
+     * @param binding Binding to add
+     */
+    void AddBinding(const Binding& binding);
+
+    /**
+     * @brief Get handler bindings in source order
+     * @return Bindings
+     */
+    const std::vector<Binding>& GetBindings() const;
+
+    /**
+     * @brief Get the flow declared on the node header
+     * @return Header stages
+     */
+    const std::vector<Stage>& GetFlow() const;
+
+    void ShiftLines(int delta) override;
+
+private:
+    std::vector<Stage> m_Flow;
+    std::vector<Binding> m_Bindings;
+};
+
+/**
+ * @brief AI node (`NN`, `RL`, `GA` or `〈MCP〉`) with its `⊸ Key values` properties
+ */
+class AINode : public Node {
+public:
+    AINode(const std::string& kind, const std::string& name, const std::vector<Stage>& flow);
+    ~AINode() override = default;
+
+    /**
+     * @brief Get the node kind (one of the AI-specific symbols)
+     * @return Kind string, e.g. "NN"
+     */
+    const std::string& GetKind() const;
+
+    /**
+     * @brief Get the flow declared on the node header
+     * @return Header stages
+     */
+    const std::vector<Stage>& GetFlow() const;
+
+    /**
+     * @brief Set a property from a `⊸ Key values...` line
+     * @param key Property key
+     * @param values Property values (quotes removed)
+     */
+    void SetProperty(const std::string& key, const std::vector<std::string>& values);
+
+    /**
+     * @brief Get a property
+     * @param key Property key
+     * @return Values or nullptr if not set
+     */
+    const std::vector<std::string>* GetProperty(const std::string& key) const;
+
+    /**
+     * @brief Get all properties
+     * @return Properties by key
+     */
+    const std::unordered_map<std::string, std::vector<std::string>>& GetProperties() const;
+
+    void ShiftLines(int delta) override;
+
+private:
+    std::string m_Kind;
+    std::vector<Stage> m_Flow;
+    std::unordered_map<std::string, std::vector<std::string>> m_Properties;
+};
+
 } // namespace aopl
-} // namespace gaia_matrix
\ No newline at end of file
+} // namespace gaia_matrix
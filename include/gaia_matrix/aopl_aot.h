@@ -0,0 +1,90 @@
+#pragma once
+
+#include "gaia_matrix/aopl_runtime.h"
+#include <string>
+#include <memory>
+#include <vector>
+
+namespace gaia_matrix {
+namespace aopl {
+
+/**
+ * @brief Options for ahead-of-time compilation of AOPL modules
+ */
+struct AotOptions {
+    std::string compiler = "";          // C++ compiler, e.g. "ccache c++"; empty uses $CXX or "c++"
+    std::string optimizationFlags = "-O3";  // Split on whitespace; run without a shell, so nothing is expanded
+    bool keepGeneratedSource = false;   // Leave the generated .cpp next to the library
+};
+
+/**
+ * @brief Ahead-of-time compiler from AOPL modules to native shared objects
+ *
+ * Each handler becomes an `extern "C"` function with the NativeHandler entry
+ * point signature. Entity slots are accessed through a generated typed
+ * `EntityView` struct so the system compiler sees plain float arithmetic.
+ */
+class AotCompiler {
+public:
+    /**
+     * @brief Generate C++ source for a module
+     * @param module Compiled module
+     * @return C++ translation unit
+     */
+    static std::string GenerateSource(const Module& module);
+
+    /**
+     * @brief Generate C++ for a module and build it into a shared object
+     * @param module Compiled module
+     * @param outputPath Path of the shared object to write
+     * @param options Compiler options
+     * @return True if the library was built
+     */
+    static bool BuildLibrary(const Module& module, const std::string& outputPath, const AotOptions& options = AotOptions());
+
+    /**
+     * @brief Get the exported symbol name of a handler
+     * @param index Handler index in the module
+     * @return Symbol name
+     */
+    static std::string GetHandlerSymbol(size_t index);
+};
+
+/**
+ * @brief Shared object produced by AotCompiler, loaded with dlopen
+ */
+class AotLibrary {
+public:
+    ~AotLibrary();
+
+    AotLibrary(const AotLibrary&) = delete;
+    AotLibrary& operator=(const AotLibrary&) = delete;
+
+    /**
+     * @brief Load a library and bind its handler symbols
+     * @param path Path to the shared object
+     * @param module Module the library must have been generated from
+     * @return Library or nullptr if loading or validation failed
+     */
+    static std::shared_ptr<AotLibrary> Load(const std::string& path, const Module& module);
+
+    /**
+     * @brief Get the native entry point of a handler
+     * @param index Handler index in the module
+     * @return Entry point
+     */
+    NativeHandler::EntryPoint GetHandler(size_t index) const;
+
+    size_t GetHandlerCount() const;
+    uint64_t GetModuleHash() const;
+
+private:
+    AotLibrary() = default;
+
+    void* m_Handle = nullptr;
+    uint64_t m_ModuleHash = 0;
+    std::vector<NativeHandler::EntryPoint> m_Handlers;
+};
+
+} // namespace aopl
+} // namespace gaia_matrix
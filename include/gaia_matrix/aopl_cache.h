@@ -0,0 +1,108 @@
+#pragma once
+
+#include "gaia_matrix/aopl_runtime.h"
+#include <string>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace gaia_matrix {
+namespace aopl {
+
+/**
+ * @brief Compiled script as stored in the precompiled cache
+ *
+ * Besides the module itself, the entry keeps the names a project build
+ * needs for dependency resolution so a cache hit skips parsing entirely.
+ */
+struct ModuleCacheEntry {
+    std::shared_ptr<const Module> module;
+    std::vector<std::string> declarations;
+    std::vector<std::string> references;
+    std::vector<std::string> paths;
+};
+
+/**
+ * @brief Cache hit/miss counters
+ */
+struct ModuleCacheStats {
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+    uint32_t rejected = 0;      // Files that existed but were corrupt or from another format version
+    uint32_t stores = 0;
+    double loadMilliseconds = 0.0;
+};
+
+/**
+ * @brief Directory of precompiled AOPL modules (`<key>.aoplc`)
+ *
+ * Entries are keyed by a hash of the source text, the compiler version and
+ * the optimizer configuration, so an unchanged script always maps to the
+ * same file and any change simply misses. Files are read through mmap and
+ * validated against their header and module hash before use. Safe to use
+ * from several threads at once.
+ */
+class ModuleCache {
+public:
+    /**
+     * @brief Bumped whenever lowering, optimization or the file layout changes
+     */
+    static constexpr uint32_t FORMAT_VERSION = 4;
+
+    explicit ModuleCache(const std::string& directory);
+
+    /**
+     * @brief Compute the cache key of a script
+     * @param source AOPL source text
+     * @param config Optimizer configuration the module is compiled with
+     * @return 64-bit key
+     */
+    static uint64_t ComputeKey(const std::string& source, const OptimizerConfig& config);
+
+    /**
+     * @brief Load a cached entry
+     * @param key Key from ComputeKey()
+     * @param entry Receives the module and symbol lists on a hit
+     * @param label Script name shown in the report
+     * @return True on a cache hit
+     */
+    bool Load(uint64_t key, ModuleCacheEntry& entry, const std::string& label);
+
+    /**
+     * @brief Store an entry, replacing any existing file atomically
+     * @param key Key from ComputeKey()
+     * @param entry Compiled module and symbol lists
+     * @return True if the file was written
+     */
+    bool Store(uint64_t key, const ModuleCacheEntry& entry);
+
+    /**
+     * @brief Get the path of the file backing a key
+     * @param key Cache key
+     * @return File path inside the cache directory
+     */
+    std::string GetPath(uint64_t key) const;
+
+    ModuleCacheStats GetStats() const;
+
+    /**
+     * @brief Format a hit/miss report with one line per looked-up script
+     * @return Human-readable report
+     */
+    std::string GetReport() const;
+
+private:
+    struct Lookup {
+        std::string label;
+        bool hit;
+        double milliseconds;
+    };
+
+    std::string m_Directory;
+    mutable std::mutex m_Mutex;
+    ModuleCacheStats m_Stats;
+    std::vector<Lookup> m_Lookups;
+};
+
+} // namespace aopl
+} // namespace gaia_matrix
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "gaia_matrix/aopl_runtime.h"
+#include <array>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gaia_matrix {
+namespace aopl {
+
+/**
+ * @brief One handler in the dataflow graph of a module
+ *
+ * Stages of a binding are chained by their guards, so a handler is the
+ * smallest unit that can run on its own. Its read and write sets are the
+ * union over its stages.
+ */
+struct DataflowNode {
+    uint32_t handler = 0;
+    std::vector<uint16_t> reads;        // Slots read by guards, copies and integrations (sorted)
+    std::vector<uint16_t> writes;       // Slots written (sorted)
+    bool readsInput = false;            // Has `I.K` guards
+    std::array<uint64_t, 4> keys = {0, 0, 0, 0}; // Key codes tested by those guards, as an InputState mask
+    bool serial = false;                // Resumable: touches the runtime's timer wheel, runs on the calling thread
+    bool pure = false;                  // Never reads what it writes: rerunning it on unchanged reads and keys is a no-op
+    std::vector<uint32_t> dependencies; // Earlier nodes it conflicts with
+    uint32_t level = 0;                 // Nodes of one level are independent of each other
+};
+
+/**
+ * @brief Dataflow DAG of a module's handlers, grouped into barrier-separated levels
+ *
+ * A handler depends on every earlier handler whose writes overlap its
+ * reads or writes, or whose reads overlap its writes. Handlers with no
+ * path between them touch disjoint state and may run concurrently; a
+ * barrier between levels keeps the results identical to running the
+ * handlers one after another in module order.
+ */
+struct DataflowGraph {
+    std::vector<DataflowNode> nodes;
+    std::vector<std::vector<uint32_t>> levels;
+
+    /**
+     * @brief Format the levels and dependencies for debugging
+     * @param module Module the graph was built from, for handler names
+     * @return One line per node
+     */
+    std::string ToString(const Module& module) const;
+};
+
+/**
+ * @brief Build the dataflow graph of a module
+ * @param module Compiled module
+ * @return Graph with one node per handler
+ */
+DataflowGraph BuildDataflowGraph(const Module& module);
+
+/**
+ * @brief Persistent worker threads that run one batch of tasks at a time
+ *
+ * Run() blocks until every task of the batch has finished, which is the
+ * barrier between two dataflow levels. The calling thread takes part.
+ */
+class WorkerPool {
+public:
+    /**
+     * @brief Start the workers
+     * @param threadCount Total threads including the caller; 0 uses one per core
+     */
+    explicit WorkerPool(uint32_t threadCount = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * @brief Run `count` tasks and wait for all of them
+     * @param count Number of tasks
+     * @param task Called once with each index in [0, count)
+     */
+    void Run(size_t count, const std::function<void(size_t)>& task);
+
+    /**
+     * @brief Get the number of threads, including the caller
+     */
+    uint32_t GetThreadCount() const;
+
+private:
+    void Work();
+    void WorkerLoop();
+
+    std::vector<std::thread> m_Threads;
+    std::mutex m_Mutex;
+    std::condition_variable m_Wake;
+    std::condition_variable m_Done;
+    const std::function<void(size_t)>* m_Task = nullptr;
+    size_t m_Count = 0;
+    size_t m_Next = 0;
+    size_t m_Finished = 0;
+    uint64_t m_Generation = 0;
+    bool m_Stopping = false;
+};
+
+} // namespace aopl
+} // namespace gaia_matrix
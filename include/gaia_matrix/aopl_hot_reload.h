@@ -0,0 +1,84 @@
+#pragma once
+
+#include "gaia_matrix/aopl_project.h"
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gaia_matrix {
+namespace aopl {
+
+/**
+ * @brief Outcome of one HotReloader::Poll()
+ */
+struct HotReloadResult {
+    bool reloaded = false;                  // A new module was linked and swapped into the runtimes
+    std::vector<std::string> changedFiles;  // Files added, modified or removed since the last poll
+    std::vector<std::string> errors;        // Build errors; the previous module keeps running
+    uint32_t filesCompiled = 0;
+    ReloadStats runtime;                    // Migration done on the first attached runtime
+};
+
+/**
+ * @brief Watches a directory of .aopl files and reloads running scripts on change
+ *
+ * Poll() compares file modification times, recompiles only the files
+ * whose contents changed, relinks the project and swaps the result into
+ * every attached Runtime with Runtime::Reload(), so entity state survives
+ * edits that add, remove or retype variables.
+ */
+class HotReloader {
+public:
+    explicit HotReloader(const std::string& directory, const ProjectConfig& config = ProjectConfig());
+
+    /**
+     * @brief Scan the directory and build every file
+     * @return True if the initial build succeeded
+     */
+    bool Start();
+
+    /**
+     * @brief Reload runtimes whenever a new module is built
+     * @param runtime Runtime created from GetModule()
+     */
+    void Attach(std::shared_ptr<Runtime> runtime);
+
+    /**
+     * @brief Check for changed files and reload if there are any
+     * @return What changed and whether the runtimes were reloaded
+     */
+    HotReloadResult Poll();
+
+    /**
+     * @brief Get the module of the last successful build
+     * @return Module or nullptr
+     */
+    std::shared_ptr<const Module> GetModule() const;
+
+    /**
+     * @brief Get errors of the last failed build
+     * @return Error messages prefixed with their file
+     */
+    const std::vector<std::string>& GetErrors() const;
+
+    const std::string& GetDirectory() const;
+
+private:
+    /**
+     * @brief Sync the project with the files on disk
+     * @return Paths whose contents changed
+     */
+    std::vector<std::string> Scan();
+
+    std::string m_Directory;
+    ProjectCompiler m_Project;
+    std::map<std::string, std::filesystem::file_time_type> m_Timestamps;
+    std::shared_ptr<const Module> m_Module;
+    std::vector<std::shared_ptr<Runtime>> m_Runtimes;
+    std::vector<std::string> m_Errors;
+};
+
+} // namespace aopl
+} // namespace gaia_matrix
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "gaia_matrix/aopl_runtime.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gaia_matrix {
+namespace aopl {
+
+/**
+ * @brief How the profiler attributes time within a handler
+ */
+enum class ProfileMode {
+    Sampling,   // A background thread samples the executing stage; handlers keep their tier
+    Exact       // Every instruction is counted; handlers are forced onto the per-entity interpreter
+};
+
+/**
+ * @brief Granularity of a profile report
+ */
+enum class ProfileLevel {
+    Handler,
+    Line,
+    Stage
+};
+
+/**
+ * @brief Profiler configuration
+ */
+struct ProfilerConfig {
+    ProfileMode mode = ProfileMode::Sampling;
+    uint32_t sampleIntervalMicroseconds = 1000;
+};
+
+/**
+ * @brief Time and counts attributed to one handler, line or stage
+ */
+struct ProfileEntry {
+    std::string file;           // Source file, empty for modules compiled by a single Parser
+    int line = 0;
+    int stage = -1;             // `→` stage index, -1 for handler and line entries
+    std::string handler;        // "Behavior.Handler" (or the behavior for fused handlers)
+    uint64_t invocations = 0;   // Entities that reached this point (exact mode or handler level only)
+    uint64_t samples = 0;       // Sampler hits (sampling mode)
+    double milliseconds = 0.0;
+    double percent = 0.0;       // Share of all profiled handler time
+
+    /**
+     * @brief Format the location as `file:line` or `file:line →stage`
+     */
+    std::string GetLocation() const;
+};
+
+/**
+ * @brief Attributes AOPL execution time to handlers, source lines and `→` stages
+ *
+ * Each handler run is timed as a whole. Time inside a handler is split
+ * over its lines and stages by sampler hits in sampling mode, or by
+ * executed instructions in exact mode. Sampling keeps JIT and AOT code
+ * running (native code is attributed to its handler only); exact mode
+ * runs everything through the interpreter so counts are precise.
+ * Attach with Runtime::SetProfiler().
+ */
+class Profiler {
+public:
+    explicit Profiler(const ProfilerConfig& config = ProfilerConfig());
+    ~Profiler();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    /**
+     * @brief Bind to a module and clear collected data
+     * @param module Module whose handlers are profiled
+     */
+    void Reset(std::shared_ptr<const Module> module);
+
+    ProfileMode GetMode() const;
+
+    /**
+     * @brief Mark a handler as executing (sampling mode)
+     * @param index Handler index
+     */
+    void Enter(size_t index);
+
+    /**
+     * @brief Mark that no handler is executing
+     */
+    void Leave();
+
+    /**
+     * @brief Record one run of a handler over the world
+     * @param index Handler index
+     * @param invocations Entities the handler ran for
+     * @param milliseconds Wall time of the run
+     */
+    void Record(size_t index, uint64_t invocations, double milliseconds);
+
+    /**
+     * @brief Get the per-instruction counters of a handler, for Interpret()
+     * @param index Handler index
+     * @return Counter array with one entry per instruction
+     */
+    uint64_t* GetInstructionCounts(size_t index);
+
+    /**
+     * @brief Get the program counter the interpreters publish for the sampler
+     */
+    std::atomic<uint32_t>* GetCursor();
+
+    /**
+     * @brief Get collected entries, most expensive first
+     * @param level Handler, line or stage granularity
+     * @return Profile entries
+     */
+    std::vector<ProfileEntry> GetEntries(ProfileLevel level) const;
+
+    /**
+     * @brief Format a report of handlers with their lines and stages
+     * @return Human-readable report
+     */
+    std::string GetReport() const;
+
+private:
+    static constexpr uint32_t IDLE = 0xFFFFFFFF;
+
+    struct HandlerProfile {
+        uint64_t invocations = 0;
+        double milliseconds = 0.0;
+        std::vector<uint64_t> counts;   // Exact mode: executions per instruction
+        std::vector<uint64_t> samples;  // Sampling mode: hits per instruction, plus one for native code
+    };
+
+    void Sample();
+
+    ProfilerConfig m_Config;
+    std::shared_ptr<const Module> m_Module;
+    std::vector<HandlerProfile> m_Handlers;
+    std::atomic<uint32_t> m_Handler{IDLE};
+    std::atomic<uint32_t> m_Cursor{IDLE};
+    mutable std::mutex m_Mutex;
+    std::atomic<bool> m_Running{false};
+    std::thread m_Sampler;
+};
+
+} // namespace aopl
+} // namespace gaia_matrix
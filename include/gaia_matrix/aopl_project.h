@@ -0,0 +1,143 @@
+#pragma once
+
+#include "gaia_matrix/aopl_cache.h"
+#include <string>
+#include <memory>
+#include <vector>
+
+namespace gaia_matrix {
+namespace aopl {
+
+/**
+ * @brief Project build configuration
+ */
+struct ProjectConfig {
+    uint32_t threadCount = 0;       // Worker threads for parsing and compiling; 0 uses all cores
+    OptimizerConfig optimizer;      // Passes run on each file before linking
+    std::string cacheDirectory;     // Precompiled .aoplc cache; empty disables caching
+};
+
+/**
+ * @brief One source file of a project and the result of compiling it on its own
+ */
+struct ProjectFile {
+    std::string path;
+    std::string source;
+    std::vector<std::string> declarations;  // Node names declared in this file
+    std::vector<std::string> references;    // Names that must resolve, from `E PlayerEntity` stages
+    std::vector<std::string> paths;         // Dotted property values, e.g. `PlayerEntity.T.P`
+    std::vector<size_t> dependencies;       // Indices of other files declaring referenced names
+    std::shared_ptr<const Module> module;   // File-local module (own slot layout) before linking
+    std::vector<std::string> errors;
+    bool fromCache = false;                 // Module was loaded from the precompiled cache
+    bool dirty = true;                      // Source changed since the file was last compiled
+};
+
+/**
+ * @brief Timings and counters of the last project build
+ */
+struct ProjectStats {
+    uint32_t filesCompiled = 0;         // Files new or changed since the previous Build()
+    uint32_t threadsUsed = 0;
+    uint32_t cacheHits = 0;
+    uint32_t cacheMisses = 0;
+    double compileMilliseconds = 0.0;   // Parallel parse + lower + optimize
+    double linkMilliseconds = 0.0;      // Serial dependency resolution and link
+};
+
+/**
+ * @brief Compiles a set of AOPL files into one module
+ *
+ * Files are parsed, lowered and optimized independently on worker threads.
+ * Cross-file references (`NN〈PlayerAnimator〉: E PlayerEntity` naming an
+ * entity declared in another file) form a dependency graph, and only the
+ * final link, which merges the per-file modules in dependency order onto a
+ * shared slot layout, runs serially.
+ */
+class ProjectCompiler {
+public:
+    explicit ProjectCompiler(const ProjectConfig& config = ProjectConfig());
+
+    /**
+     * @brief Add a source file
+     * @param path Path used to identify the file in errors and build order
+     * @param source AOPL source text
+     */
+    void AddFile(const std::string& path, const std::string& source);
+
+    /**
+     * @brief Replace the source of a file, or add it if the path is new
+     *
+     * The next Build() recompiles only files changed this way; the others
+     * keep their per-file module and are just linked again.
+     * @param path Path given to AddFile()
+     * @param source New source text
+     * @return True if the source differs from the current one
+     */
+    bool UpdateFile(const std::string& path, const std::string& source);
+
+    /**
+     * @brief Remove a file from the project
+     * @param path Path given to AddFile()
+     * @return True if the file existed
+     */
+    bool RemoveFile(const std::string& path);
+
+    /**
+     * @brief Add every .aopl file below a directory, in path order
+     * @param directory Directory to search recursively
+     * @return Number of files added
+     */
+    size_t AddDirectory(const std::string& directory);
+
+    /**
+     * @brief Compile all files and link them
+     * @return True if every file compiled, every reference resolved and the graph is acyclic
+     */
+    bool Build();
+
+    /**
+     * @brief Get the linked module of the last successful Build()
+     * @return Module or nullptr
+     */
+    std::shared_ptr<const Module> GetModule() const;
+
+    const std::vector<ProjectFile>& GetFiles() const;
+
+    /**
+     * @brief Get file paths in link order (dependencies first)
+     * @return Paths of the last successful Build()
+     */
+    std::vector<std::string> GetBuildOrder() const;
+
+    /**
+     * @brief Get errors of the last Build(), prefixed with their file
+     * @return Error messages
+     */
+    const std::vector<std::string>& GetErrors() const;
+
+    const ProjectStats& GetStats() const;
+
+    /**
+     * @brief Get the precompiled module cache
+     * @return Cache or nullptr if ProjectConfig::cacheDirectory is empty
+     */
+    const ModuleCache* GetCache() const;
+
+private:
+    void CompileFile(ProjectFile& file);
+    bool ResolveDependencies();
+    bool SortFiles();
+    bool Link();
+
+    ProjectConfig m_Config;
+    std::unique_ptr<ModuleCache> m_Cache;
+    std::vector<ProjectFile> m_Files;
+    std::vector<size_t> m_BuildOrder;
+    std::shared_ptr<Module> m_Module;
+    std::vector<std::string> m_Errors;
+    ProjectStats m_Stats;
+};
+
+} // namespace aopl
+} // namespace gaia_matrix
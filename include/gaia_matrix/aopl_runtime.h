@@ -0,0 +1,811 @@
+#pragma once
+
+#include "gaia_matrix/aopl.h"
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+namespace gaia_matrix {
+namespace aopl {
+
+/**
+ * @brief Number of entities stored per world chunk.
+ *
+ * Entity state is kept structure-of-arrays inside a chunk: slot `s` of the
+ * entity in lane `l` lives at `slots[s * CHUNK_SIZE + l]`.
+ */
+constexpr uint32_t CHUNK_SIZE = 64;
+
+/**
+ * @brief Entity handle inside a World
+ */
+using EntityId = int32_t;
+
+/**
+ * @brief Lowered AOPL operation
+ */
+enum class OpCode : uint8_t {
+    Nop,
+    TestKey,    // Abort handler unless key `src` is held
+    TestFlag,   // Abort handler unless (slot[src] != 0) == (imm[0] != 0)
+    Store,      // slot[dst + i] = imm[i]
+    Add,        // slot[dst + i] += imm[i]
+    Copy,       // slot[dst + i] = slot[src + i]
+    AddScaled,  // slot[dst + i] += slot[src + i] * dt
+    Segment,    // Start of a fused flow covering the next `dst` instructions;
+                // a failed guard inside it skips to its end instead of aborting
+    Wait        // Suspend the handler for imm[0] seconds (0: until the next tick)
+};
+
+/**
+ * @brief Single lowered instruction operating on entity slots
+ */
+struct Instruction {
+    OpCode op = OpCode::Nop;
+    uint8_t width = 1;
+    uint16_t dst = 0;
+    uint16_t src = 0;
+    std::array<float, 4> imm = {0.0f, 0.0f, 0.0f, 0.0f};
+    SourceLocation location;
+};
+
+/**
+ * @brief Lowered handler: one binding line of a behavior node
+ */
+struct Handler {
+    std::string name;
+    std::string behavior;
+    std::string file;               // Source file, set when linked by a ProjectCompiler
+    std::vector<Instruction> code;
+    SourceLocation location;
+};
+
+/**
+ * @brief Initial state of an entity declared with `N ⊢ E〈Name〉`
+ */
+struct EntityTemplate {
+    std::string name;
+    std::vector<float> initialSlots;
+};
+
+/**
+ * @brief Compiled AOPL module ready to be executed by a Runtime
+ */
+struct Module {
+    /**
+     * @brief Named slot ranges (e.g. "T.P" covers 3 slots, "T.P.z" 1 slot)
+     */
+    struct SlotRange {
+        uint16_t index = 0;
+        uint8_t width = 1;
+    };
+
+    std::unordered_map<std::string, SlotRange> slots;
+    uint16_t slotCount = 0;
+    std::vector<Handler> handlers;
+    std::vector<EntityTemplate> templates;
+
+    /**
+     * @brief Find a named slot range
+     * @param path Slot path such as "T.P", "V.y" or "grounded"
+     * @return Pointer to the range or nullptr
+     */
+    const SlotRange* FindSlot(const std::string& path) const;
+
+    /**
+     * @brief Find an entity template
+     * @param name Template name
+     * @return Pointer to the template or nullptr
+     */
+    const EntityTemplate* FindTemplate(const std::string& name) const;
+};
+
+/**
+ * @brief Infer the type and width of every value used by a parsed script
+ *
+ * Built-in slots have fixed types; script variables take their type from
+ * `⊸` literals, `N ⊢ name` style declarations in behavior headers, `⊿`
+ * conditions, and copies or integrations that equate two values.
+ * @param parser Parser holding a successful parse
+ * @param types Receives the inferred types and diagnostics
+ * @return True if no conflicting uses were found
+ */
+bool InferTypes(const Parser& parser, TypeTable& types);
+
+/**
+ * @brief Lower parsed AOPL into an executable module
+ *
+ * Runs InferTypes() first so vector variables get contiguous slots and
+ * width-N instructions.
+ * @param parser Parser holding a successful parse
+ * @param errors Receives compile errors prefixed with their source line
+ * @param types Optionally receives the inferred types
+ * @return Module or nullptr on error
+ */
+std::shared_ptr<Module> LowerModule(const Parser& parser, std::vector<std::string>& errors,
+                                    TypeTable* types = nullptr);
+
+/**
+ * @brief Check if a handler can suspend, i.e. contains a `⧖` stage
+ *
+ * Resumable handlers always run on the per-entity interpreter and are
+ * never fused with other handlers.
+ * @param handler Handler to check
+ * @return True if the handler contains a Wait instruction
+ */
+bool IsResumable(const Handler& handler);
+
+/**
+ * @brief Run the optimizer pipeline over a lowered module
+ *
+ * Passes run in the order constant folding, common subexpressions, dead
+ * stores, dead code, flow fusion. Per-handler passes skip handlers that
+ * were already fused.
+ * @param module Module to optimize in place
+ * @param config Passes to run
+ * @return Counters for each pass
+ */
+OptimizerStats OptimizeModule(Module& module, const OptimizerConfig& config = OptimizerConfig());
+
+/**
+ * @brief Hash the slot layout and handler code of a module
+ *
+ * Native code generated from a module is only valid for modules with the same hash.
+ * @param module Module to hash
+ * @return 64-bit FNV-1a hash
+ */
+uint64_t HashModule(const Module& module);
+
+/**
+ * @brief Look up the key code used by `I.K <Key>` stages
+ * @param name Key name such as "W" or "Space"
+ * @return Key code in [0, 255] or -1 if unknown
+ */
+int LookupKeyCode(const std::string& name);
+
+/**
+ * @brief Held-key state sampled once per frame
+ */
+struct InputState {
+    std::array<uint64_t, 4> keys = {0, 0, 0, 0};
+
+    void SetKey(int code, bool down);
+    bool IsKeyDown(int code) const;
+};
+
+/**
+ * @brief Input devices an ActionMap can bind
+ *
+ * Each device reports up to INPUT_CODE_COUNT buttons in an InputState.
+ */
+enum class InputDevice : uint8_t {
+    Keyboard,   // Codes from LookupKeyCode()
+    Mouse,      // Button index
+    Gamepad     // Button index
+};
+
+constexpr uint32_t INPUT_DEVICE_COUNT = 3;
+constexpr uint32_t INPUT_CODE_COUNT = 256;
+
+/**
+ * @brief Look up an input device by name
+ * @param name "Keyboard", "Mouse" or "Gamepad"
+ * @return Device index or -1 if unknown
+ */
+int LookupInputDevice(const std::string& name);
+
+/**
+ * @brief Remappable layout from device buttons to the actions `I.K` stages test
+ *
+ * An `I.K <Key>` stage tests action LookupKeyCode(Key). The layout is a
+ * dense table with one row per (device, code) holding the bitset of actions
+ * that button drives, so resolving a frame is one pass over the buttons
+ * that are held, however many bindings and entities there are. The default
+ * layout binds every keyboard key to the action of the same code.
+ */
+class ActionMap {
+public:
+    ActionMap();
+
+    /**
+     * @brief Drive an action from a device button, in addition to its other bindings
+     * @param action Action code, i.e. the key code named in `I.K`
+     * @param device Device the button belongs to
+     * @param code Button code on that device
+     * @return False if the action or code is out of range
+     */
+    bool Bind(int action, InputDevice device, int code);
+
+    /**
+     * @brief Remove every action from a device button
+     */
+    void Unbind(InputDevice device, int code);
+
+    /**
+     * @brief Remove every binding of an action
+     */
+    void ClearAction(int action);
+
+    /**
+     * @brief Remove every binding
+     */
+    void Clear();
+
+    /**
+     * @brief Restore the default layout
+     */
+    void Reset();
+
+    /**
+     * @brief Get the buttons bound to an action
+     * @param action Action code
+     * @return (device, code) pairs in table order
+     */
+    std::vector<std::pair<InputDevice, int>> GetBindings(int action) const;
+
+    /**
+     * @brief Replace the layout with one in text form
+     *
+     * One binding per line, `<Action> = <Device> <Button>`, e.g.
+     * `Space = Gamepad 0` or `W = Keyboard Up`. Actions and keyboard buttons
+     * use key names, or codes for unnamed keys; other buttons are numbers.
+     * `#` starts a comment.
+     * @param text Layout text
+     * @param errors Receives one message per rejected line
+     * @return True if every line was accepted; accepted lines are kept either way
+     */
+    bool LoadLayout(const std::string& text, std::vector<std::string>& errors);
+
+    /**
+     * @brief Write the layout in the form LoadLayout() reads
+     */
+    std::string SaveLayout() const;
+
+    /**
+     * @brief Compute the held actions from the held device buttons
+     * @param devices Button state per device, indexed by InputDevice
+     * @param actions Receives the held actions
+     */
+    void Resolve(const std::array<InputState, INPUT_DEVICE_COUNT>& devices, InputState& actions) const;
+
+private:
+    std::vector<std::array<uint64_t, 4>> m_Table;   // [device * INPUT_CODE_COUNT + code] -> action bitset
+};
+
+/**
+ * @brief Chunked structure-of-arrays entity storage
+ */
+class World {
+public:
+    explicit World(uint16_t slotCount);
+
+    /**
+     * @brief Create an entity initialised from a template
+     * @param entityTemplate Template to copy initial slots from
+     * @return New entity ID
+     */
+    EntityId Spawn(const EntityTemplate& entityTemplate);
+
+    /**
+     * @brief Get number of live entities
+     * @return Entity count
+     */
+    uint32_t GetEntityCount() const;
+
+    /**
+     * @brief Get a slot value of an entity
+     * @param entity Entity ID
+     * @param slot Slot index
+     * @return Slot value
+     */
+    float GetSlot(EntityId entity, uint16_t slot) const;
+
+    /**
+     * @brief Set a slot value of an entity
+     * @param entity Entity ID
+     * @param slot Slot index
+     * @param value New value
+     */
+    void SetSlot(EntityId entity, uint16_t slot, float value);
+
+    /**
+     * @brief Get the number of chunks
+     * @return Chunk count
+     */
+    uint32_t GetChunkCount() const;
+
+    /**
+     * @brief Get the number of occupied lanes of a chunk
+     * @param chunk Chunk index
+     * @return Lane count
+     */
+    uint32_t GetChunkLaneCount(uint32_t chunk) const;
+
+    /**
+     * @brief Get the slot storage of a chunk
+     * @param chunk Chunk index
+     * @return Pointer to `slotCount * CHUNK_SIZE` floats
+     */
+    float* GetChunkData(uint32_t chunk);
+
+    uint16_t GetSlotCount() const;
+
+    /**
+     * @brief Change the slot layout, keeping every entity
+     *
+     * Each chunk is rebuilt row by row, so the cost is one copy per slot and
+     * chunk rather than per entity.
+     * @param slotCount New number of slots
+     * @param sources Old slot to copy for each new slot, or -1 to zero it
+     */
+    void Migrate(uint16_t slotCount, const std::vector<int32_t>& sources);
+
+private:
+    uint16_t m_SlotCount;
+    uint32_t m_EntityCount = 0;
+    std::vector<std::vector<float>> m_Chunks;
+};
+
+/**
+ * @brief How an interpreted handler run ended
+ */
+enum class ExecutionResult {
+    Aborted,    // A guard stage stopped the flow
+    Completed,  // All stages ran
+    Suspended   // A `⧖` stage suspended the flow
+};
+
+/**
+ * @brief Interpret a handler for one entity lane, starting at any instruction
+ * @param handler Handler to execute
+ * @param pc Instruction to start at; receives the resume point when the handler suspends
+ * @param lane Pointer to slot 0 of the entity (slots are CHUNK_SIZE floats apart)
+ * @param input Input state for the frame
+ * @param dt Frame delta time in seconds
+ * @param wait Receives the delay in seconds when the handler suspends
+ * @param counts Optional per-instruction execution counters (exact profiling)
+ * @param cursor Optional program counter published for a sampling profiler
+ * @return How the run ended
+ */
+ExecutionResult InterpretFrom(const Handler& handler, uint32_t& pc, float* lane, const InputState& input, float dt,
+                              float& wait, uint64_t* counts = nullptr, std::atomic<uint32_t>* cursor = nullptr);
+
+/**
+ * @brief Interpret a handler for one entity lane
+ * @param handler Handler to execute
+ * @param lane Pointer to slot 0 of the entity (slots are CHUNK_SIZE floats apart)
+ * @param input Input state for the frame
+ * @param dt Frame delta time in seconds
+ * @param counts Optional per-instruction execution counters (exact profiling)
+ * @param cursor Optional program counter published for a sampling profiler
+ * @return True if the handler ran to completion, false if a guard stopped or a `⧖` suspended it
+ */
+bool Interpret(const Handler& handler, float* lane, const InputState& input, float dt, uint64_t* counts = nullptr,
+               std::atomic<uint32_t>* cursor = nullptr);
+
+/**
+ * @brief Interpret a handler for every occupied lane of a chunk at once
+ *
+ * Each instruction is applied to the whole chunk in groups of 4 lanes
+ * (SSE2 where available). Lanes that fail a `⊿` guard are masked off rather
+ * than branched around, so divergent entities share one pass.
+ * @param handler Handler to execute
+ * @param chunk Chunk storage from World::GetChunkData
+ * @param laneCount Number of occupied lanes
+ * @param input Input state for the frame
+ * @param dt Frame delta time in seconds
+ * @param cursor Optional program counter published for a sampling profiler
+ * @return Number of lanes that ran to completion
+ */
+uint32_t InterpretChunk(const Handler& handler, float* chunk, uint32_t laneCount, const InputState& input, float dt,
+                        std::atomic<uint32_t>* cursor = nullptr);
+
+/**
+ * @brief Native code produced by the JIT for one handler
+ */
+class NativeHandler {
+public:
+    /**
+     * @brief Result codes returned by native handler code
+     */
+    enum Result : int {
+        Aborted = 0,    // A guard stage stopped the flow
+        Completed = 1,  // All stages ran
+        Deoptimize = 2  // Layout guard failed; caller must interpret instead
+    };
+
+    using EntryPoint = int (*)(float* lane, const uint64_t* keys, float dt, uint32_t layoutEpoch);
+
+    NativeHandler(void* memory, size_t size);
+    ~NativeHandler();
+
+    NativeHandler(const NativeHandler&) = delete;
+    NativeHandler& operator=(const NativeHandler&) = delete;
+
+    /**
+     * @brief Run the native code for one entity lane
+     */
+    int Invoke(float* lane, const InputState& input, float dt, uint32_t layoutEpoch) const;
+
+    size_t GetCodeSize() const;
+
+private:
+    void* m_Memory;
+    size_t m_Size;
+};
+
+/**
+ * @brief x86-64 JIT for lowered AOPL handlers
+ *
+ * Emits scalar SSE code into mmap'd pages that are flipped from writable to
+ * executable before use. Every compiled handler starts with a guard on the
+ * world layout epoch it was compiled for and returns Deoptimize on mismatch.
+ */
+class JitCompiler {
+public:
+    /**
+     * @brief Check if native code generation is supported on this build
+     * @return True on x86-64 POSIX targets
+     */
+    static bool IsSupported();
+
+    /**
+     * @brief Compile a handler to native code
+     * @param handler Handler to compile
+     * @param layoutEpoch Layout epoch the code is specialised for
+     * @return Native handler or nullptr if unsupported
+     */
+    static std::unique_ptr<NativeHandler> Compile(const Handler& handler, uint32_t layoutEpoch);
+};
+
+/**
+ * @brief Suspended handler run of one entity
+ *
+ * This is all that is kept while an entity waits on a `⧖` stage: the
+ * interpreter state of a handler is its program counter, since every
+ * value lives in entity slots.
+ */
+struct Frame {
+    EntityId entity = -1;
+    uint16_t handler = 0;
+    uint16_t pc = 0;    // Instruction after the `⧖` stage
+};
+
+/**
+ * @brief Hashed timer wheel of suspended frames
+ *
+ * Time advances in ticks of a fixed resolution. A frame is linked into the
+ * bucket of its due tick; frames due more than one revolution ahead stay
+ * in their bucket and are skipped until their revolution comes round, so
+ * scheduling and expiry are O(1) regardless of the delay. Frames live in a
+ * pool with a free list and cost sizeof(Frame) plus link and due fields.
+ */
+class TimerWheel {
+public:
+    /**
+     * @brief Create an empty wheel
+     * @param resolution Tick length in seconds
+     * @param bucketCount Number of buckets, rounded up to a power of two
+     */
+    explicit TimerWheel(float resolution = 0.001f, uint32_t bucketCount = 1024);
+
+    /**
+     * @brief Schedule a frame to resume after a delay
+     *
+     * Delays are rounded up to whole ticks, with a minimum of one tick.
+     * @param frame Frame to resume
+     * @param delay Delay in seconds from the current wheel time
+     */
+    void Schedule(const Frame& frame, float delay);
+
+    /**
+     * @brief Advance the wheel and collect the frames that became due
+     * @param dt Elapsed time in seconds
+     * @param due Receives due frames, earliest first and in scheduling order for equal ticks
+     */
+    void Advance(float dt, std::vector<Frame>& due);
+
+    /**
+     * @brief Rewrite or drop pending frames
+     * @param keep Called for every pending frame; may modify it, returns false to drop it
+     * @return Number of frames dropped
+     */
+    uint32_t Retain(const std::function<bool(Frame&)>& keep);
+
+    /**
+     * @brief Drop every pending frame
+     */
+    void Clear();
+
+    size_t GetPendingCount() const;
+
+    /**
+     * @brief Get the bytes used by the frame pool and buckets
+     */
+    size_t GetMemoryUsage() const;
+
+    /**
+     * @brief Get the wheel time in seconds
+     */
+    double GetTime() const;
+
+private:
+    static constexpr uint32_t NONE = 0xFFFFFFFF;
+
+    struct Node {
+        Frame frame;
+        uint32_t next = NONE;
+        uint32_t sequence = 0;
+        uint64_t due = 0;
+    };
+
+    void Link(uint32_t index);
+
+    double m_Resolution;
+    uint64_t m_Mask;
+    uint64_t m_Now = 0;         // Current tick
+    double m_Remainder = 0.0;   // Time not yet worth a whole tick
+    uint32_t m_Sequence = 0;
+    uint32_t m_FreeList = NONE;
+    size_t m_Pending = 0;
+    std::vector<Node> m_Nodes;
+    std::vector<uint32_t> m_Buckets;
+};
+
+class AotLibrary;
+class Profiler;
+class WorkerPool;
+struct DataflowGraph;
+
+/**
+ * @brief Runtime configuration
+ */
+struct RuntimeConfig {
+    bool enableJit = true;          // Tier hot handlers up to native code
+    uint32_t jitThreshold = 1000;   // Interpreted invocations before a handler is compiled
+    bool batchChunks = true;        // Interpret whole chunks at once instead of one entity at a time
+    float timerResolution = 0.001f; // Tick length of the timer wheel that resumes `⧖` stages, in seconds
+    uint32_t threadCount = 1;       // Threads running independent handlers and chunk ranges; 0 uses all cores
+    bool reactive = false;          // Skip pure handlers on chunks whose slots and keys they depend on are unchanged
+};
+
+/**
+ * @brief Runtime execution counters
+ */
+struct RuntimeStats {
+    uint64_t interpretedInvocations = 0;
+    uint64_t nativeInvocations = 0;
+    uint64_t aotInvocations = 0;
+    uint64_t batchedChunks = 0;
+    uint32_t compiledHandlers = 0;
+    uint32_t deoptimizations = 0;
+    uint64_t suspensions = 0;       // Handler runs suspended by a `⧖` stage
+    uint64_t resumptions = 0;       // Suspended frames resumed by the timer wheel
+    uint64_t parallelLevels = 0;    // Dataflow levels that were split over worker threads
+    uint64_t parallelTasks = 0;     // Handler chunk ranges run by those levels
+    uint64_t skippedEvaluations = 0; // Reactive mode: entity runs of pure handlers skipped as up to date
+    uint64_t skippedChunks = 0;     // Reactive mode: chunks those skips came from
+};
+
+/**
+ * @brief What Runtime::Reload() kept and changed
+ */
+struct ReloadStats {
+    uint32_t handlersReused = 0;    // Unchanged handlers that kept their native code and tier counters
+    uint32_t handlersReplaced = 0;  // New or changed handlers, starting over in the interpreter
+    uint32_t slotsMigrated = 0;     // Slots whose values were carried over
+    uint32_t slotsAdded = 0;        // Slots initialised from the entity's template
+    uint32_t slotsRemoved = 0;
+    uint32_t framesKept = 0;        // Suspended frames of reused handlers, still waiting
+    uint32_t framesDropped = 0;     // Suspended frames of changed or removed handlers
+    bool layoutChanged = false;
+};
+
+/**
+ * @brief Executes a compiled AOPL module over a world of entities
+ */
+class Runtime {
+public:
+    explicit Runtime(std::shared_ptr<const Module> module, const RuntimeConfig& config = RuntimeConfig());
+    ~Runtime();
+
+    /**
+     * @brief Spawn an entity from a template declared in the module
+     * @param templateName Entity name from `N ⊢ E〈Name〉`
+     * @return Entity ID or -1 if the template does not exist
+     */
+    EntityId Spawn(const std::string& templateName);
+
+    /**
+     * @brief Run every handler over every entity once
+     *
+     * Frames suspended by `⧖` stages that became due are resumed first.
+     * While an entity has a suspended frame in a handler, that handler does
+     * not start over for the entity; the tick a frame resumes counts as the
+     * handler's run for it.
+     *
+     * In reactive mode, a pure handler (see DataflowNode::pure) is skipped
+     * for a chunk when none of the slots it reads or writes there changed
+     * and none of its keys changed since it last ran on the chunk. Changes
+     * are tracked per chunk row by comparing each handler's written rows
+     * before and after it runs, so handlers that run without changing
+     * anything do not wake their readers.
+     * @param dt Frame delta time in seconds
+     */
+    void Tick(float dt);
+
+    /**
+     * @brief Get the number of handler runs waiting on a `⧖` stage
+     * @return Suspended frame count
+     */
+    size_t GetSuspendedCount() const;
+
+    /**
+     * @brief Get the timer wheel that resumes suspended frames
+     */
+    const TimerWheel& GetTimers() const;
+
+    /**
+     * @brief Get the dataflow graph used to run handlers concurrently
+     *
+     * With more than one thread, Tick() runs each level of the graph as a
+     * batch of (handler, chunk range) tasks and waits for it before the
+     * next level. Results match a serial tick.
+     */
+    const DataflowGraph& GetDataflowGraph() const;
+
+    /**
+     * @brief Read a slot of an entity by path
+     * @param entity Entity ID
+     * @param path Slot path such as "T.P.z"
+     * @return Slot value (0 if the path is unknown)
+     */
+    float GetValue(EntityId entity, const std::string& path) const;
+
+    /**
+     * @brief Write a slot of an entity by path
+     * @param entity Entity ID
+     * @param path Slot path such as "grounded"
+     * @param value New value
+     * @return True if the path exists
+     */
+    bool SetValue(EntityId entity, const std::string& path, float value);
+
+    /**
+     * @brief Tell reactive mode that an entity changed behind its back
+     *
+     * Writes through SetValue() and by handlers are tracked; writes made
+     * directly through GetWorld() must be reported here, or pure handlers
+     * may keep skipping the entity. Marks every slot of its chunk.
+     * @param entity Entity ID
+     */
+    void MarkChanged(EntityId entity);
+
+    /**
+     * @brief Swap in a recompiled module without losing entity state
+     *
+     * Slots are matched by name: values of slots that still exist are kept,
+     * new slots take the value from the template each entity was spawned
+     * from, and removed slots are dropped. Handlers whose code is unchanged
+     * keep their JIT code and suspended frames; frames of other handlers
+     * are dropped. An attached AOT library is detached.
+     * @param module Recompiled module
+     * @return What was reused and migrated
+     */
+    ReloadStats Reload(std::shared_ptr<const Module> module);
+
+    /**
+     * @brief Run handlers from an ahead-of-time compiled library
+     *
+     * AOT handlers take precedence over the interpreter and the JIT until
+     * the layout is invalidated.
+     * @param library Library built from this runtime's module
+     * @return True if the library matches the module and was attached
+     */
+    bool AttachLibrary(std::shared_ptr<AotLibrary> library);
+
+    /**
+     * @brief Attribute execution time to handlers, lines and stages
+     *
+     * The profiler is reset for this runtime's module. In exact mode every
+     * handler runs on the per-entity interpreter while attached.
+     * @param profiler Profiler to attach, or nullptr to detach
+     */
+    void SetProfiler(std::shared_ptr<Profiler> profiler);
+
+    std::shared_ptr<Profiler> GetProfiler() const;
+
+    /**
+     * @brief Enable or disable tiering up to native code
+     * @param enabled True to allow the JIT
+     */
+    void SetJitEnabled(bool enabled);
+
+    bool IsJitEnabled() const;
+
+    /**
+     * @brief Invalidate all native code specialised for the current layout
+     *
+     * Compiled handlers deoptimize on their next invocation.
+     */
+    void InvalidateLayout();
+
+    /**
+     * @brief Get the button state of a device, resolved through the action map each tick
+     * @param device Device, the keyboard by default
+     */
+    InputState& GetInput(InputDevice device = InputDevice::Keyboard);
+
+    /**
+     * @brief Get the layout that maps device buttons to `I.K` actions
+     */
+    ActionMap& GetActionMap();
+
+    /**
+     * @brief Get the actions held during the last tick
+     */
+    const InputState& GetActions() const;
+
+    World& GetWorld();
+    const Module& GetModule() const;
+    const RuntimeStats& GetStats() const;
+
+private:
+    struct HandlerState {
+        uint32_t invocations = 0;
+        bool jitFailed = false;
+        std::unique_ptr<NativeHandler> native;
+        NativeHandler::EntryPoint aot = nullptr;
+        uint32_t nativeEpoch = 0;           // Layout epoch `native` was compiled for
+        bool resumable = false;
+        std::vector<uint64_t> suspended;    // Resumable handlers: one bit per entity with a waiting frame
+        std::vector<uint64_t> stamps;       // Reactive mode, pure handlers: version each chunk was last run at
+    };
+
+    bool IsSuspended(const HandlerState& state, EntityId entity) const;
+    void SetSuspended(HandlerState& state, EntityId entity, bool suspended);
+    void Resume(const Frame& frame, float dt);
+    void Suspend(size_t index, EntityId entity, uint32_t pc, float wait);
+    void RunResumable(size_t index, float dt, uint64_t* counts, std::atomic<uint32_t>* cursor);
+    void RunHandler(size_t index, float dt);
+    void RunChunks(size_t index, uint32_t begin, uint32_t end, float dt, RuntimeStats& stats, uint32_t& invocations,
+                   bool tierUp, std::atomic<uint32_t>* cursor);
+    void RunChunk(size_t index, uint32_t chunk, float dt, RuntimeStats& stats, uint32_t& invocations, bool tierUp,
+                  std::atomic<uint32_t>* cursor);
+    bool IsUpToDate(size_t index, uint32_t chunk) const;
+    void MarkWrites(size_t index, uint32_t chunk);
+    void RunParallel(float dt);
+    void RunProfiled(size_t index, float dt);
+    void TierUp(size_t index);
+
+    std::shared_ptr<const Module> m_Module;
+    RuntimeConfig m_Config;
+    World m_World;
+    std::array<InputState, INPUT_DEVICE_COUNT> m_Devices;
+    ActionMap m_ActionMap;
+    InputState m_Actions;               // What handlers test: m_Devices resolved through m_ActionMap
+    RuntimeStats m_Stats;
+    std::vector<HandlerState> m_HandlerStates;
+    std::vector<uint16_t> m_EntityTemplates;    // Template index each entity was spawned from
+    std::shared_ptr<AotLibrary> m_AotLibrary;
+    std::shared_ptr<Profiler> m_Profiler;
+    TimerWheel m_Timers;
+    std::vector<Frame> m_Yielded;       // Frames suspended by a bare `⧖`, resumed on the next tick
+    std::vector<Frame> m_Due;
+    std::vector<Frame> m_Resumed;       // Frames that finished this tick; their handler skips the entity
+    std::unique_ptr<DataflowGraph> m_Graph;
+    std::unique_ptr<WorkerPool> m_Workers;
+    std::vector<uint64_t> m_RowVersions;    // Reactive mode: version of each (chunk, slot) row's last change
+    std::atomic<uint64_t> m_Version{0};
+    std::array<uint64_t, 4> m_PreviousKeys = {0, 0, 0, 0};
+    std::array<uint64_t, 4> m_ChangedKeys = {0, 0, 0, 0};
+    uint32_t m_LayoutEpoch = 1;
+};
+
+} // namespace aopl
+} // namespace gaia_matrix
@@ -10,6 +10,11 @@ namespace gaia_matrix {
 // Forward declarations
 class Scene;
 
+namespace aopl {
+class HotReloader;
+class Runtime;
+}
+
 /**
  * @brief Editor configuration
  */
@@ -47,11 +52,26 @@ public:
 
     /**
      * @brief Open a project
+     *
+     * The project's .aopl scripts are compiled and started, and then
+     * watched: Run() reloads changed scripts into the running world.
      * @param projectPath Path to project to open
      * @return True if project opened successfully
      */
     bool OpenProject(const std::string& projectPath);
 
+    /**
+     * @brief Reload scripts changed on disk into the running world
+     * @return True if a new module was swapped in
+     */
+    bool ReloadScripts();
+
+    /**
+     * @brief Get the runtime executing the project's scripts
+     * @return Runtime or nullptr if no project with scripts is open
+     */
+    std::shared_ptr<aopl::Runtime> GetScriptRuntime() const;
+
     /**
      * @brief Create a new project
      * @param projectName Name of new project
@@ -78,6 +98,8 @@ private:
     bool m_IsInitialized = false;
     EditorConfig m_Config;
     std::shared_ptr<Scene> m_ActiveScene;
+    std::unique_ptr<aopl::HotReloader> m_ScriptReloader;
+    std::shared_ptr<aopl::Runtime> m_ScriptRuntime;
 };
 
 /**
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "gaia_matrix/neural_graph.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gaia_matrix {
+namespace neural {
+
+/**
+ * @brief Counters of an InferenceBatcher
+ */
+struct BatchingStats {
+    uint64_t requests = 0;          // Requests submitted
+    uint64_t batches = 0;           // Batched runs, each serving one or more requests
+    uint64_t rows = 0;              // Rows run across all batches
+    uint32_t largestBatch = 0;      // Most rows run at once
+};
+
+/**
+ * @brief Coalesces concurrent requests against one model into batched runs
+ *
+ * A worker thread collects submitted requests until they hold the maximum
+ * batch size in rows, or until the oldest has waited the maximum wait, then
+ * concatenates the requests whose shapes agree beyond the first dimension
+ * and runs them as one batch. The output is split back by rows, so the
+ * model's first dimension must be a batch dimension on its input and output.
+ *
+ * Submit() may be called from any thread. The destructor runs every request
+ * still queued before it returns.
+ */
+class InferenceBatcher {
+public:
+    /**
+     * @brief Runs one batch: input data and shape in, first output data and shape out; false on failure
+     */
+    using RunFunction = std::function<bool(const float*, const Shape&, std::vector<float>&, Shape&)>;
+
+    /**
+     * @brief Start the worker
+     * @param run Called on the worker thread with each batch
+     * @param maxBatchSize Rows at which a batch runs without waiting; a larger single request runs alone
+     * @param maxWait Longest a request waits for others to join its batch
+     */
+    InferenceBatcher(RunFunction run, size_t maxBatchSize, std::chrono::microseconds maxWait);
+    ~InferenceBatcher();
+
+    InferenceBatcher(const InferenceBatcher&) = delete;
+    InferenceBatcher& operator=(const InferenceBatcher&) = delete;
+
+    /**
+     * @brief Queue a request
+     * @param input Row-major input data
+     * @param shape Shape of the input; the first dimension counts rows
+     * @return Future of the request's rows of the output, or empty on failure
+     */
+    std::future<std::vector<float>> Submit(std::vector<float> input, Shape shape);
+
+    BatchingStats GetStats() const;
+
+private:
+    struct Request {
+        std::vector<float> input;
+        Shape shape;
+        std::promise<std::vector<float>> result;
+        std::chrono::steady_clock::time_point deadline;
+    };
+
+    void WorkerLoop();
+    void RunBatch(std::vector<Request>& batch);
+
+    RunFunction m_Run;
+    size_t m_MaxBatchSize;
+    std::chrono::microseconds m_MaxWait;
+
+    mutable std::mutex m_Mutex;
+    std::condition_variable m_Wake;
+    std::deque<Request> m_Queue;
+    size_t m_QueuedRows = 0;
+    bool m_Stopping = false;
+    BatchingStats m_Stats;
+
+    // Worker-only buffers, reused across batches
+    std::vector<float> m_Input;
+    std::vector<float> m_Output;
+    Shape m_OutputShape;
+    std::thread m_Worker;
+};
+
+} // namespace neural
+} // namespace gaia_matrix
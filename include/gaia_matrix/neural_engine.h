@@ -1,17 +1,44 @@
 #pragma once
 
+#include "gaia_matrix/neural_batcher.h"
+#include "gaia_matrix/neural_kernels.h"
+#include "gaia_matrix/neural_tensor.h"
+#include <chrono>
+#include <cstdint>
+#include <future>
 #include <string>
+#include <list>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 #include <array>
 
 namespace gaia_matrix {
 
+/**
+ * @brief Counters of the Neural Engine's model registry
+ */
+struct ModelCacheStats {
+    uint32_t loads = 0;             // Models read from disk and prepared
+    uint32_t pathHits = 0;          // Loads answered by a model already loaded from the same file
+    uint32_t contentHits = 0;       // Loads answered by an identical model under another path
+    uint32_t evictions = 0;         // Unreferenced models dropped to stay within the cache budget
+    uint32_t cachedModels = 0;      // Unreferenced models currently kept
+    size_t cachedBytes = 0;         // Weight bytes of those models
+    double loadMilliseconds = 0.0;  // Time spent in loads that missed
+};
+
 /**
  * @brief Neural Engine Integration for GAIA MATRIX
  * 
  * Provides direct access to Apple Silicon Neural Engine via Gaia OS.
  * Falls back to CPU implementation when Neural Engine is not available.
+ * Models are ONNX files run by neural::GraphExecutor; see neural_executor.h
+ * for the supported operators.
+ *
+ * RunInference and SubmitInference may be called from several threads at
+ * once; each model runs one call at a time. Loading, unloading and
+ * reconfiguring models must not overlap with them.
  */
 class NeuralEngine {
 public:
@@ -29,25 +56,177 @@ public:
     
     /**
      * @brief Load an ONNX model for Neural Engine execution
+     *
+     * Models are shared: loading a file that is already loaded, or a file with
+     * identical contents, returns the existing model's ID and adds a reference
+     * instead of loading it again. IDs are never reused.
+     *
      * @param modelPath Path to the ONNX model file
      * @return Model ID or -1 if loading failed
      */
     int LoadModel(const std::string& modelPath);
     
     /**
-     * @brief Unload a previously loaded model
+     * @brief Release one reference to a loaded model
+     *
+     * A model without references stays cached, so loading it again is free,
+     * until the cached models exceed the cache budget; the least recently
+     * released ones are dropped first.
+     *
      * @param modelId Model ID to unload
      */
     void UnloadModel(int modelId);
+
+    /**
+     * @brief Set how many weight bytes of unreferenced models to keep cached
+     * @param bytes Budget; 0 drops models as soon as their last reference is released
+     */
+    void SetCacheBudget(size_t bytes);
+
+    /**
+     * @brief Get the model registry's counters
+     */
+    ModelCacheStats GetCacheStats() const;
     
     /**
      * @brief Run inference on loaded model
+     *
+     * Only for models with a single input; see the TensorView overload for others.
+     *
      * @param modelId Model ID to run inference on
      * @param inputData Input data for the model
-     * @param inputShape Shape of the input data
-     * @return Output data from the model
+     * @param inputShape Shape of the input data; trailing 1s are dropped for lower-rank model inputs
+     * @return Data of the model's first output, or empty on failure
      */
     std::vector<float> RunInference(int modelId, const std::vector<float>& inputData, const std::array<int, 4>& inputShape);
+
+    /**
+     * @brief Run inference on tensors of any rank, writing the outputs into the caller's buffers
+     *
+     * Views bind to the graph input or output of their name, or by position
+     * when unnamed. Contiguous fp32 inputs are read in place; other types and
+     * strided layouts are converted into a staging buffer kept by the model.
+     * Outputs are written straight from the executor's arena, converted to
+     * each view's type and layout, so a steady stream of calls allocates
+     * nothing.
+     *
+     * @param modelId Model ID to run inference on
+     * @param inputs One view per graph input
+     * @param outputs Views of the outputs wanted, each with the shape that output has for these inputs
+     * @return True on success
+     */
+    bool RunInference(int modelId, const std::vector<neural::TensorView>& inputs,
+                      const std::vector<neural::TensorView>& outputs);
+
+    /**
+     * @brief Coalesce the model's SubmitInference calls into batched runs
+     *
+     * Requests are concatenated along the model's dynamic first dimension and
+     * run together once they hold maxBatchSize rows, or once the oldest has
+     * waited maxWait. Enabling again replaces the settings.
+     *
+     * @param modelId Model ID; its input must have a dynamic first dimension
+     * @param maxBatchSize Rows per batched run
+     * @param maxWait Longest a request waits for others to join its batch
+     * @return True on success
+     */
+    bool EnableBatching(int modelId, size_t maxBatchSize, std::chrono::microseconds maxWait);
+
+    /**
+     * @brief Stop batching a model's requests, after running the ones already submitted
+     * @param modelId Model ID
+     */
+    void DisableBatching(int modelId);
+
+    /**
+     * @brief Queue inference on a loaded model
+     *
+     * Runs in a batch with other requests if batching is enabled for the
+     * model, and immediately on the calling thread otherwise.
+     *
+     * @param modelId Model ID to run inference on
+     * @param inputData Input data for the model
+     * @param inputShape Shape of the input data, as for RunInference
+     * @return Future of the request's rows of the first output, or empty on failure
+     */
+    std::future<std::vector<float>> SubmitInference(int modelId, std::vector<float> inputData,
+                                                    const std::array<int, 4>& inputShape);
+
+    /**
+     * @brief Get the batching counters of a model
+     * @param modelId Model ID
+     * @return Counters, or all zero if the model is unknown or not batching
+     */
+    neural::BatchingStats GetBatchingStats(int modelId) const;
+
+    /**
+     * @brief Get the declared shape of a loaded model's first input
+     * @param modelId Model ID
+     * @return Shape with -1 for dynamic dimensions, or empty if the model is unknown
+     */
+    std::vector<int64_t> GetInputShape(int modelId) const;
+
+    /**
+     * @brief Get the names, types and declared shapes of a loaded model's inputs
+     * @param modelId Model ID
+     * @return One entry per graph input, or empty if the model is unknown
+     */
+    std::vector<neural::ValueInfo> GetInputInfo(int modelId) const;
+
+    /**
+     * @brief Get the names, types and declared shapes of a loaded model's outputs
+     * @param modelId Model ID
+     * @return One entry per graph output, or empty if the model is unknown
+     */
+    std::vector<neural::ValueInfo> GetOutputInfo(int modelId) const;
+
+    /**
+     * @brief Get the output shape of a loaded model, derived from the graph
+     * @param modelId Model ID
+     * @return Shape with -1 for dynamic dimensions, or empty if the model is unknown
+     */
+    std::vector<int64_t> GetOutputShape(int modelId) const;
+
+    /**
+     * @brief Quantize a loaded model to int8 in place (see neural::QuantizeGraph)
+     *
+     * Affects every holder of the model ID; later loads of the file get a fresh fp32 model.
+     *
+     * @param modelId Model ID
+     * @param calibrationData Representative inputs, one tensor per sample
+     * @param inputShape Shape of each sample, as for RunInference
+     * @return True if the model now runs quantized; on failure it keeps running in fp32
+     */
+    bool QuantizeModel(int modelId, const std::vector<std::vector<float>>& calibrationData,
+                       const std::array<int, 4>& inputShape);
+
+    /**
+     * @brief Store a loaded model's weights in another precision
+     *
+     * Affects every holder of the model ID; later loads of the file get a fresh fp32 model.
+     *
+     * @param modelId Model ID
+     * @param precision fp16 or bf16 to halve weight memory, or fp32
+     * @return True on success
+     */
+    bool SetWeightPrecision(int modelId, neural::WeightPrecision precision);
+
+    /**
+     * @brief Get the bytes of weight data a loaded model holds
+     * @param modelId Model ID
+     * @return Byte count, or 0 if the model is unknown
+     */
+    size_t GetWeightBytes(int modelId) const;
+
+    /**
+     * @brief Get the peak activation memory planned for a model's most recent input shape
+     *
+     * Planned at load for the declared input shape with dynamic dimensions set
+     * to 1, and again whenever RunInference sees a new input shape.
+     * @param modelId Model ID
+     * @return Byte count, or 0 if the model is unknown
+     */
+    size_t GetActivationBytes(int modelId) const;
     
     /**
      * @brief Get the singleton instance
@@ -64,14 +243,27 @@ private:
      * @brief Shutdown and release resources
      */
     void Shutdown();
+
+    struct Model;
+
+    Model* FindModel(int modelId) const;
+    void AddReference(Model& model);
+    void Detach(Model& model);
+    void Destroy(int modelId);
+    void EvictUnreferenced();
     
     static NeuralEngine* s_Instance;
     bool m_IsInitialized;
     bool m_IsNeuralEngineAvailable;
     
-    // Model storage
-    struct Model;
-    std::vector<std::unique_ptr<Model>> m_LoadedModels;
+    // Model registry: IDs are handed out once and never reused
+    std::unordered_map<int, std::unique_ptr<Model>> m_Models;
+    std::unordered_map<std::string, int> m_ModelsByPath;        // Canonical path -> model
+    std::unordered_map<uint64_t, int> m_ModelsByContent;        // Hash of the file bytes -> model
+    std::list<int> m_Unreferenced;                              // Cached models, most recently released first
+    int m_NextModelId = 0;
+    size_t m_CacheBudget = 64 * 1024 * 1024;
+    ModelCacheStats m_CacheStats;
 };
 
 /**
@@ -95,6 +287,13 @@ public:
      * @return Generated data
      */
     const std::vector<float>& GetGeneratedData() const;
+
+    /**
+     * @brief Store the generator's weights in another precision
+     * @param precision fp16 or bf16 to halve weight memory, or fp32
+     * @return True on success
+     */
+    bool SetWeightPrecision(neural::WeightPrecision precision);
     
 private:
     int m_ModelId = -1;
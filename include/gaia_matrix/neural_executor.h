@@ -0,0 +1,199 @@
+#pragma once
+
+#include "gaia_matrix/neural_graph.h"
+#include "gaia_matrix/neural_kernels.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gaia_matrix {
+namespace neural {
+
+/**
+ * @brief Check if the executor implements an operator
+ * @param opType ONNX operator name such as "Conv"
+ * @return True if supported
+ */
+bool IsOperatorSupported(const std::string& opType);
+
+/**
+ * @brief Runs an inference graph on the CPU in fp32
+ *
+ * Prepare() resolves every value name to a slot and orders the nodes
+ * topologically once. Shapes are inferred from the input shapes of each
+ * Run(), so graphs with a symbolic batch dimension accept any batch size.
+ * Each new set of input shapes also plans the activations: every node
+ * output and kernel scratch buffer gets a fixed offset in one arena, and
+ * values whose lifetimes do not overlap share memory, so a Run() on shapes
+ * seen last time allocates nothing.
+ *
+ * Supported operators: Gemm, MatMul, Conv, Add, Sub, Mul, Div, Relu,
+ * Sigmoid, Tanh, Softmax, BatchNormalization, Reshape, Flatten, Transpose, Concat, MaxPool,
+ * AveragePool, GlobalAveragePool, GlobalMaxPool, Identity, Dropout,
+ * Constant, QuantizeLinear, DequantizeLinear, QLinearMatMul and QLinearConv.
+ *
+ * Gemm, MatMul and Conv whose activation and constant weights both come
+ * from DequantizeLinear run on the int8 kernels instead of in fp32.
+ *
+ * Prepare() also fuses the graph: BatchNormalization and bias Adds fold into
+ * the constant weights of the product before them, activations run in the
+ * GEMM epilogue, and chains of elementwise steps run as one loop. Reshape,
+ * Flatten, Identity and order-preserving Transpose steps alias their input.
+ */
+class GraphExecutor {
+public:
+    GraphExecutor();
+    ~GraphExecutor();
+
+    /**
+     * @brief Bind a graph and check that it can run
+     * @param graph Graph to run; must outlive the executor
+     * @param errors Receives one message per problem, such as an unsupported operator
+     * @return True if the graph is ready to run
+     */
+    bool Prepare(std::shared_ptr<const Graph> graph, std::vector<std::string>& errors);
+
+    /**
+     * @brief Infer the output shapes for a set of input shapes without running the graph
+     * @param inputShapes One shape per graph input, in graph order
+     * @param outputShapes Receives one shape per graph output
+     * @param error Receives a message on failure
+     * @return True if every node accepted its input shapes
+     */
+    bool InferShapes(const std::vector<Shape>& inputShapes, std::vector<Shape>& outputShapes, std::string& error);
+
+    /**
+     * @brief Plan activation memory once for the largest input shapes a caller will run
+     *
+     * Later input shapes whose every node output and scratch space fits in the
+     * space reserved for it run inside this plan, so a batch size that changes
+     * from run to run below the reserved one neither re-plans nor allocates.
+     * Larger shapes are planned as usual. Cleared by Prepare().
+     *
+     * @param inputShapes One shape per graph input, in graph order
+     * @param error Receives a message on failure
+     * @return True if every node accepted the input shapes
+     */
+    bool ReserveShapes(const std::vector<Shape>& inputShapes, std::string& error);
+
+    /**
+     * @brief Drop the ReserveShapes() plan; the next new input shape is planned on its own
+     */
+    void ClearReservedShapes();
+
+    /**
+     * @brief Run the graph
+     * @param inputs One pointer per graph input, in graph order, to contiguous row-major data
+     * @param inputShapes Shape of each input
+     * @param outputs Receives the data of each graph output
+     * @param outputShapes Receives the shape of each graph output
+     * @param error Receives a message on failure
+     * @return True on success
+     */
+    bool Run(const std::vector<const float*>& inputs, const std::vector<Shape>& inputShapes,
+             std::vector<std::vector<float>>& outputs, std::vector<Shape>& outputShapes, std::string& error);
+
+    /**
+     * @brief Run the graph and leave the outputs in the executor, read through GetOutputData()
+     * @param inputs One pointer per graph input, in graph order, to contiguous row-major data
+     * @param inputShapes Shape of each input
+     * @param error Receives a message on failure
+     * @return True on success
+     */
+    bool Run(const std::vector<const float*>& inputs, const std::vector<Shape>& inputShapes, std::string& error);
+
+    /**
+     * @brief Get the data of a graph output of the last successful Run()
+     *
+     * Points into the executor's arena, a constant or an input, and stays
+     * valid until the next Run() or Prepare().
+     *
+     * @param index Graph output index
+     * @return Contiguous row-major data, or nullptr if there is no such output
+     */
+    const float* GetOutputData(size_t index) const;
+
+    /**
+     * @brief Get the shape of a graph output of the last successful Run()
+     */
+    const Shape& GetOutputShape(size_t index) const;
+
+    /**
+     * @brief Observe every value a run produces, e.g. to calibrate quantization ranges
+     * @param observer Called with the name, data and shape of each graph input and node output; empty to disable
+     */
+    void SetObserver(std::function<void(const std::string&, const float*, const Shape&)> observer);
+
+    /**
+     * @brief Set the storage precision of constant Gemm, MatMul and Conv weights
+     *
+     * Takes effect at the next Prepare(). 16-bit weights halve the memory and
+     * bandwidth they take; they are widened as the products run, which still
+     * accumulate in fp32. Int8 weights are not affected.
+     */
+    void SetWeightPrecision(WeightPrecision precision);
+
+    /**
+     * @brief Enable or disable fusing steps, which is on by default
+     *
+     * Takes effect at the next Prepare(). Fused steps skip their intermediate
+     * values, so the observer only sees every node output with fusion off.
+     */
+    void SetFusion(bool enabled);
+    WeightPrecision GetWeightPrecision() const { return m_WeightPrecision; }
+
+    /**
+     * @brief Get the bytes of constant data held, including packed weights
+     */
+    size_t GetWeightBytes() const;
+
+    /**
+     * @brief Get the peak bytes of activation memory planned for the last input shapes
+     *
+     * Covers node outputs and kernel scratch space; graph inputs are read in
+     * place from the caller's memory. Shapes run inside a ReserveShapes() plan
+     * report the reserved peak.
+     */
+    size_t GetActivationBytes() const;
+
+    const Graph& GetGraph() const;
+
+private:
+    struct Value;
+    struct Step;
+    struct Quantization;
+    struct Block;
+
+    bool Infer(const std::vector<Shape>& inputShapes, std::string& error, bool reserve = false);
+    void PlanMemory(const std::vector<size_t>& scratch, bool reserve);
+    void PlaceBlocks(const std::vector<Block>& blocks, size_t peak);
+    bool ReadQuantization(int32_t scaleId, int32_t zeroPointId, int64_t channels, DataType fallback,
+                          Quantization& quantization) const;
+    bool PrepareQLinear(Step& step, std::string& error);
+    void FuseQuantized();
+    void FuseGraph();
+    int32_t AddConstant(const std::string& name, const Shape& shape, std::vector<float> data);
+    void RemoveDeadSteps();
+    void PackConstants();
+    void ReleasePackedConstants();
+    void RunQuantized(const Step& step);
+
+    std::shared_ptr<const Graph> m_Graph;
+    std::vector<Value> m_Values;
+    std::vector<Step> m_Steps;
+    std::vector<int32_t> m_Inputs;
+    std::vector<int32_t> m_Outputs;
+    std::vector<Shape> m_InferredFor;   // Input shapes the current value shapes were inferred for
+    std::vector<float> m_Arena;         // Node outputs and scratch space, at offsets set by PlanMemory
+    size_t m_ActivationBytes = 0;
+    std::vector<Block> m_Reserved;      // Plan made by ReserveShapes(), reused by smaller shapes
+    size_t m_ReservedBytes = 0;
+    std::vector<int64_t> m_Index;       // Position of strided walks during Run
+    std::function<void(const std::string&, const float*, const Shape&)> m_Observer;
+    WeightPrecision m_WeightPrecision = WeightPrecision::Float32;
+    bool m_Fusion = true;
+};
+
+} // namespace neural
+} // namespace gaia_matrix
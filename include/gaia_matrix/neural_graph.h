@@ -0,0 +1,190 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gaia_matrix {
+
+class MappedFile;
+
+namespace neural {
+
+/**
+ * @brief Tensor dimensions, outermost first; -1 marks a dimension only known at run time
+ */
+using Shape = std::vector<int64_t>;
+
+/**
+ * @brief Element types, numbered as in ONNX TensorProto.DataType
+ */
+enum class DataType : int32_t {
+    Undefined = 0,
+    Float32 = 1,
+    Uint8 = 2,
+    Int8 = 3,
+    Int32 = 6,
+    Int64 = 7,
+    Bool = 9,
+    Float16 = 10,
+    Float64 = 11,
+    BFloat16 = 16
+};
+
+/**
+ * @brief Constant tensor: a graph initializer or the value of a Constant node
+ *
+ * Every element type is widened to float on load; integer tensors, such as
+ * Reshape targets, are exact up to 2^24. fp32 tensors of a model loaded with
+ * MapOnnxModel() may instead point into the file mapping, in which case
+ * `data` is empty; read the values through Values() and Count().
+ */
+struct Initializer {
+    std::string name;
+    DataType type = DataType::Float32;
+    Shape dims;
+    std::vector<float> data;
+    const float* mapped = nullptr;          // Values inside `mapping`, used instead of `data`
+    std::shared_ptr<const void> mapping;    // Keeps the mapped file alive while `mapped` points into it
+
+    const float* Values() const;
+    size_t Count() const;
+};
+
+/**
+ * @brief Node attribute
+ */
+struct Attribute {
+    enum class Type { Undefined, Float, Int, String, Tensor, Floats, Ints, Strings };
+
+    std::string name;
+    Type type = Type::Undefined;
+    float f = 0.0f;
+    int64_t i = 0;
+    std::string s;
+    Initializer t;
+    std::vector<float> floats;
+    std::vector<int64_t> ints;
+    std::vector<std::string> strings;
+};
+
+/**
+ * @brief One operator application
+ */
+struct Node {
+    std::string name;
+    std::string opType;
+    std::string domain;
+    std::vector<std::string> inputs;    // Empty names are omitted optional inputs
+    std::vector<std::string> outputs;
+    std::vector<Attribute> attributes;
+
+    const Attribute* FindAttribute(const std::string& attribute) const;
+    int64_t GetInt(const std::string& attribute, int64_t fallback) const;
+    float GetFloat(const std::string& attribute, float fallback) const;
+    std::string GetString(const std::string& attribute, const std::string& fallback) const;
+    std::vector<int64_t> GetInts(const std::string& attribute) const;
+};
+
+/**
+ * @brief Name, element type and declared shape of a graph input or output
+ */
+struct ValueInfo {
+    std::string name;
+    DataType type = DataType::Float32;
+    Shape shape;
+};
+
+/**
+ * @brief Inference graph loaded from an ONNX model
+ *
+ * Only the parts the executor needs are kept: the main graph's nodes,
+ * inputs, outputs and initializers, the default-domain opset and the
+ * model metadata.
+ */
+struct Graph {
+    std::string name;
+    std::vector<Node> nodes;
+    std::vector<ValueInfo> inputs;      // Runtime inputs only; initializers listed as inputs are dropped
+    std::vector<ValueInfo> outputs;
+    std::vector<Initializer> initializers;
+    std::vector<std::string> externalData;  // Files external tensors were read from, in the model's directory
+    std::vector<std::shared_ptr<const MappedFile>> mappedFiles;   // Files tensors read in place from
+
+    int64_t irVersion = 0;
+    int64_t opsetVersion = 0;           // Version of the default ("" / "ai.onnx") domain
+    int64_t modelVersion = 0;
+    std::string producerName;
+    std::string producerVersion;
+    std::string domain;
+    std::string docString;
+
+    const Initializer* FindInitializer(const std::string& initializer) const;
+};
+
+/**
+ * @brief Number of elements of a fully known shape
+ * @return Product of the dimensions, 1 for a scalar, -1 if any dimension is unknown
+ */
+int64_t ElementCount(const Shape& shape);
+
+/**
+ * @brief Format a shape as `[1, 3, 224, 224]`, with `?` for unknown dimensions
+ */
+std::string FormatShape(const Shape& shape);
+
+/**
+ * @brief Decode a serialized ONNX ModelProto
+ *
+ * Tensors stored as external data have no file to resolve against and are rejected.
+ *
+ * @param data Protobuf bytes
+ * @param size Byte count
+ * @param graph Receives the model
+ * @param error Receives a message on failure
+ * @return True on success
+ */
+bool ParseOnnxModel(const void* data, size_t size, Graph& graph, std::string& error);
+
+/**
+ * @brief Read and decode an ONNX model file, copying every tensor onto the heap
+ * @param path Path to a `.onnx` file; external data locations resolve relative to its directory
+ * @param graph Receives the model
+ * @param error Receives a message on failure
+ * @return True on success
+ */
+bool LoadOnnxModel(const std::string& path, Graph& graph, std::string& error);
+
+/**
+ * @brief Memory-map an ONNX model file and decode it without copying its weights
+ *
+ * fp32 initializers whose bytes are 4-byte aligned in the file, inline or in
+ * external data files, point straight into the read-only mapping, so every
+ * process that maps the same model shares one page-cache copy. Other tensors
+ * are decoded onto the heap as with LoadOnnxModel(). The graph keeps the
+ * mappings alive, including through copies of it.
+ *
+ * Model and external data files must be replaced atomically, by writing a
+ * new file and renaming it over the old one, while a graph maps them.
+ * Rewriting one in place changes the weights under the graph, or raises
+ * SIGBUS if it shrinks; CheckMappedFiles() detects it.
+ *
+ * @param path Path to a `.onnx` file; external data locations resolve relative to its directory
+ * @param graph Receives the model
+ * @param error Receives a message on failure
+ * @return True on success
+ */
+bool MapOnnxModel(const std::string& path, Graph& graph, std::string& error);
+
+/**
+ * @brief Check that no file a graph reads tensors from in place was rewritten since it was mapped
+ * @param graph Graph loaded with MapOnnxModel(); graphs without mapped tensors always pass
+ * @param error Receives the path of the changed file
+ * @return True if every mapped tensor still holds the values it was loaded with
+ */
+bool CheckMappedFiles(const Graph& graph, std::string& error);
+
+} // namespace neural
+} // namespace gaia_matrix
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gaia_matrix {
+namespace neural {
+
+/**
+ * @brief Instruction sets the GEMM micro-kernels are written for
+ */
+enum class KernelIsa {
+    Scalar,
+    Neon,
+    Avx2,       // AVX2 + FMA
+    Avx512      // AVX-512F
+};
+
+/**
+ * @brief Get the display name of an instruction set
+ */
+const char* GetKernelIsaName(KernelIsa isa);
+
+/**
+ * @brief Check if the kernels for an instruction set are compiled in and the CPU runs them
+ */
+bool IsKernelIsaSupported(KernelIsa isa);
+
+/**
+ * @brief Get the instruction set the kernels dispatch to
+ *
+ * Defaults to the widest supported one, detected on first use.
+ */
+KernelIsa GetKernelIsa();
+
+/**
+ * @brief Force the kernels onto an instruction set, e.g. to compare paths
+ * @param isa Instruction set to use
+ * @return False if the instruction set is not supported
+ */
+bool SetKernelIsa(KernelIsa isa);
+
+/**
+ * @brief Storage precision of constant weights; arithmetic is always fp32
+ */
+enum class WeightPrecision {
+    Float32,
+    Float16,    // IEEE half: 10-bit mantissa, range up to 65504
+    BFloat16    // Truncated fp32: 7-bit mantissa, full fp32 range
+};
+
+/**
+ * @brief Get the display name of a weight precision
+ */
+const char* GetWeightPrecisionName(WeightPrecision precision);
+
+/**
+ * @brief Narrow floats to a 16-bit precision, rounding to nearest even
+ *
+ * Uses F16C or AVX-512 BF16 when the active instruction set allows it.
+ * Float32 is not a valid target.
+ */
+void ConvertToHalf(WeightPrecision precision, const float* src, uint16_t* dst, size_t count);
+
+/**
+ * @brief Widen 16-bit floats back to fp32; exact
+ */
+void ConvertFromHalf(WeightPrecision precision, const uint16_t* src, float* dst, size_t count);
+
+/**
+ * @brief Elementwise activation applied after a product
+ */
+enum class Activation {
+    None,
+    Relu,
+    Sigmoid,
+    Tanh
+};
+
+/**
+ * @brief Apply an activation in place
+ */
+void ApplyActivation(Activation activation, float* data, size_t count);
+
+/**
+ * @brief Work folded into the GEMM's final write of each output tile
+ *
+ * Applied while the tile is still in cache, which saves the separate passes
+ * over C that a bias add and an activation would otherwise take.
+ */
+struct GemmEpilogue {
+    const float* bias = nullptr;    // One value per column of C, or per row with `biasPerRow`
+    bool biasPerRow = false;
+    Activation activation = Activation::None;
+};
+
+/**
+ * @brief B operand packed once into the panel layout the micro-kernel reads
+ *
+ * Used for constant weights, so repeated products skip the per-call packing.
+ * Panels are laid out for the instruction set active when Pack() ran. With
+ * a 16-bit precision the panels are stored narrowed and widened one cache
+ * block at a time as the product runs.
+ */
+class PackedMatrix {
+public:
+    /**
+     * @brief Pack a K x N operand
+     * @param trans True if `data` holds the N x K transpose
+     * @param K Rows of the operand
+     * @param N Columns of the operand
+     * @param data Row-major source
+     * @param ld Leading dimension of `data`
+     * @param precision Storage precision of the panels
+     */
+    void Pack(bool trans, int64_t K, int64_t N, const float* data, int64_t ld,
+              WeightPrecision precision = WeightPrecision::Float32);
+
+    int64_t GetRows() const { return m_K; }
+    int64_t GetColumns() const { return m_N; }
+    KernelIsa GetIsa() const { return m_Isa; }
+    WeightPrecision GetPrecision() const { return m_Precision; }
+    size_t GetByteSize() const { return m_Data.size() * sizeof(float) + m_Half.size() * sizeof(uint16_t); }
+
+private:
+    friend void SgemmPacked(bool, int64_t, float, const float*, int64_t, const PackedMatrix&, float, float*, int64_t,
+                            const GemmEpilogue*);
+
+    std::vector<float> m_Data;
+    std::vector<uint16_t> m_Half;       // Used instead of m_Data for 16-bit precisions
+    int64_t m_K = 0;
+    int64_t m_N = 0;
+    KernelIsa m_Isa = KernelIsa::Scalar;
+    WeightPrecision m_Precision = WeightPrecision::Float32;
+};
+
+/**
+ * @brief Single-precision GEMM: C = alpha * op(A) * op(B) + beta * C, row-major
+ *
+ * Cache-blocked and register-tiled; operands are packed into panels per
+ * block. When beta is 0, C is not read.
+ *
+ * @param transA Use the transpose of A
+ * @param transB Use the transpose of B
+ * @param M Rows of op(A) and C
+ * @param N Columns of op(B) and C
+ * @param K Columns of op(A), rows of op(B)
+ * @param lda Leading dimension of A
+ * @param ldb Leading dimension of B
+ * @param ldc Leading dimension of C
+ * @param epilogue Bias and activation applied to the finished C, or nullptr
+ */
+void Sgemm(bool transA, bool transB, int64_t M, int64_t N, int64_t K, float alpha, const float* A, int64_t lda,
+           const float* B, int64_t ldb, float beta, float* C, int64_t ldc, const GemmEpilogue* epilogue = nullptr);
+
+/**
+ * @brief GEMM with a pre-packed B operand; N and K come from `B`
+ */
+void SgemmPacked(bool transA, int64_t M, float alpha, const float* A, int64_t lda, const PackedMatrix& B, float beta,
+                 float* C, int64_t ldc, const GemmEpilogue* epilogue = nullptr);
+
+/**
+ * @brief Signed 8-bit B operand packed for the int8 GEMM
+ *
+ * K is grouped in fours so each 32-bit lane holds four consecutive products.
+ * Column sums are kept for the zero-point corrections.
+ */
+class PackedMatrixInt8 {
+public:
+    /**
+     * @brief Pack a K x N operand
+     * @param trans True if `data` holds the N x K transpose
+     * @param K Rows of the operand
+     * @param N Columns of the operand
+     * @param data Row-major source
+     * @param ld Leading dimension of `data`
+     * @param zeroPoints One zero point per column, or nullptr for symmetric weights
+     */
+    void Pack(bool trans, int64_t K, int64_t N, const int8_t* data, int64_t ld, const int32_t* zeroPoints);
+
+    int64_t GetRows() const { return m_K; }
+    int64_t GetColumns() const { return m_N; }
+    KernelIsa GetIsa() const;
+    size_t GetByteSize() const { return m_Data.size(); }
+
+private:
+    friend void QGemm(int64_t, const uint8_t*, int64_t, int32_t, const PackedMatrixInt8&, const float*, const float*,
+                      bool, float, float, float*, int64_t);
+
+    std::vector<int8_t> m_Data;
+    std::vector<int32_t> m_ColumnSums;
+    std::vector<int32_t> m_ZeroPoints;  // Empty if every zero point is 0
+    int64_t m_K = 0;
+    int64_t m_N = 0;
+    int m_Kernel = 0;
+};
+
+/**
+ * @brief Int8 GEMM with fused requantization
+ *
+ * Accumulates (A - aZeroPoint) * (B - bZeroPoint) exactly in int32, then
+ * writes C = acc * scale[n] + offset[n]. With `quantize`, the result is
+ * rounded to nearest even and clamped to [minimum, maximum], which yields
+ * QLinear outputs when offset holds the output zero point.
+ *
+ * @param M Rows of A and C
+ * @param A Unsigned 8-bit activations, M x K
+ * @param lda Leading dimension of A
+ * @param aZeroPoint Zero point of A
+ * @param B Packed weights; N and K come from here
+ * @param scale One multiplier per column of C
+ * @param offset One value per column added after scaling, or nullptr
+ * @param quantize Round and clamp the result
+ * @param minimum Lower clamp bound when quantizing
+ * @param maximum Upper clamp bound when quantizing
+ * @param C Output, M x N
+ * @param ldc Leading dimension of C
+ */
+void QGemm(int64_t M, const uint8_t* A, int64_t lda, int32_t aZeroPoint, const PackedMatrixInt8& B, const float* scale,
+           const float* offset, bool quantize, float minimum, float maximum, float* C, int64_t ldc);
+
+} // namespace neural
+} // namespace gaia_matrix
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "gaia_matrix/neural_graph.h"
+#include <string>
+#include <vector>
+
+namespace gaia_matrix {
+namespace neural {
+
+/**
+ * @brief One set of representative graph inputs for calibration
+ */
+struct CalibrationSample {
+    std::vector<std::vector<float>> inputs;     // One tensor per graph input, in graph order
+    std::vector<Shape> shapes;
+};
+
+/**
+ * @brief Post-training int8 quantization of a float graph
+ *
+ * Runs the calibration samples to record the range of every activation, then
+ * rewrites each Gemm, MatMul and Conv with constant weights into QDQ form:
+ * activations become per-tensor asymmetric uint8 and weights per-channel
+ * symmetric int8, stored as int8 initializers. The executor fuses the result
+ * onto its int8 kernels; other operators keep running in fp32.
+ *
+ * @param graph Float graph to quantize
+ * @param samples Calibration inputs; ranges come only from these
+ * @param quantized Receives the quantized graph
+ * @param error Receives a message on failure
+ * @return True on success
+ */
+bool QuantizeGraph(const Graph& graph, const std::vector<CalibrationSample>& samples, Graph& quantized,
+                   std::string& error);
+
+} // namespace neural
+} // namespace gaia_matrix
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "gaia_matrix/neural_graph.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gaia_matrix {
+namespace neural {
+
+/**
+ * @brief Alignment of Tensor storage, one cache line and the widest vector load
+ */
+constexpr size_t TENSOR_ALIGNMENT = 64;
+
+/**
+ * @brief Bytes per element of the types a TensorView may hold
+ * @return Size, or 0 for types tensor views do not support
+ */
+size_t DataTypeSize(DataType type);
+
+/**
+ * @brief Non-owning description of tensor memory
+ *
+ * Strides count elements, not bytes, so a view can describe a slice or a
+ * transposed layout of a larger buffer. Views passed as inputs are only read.
+ */
+struct TensorView {
+    void* data = nullptr;
+    DataType type = DataType::Float32;
+    Shape shape;
+    Shape strides;      // Elements between neighbours along each dimension; empty for contiguous row-major
+    std::string name;   // Graph input or output to bind to; empty to bind by position
+
+    TensorView() = default;
+    TensorView(float* data, Shape shape, std::string name = "");
+    TensorView(const float* data, Shape shape, std::string name = "");
+    TensorView(void* data, DataType type, Shape shape, Shape strides = {}, std::string name = "");
+
+    /**
+     * @brief Number of elements, or -1 if a dimension is unknown
+     */
+    int64_t Count() const;
+
+    /**
+     * @brief Check if the elements are packed in row-major order
+     */
+    bool IsContiguous() const;
+
+    /**
+     * @brief Check if the data starts on a TENSOR_ALIGNMENT boundary
+     */
+    bool IsAligned() const;
+};
+
+/**
+ * @brief Tensor owning contiguous storage aligned to TENSOR_ALIGNMENT
+ */
+class Tensor {
+public:
+    Tensor() = default;
+
+    /**
+     * @brief Allocate zeroed storage
+     * @param type Element type; must have a DataTypeSize()
+     * @param shape Fully known shape
+     * @param name Name used by View() to bind to a graph input or output
+     */
+    Tensor(DataType type, Shape shape, std::string name = "");
+
+    // Copies would not keep the alignment of the storage they copy
+    Tensor(const Tensor&) = delete;
+    Tensor& operator=(const Tensor&) = delete;
+    Tensor(Tensor&& other) noexcept;
+    Tensor& operator=(Tensor&& other) noexcept;
+
+    void* GetData() { return m_Data; }
+    const void* GetData() const { return m_Data; }
+    template <typename T> T* Data() { return static_cast<T*>(m_Data); }
+    template <typename T> const T* Data() const { return static_cast<const T*>(m_Data); }
+
+    DataType GetType() const { return m_Type; }
+    const Shape& GetShape() const { return m_Shape; }
+    const std::string& GetName() const { return m_Name; }
+    size_t GetByteSize() const { return m_Bytes; }
+
+    /**
+     * @brief Change the shape, reallocating only when the storage is too small
+     * @param shape Fully known shape; the contents are unspecified afterwards
+     */
+    void Resize(Shape shape);
+
+    TensorView View();
+
+private:
+    DataType m_Type = DataType::Float32;
+    Shape m_Shape;
+    std::string m_Name;
+    std::vector<uint8_t> m_Storage;
+    void* m_Data = nullptr;             // First aligned byte of m_Storage
+    size_t m_Bytes = 0;
+};
+
+/**
+ * @brief Gather a view into contiguous fp32 memory, converting its elements
+ * @param view Source of any supported type and layout
+ * @param dst Receives view.Count() values in row-major order
+ * @return False if the type is unsupported or the view is malformed
+ */
+bool ReadTensor(const TensorView& view, float* dst);
+
+/**
+ * @brief Scatter contiguous fp32 values into a view, converting to its element type
+ *
+ * Integer types round to nearest and saturate.
+ *
+ * @param src view.Count() values in row-major order
+ * @param view Destination of any supported type and layout
+ * @return False if the type is unsupported or the view is malformed
+ */
+bool WriteTensor(const float* src, const TensorView& view);
+
+} // namespace neural
+} // namespace gaia_matrix
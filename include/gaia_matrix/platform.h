@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include <memory>
 #include <vector>
@@ -123,4 +124,69 @@ public:
     static std::vector<std::string> GetFilesInDirectory(const std::string& path, const std::string& extension = "");
 };
 
+/**
+ * @brief Read-only memory mapping of a whole file
+ *
+ * Processes that map the same file read the same page-cache pages instead of
+ * holding private copies. Windows builds read the file into memory instead.
+ *
+ * The mapping shows later writes to the file, and touching pages past a
+ * truncated end raises SIGBUS. Replace mapped files atomically (write a
+ * temporary file, then rename it over the old one): the mapping keeps the
+ * old file open, so it is not affected. IsUnchanged() detects files that
+ * were rewritten in place instead.
+ */
+class MappedFile {
+public:
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Map a file
+     * @param path File path
+     * @return The mapping, or nullptr if the file cannot be opened or mapped
+     */
+    static std::shared_ptr<MappedFile> Open(const std::string& path);
+
+    /**
+     * @brief Get the mapped bytes; nullptr for an empty file
+     */
+    const void* GetData() const { return m_Data; }
+
+    /**
+     * @brief Get the file size in bytes
+     */
+    size_t GetSize() const { return m_Size; }
+
+    /**
+     * @brief Get the path the file was opened from
+     */
+    const std::string& GetPath() const { return m_Path; }
+
+    /**
+     * @brief Check that the mapped file still has the size and modification time it had when mapped
+     * @return False if it was written to or truncated since; always true for files read into memory
+     */
+    bool IsUnchanged() const;
+
+    /**
+     * @brief Check that the path still names the mapped file and that it is unchanged
+     * @return False if the file was rewritten, or replaced by another under the same path; always true for
+     *         files read into memory
+     */
+    bool IsCurrent() const;
+
+private:
+    MappedFile() = default;
+
+    const void* m_Data = nullptr;
+    size_t m_Size = 0;
+    std::string m_Path;
+    int m_File = -1;                // Kept open so the checks see the mapped file, not whatever has its path now
+    int64_t m_Modified = 0;         // Modification time in nanoseconds when mapped
+    std::vector<char> m_Buffer;     // Contents when the file is read rather than mapped
+};
+
 } // namespace gaia_matrix
\ No newline at end of file
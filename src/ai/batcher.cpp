@@ -0,0 +1,147 @@
+#include "gaia_matrix/neural_batcher.h"
+#include <algorithm>
+#include <iostream>
+
+namespace gaia_matrix {
+namespace neural {
+
+namespace {
+
+size_t RowsOf(const Shape& shape) {
+    return shape.empty() ? 1 : static_cast<size_t>(std::max<int64_t>(shape[0], 0));
+}
+
+// Requests batch together when they agree on everything but the row count
+bool SameRowShape(const Shape& a, const Shape& b) {
+    return a.size() == b.size() && std::equal(a.begin() + 1, a.end(), b.begin() + 1);
+}
+
+} // namespace
+
+InferenceBatcher::InferenceBatcher(RunFunction run, size_t maxBatchSize, std::chrono::microseconds maxWait)
+    : m_Run(std::move(run)), m_MaxBatchSize(std::max<size_t>(1, maxBatchSize)), m_MaxWait(maxWait) {
+    m_Worker = std::thread([this]() { WorkerLoop(); });
+}
+
+InferenceBatcher::~InferenceBatcher() {
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stopping = true;
+    }
+    m_Wake.notify_one();
+    if (m_Worker.joinable()) {
+        m_Worker.join();
+    }
+}
+
+std::future<std::vector<float>> InferenceBatcher::Submit(std::vector<float> input, Shape shape) {
+    Request request;
+    auto future = request.result.get_future();
+    if (shape.empty() || ElementCount(shape) != static_cast<int64_t>(input.size())) {
+        std::cerr << "Batched input of " << input.size() << " values does not match shape "
+                  << FormatShape(shape) << std::endl;
+        request.result.set_value({});
+        return future;
+    }
+    request.input = std::move(input);
+    request.shape = std::move(shape);
+    request.deadline = std::chrono::steady_clock::now() + m_MaxWait;
+
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        wake = m_Queue.empty() || m_QueuedRows < m_MaxBatchSize;
+        m_QueuedRows += RowsOf(request.shape);
+        m_Queue.push_back(std::move(request));
+        ++m_Stats.requests;
+        wake = wake && (m_Queue.size() == 1 || m_QueuedRows >= m_MaxBatchSize);
+    }
+    // The worker only needs the first request, which sets the deadline, or the one that fills the batch
+    if (wake) {
+        m_Wake.notify_one();
+    }
+    return future;
+}
+
+BatchingStats InferenceBatcher::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Stats;
+}
+
+void InferenceBatcher::WorkerLoop() {
+    std::vector<Request> batch;
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    while (true) {
+        m_Wake.wait(lock, [this]() { return m_Stopping || !m_Queue.empty(); });
+        if (m_Queue.empty()) {
+            return;     // Stopping with nothing left to run
+        }
+
+        // Give other requests until the oldest one's deadline to fill the batch
+        m_Wake.wait_until(lock, m_Queue.front().deadline,
+                          [this]() { return m_Stopping || m_QueuedRows >= m_MaxBatchSize; });
+
+        // Take the oldest request and every later one of the same row shape that still fits
+        batch.clear();
+        size_t rows = 0;
+        const Shape shape = m_Queue.front().shape;
+        for (auto it = m_Queue.begin(); it != m_Queue.end();) {
+            size_t requestRows = RowsOf(it->shape);
+            if (batch.empty() || (SameRowShape(it->shape, shape) && rows + requestRows <= m_MaxBatchSize)) {
+                rows += requestRows;
+                batch.push_back(std::move(*it));
+                it = m_Queue.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        m_QueuedRows -= rows;
+        ++m_Stats.batches;
+        m_Stats.rows += rows;
+        m_Stats.largestBatch = std::max(m_Stats.largestBatch, static_cast<uint32_t>(rows));
+
+        lock.unlock();
+        RunBatch(batch);
+        lock.lock();
+    }
+}
+
+void InferenceBatcher::RunBatch(std::vector<Request>& batch) {
+    // A lone request runs from its own buffer
+    const float* input = batch[0].input.data();
+    Shape shape = batch[0].shape;
+    if (batch.size() > 1) {
+        m_Input.clear();
+        shape[0] = 0;
+        for (const auto& request : batch) {
+            m_Input.insert(m_Input.end(), request.input.begin(), request.input.end());
+            shape[0] += request.shape[0];
+        }
+        input = m_Input.data();
+    }
+
+    bool ok = m_Run(input, shape, m_Output, m_OutputShape);
+    if (ok && (m_OutputShape.empty() || m_OutputShape[0] != shape[0])) {
+        std::cerr << "Batched output " << FormatShape(m_OutputShape) << " does not have the " << shape[0]
+                  << " rows of its input" << std::endl;
+        ok = false;
+    }
+    if (!ok) {
+        for (auto& request : batch) {
+            request.result.set_value({});
+        }
+        return;
+    }
+
+    // Scatter the output rows back in the order the inputs were concatenated
+    size_t rowSize = shape[0] > 0 ? m_Output.size() / static_cast<size_t>(shape[0]) : 0;
+    size_t offset = 0;
+    for (auto& request : batch) {
+        size_t count = RowsOf(request.shape) * rowSize;
+        request.result.set_value(std::vector<float>(m_Output.begin() + offset, m_Output.begin() + offset + count));
+        offset += count;
+    }
+}
+
+} // namespace neural
+} // namespace gaia_matrix
@@ -0,0 +1,1935 @@
+#include "gaia_matrix/neural_executor.h"
+#include "gaia_matrix/neural_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+namespace gaia_matrix {
+namespace neural {
+
+namespace {
+
+enum class OpKind {
+    Gemm, MatMul, Conv,
+    Add, Sub, Mul, Div,
+    Relu, Sigmoid, Tanh, Softmax, BatchNormalization,
+    Reshape, Flatten, Transpose, Concat,
+    MaxPool, AveragePool, GlobalAveragePool, GlobalMaxPool,
+    Identity,
+    QuantizeLinear, DequantizeLinear
+};
+
+const std::unordered_map<std::string, OpKind>& OperatorTable() {
+    static const std::unordered_map<std::string, OpKind> table = {
+        {"Gemm", OpKind::Gemm}, {"MatMul", OpKind::MatMul}, {"Conv", OpKind::Conv},
+        {"Add", OpKind::Add}, {"Sub", OpKind::Sub}, {"Mul", OpKind::Mul}, {"Div", OpKind::Div},
+        {"Relu", OpKind::Relu}, {"Sigmoid", OpKind::Sigmoid}, {"Tanh", OpKind::Tanh}, {"Softmax", OpKind::Softmax},
+        {"BatchNormalization", OpKind::BatchNormalization},
+        {"Reshape", OpKind::Reshape}, {"Flatten", OpKind::Flatten}, {"Transpose", OpKind::Transpose},
+        {"Concat", OpKind::Concat}, {"MaxPool", OpKind::MaxPool}, {"AveragePool", OpKind::AveragePool},
+        {"GlobalAveragePool", OpKind::GlobalAveragePool}, {"GlobalMaxPool", OpKind::GlobalMaxPool},
+        {"Identity", OpKind::Identity}, {"Dropout", OpKind::Identity},
+        {"QuantizeLinear", OpKind::QuantizeLinear}, {"DequantizeLinear", OpKind::DequantizeLinear},
+        // Rewritten in Prepare into int8 MatMul/Conv steps
+        {"QLinearMatMul", OpKind::MatMul}, {"QLinearConv", OpKind::Conv}};
+    return table;
+}
+
+// Normalise a possibly negative axis; -1 if out of range
+int64_t ResolveAxis(int64_t axis, size_t rank) {
+    int64_t resolved = axis < 0 ? axis + static_cast<int64_t>(rank) : axis;
+    return resolved >= 0 && resolved < static_cast<int64_t>(rank) ? resolved : -1;
+}
+
+int64_t Product(const Shape& shape, size_t begin, size_t end) {
+    int64_t product = 1;
+    for (size_t i = begin; i < end; ++i) {
+        product *= shape[i];
+    }
+    return product;
+}
+
+// Multidirectional (numpy) broadcasting
+bool BroadcastShapes(const Shape& a, const Shape& b, Shape& out) {
+    size_t rank = std::max(a.size(), b.size());
+    out.assign(rank, 1);
+    for (size_t i = 0; i < rank; ++i) {
+        int64_t da = i < rank - a.size() ? 1 : a[i - (rank - a.size())];
+        int64_t db = i < rank - b.size() ? 1 : b[i - (rank - b.size())];
+        if (da != db && da != 1 && db != 1) {
+            return false;
+        }
+        out[i] = da == 1 ? db : da;
+    }
+    return true;
+}
+
+// Element strides of `shape` seen through a broadcast to `out`; broadcast dimensions get stride 0
+std::vector<int64_t> BroadcastStrides(const Shape& shape, const Shape& out) {
+    std::vector<int64_t> strides(out.size(), 0);
+    int64_t stride = 1;
+    for (size_t i = 0; i < shape.size(); ++i) {
+        size_t dim = shape.size() - 1 - i;
+        size_t outDim = out.size() - 1 - i;
+        strides[outDim] = shape[dim] == 1 ? 0 : stride;
+        stride *= shape[dim];
+    }
+    return strides;
+}
+
+// Alignment of the activation arena and of every block in it: one cache line
+constexpr size_t ARENA_ALIGNMENT = 64;
+
+// Floats a block of `bytes` takes in the arena, rounded up to whole cache lines
+size_t ArenaFloats(size_t bytes) {
+    return (bytes + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * (ARENA_ALIGNMENT / sizeof(float));
+}
+
+/**
+ * Sliding window of a 1-D or 2-D convolution or pooling over NC(H)W input.
+ * 1-D windows are treated as 2-D with a height of one.
+ */
+struct Window {
+    int64_t kernelH = 1, kernelW = 1;
+    int64_t strideH = 1, strideW = 1;
+    int64_t dilationH = 1, dilationW = 1;
+    int64_t padTop = 0, padLeft = 0, padBottom = 0, padRight = 0;
+    int64_t inH = 1, inW = 1, outH = 1, outW = 1;
+    bool countPadding = false;      // AveragePool's count_include_pad
+};
+
+// Elementwise outputs are produced in blocks this long, so a fused chain runs over each block while it is in L1
+constexpr size_t ELEMENTWISE_BLOCK = 1024;
+
+/**
+ * An elementwise step folded into the one before it: an activation, or
+ * arithmetic with a scalar constant.
+ */
+struct ElementwiseLink {
+    OpKind kind;
+    float operand = 0.0f;
+    bool reversed = false;          // The constant is the left operand of Sub or Div
+    size_t rank = 0;                // Rank of the constant, which the output broadcasts to
+};
+
+bool IsElementwise(OpKind kind) {
+    return kind == OpKind::Add || kind == OpKind::Sub || kind == OpKind::Mul || kind == OpKind::Div ||
+           kind == OpKind::Relu || kind == OpKind::Sigmoid || kind == OpKind::Tanh;
+}
+
+Activation ActivationOf(OpKind kind) {
+    switch (kind) {
+        case OpKind::Relu: return Activation::Relu;
+        case OpKind::Sigmoid: return Activation::Sigmoid;
+        case OpKind::Tanh: return Activation::Tanh;
+        default: return Activation::None;
+    }
+}
+
+float ApplyBinary(OpKind kind, float x, float y) {
+    switch (kind) {
+        case OpKind::Add: return x + y;
+        case OpKind::Sub: return x - y;
+        case OpKind::Mul: return x * y;
+        default: return x / y;
+    }
+}
+
+void ApplyLink(const ElementwiseLink& link, float* data, size_t count) {
+    Activation activation = ActivationOf(link.kind);
+    if (activation != Activation::None) {
+        ApplyActivation(activation, data, count);
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        data[i] = link.reversed ? ApplyBinary(link.kind, link.operand, data[i])
+                                : ApplyBinary(link.kind, data[i], link.operand);
+    }
+}
+
+// A 1x1 convolution with unit strides and no padding reads its input directly, without im2col
+bool IsPointwise(const Window& window) {
+    return window.kernelH == 1 && window.kernelW == 1 && window.strideH == 1 && window.strideW == 1 &&
+           window.padTop == 0 && window.padLeft == 0 && window.padBottom == 0 && window.padRight == 0;
+}
+
+bool ResolveWindow(const Node& node, const Shape& input, const std::vector<int64_t>& kernel, bool ceilMode,
+                   Window& window, std::string& error) {
+    size_t spatial = input.size() - 2;
+    if ((spatial != 1 && spatial != 2) || kernel.size() != spatial) {
+        error = node.opType + " supports 1-D and 2-D windows only";
+        return false;
+    }
+    auto strides = node.GetInts("strides");
+    auto dilations = node.GetInts("dilations");
+    auto pads = node.GetInts("pads");
+    strides.resize(spatial, 1);
+    dilations.resize(spatial, 1);
+    pads.resize(spatial * 2, 0);
+
+    // Index 0 is H for 2-D windows; 1-D windows only have W
+    size_t w = spatial - 1;
+    window.kernelW = kernel[w];
+    window.strideW = strides[w];
+    window.dilationW = dilations[w];
+    window.padLeft = pads[w];
+    window.padRight = pads[spatial + w];
+    window.inW = input[input.size() - 1];
+    if (spatial == 2) {
+        window.kernelH = kernel[0];
+        window.strideH = strides[0];
+        window.dilationH = dilations[0];
+        window.padTop = pads[0];
+        window.padBottom = pads[2];
+        window.inH = input[2];
+    }
+
+    auto resolve = [&](int64_t in, int64_t k, int64_t s, int64_t d, int64_t& begin, int64_t& end, int64_t& out) {
+        if (k <= 0 || s <= 0 || d <= 0) {
+            return false;
+        }
+        int64_t extent = d * (k - 1) + 1;
+        std::string autoPad = node.GetString("auto_pad", "NOTSET");
+        if (autoPad == "SAME_UPPER" || autoPad == "SAME_LOWER") {
+            out = (in + s - 1) / s;
+            int64_t total = std::max<int64_t>(0, (out - 1) * s + extent - in);
+            begin = autoPad == "SAME_UPPER" ? total / 2 : total - total / 2;
+            end = total - begin;
+            return true;
+        }
+        if (autoPad == "VALID") {
+            begin = end = 0;
+        }
+        int64_t span = in + begin + end - extent;
+        if (span < 0) {
+            return false;
+        }
+        out = (ceilMode ? (span + s - 1) / s : span / s) + 1;
+        return true;
+    };
+    if (!resolve(window.inH, window.kernelH, window.strideH, window.dilationH, window.padTop, window.padBottom,
+                 window.outH) ||
+        !resolve(window.inW, window.kernelW, window.strideW, window.dilationW, window.padLeft, window.padRight,
+                 window.outW)) {
+        error = node.opType + " window does not fit input " + FormatShape(input);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Int8 form of a MatMul, Gemm or Conv step. The activation input holds
+ * quantized integers; the output is either float (fused QDQ) or quantized
+ * integers again (QLinear operators).
+ */
+struct QuantizedOp {
+    std::vector<PackedMatrixInt8> weights;  // One per convolution group
+    int32_t inputZeroPoint = 0;             // After shifting signed inputs into the unsigned range
+    bool inputSigned = false;
+    std::vector<float> scale;               // Per output channel
+    std::vector<float> offset;              // Per output channel; empty for none
+    bool quantizeOutput = false;
+    float minimum = 0.0f;
+    float maximum = 0.0f;
+};
+
+bool IsSigned(DataType type) {
+    return type == DataType::Int8;
+}
+
+} // namespace
+
+struct GraphExecutor::Value {
+    std::string name;
+    Shape shape;
+    std::vector<float> data;        // Folded constants that exist nowhere else
+    const float* view = nullptr;    // Data held elsewhere: graph constants, or the caller's input during Run
+    float* buffer = nullptr;        // Step outputs: the value's slot in the activation arena
+    size_t count = 0;               // Element count of `view` or `buffer`
+    DataType type = DataType::Float32;
+    bool constant = false;
+
+    const float* Data() const { return view ? view : buffer ? buffer : data.data(); }
+    size_t Size() const { return view || buffer ? count : data.size(); }
+};
+
+// Scale and zero point of a quantized tensor, one entry per channel
+struct GraphExecutor::Quantization {
+    std::vector<float> scale;
+    std::vector<int32_t> zeroPoint;
+    bool isSigned = false;
+};
+
+// A node output or a step's scratch space in the arena, live from the step
+// that writes it to the last step that reads it
+struct GraphExecutor::Block {
+    size_t size;        // Floats, rounded up to whole cache lines
+    size_t first;
+    size_t last;
+    float** target;
+    size_t offset = 0;
+};
+
+struct GraphExecutor::Step {
+    const Node* node = nullptr;
+    OpKind kind = OpKind::Identity;
+    std::vector<int32_t> inputs;    // -1 for an omitted optional input
+    std::vector<int32_t> outputs;
+    std::shared_ptr<PackedMatrix> weights;  // Constant B operand of Gemm/MatMul, packed once
+    std::shared_ptr<QuantizedOp> quantized;
+    std::shared_ptr<std::vector<uint16_t>> halfWeights;    // Constant Conv filters in 16-bit storage
+
+    // Set by FuseGraph
+    Activation activation = Activation::None;  // Gemm, MatMul and Conv apply it in the GEMM epilogue
+    std::vector<ElementwiseLink> chain;         // Elementwise steps folded into this one, in order
+
+    // Derived from the current input shapes by Infer, so Run does not allocate
+    Window window;                  // Conv and pooling
+    Shape extent;                   // Index space of a strided walk: broadcast output, MatMul batches, Transpose
+    std::vector<int64_t> strides[2];    // Input strides over `extent`; Gemm keeps the bias strides in [0]
+    float* scratch = nullptr;       // Step-local space in the arena: im2col columns, widened or quantized operands
+    bool alias = false;             // The output is the input's data under another shape, so nothing is copied
+};
+
+namespace {
+
+/**
+ * Pack integer weights for QGemm. `weights` is K x N, or N x K when `trans`;
+ * with groups, each group owns a contiguous N / groups slice of rows.
+ */
+std::shared_ptr<QuantizedOp> MakeQuantizedOp(float inputScale, int32_t inputZeroPoint, bool inputSigned,
+                                             const float* weights, const std::vector<float>& scales,
+                                             const std::vector<int32_t>& zeroPoints, bool weightsSigned, bool trans,
+                                             int64_t K, int64_t N, int64_t groups, float alpha) {
+    auto op = std::make_shared<QuantizedOp>();
+    op->inputSigned = inputSigned;
+    op->inputZeroPoint = inputZeroPoint + (inputSigned ? 128 : 0);
+
+    // Unsigned weights are shifted into int8; the zero points move with them
+    int32_t shift = weightsSigned ? 0 : 128;
+    std::vector<int8_t> values(static_cast<size_t>(K * N));
+    std::transform(weights, weights + values.size(), values.begin(),
+                   [shift](float w) { return static_cast<int8_t>(static_cast<int32_t>(w) - shift); });
+    std::vector<int32_t> shifted(zeroPoints.size());
+    std::transform(zeroPoints.begin(), zeroPoints.end(), shifted.begin(), [shift](int32_t z) { return z - shift; });
+
+    int64_t channels = N / groups;
+    op->weights.resize(static_cast<size_t>(groups));
+    for (int64_t g = 0; g < groups; ++g) {
+        op->weights[g].Pack(trans, K, channels, values.data() + g * channels * K, trans ? K : N,
+                            shifted.data() + g * channels);
+    }
+    op->scale.resize(static_cast<size_t>(N));
+    for (int64_t n = 0; n < N; ++n) {
+        op->scale[n] = alpha * inputScale * scales[n];
+    }
+    return op;
+}
+
+} // namespace
+
+bool IsOperatorSupported(const std::string& opType) {
+    return opType == "Constant" || OperatorTable().count(opType) > 0;
+}
+
+GraphExecutor::GraphExecutor() {}
+
+GraphExecutor::~GraphExecutor() {}
+
+const Graph& GraphExecutor::GetGraph() const {
+    return *m_Graph;
+}
+
+bool GraphExecutor::Prepare(std::shared_ptr<const Graph> graph, std::vector<std::string>& errors) {
+    m_Graph = graph;
+    m_Values.clear();
+    m_Steps.clear();
+    m_Inputs.clear();
+    m_Outputs.clear();
+    m_InferredFor.clear();
+    m_Reserved.clear();
+    m_ReservedBytes = 0;
+    size_t errorCount = errors.size();
+
+    std::unordered_map<std::string, int32_t> ids;
+    auto define = [this, &ids](const std::string& name) {
+        auto [it, inserted] = ids.emplace(name, static_cast<int32_t>(m_Values.size()));
+        if (inserted) {
+            m_Values.emplace_back();
+            m_Values.back().name = name;
+        }
+        return it->second;
+    };
+
+    for (const auto& input : graph->inputs) {
+        m_Inputs.push_back(define(input.name));
+    }
+    // Constants are read in place: the graph outlives the executor, and mapped weights stay in the page cache
+    for (const auto& initializer : graph->initializers) {
+        Value& value = m_Values[define(initializer.name)];
+        value.shape = initializer.dims;
+        value.view = initializer.Values();
+        value.count = initializer.Count();
+        value.type = initializer.type;
+        value.constant = true;
+    }
+
+    // Kahn's algorithm: ONNX requires sorted nodes, but exporters do not always comply
+    std::vector<const Node*> pending;
+    for (const auto& node : graph->nodes) {
+        pending.push_back(&node);
+    }
+    std::vector<bool> available(m_Values.size(), true);
+    bool progress = true;
+    while (!pending.empty() && progress) {
+        progress = false;
+        for (auto it = pending.begin(); it != pending.end();) {
+            const Node& node = **it;
+            bool ready = std::all_of(node.inputs.begin(), node.inputs.end(), [&](const std::string& name) {
+                auto found = ids.find(name);
+                return name.empty() || (found != ids.end() && available[found->second]);
+            });
+            if (!ready) {
+                ++it;
+                continue;
+            }
+
+            if (node.opType == "Constant") {
+                // Folded into a constant value; the node never runs
+                const Attribute* attribute = node.attributes.empty() ? nullptr : &node.attributes[0];
+                Value& value = m_Values[define(node.outputs.empty() ? "" : node.outputs[0])];
+                value.constant = true;
+                if (attribute && attribute->name == "value") {
+                    value.shape = attribute->t.dims;
+                    value.view = attribute->t.Values();
+                    value.count = attribute->t.Count();
+                    value.type = attribute->t.type;
+                } else if (attribute && (attribute->name == "value_float" || attribute->name == "value_int")) {
+                    value.data = {attribute->name == "value_float" ? attribute->f : static_cast<float>(attribute->i)};
+                } else if (attribute && attribute->name == "value_floats") {
+                    value.shape = {static_cast<int64_t>(attribute->floats.size())};
+                    value.view = attribute->floats.data();
+                    value.count = attribute->floats.size();
+                } else if (attribute && attribute->name == "value_ints") {
+                    value.shape = {static_cast<int64_t>(attribute->ints.size())};
+                    value.data.assign(attribute->ints.begin(), attribute->ints.end());
+                } else {
+                    errors.push_back("Constant node '" + node.name + "' has no supported value");
+                }
+            } else {
+                auto op = OperatorTable().find(node.opType);
+                if (op == OperatorTable().end() || !(node.domain.empty() || node.domain == "ai.onnx")) {
+                    errors.push_back("unsupported operator " + node.opType + " (node '" + node.name + "')");
+                }
+                Step step;
+                step.node = &node;
+                step.kind = op != OperatorTable().end() ? op->second : OpKind::Identity;
+                for (const auto& name : node.inputs) {
+                    step.inputs.push_back(name.empty() ? -1 : ids[name]);
+                }
+                for (size_t i = 0; i < node.outputs.size(); ++i) {
+                    // Secondary outputs (pool indices, dropout masks) are not produced
+                    if (i > 0 && !node.outputs[i].empty()) {
+                        errors.push_back(node.opType + " node '" + node.name + "' output " + std::to_string(i) +
+                                         " is not supported");
+                    }
+                    step.outputs.push_back(node.outputs[i].empty() ? -1 : define(node.outputs[i]));
+                }
+
+                // Element types only matter for quantized tensors: Q/DQ zero points and their producers
+                if (!step.outputs.empty() && step.outputs[0] >= 0) {
+                    DataType type = DataType::Float32;
+                    if (step.kind == OpKind::QuantizeLinear) {
+                        type = step.inputs.size() > 2 && step.inputs[2] >= 0 ? m_Values[step.inputs[2]].type
+                                                                              : DataType::Uint8;
+                    } else if (step.kind == OpKind::Reshape || step.kind == OpKind::Flatten ||
+                               step.kind == OpKind::Transpose || step.kind == OpKind::Concat ||
+                               step.kind == OpKind::Identity || step.kind == OpKind::MaxPool) {
+                        type = step.inputs.empty() || step.inputs[0] < 0 ? type : m_Values[step.inputs[0]].type;
+                    }
+                    m_Values[step.outputs[0]].type = type;
+                }
+                if (node.opType == "QLinearMatMul" || node.opType == "QLinearConv") {
+                    std::string error;
+                    if (!PrepareQLinear(step, error)) {
+                        errors.push_back(node.opType + " node '" + node.name + "': " + error);
+                    }
+                }
+                if (step.kind == OpKind::Reshape &&
+                    (step.inputs.size() < 2 || step.inputs[1] < 0 || !m_Values[step.inputs[1]].constant)) {
+                    errors.push_back("Reshape node '" + node.name + "' needs a constant shape");
+                }
+                m_Steps.push_back(std::move(step));
+            }
+            available.resize(m_Values.size(), false);
+            for (const auto& name : node.outputs) {
+                if (!name.empty()) {
+                    available[ids[name]] = true;
+                }
+            }
+            it = pending.erase(it);
+            progress = true;
+        }
+    }
+    for (const Node* node : pending) {
+        errors.push_back("node '" + node->name + "' (" + node->opType + ") has an input nothing produces");
+    }
+
+    for (const auto& output : graph->outputs) {
+        auto found = ids.find(output.name);
+        if (found == ids.end() || !available[found->second]) {
+            errors.push_back("graph output '" + output.name + "' is never produced");
+            continue;
+        }
+        m_Outputs.push_back(found->second);
+    }
+    if (errors.size() != errorCount) {
+        return false;
+    }
+
+    FuseQuantized();
+    if (m_Fusion) {
+        FuseGraph();
+    }
+    RemoveDeadSteps();
+    PackConstants();
+    ReleasePackedConstants();
+    return true;
+}
+
+bool GraphExecutor::ReadQuantization(int32_t scaleId, int32_t zeroPointId, int64_t channels, DataType fallback,
+                                     Quantization& quantization) const {
+    if (scaleId < 0 || !m_Values[scaleId].constant || (zeroPointId >= 0 && !m_Values[zeroPointId].constant)) {
+        return false;
+    }
+    const Value& scale = m_Values[scaleId];
+    size_t count = scale.Size();
+    if (count != 1 && count != static_cast<size_t>(channels)) {
+        return false;
+    }
+    quantization.scale.assign(static_cast<size_t>(channels), scale.Data()[0]);
+    quantization.zeroPoint.assign(static_cast<size_t>(channels), 0);
+    quantization.isSigned = IsSigned(fallback);
+    if (zeroPointId >= 0) {
+        const Value& zeroPoint = m_Values[zeroPointId];
+        if (zeroPoint.Size() != count) {
+            return false;
+        }
+        quantization.isSigned = IsSigned(zeroPoint.type);
+        for (int64_t c = 0; c < channels; ++c) {
+            quantization.zeroPoint[c] = static_cast<int32_t>(zeroPoint.Data()[count == 1 ? 0 : c]);
+        }
+    }
+    for (int64_t c = 0; count > 1 && c < channels; ++c) {
+        quantization.scale[c] = scale.Data()[c];
+    }
+    return true;
+}
+
+bool GraphExecutor::PrepareQLinear(Step& step, std::string& error) {
+    // QLinearMatMul: a, a_scale, a_zp, b, b_scale, b_zp, y_scale, y_zp
+    // QLinearConv:   x, x_scale, x_zp, w, w_scale, w_zp, y_scale, y_zp[, B]
+    const auto& ids = step.inputs;
+    if (ids.size() < 8 || ids[0] < 0 || ids[3] < 0) {
+        error = "expected 8 inputs";
+        return false;
+    }
+    const Value& w = m_Values[ids[3]];
+    bool isConv = step.kind == OpKind::Conv;
+    if (!w.constant || (isConv ? w.shape.size() < 3 : w.shape.size() != 2)) {
+        error = "weights must be a constant " + std::string(isConv ? "filter bank" : "matrix");
+        return false;
+    }
+    int64_t N = isConv ? w.shape[0] : w.shape[1];
+    int64_t K = isConv ? Product(w.shape, 1, w.shape.size()) : w.shape[0];
+    int64_t groups = isConv ? step.node->GetInt("group", 1) : 1;
+    if (groups <= 0 || N % groups) {
+        error = "invalid group count";
+        return false;
+    }
+
+    Quantization input, weights, output;
+    if (!ReadQuantization(ids[1], ids[2], 1, m_Values[ids[0]].type, input) ||
+        !ReadQuantization(ids[4], ids[5], N, w.type, weights) ||
+        !ReadQuantization(ids[6], ids[7], 1, DataType::Uint8, output)) {
+        error = "scales and zero points must be constants, per tensor or per output channel for the weights";
+        return false;
+    }
+
+    auto op = MakeQuantizedOp(input.scale[0], input.zeroPoint[0], input.isSigned, w.Data(), weights.scale,
+                              weights.zeroPoint, weights.isSigned, isConv, K, N, groups, 1.0f);
+    const Value* bias = ids.size() > 8 && ids[8] >= 0 ? &m_Values[ids[8]] : nullptr;
+    if (bias && (!bias->constant || bias->Size() != static_cast<size_t>(N))) {
+        error = "bias must be a constant with one value per output channel";
+        return false;
+    }
+    // The int32 bias shares the accumulator's scale, so it folds into the offset
+    op->offset.resize(static_cast<size_t>(N));
+    for (int64_t n = 0; n < N; ++n) {
+        op->scale[n] /= output.scale[0];
+        op->offset[n] = static_cast<float>(output.zeroPoint[0]) + (bias ? bias->Data()[n] * op->scale[n] : 0.0f);
+    }
+    op->quantizeOutput = true;
+    op->minimum = output.isSigned ? -128.0f : 0.0f;
+    op->maximum = output.isSigned ? 127.0f : 255.0f;
+
+    step.quantized = op;
+    step.inputs = {ids[0], ids[3]};
+    if (!step.outputs.empty() && step.outputs[0] >= 0) {
+        m_Values[step.outputs[0]].type = output.isSigned ? DataType::Int8 : DataType::Uint8;
+    }
+    return true;
+}
+
+void GraphExecutor::FuseQuantized() {
+    std::vector<int32_t> producer(m_Values.size(), -1);
+    for (size_t i = 0; i < m_Steps.size(); ++i) {
+        for (int32_t id : m_Steps[i].outputs) {
+            if (id >= 0) {
+                producer[id] = static_cast<int32_t>(i);
+            }
+        }
+    }
+    auto dequantized = [&](int32_t id) -> const Step* {
+        int32_t index = id >= 0 ? producer[id] : -1;
+        return index >= 0 && m_Steps[index].kind == OpKind::DequantizeLinear ? &m_Steps[index] : nullptr;
+    };
+
+    // DequantizeLinear(activation) and DequantizeLinear(constant weights) into MatMul/Gemm/Conv
+    for (Step& step : m_Steps) {
+        bool candidate = step.kind == OpKind::MatMul || step.kind == OpKind::Gemm || step.kind == OpKind::Conv;
+        if (!candidate || step.quantized || step.inputs.size() < 2) {
+            continue;
+        }
+        const Step* x = dequantized(step.inputs[0]);
+        const Step* w = dequantized(step.inputs[1]);
+        if (!x || !w || w->inputs.size() < 2 || !m_Values[w->inputs[0]].constant) {
+            continue;
+        }
+        const Value& weights = m_Values[w->inputs[0]];
+        const Node& node = *step.node;
+        bool trans = false;
+        int64_t N = 0, K = 0, axis = 0, groups = 1;
+        float alpha = 1.0f;
+        if (step.kind == OpKind::Conv) {
+            if (weights.shape.size() < 3) {
+                continue;
+            }
+            trans = true;
+            N = weights.shape[0];
+            K = Product(weights.shape, 1, weights.shape.size());
+            groups = node.GetInt("group", 1);
+        } else {
+            if (weights.shape.size() != 2 || (step.kind == OpKind::Gemm && node.GetInt("transA", 0) != 0)) {
+                continue;
+            }
+            trans = step.kind == OpKind::Gemm && node.GetInt("transB", 0) != 0;
+            N = weights.shape[trans ? 0 : 1];
+            K = weights.shape[trans ? 1 : 0];
+            axis = trans ? 0 : 1;
+            alpha = step.kind == OpKind::Gemm ? node.GetFloat("alpha", 1.0f) : 1.0f;
+        }
+        if (groups <= 0 || N % groups) {
+            continue;
+        }
+
+        // Per-channel weight scales must run along the output channels
+        Quantization input, weightQuantization;
+        int32_t scaleId = w->inputs[1];
+        if (scaleId >= 0 && m_Values[scaleId].Size() > 1 &&
+            ResolveAxis(w->node->GetInt("axis", 1), weights.shape.size()) != axis) {
+            continue;
+        }
+        if (x->inputs.size() < 2 ||
+            !ReadQuantization(x->inputs[1], x->inputs.size() > 2 ? x->inputs[2] : -1, 1,
+                              m_Values[x->inputs[0]].type, input) ||
+            !ReadQuantization(scaleId, w->inputs.size() > 2 ? w->inputs[2] : -1, N, weights.type,
+                              weightQuantization)) {
+            continue;
+        }
+
+        step.quantized = MakeQuantizedOp(input.scale[0], input.zeroPoint[0], input.isSigned, weights.Data(),
+                                         weightQuantization.scale, weightQuantization.zeroPoint,
+                                         weightQuantization.isSigned, trans, K, N, groups, alpha);
+        step.inputs[0] = x->inputs[0];
+        step.inputs[1] = w->inputs[0];
+    }
+}
+
+int32_t GraphExecutor::AddConstant(const std::string& name, const Shape& shape, std::vector<float> data) {
+    Value value;
+    value.name = name;
+    value.shape = shape;
+    value.data = std::move(data);
+    value.constant = true;
+    m_Values.push_back(std::move(value));
+    return static_cast<int32_t>(m_Values.size() - 1);
+}
+
+void GraphExecutor::FuseGraph() {
+    // A value can be folded into its producer when exactly one step reads it and it is not a graph output
+    std::vector<int32_t> uses(m_Values.size(), 0);
+    std::vector<int32_t> consumer(m_Values.size(), -1);
+    for (int32_t id : m_Outputs) {
+        uses[id] += 2;
+    }
+    for (size_t i = 0; i < m_Steps.size(); ++i) {
+        for (int32_t id : m_Steps[i].inputs) {
+            if (id >= 0) {
+                ++uses[id];
+                consumer[id] = static_cast<int32_t>(i);
+            }
+        }
+    }
+    auto next = [&](const Step& step) -> Step* {
+        int32_t id = step.outputs.empty() ? -1 : step.outputs[0];
+        return id >= 0 && uses[id] == 1 ? &m_Steps[consumer[id]] : nullptr;
+    };
+    // The folded step's output takes over from `absorbed`, which then produces nothing and is removed as dead
+    auto absorb = [](Step& step, Step& absorbed) {
+        step.outputs[0] = absorbed.outputs[0];
+        absorbed.outputs.assign(1, -1);
+        absorbed.inputs.clear();
+    };
+    auto constant = [&](int32_t id) { return id >= 0 && m_Values[id].constant && m_Values[id].type == DataType::Float32; };
+    // The constant operand of a binary step whose other operand is `id`, or -1
+    auto operand = [&](const Step& step, int32_t id, bool& reversed) {
+        if (step.inputs.size() != 2 || step.inputs[0] == step.inputs[1]) {
+            return -1;
+        }
+        reversed = step.inputs[1] == id;
+        int32_t other = step.inputs[reversed ? 0 : 1];
+        return constant(other) ? other : -1;
+    };
+
+    for (Step& step : m_Steps) {
+        if (step.outputs.empty() || step.outputs[0] < 0 || step.quantized) {
+            continue;
+        }
+        const Node& node = *step.node;
+        bool isGemm = step.kind == OpKind::Gemm;
+        bool isConv = step.kind == OpKind::Conv;
+        if (isGemm || isConv || step.kind == OpKind::MatMul) {
+            // BatchNormalization and a bias Add fold into constant weights; any product takes an activation
+            bool weighted = step.inputs.size() > 1 && constant(step.inputs[1]);
+            Shape w = weighted ? m_Values[step.inputs[1]].shape : Shape();
+            bool transB = isGemm && node.GetInt("transB", 0) != 0;
+            int64_t channels = w.size() < 2 ? 0 : isConv ? w[0] : w[transB ? 0 : 1];
+            int32_t biasId = step.inputs.size() > 2 ? step.inputs[2] : -1;
+            // Constants holding one value per output channel, laid out to broadcast along the channel axis
+            auto perChannel = [&](int32_t id) {
+                const Shape& shape = m_Values[id].shape;
+                if (ElementCount(shape) != channels) {
+                    return false;
+                }
+                if (isConv) {
+                    // Axis 1 of the NC(H)W output, which has the rank of the filters
+                    return shape.size() + 1 >= w.size() && shape.size() <= w.size() &&
+                           shape[shape.size() + 1 - w.size()] == channels;
+                }
+                return shape.size() == 1 || (isGemm && shape.size() == 2 && shape[0] == 1);
+            };
+            bool foldsBias = (isConv ? w.size() >= 3 : w.size() == 2) &&
+                             (!isGemm || node.GetFloat("beta", 1.0f) == 1.0f) &&
+                             (biasId < 0 || (constant(biasId) && (isConv ? m_Values[biasId].Size() ==
+                                                                               static_cast<size_t>(channels)
+                                                                         : perChannel(biasId))));
+            auto bias = [&]() {
+                std::vector<float> values(static_cast<size_t>(channels), 0.0f);
+                if (biasId >= 0) {
+                    std::copy_n(m_Values[biasId].Data(), channels, values.begin());
+                }
+                return values;
+            };
+
+            // MatMul outputs can have batch dimensions ahead of the channels BatchNormalization scales
+            Step* follower = next(step);
+            bool normalizes = foldsBias && follower && follower->kind == OpKind::BatchNormalization &&
+                              step.kind != OpKind::MatMul && follower->inputs.size() == 5 &&
+                              std::all_of(follower->inputs.begin() + 1, follower->inputs.end(), [&](int32_t id) {
+                                  return constant(id) && m_Values[id].Size() == static_cast<size_t>(channels);
+                              });
+            if (normalizes) {
+                // y = (x - mean) / sqrt(var + epsilon) * scale + B scales each output channel's weights
+                float epsilon = follower->node->GetFloat("epsilon", 1e-5f);
+                const float* scale = m_Values[follower->inputs[1]].Data();
+                const float* shift = m_Values[follower->inputs[2]].Data();
+                const float* mean = m_Values[follower->inputs[3]].Data();
+                const float* variance = m_Values[follower->inputs[4]].Data();
+                const Value& weights = m_Values[step.inputs[1]];
+                std::vector<float> folded(weights.Data(), weights.Data() + weights.Size());
+                std::vector<float> offset = bias();
+                int64_t inner = static_cast<int64_t>(folded.size()) / channels;
+                for (int64_t c = 0; c < channels; ++c) {
+                    float factor = scale[c] / std::sqrt(variance[c] + epsilon);
+                    for (int64_t k = 0; k < inner; ++k) {
+                        // Conv and transposed Gemm weights hold one row per channel, plain Gemm one column
+                        folded[isConv || transB ? c * inner + k : k * channels + c] *= factor;
+                    }
+                    offset[c] = (offset[c] - mean[c]) * factor + shift[c];
+                }
+                Shape shape = weights.shape;
+                std::string name = weights.name;
+                step.inputs[1] = AddConstant(name + "/folded", shape, std::move(folded));
+                biasId = AddConstant(follower->node->name + "/bias", {channels}, std::move(offset));
+                step.inputs.resize(3, -1);
+                step.inputs[2] = biasId;
+                absorb(step, *follower);
+                follower = next(step);
+            }
+
+            bool reversed = false;
+            int32_t addend = follower && follower->kind == OpKind::Add ? operand(*follower, step.outputs[0], reversed)
+                                                                       : -1;
+            if (foldsBias && addend >= 0 && perChannel(addend)) {
+                std::vector<float> offset = bias();
+                const float* values = m_Values[addend].Data();
+                std::transform(offset.begin(), offset.end(), values, offset.begin(), std::plus<float>());
+                biasId = AddConstant(follower->node->name + "/bias", {channels}, std::move(offset));
+                step.inputs.resize(3, -1);
+                step.inputs[2] = biasId;
+                absorb(step, *follower);
+                follower = next(step);
+            }
+
+            if (follower && ActivationOf(follower->kind) != Activation::None) {
+                step.activation = ActivationOf(follower->kind);
+                absorb(step, *follower);
+            }
+            continue;
+        }
+
+        // Elementwise chains: activations and arithmetic with scalar constants fold into the first step
+        if (!IsElementwise(step.kind)) {
+            continue;
+        }
+        for (Step* follower = next(step); follower && IsElementwise(follower->kind); follower = next(step)) {
+            ElementwiseLink link{follower->kind};
+            if (ActivationOf(follower->kind) == Activation::None) {
+                int32_t scalar = operand(*follower, step.outputs[0], link.reversed);
+                if (scalar < 0 || m_Values[scalar].Size() != 1) {
+                    break;
+                }
+                link.operand = m_Values[scalar].Data()[0];
+                link.rank = m_Values[scalar].shape.size();
+            }
+            step.chain.push_back(link);
+            absorb(step, *follower);
+        }
+    }
+}
+
+void GraphExecutor::PackConstants() {
+    for (Step& step : m_Steps) {
+        if (step.quantized || step.inputs.size() < 2 || step.inputs[1] < 0 || !m_Values[step.inputs[1]].constant) {
+            continue;
+        }
+        const Value& w = m_Values[step.inputs[1]];
+        // Constant 2-D weights are packed into GEMM panels up front
+        if ((step.kind == OpKind::Gemm || step.kind == OpKind::MatMul) && w.shape.size() == 2) {
+            bool transB = step.kind == OpKind::Gemm && step.node->GetInt("transB", 0) != 0;
+            step.weights = std::make_shared<PackedMatrix>();
+            step.weights->Pack(transB, w.shape[transB ? 1 : 0], w.shape[transB ? 0 : 1], w.Data(), w.shape[1],
+                               m_WeightPrecision);
+        }
+        // Conv filters are the A operand, so 16-bit filters are stored as is and widened per run
+        if (step.kind == OpKind::Conv && m_WeightPrecision != WeightPrecision::Float32) {
+            step.halfWeights = std::make_shared<std::vector<uint16_t>>(w.Size());
+            ConvertToHalf(m_WeightPrecision, w.Data(), step.halfWeights->data(), w.Size());
+        }
+    }
+}
+
+void GraphExecutor::RemoveDeadSteps() {
+    std::vector<int32_t> uses(m_Values.size(), 0);
+    for (int32_t id : m_Outputs) {
+        ++uses[id];
+    }
+    for (const Step& step : m_Steps) {
+        for (int32_t id : step.inputs) {
+            if (id >= 0) {
+                ++uses[id];
+            }
+        }
+    }
+
+    // Backwards, so removing a step can free its producers
+    std::vector<bool> keep(m_Steps.size(), true);
+    for (size_t i = m_Steps.size(); i-- > 0;) {
+        const Step& step = m_Steps[i];
+        bool used = std::any_of(step.outputs.begin(), step.outputs.end(), [&](int32_t id) {
+            return id >= 0 && uses[id] > 0;
+        });
+        if (used) {
+            continue;
+        }
+        keep[i] = false;
+        for (int32_t id : step.inputs) {
+            if (id >= 0) {
+                --uses[id];
+            }
+        }
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < m_Steps.size(); ++i) {
+        if (keep[i] && kept++ != i) {
+            m_Steps[kept - 1] = std::move(m_Steps[i]);
+        }
+    }
+    m_Steps.resize(kept);
+}
+
+void GraphExecutor::ReleasePackedConstants() {
+    // Constants only read through packed panels, or not at all, keep their shape but drop their data
+    std::vector<bool> needed(m_Values.size(), false);
+    for (int32_t id : m_Outputs) {
+        needed[id] = true;
+    }
+    for (const Step& step : m_Steps) {
+        for (size_t i = 0; i < step.inputs.size(); ++i) {
+            bool packed = i == 1 && (step.weights || step.quantized || step.halfWeights);
+            if (step.inputs[i] >= 0 && !packed) {
+                needed[step.inputs[i]] = true;
+            }
+        }
+    }
+    for (size_t id = 0; id < m_Values.size(); ++id) {
+        if (m_Values[id].constant && !needed[id]) {
+            std::vector<float>().swap(m_Values[id].data);
+            m_Values[id].view = nullptr;
+            m_Values[id].count = 0;
+        }
+    }
+}
+
+void GraphExecutor::SetWeightPrecision(WeightPrecision precision) {
+    m_WeightPrecision = precision;
+}
+
+void GraphExecutor::SetFusion(bool enabled) {
+    m_Fusion = enabled;
+}
+
+void GraphExecutor::SetObserver(std::function<void(const std::string&, const float*, const Shape&)> observer) {
+    m_Observer = std::move(observer);
+}
+
+size_t GraphExecutor::GetWeightBytes() const {
+    size_t bytes = 0;
+    for (const Value& value : m_Values) {
+        bytes += value.constant ? value.Size() * sizeof(float) : 0;
+    }
+    for (const Step& step : m_Steps) {
+        bytes += step.weights ? step.weights->GetByteSize() : 0;
+        bytes += step.halfWeights ? step.halfWeights->size() * sizeof(uint16_t) : 0;
+        for (size_t g = 0; step.quantized && g < step.quantized->weights.size(); ++g) {
+            bytes += step.quantized->weights[g].GetByteSize();
+        }
+    }
+    return bytes;
+}
+
+bool GraphExecutor::InferShapes(const std::vector<Shape>& inputShapes, std::vector<Shape>& outputShapes,
+                                std::string& error) {
+    if (!Infer(inputShapes, error)) {
+        return false;
+    }
+    outputShapes.clear();
+    for (int32_t id : m_Outputs) {
+        outputShapes.push_back(m_Values[id].shape);
+    }
+    return true;
+}
+
+bool GraphExecutor::ReserveShapes(const std::vector<Shape>& inputShapes, std::string& error) {
+    ClearReservedShapes();
+    return Infer(inputShapes, error, true);
+}
+
+void GraphExecutor::ClearReservedShapes() {
+    m_Reserved.clear();
+    m_ReservedBytes = 0;
+    m_InferredFor.clear();
+}
+
+bool GraphExecutor::Infer(const std::vector<Shape>& inputShapes, std::string& error, bool reserve) {
+    if (!m_Graph) {
+        error = "no graph prepared";
+        return false;
+    }
+    if (!m_InferredFor.empty() && m_InferredFor == inputShapes) {
+        return true;
+    }
+    m_InferredFor.clear();
+
+    if (inputShapes.size() != m_Inputs.size()) {
+        error = "graph has " + std::to_string(m_Inputs.size()) + " input(s), got " +
+                std::to_string(inputShapes.size());
+        return false;
+    }
+    for (size_t i = 0; i < m_Inputs.size(); ++i) {
+        const Shape& declared = m_Graph->inputs[i].shape;
+        const Shape& shape = inputShapes[i];
+        bool matches = declared.empty() || declared.size() == shape.size();
+        for (size_t d = 0; matches && d < declared.size(); ++d) {
+            matches = declared[d] < 0 || declared[d] == shape[d];
+        }
+        if (!matches || ElementCount(shape) < 0) {
+            error = "input '" + m_Graph->inputs[i].name + "' expects shape " + FormatShape(declared) + ", got " +
+                    FormatShape(shape);
+            return false;
+        }
+        m_Values[m_Inputs[i]].shape = shape;
+    }
+
+    std::vector<size_t> scratch(m_Steps.size(), 0);
+    size_t rank = 0;
+    for (size_t s = 0; s < m_Steps.size(); ++s) {
+        Step& step = m_Steps[s];
+        const Node& node = *step.node;
+        auto in = [&](size_t i) -> const Shape& { return m_Values[step.inputs[i]].shape; };
+        size_t required = step.kind == OpKind::Gemm || step.kind == OpKind::Conv ? 2
+                          : step.kind == OpKind::BatchNormalization             ? 5
+                          : step.kind == OpKind::Concat                         ? 1
+                          : step.kind == OpKind::MatMul || step.kind == OpKind::Reshape || step.kind == OpKind::Add ||
+                                    step.kind == OpKind::Sub || step.kind == OpKind::Mul || step.kind == OpKind::Div ||
+                                    step.kind == OpKind::QuantizeLinear || step.kind == OpKind::DequantizeLinear
+                              ? 2
+                              : 1;
+        bool missing = step.inputs.size() < required || step.outputs.empty() || step.outputs[0] < 0;
+        for (size_t i = 0; i < required && !missing; ++i) {
+            missing = step.inputs[i] < 0;
+        }
+        if (missing) {
+            error = node.opType + " node '" + node.name + "' is missing an input or output";
+            return false;
+        }
+
+        Shape out;
+        std::string problem;
+        switch (step.kind) {
+            case OpKind::Gemm: {
+                const Shape& a = in(0);
+                const Shape& b = in(1);
+                if (a.size() != 2 || b.size() != 2) {
+                    problem = "inputs must be matrices";
+                    break;
+                }
+                bool transA = node.GetInt("transA", 0) != 0;
+                bool transB = node.GetInt("transB", 0) != 0;
+                int64_t k = transA ? a[0] : a[1];
+                if (k != (transB ? b[1] : b[0])) {
+                    problem = "inner dimensions differ";
+                    break;
+                }
+                out = {transA ? a[1] : a[0], transB ? b[0] : b[1]};
+                Shape broadcast;
+                if (step.inputs.size() > 2 && step.inputs[2] >= 0) {
+                    if (!BroadcastShapes(out, in(2), broadcast) || broadcast != out) {
+                        problem = "bias does not broadcast to the output";
+                        break;
+                    }
+                    step.strides[0] = BroadcastStrides(in(2), out);
+                }
+                if (step.quantized) {
+                    scratch[s] = ArenaFloats(static_cast<size_t>(ElementCount(a)));
+                }
+                break;
+            }
+            case OpKind::MatMul: {
+                Shape a = in(0);
+                Shape b = in(1);
+                if (a.empty() || b.empty()) {
+                    problem = "inputs must not be scalars";
+                    break;
+                }
+                bool vectorA = a.size() == 1;
+                bool vectorB = b.size() == 1;
+                if (vectorA) {
+                    a.insert(a.begin(), 1);
+                }
+                if (vectorB) {
+                    b.push_back(1);
+                }
+                if (a.back() != b[b.size() - 2]) {
+                    problem = "inner dimensions differ";
+                    break;
+                }
+                Shape batch;
+                if (!BroadcastShapes(Shape(a.begin(), a.end() - 2), Shape(b.begin(), b.end() - 2), batch)) {
+                    problem = "batch dimensions do not broadcast";
+                    break;
+                }
+                out = batch;
+                if (!vectorA) {
+                    out.push_back(a[a.size() - 2]);
+                }
+                if (!vectorB) {
+                    out.push_back(b.back());
+                }
+                // A 2-D B is shared by every batch, which then stack into one product; otherwise walk the batches
+                if (b.size() > 2) {
+                    step.extent = batch;
+                    step.strides[0] = BroadcastStrides(Shape(a.begin(), a.end() - 2), batch);
+                    step.strides[1] = BroadcastStrides(Shape(b.begin(), b.end() - 2), batch);
+                }
+                if (step.quantized) {
+                    scratch[s] = ArenaFloats(static_cast<size_t>(ElementCount(in(0))));
+                }
+                break;
+            }
+            case OpKind::Conv: {
+                const Shape& x = in(0);
+                const Shape& w = in(1);
+                int64_t group = node.GetInt("group", 1);
+                if (x.size() < 3 || w.size() != x.size() || group <= 0 || x[1] != w[1] * group || w[0] % group) {
+                    problem = "input " + FormatShape(x) + " and weights " + FormatShape(w) + " do not match";
+                    break;
+                }
+                auto kernel = node.GetInts("kernel_shape");
+                if (kernel.empty()) {
+                    kernel.assign(w.begin() + 2, w.end());
+                }
+                Window window;
+                if (!ResolveWindow(node, x, kernel, false, window, problem)) {
+                    break;
+                }
+                if (step.inputs.size() > 2 && step.inputs[2] >= 0 && ElementCount(in(2)) != w[0]) {
+                    problem = "bias must have one value per output channel";
+                    break;
+                }
+                out = {x[0], w[0]};
+                if (x.size() == 4) {
+                    out.push_back(window.outH);
+                }
+                out.push_back(window.outW);
+                step.window = window;
+
+                // See Run and RunQuantized for how the scratch space is split
+                auto patch = static_cast<size_t>(x[1] / group * window.kernelH * window.kernelW);
+                auto pixels = static_cast<size_t>(window.outH * window.outW);
+                if (step.quantized) {
+                    scratch[s] = ArenaFloats(static_cast<size_t>(ElementCount(x))) + ArenaFloats(pixels * patch) +
+                                 ArenaFloats(pixels * static_cast<size_t>(w[0] / group) * sizeof(float));
+                } else {
+                    scratch[s] = (IsPointwise(window) ? 0 : ArenaFloats(patch * pixels * sizeof(float))) +
+                                 (step.halfWeights ? ArenaFloats(step.halfWeights->size() * sizeof(float)) : 0);
+                }
+                break;
+            }
+            case OpKind::Add:
+            case OpKind::Sub:
+            case OpKind::Mul:
+            case OpKind::Div:
+                if (!BroadcastShapes(in(0), in(1), out)) {
+                    problem = "shapes " + FormatShape(in(0)) + " and " + FormatShape(in(1)) + " do not broadcast";
+                    break;
+                }
+                step.extent = out;
+                step.strides[0] = BroadcastStrides(in(0), out);
+                step.strides[1] = BroadcastStrides(in(1), out);
+                break;
+            case OpKind::Relu:
+            case OpKind::Sigmoid:
+            case OpKind::Tanh:
+            case OpKind::Identity:
+                out = in(0);
+                break;
+            case OpKind::Softmax:
+                out = in(0);
+                if (ResolveAxis(node.GetInt("axis", m_Graph->opsetVersion >= 13 ? -1 : 1), out.size()) < 0) {
+                    problem = "axis out of range";
+                }
+                break;
+            case OpKind::BatchNormalization:
+                out = in(0);
+                if (out.size() < 2) {
+                    problem = "input must have a channel dimension";
+                    break;
+                }
+                for (size_t i = 1; i < 5; ++i) {
+                    if (ElementCount(in(i)) != out[1]) {
+                        problem = "scale, bias, mean and variance must have one value per channel";
+                        break;
+                    }
+                }
+                break;
+            case OpKind::Reshape: {
+                const Value& target = m_Values[step.inputs[1]];
+                int64_t count = ElementCount(in(0));
+                int64_t known = 1;
+                int inferred = -1;
+                bool allowZero = node.GetInt("allowzero", 0) != 0;
+                for (size_t i = 0; i < target.Size(); ++i) {
+                    auto dim = static_cast<int64_t>(target.Data()[i]);
+                    if (dim == 0 && !allowZero) {
+                        dim = i < in(0).size() ? in(0)[i] : -2;
+                    }
+                    if (dim == -1 && inferred < 0) {
+                        inferred = static_cast<int>(i);
+                    } else if (dim < 0) {
+                        problem = "invalid target shape";
+                        break;
+                    } else {
+                        known *= dim;
+                    }
+                    out.push_back(dim);
+                }
+                if (problem.empty() && inferred >= 0) {
+                    out[inferred] = known ? count / known : 0;
+                }
+                if (problem.empty() && ElementCount(out) != count) {
+                    problem = "cannot reshape " + FormatShape(in(0)) + " to " + FormatShape(out);
+                }
+                break;
+            }
+            case OpKind::Flatten: {
+                const Shape& x = in(0);
+                int64_t axis = node.GetInt("axis", 1);
+                axis = axis < 0 ? axis + static_cast<int64_t>(x.size()) : axis;
+                if (axis < 0 || axis > static_cast<int64_t>(x.size())) {
+                    problem = "axis out of range";
+                    break;
+                }
+                out = {Product(x, 0, axis), Product(x, axis, x.size())};
+                break;
+            }
+            case OpKind::Transpose: {
+                const Shape& x = in(0);
+                auto perm = node.GetInts("perm");
+                if (perm.empty()) {
+                    for (size_t i = x.size(); i-- > 0;) {
+                        perm.push_back(static_cast<int64_t>(i));
+                    }
+                }
+                std::vector<int64_t> sorted = perm;
+                std::sort(sorted.begin(), sorted.end());
+                std::vector<int64_t> identity(x.size());
+                std::iota(identity.begin(), identity.end(), 0);
+                if (sorted != identity) {
+                    problem = "perm is not a permutation of the input dimensions";
+                    break;
+                }
+                // Input stride of each output dimension
+                std::vector<int64_t> inStrides(x.size(), 1);
+                for (size_t d = x.size(); d-- > 1;) {
+                    inStrides[d - 1] = inStrides[d] * x[d];
+                }
+                step.strides[0].clear();
+                for (int64_t axis : perm) {
+                    out.push_back(x[axis]);
+                    step.strides[0].push_back(inStrides[axis]);
+                }
+                step.extent = out;
+                break;
+            }
+            case OpKind::Concat: {
+                out = in(0);
+                int64_t axis = ResolveAxis(node.GetInt("axis", 0), out.size());
+                if (axis < 0) {
+                    problem = "axis out of range";
+                    break;
+                }
+                for (size_t i = 1; i < step.inputs.size() && problem.empty(); ++i) {
+                    const Shape& other = in(i);
+                    bool matches = other.size() == out.size();
+                    for (size_t d = 0; matches && d < out.size(); ++d) {
+                        matches = d == static_cast<size_t>(axis) || other[d] == out[d];
+                    }
+                    if (!matches) {
+                        problem = "input " + FormatShape(other) + " does not match " + FormatShape(in(0));
+                        break;
+                    }
+                    out[axis] += other[axis];
+                }
+                break;
+            }
+            case OpKind::MaxPool:
+            case OpKind::AveragePool: {
+                const Shape& x = in(0);
+                if (x.size() < 3) {
+                    problem = "input must be NCW or NCHW";
+                    break;
+                }
+                Window window;
+                if (!ResolveWindow(node, x, node.GetInts("kernel_shape"), node.GetInt("ceil_mode", 0) != 0, window,
+                                   problem)) {
+                    break;
+                }
+                out = {x[0], x[1]};
+                if (x.size() == 4) {
+                    out.push_back(window.outH);
+                }
+                out.push_back(window.outW);
+                window.countPadding = node.GetInt("count_include_pad", 0) != 0;
+                step.window = window;
+                break;
+            }
+            case OpKind::GlobalAveragePool:
+            case OpKind::GlobalMaxPool:
+                out = in(0);
+                if (out.size() < 3) {
+                    problem = "input must have spatial dimensions";
+                    break;
+                }
+                std::fill(out.begin() + 2, out.end(), 1);
+                break;
+            case OpKind::QuantizeLinear:
+            case OpKind::DequantizeLinear: {
+                out = in(0);
+                int64_t channels = ElementCount(in(1));
+                if (channels == 1) {
+                    break;
+                }
+                int64_t axis = ResolveAxis(node.GetInt("axis", 1), out.size());
+                if (axis < 0 || out[axis] != channels) {
+                    problem = "scale must be a scalar or have one value per channel of the axis";
+                }
+                if (problem.empty() && step.inputs.size() > 2 && step.inputs[2] >= 0 &&
+                    ElementCount(in(2)) != channels) {
+                    problem = "zero point must match the scale";
+                }
+                break;
+            }
+        }
+        if (!problem.empty()) {
+            error = node.opType + " node '" + node.name + "': " + problem;
+            return false;
+        }
+        // A folded scalar of higher rank still broadcasts the output up to its rank
+        for (const ElementwiseLink& link : step.chain) {
+            if (link.rank > out.size()) {
+                out.insert(out.begin(), link.rank - out.size(), 1);
+            }
+        }
+        // Reshapes copy nothing, and neither does a Transpose that keeps the order of every dimension
+        // longer than one
+        step.alias = step.kind == OpKind::Reshape || step.kind == OpKind::Flatten || step.kind == OpKind::Identity;
+        if (step.kind == OpKind::Transpose) {
+            int64_t previous = -1;
+            step.alias = true;
+            for (size_t d = 0; d < out.size() && step.alias; ++d) {
+                if (out[d] > 1) {
+                    step.alias = step.strides[0][d] < previous || previous < 0;
+                    previous = step.strides[0][d];
+                }
+            }
+        }
+        rank = std::max(rank, step.extent.size());
+        Value& value = m_Values[step.outputs[0]];
+        value.shape = std::move(out);
+        value.count = static_cast<size_t>(ElementCount(value.shape));
+    }
+
+    PlanMemory(scratch, reserve);
+    m_Index.reserve(rank);
+    m_InferredFor = inputShapes;
+    return true;
+}
+
+void GraphExecutor::PlanMemory(const std::vector<size_t>& scratch, bool reserve) {
+    // One block per step output and per step's scratch space; graph outputs live to the end.
+    // Reading an alias reads the value it aliases
+    std::vector<int32_t> root(m_Values.size());
+    std::iota(root.begin(), root.end(), 0);
+    std::vector<size_t> lastUse(m_Values.size(), 0);
+    for (size_t s = 0; s < m_Steps.size(); ++s) {
+        const Step& step = m_Steps[s];
+        for (int32_t id : step.inputs) {
+            if (id >= 0) {
+                lastUse[root[id]] = s;
+            }
+        }
+        if (step.alias) {
+            root[step.outputs[0]] = root[step.inputs[0]];
+        }
+    }
+    for (int32_t id : m_Outputs) {
+        lastUse[root[id]] = m_Steps.size();
+    }
+    std::vector<Block> blocks;
+    for (size_t s = 0; s < m_Steps.size(); ++s) {
+        int32_t id = m_Steps[s].outputs[0];
+        Value& value = m_Values[id];
+        value.view = nullptr;
+        value.buffer = nullptr;
+        if (!m_Steps[s].alias) {
+            blocks.push_back({ArenaFloats(value.count * sizeof(float)), s, std::max(s, lastUse[id]), &value.buffer});
+        }
+        blocks.push_back({scratch[s], s, s, &m_Steps[s].scratch});
+    }
+
+    // Blocks with the lifetimes of a reserved plan that fit their reserved sizes keep its offsets;
+    // they cannot overlap any more than the larger reserved blocks did
+    bool reserved = !reserve && m_Reserved.size() == blocks.size();
+    for (size_t b = 0; b < blocks.size() && reserved; ++b) {
+        const Block& block = m_Reserved[b];
+        reserved = blocks[b].first == block.first && blocks[b].last == block.last && blocks[b].size <= block.size;
+    }
+    if (reserved) {
+        for (size_t b = 0; b < blocks.size(); ++b) {
+            blocks[b].offset = m_Reserved[b].offset;
+        }
+        PlaceBlocks(blocks, m_ReservedBytes / sizeof(float));
+        return;
+    }
+
+    // Greedy by size: the largest blocks are placed first, each at the lowest
+    // offset that no block with an overlapping lifetime occupies
+    std::vector<size_t> order(blocks.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return blocks[a].size > blocks[b].size; });
+    std::vector<const Block*> placed;
+    std::vector<std::pair<size_t, size_t>> taken;
+    size_t peak = 0;
+    for (size_t index : order) {
+        Block& block = blocks[index];
+        taken.clear();
+        for (const Block* other : placed) {
+            if (other->first <= block.last && block.first <= other->last) {
+                taken.emplace_back(other->offset, other->offset + other->size);
+            }
+        }
+        std::sort(taken.begin(), taken.end());
+        for (const auto& [begin, end] : taken) {
+            if (begin >= block.offset + block.size) {
+                break;
+            }
+            block.offset = std::max(block.offset, end);
+        }
+        peak = std::max(peak, block.offset + block.size);
+        placed.push_back(&block);
+    }
+
+    if (reserve) {
+        m_Reserved = blocks;
+        m_ReservedBytes = peak * sizeof(float);
+    }
+    PlaceBlocks(blocks, peak);
+}
+
+void GraphExecutor::PlaceBlocks(const std::vector<Block>& blocks, size_t peak) {
+    // The arena only grows, so shapes that alternate reuse it; one cache line of slack aligns the base
+    if (m_Arena.size() < peak + ArenaFloats(1)) {
+        m_Arena = std::vector<float>(peak + ArenaFloats(1));
+    }
+    auto address = reinterpret_cast<uintptr_t>(m_Arena.data());
+    float* base = m_Arena.data() + (ARENA_ALIGNMENT - address % ARENA_ALIGNMENT) % ARENA_ALIGNMENT / sizeof(float);
+    for (const Block& block : blocks) {
+        *block.target = base + block.offset;
+    }
+    m_ActivationBytes = peak * sizeof(float);
+}
+
+size_t GraphExecutor::GetActivationBytes() const {
+    return m_ActivationBytes;
+}
+
+bool GraphExecutor::Run(const std::vector<const float*>& inputs, const std::vector<Shape>& inputShapes,
+                        std::vector<std::vector<float>>& outputs, std::vector<Shape>& outputShapes,
+                        std::string& error) {
+    if (!Run(inputs, inputShapes, error)) {
+        return false;
+    }
+    outputs.resize(m_Outputs.size());
+    outputShapes.resize(m_Outputs.size());
+    for (size_t i = 0; i < m_Outputs.size(); ++i) {
+        const Value& output = m_Values[m_Outputs[i]];
+        outputs[i].assign(output.Data(), output.Data() + output.Size());
+        outputShapes[i] = output.shape;
+    }
+    return true;
+}
+
+bool GraphExecutor::Run(const std::vector<const float*>& inputs, const std::vector<Shape>& inputShapes,
+                        std::string& error) {
+    if (inputs.size() != m_Inputs.size()) {
+        error = "graph has " + std::to_string(m_Inputs.size()) + " input(s), got " + std::to_string(inputs.size());
+        return false;
+    }
+    if (!Infer(inputShapes, error)) {
+        return false;
+    }
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        // Read in place; the caller's data outlives the run
+        Value& value = m_Values[m_Inputs[i]];
+        value.view = inputs[i];
+        value.count = static_cast<size_t>(ElementCount(value.shape));
+        if (m_Observer) {
+            m_Observer(value.name, value.view, value.shape);
+        }
+    }
+
+    for (const Step& step : m_Steps) {
+        const Node& node = *step.node;
+        auto in = [&](size_t i) -> const Value& { return m_Values[step.inputs[i]]; };
+        bool hasInput2 = step.inputs.size() > 2 && step.inputs[2] >= 0;
+        Value& result = m_Values[step.outputs[0]];
+        float* out = result.buffer;
+
+        switch (step.kind) {
+            case OpKind::Gemm: {
+                if (step.quantized) {
+                    RunQuantized(step);
+                    break;
+                }
+                const Shape& a = in(0).shape;
+                bool transA = node.GetInt("transA", 0) != 0;
+                bool transB = node.GetInt("transB", 0) != 0;
+                int64_t M = result.shape[0];
+                int64_t N = result.shape[1];
+                int64_t K = transA ? a[0] : a[1];
+                float beta = 0.0f;
+                GemmEpilogue epilogue;
+                epilogue.activation = step.activation;
+                // A bias with one value per column is added as the tiles are written
+                const Shape* c = hasInput2 ? &in(2).shape : nullptr;
+                bool columnBias = c && node.GetFloat("beta", 1.0f) == 1.0f && ElementCount(*c) == N &&
+                                  (c->size() == 1 || (c->size() == 2 && (*c)[0] == 1));
+                if (columnBias) {
+                    epilogue.bias = in(2).Data();
+                } else if (hasInput2) {
+                    // Broadcast C into the output, then accumulate into it
+                    const Value& c = in(2);
+                    const std::vector<int64_t>& strides = step.strides[0];
+                    for (int64_t m = 0; m < M; ++m) {
+                        for (int64_t n = 0; n < N; ++n) {
+                            out[m * N + n] = c.Data()[m * strides[0] + n * strides[1]];
+                        }
+                    }
+                    beta = node.GetFloat("beta", 1.0f);
+                }
+                float alpha = node.GetFloat("alpha", 1.0f);
+                int64_t lda = transA ? M : K;
+                if (step.weights) {
+                    SgemmPacked(transA, M, alpha, in(0).Data(), lda, *step.weights, beta, out, N, &epilogue);
+                } else {
+                    Sgemm(transA, transB, M, N, K, alpha, in(0).Data(), lda, in(1).Data(), transB ? K : N,
+                          beta, out, N, &epilogue);
+                }
+                break;
+            }
+            case OpKind::MatMul: {
+                if (step.quantized) {
+                    RunQuantized(step);
+                    break;
+                }
+                // 1-D operands count as a single row of A or a single column of B
+                const Shape& a = in(0).shape;
+                const Shape& b = in(1).shape;
+                int64_t M = a.size() > 1 ? a[a.size() - 2] : 1;
+                int64_t K = a.back();
+                int64_t N = b.size() > 1 ? b.back() : 1;
+                const float* dataA = in(0).Data();
+                const float* dataB = in(1).Data();
+                // A folded bias has one value per column
+                GemmEpilogue epilogue;
+                epilogue.bias = hasInput2 ? in(2).Data() : nullptr;
+                epilogue.activation = step.activation;
+                if (b.size() <= 2) {
+                    // A 2-D B is shared by every batch, so the batches stack into one taller product
+                    int64_t rows = static_cast<int64_t>(in(0).Size()) / K;
+                    if (step.weights) {
+                        SgemmPacked(false, rows, 1.0f, dataA, K, *step.weights, 0.0f, out, N, &epilogue);
+                    } else {
+                        Sgemm(false, false, rows, N, K, 1.0f, dataA, K, dataB, N, 0.0f, out, N, &epilogue);
+                    }
+                    break;
+                }
+                const Shape& batch = step.extent;
+                const std::vector<int64_t>& stridesA = step.strides[0];
+                const std::vector<int64_t>& stridesB = step.strides[1];
+                int64_t batches = ElementCount(batch);
+                m_Index.assign(batch.size(), 0);
+                for (int64_t i = 0; i < batches; ++i) {
+                    int64_t offsetA = 0;
+                    int64_t offsetB = 0;
+                    for (size_t d = 0; d < batch.size(); ++d) {
+                        offsetA += m_Index[d] * stridesA[d];
+                        offsetB += m_Index[d] * stridesB[d];
+                    }
+                    Sgemm(false, false, M, N, K, 1.0f, dataA + offsetA * M * K, K, dataB + offsetB * K * N, N, 0.0f,
+                          out + i * M * N, N, &epilogue);
+                    for (size_t d = batch.size(); d-- > 0;) {
+                        if (++m_Index[d] < batch[d]) {
+                            break;
+                        }
+                        m_Index[d] = 0;
+                    }
+                }
+                break;
+            }
+            case OpKind::Conv: {
+                if (step.quantized) {
+                    RunQuantized(step);
+                    break;
+                }
+                const Value& x = in(0);
+                const Value& w = in(1);
+                const Window& window = step.window;
+                int64_t group = node.GetInt("group", 1);
+                int64_t batchCount = x.shape[0];
+                int64_t channels = x.shape[1] / group;
+                int64_t filters = w.shape[0] / group;
+                int64_t patch = channels * window.kernelH * window.kernelW;
+                int64_t pixels = window.outH * window.outW;
+                int64_t inPixels = window.inH * window.inW;
+                bool pointwise = IsPointwise(window);
+
+                // Scratch space holds the im2col columns, then the widened weights
+                float* columns = step.scratch;
+                const float* filterData = w.Data();
+                if (step.halfWeights) {
+                    float* widened = step.scratch + (pointwise ? 0 : ArenaFloats(patch * pixels * sizeof(float)));
+                    ConvertFromHalf(m_WeightPrecision, step.halfWeights->data(), widened, step.halfWeights->size());
+                    filterData = widened;
+                }
+
+                // Filters are the rows of each product, so the bias is per row
+                GemmEpilogue epilogue;
+                epilogue.biasPerRow = true;
+                epilogue.activation = step.activation;
+
+                // im2col: one column per output pixel, one row per (channel, kernel tap)
+                for (int64_t n = 0; n < batchCount; ++n) {
+                    for (int64_t g = 0; g < group; ++g) {
+                        const float* image = x.Data() + (n * x.shape[1] + g * channels) * inPixels;
+                        if (!pointwise) {
+                            float* column = columns;
+                            for (int64_t c = 0; c < channels; ++c) {
+                                for (int64_t kh = 0; kh < window.kernelH; ++kh) {
+                                    for (int64_t kw = 0; kw < window.kernelW; ++kw) {
+                                        for (int64_t oh = 0; oh < window.outH; ++oh) {
+                                            int64_t ih = oh * window.strideH - window.padTop + kh * window.dilationH;
+                                            for (int64_t ow = 0; ow < window.outW; ++ow) {
+                                                int64_t iw =
+                                                    ow * window.strideW - window.padLeft + kw * window.dilationW;
+                                                bool inside = ih >= 0 && ih < window.inH && iw >= 0 && iw < window.inW;
+                                                *column++ = inside ? image[(c * window.inH + ih) * window.inW + iw]
+                                                                   : 0.0f;
+                                            }
+                                        }
+                                    }
+                                }
+                            }
+                        }
+                        float* target = out + (n * w.shape[0] + g * filters) * pixels;
+                        epilogue.bias = hasInput2 ? in(2).Data() + g * filters : nullptr;
+                        Sgemm(false, false, filters, pixels, patch, 1.0f, filterData + g * filters * patch, patch,
+                              pointwise ? image : columns, pixels, 0.0f, target, pixels, &epilogue);
+                    }
+                }
+                break;
+            }
+            case OpKind::Add:
+            case OpKind::Sub:
+            case OpKind::Mul:
+            case OpKind::Div:
+            case OpKind::Relu:
+            case OpKind::Sigmoid:
+            case OpKind::Tanh: {
+                // Written a block at a time so the folded chain runs over each block while it is in cache
+                const Value& a = in(0);
+                const Value* b = step.inputs.size() > 1 ? &in(1) : nullptr;
+                Activation activation = ActivationOf(step.kind);
+                bool walk = b && a.shape != b->shape;
+                const std::vector<int64_t>& stridesA = step.strides[0];
+                const std::vector<int64_t>& stridesB = step.strides[1];
+                m_Index.assign(walk ? step.extent.size() : 0, 0);
+                int64_t offsetA = 0;
+                int64_t offsetB = 0;
+                for (size_t begin = 0; begin < result.count; begin += ELEMENTWISE_BLOCK) {
+                    size_t end = std::min(result.count, begin + ELEMENTWISE_BLOCK);
+                    if (!b) {
+                        std::copy(a.Data() + begin, a.Data() + end, out + begin);
+                        ApplyActivation(activation, out + begin, end - begin);
+                    } else if (!walk) {
+                        for (size_t i = begin; i < end; ++i) {
+                            out[i] = ApplyBinary(step.kind, a.Data()[i], b->Data()[i]);
+                        }
+                    } else {
+                        // Walk the output with one running offset per input
+                        for (size_t i = begin; i < end; ++i) {
+                            out[i] = ApplyBinary(step.kind, a.Data()[offsetA], b->Data()[offsetB]);
+                            for (size_t d = m_Index.size(); d-- > 0;) {
+                                offsetA += stridesA[d];
+                                offsetB += stridesB[d];
+                                if (++m_Index[d] < step.extent[d]) {
+                                    break;
+                                }
+                                offsetA -= stridesA[d] * m_Index[d];
+                                offsetB -= stridesB[d] * m_Index[d];
+                                m_Index[d] = 0;
+                            }
+                        }
+                    }
+                    for (const ElementwiseLink& link : step.chain) {
+                        ApplyLink(link, out + begin, end - begin);
+                    }
+                }
+                break;
+            }
+            case OpKind::Softmax: {
+                // Before opset 13 the input is flattened to 2-D at the axis; from 13 on it is per axis
+                const Shape& shape = result.shape;
+                int64_t axis = ResolveAxis(node.GetInt("axis", m_Graph->opsetVersion >= 13 ? -1 : 1), shape.size());
+                bool flatten = m_Graph->opsetVersion < 13;
+                int64_t outer = Product(shape, 0, axis);
+                int64_t extent = flatten ? Product(shape, axis, shape.size()) : shape[axis];
+                int64_t inner = flatten ? 1 : Product(shape, axis + 1, shape.size());
+                const float* x = in(0).Data();
+                for (int64_t o = 0; o < outer; ++o) {
+                    for (int64_t i = 0; i < inner; ++i) {
+                        const float* src = x + o * extent * inner + i;
+                        float* dst = out + o * extent * inner + i;
+                        float peak = -std::numeric_limits<float>::infinity();
+                        for (int64_t e = 0; e < extent; ++e) {
+                            peak = std::max(peak, src[e * inner]);
+                        }
+                        float sum = 0.0f;
+                        for (int64_t e = 0; e < extent; ++e) {
+                            dst[e * inner] = std::exp(src[e * inner] - peak);
+                            sum += dst[e * inner];
+                        }
+                        for (int64_t e = 0; e < extent; ++e) {
+                            dst[e * inner] /= sum;
+                        }
+                    }
+                }
+                break;
+            }
+            case OpKind::BatchNormalization: {
+                const Value& x = in(0);
+                int64_t channels = x.shape[1];
+                int64_t inner = Product(x.shape, 2, x.shape.size());
+                float epsilon = node.GetFloat("epsilon", 1e-5f);
+                for (int64_t c = 0; c < channels; ++c) {
+                    float factor = in(1).Data()[c] / std::sqrt(in(4).Data()[c] + epsilon);
+                    float shift = in(2).Data()[c] - in(3).Data()[c] * factor;
+                    for (int64_t n = 0; n < x.shape[0]; ++n) {
+                        const float* plane = x.Data() + (n * channels + c) * inner;
+                        std::transform(plane, plane + inner, out + (n * channels + c) * inner,
+                                       [factor, shift](float v) { return v * factor + shift; });
+                    }
+                }
+                break;
+            }
+            case OpKind::Reshape:
+            case OpKind::Flatten:
+            case OpKind::Identity:
+            case OpKind::Transpose: {
+                const Value& x = in(0);
+                if (step.alias) {
+                    result.view = x.Data();
+                    result.count = x.Size();
+                    break;
+                }
+                const std::vector<int64_t>& strides = step.strides[0];
+                m_Index.assign(strides.size(), 0);
+                int64_t offset = 0;
+                for (size_t i = 0; i < result.count; ++i) {
+                    out[i] = x.Data()[offset];
+                    for (size_t d = m_Index.size(); d-- > 0;) {
+                        offset += strides[d];
+                        if (++m_Index[d] < result.shape[d]) {
+                            break;
+                        }
+                        offset -= strides[d] * m_Index[d];
+                        m_Index[d] = 0;
+                    }
+                }
+                break;
+            }
+            case OpKind::Concat: {
+                int64_t axis = ResolveAxis(node.GetInt("axis", 0), result.shape.size());
+                int64_t outer = Product(result.shape, 0, axis);
+                int64_t inner = Product(result.shape, axis + 1, result.shape.size());
+                for (int64_t o = 0; o < outer; ++o) {
+                    for (size_t i = 0; i < step.inputs.size(); ++i) {
+                        const Value& part = in(i);
+                        int64_t run = part.shape[axis] * inner;
+                        out = std::copy_n(part.Data() + o * run, run, out);
+                    }
+                }
+                break;
+            }
+            case OpKind::MaxPool:
+            case OpKind::AveragePool: {
+                const Value& x = in(0);
+                const Window& window = step.window;
+                bool isMax = step.kind == OpKind::MaxPool;
+                bool includePad = window.countPadding;
+                int64_t planes = x.shape[0] * x.shape[1];
+                for (int64_t p = 0; p < planes; ++p) {
+                    const float* image = x.Data() + p * window.inH * window.inW;
+                    for (int64_t oh = 0; oh < window.outH; ++oh) {
+                        for (int64_t ow = 0; ow < window.outW; ++ow) {
+                            float accumulator = isMax ? -std::numeric_limits<float>::infinity() : 0.0f;
+                            int64_t counted = 0;
+                            for (int64_t kh = 0; kh < window.kernelH; ++kh) {
+                                int64_t ih = oh * window.strideH - window.padTop + kh * window.dilationH;
+                                for (int64_t kw = 0; kw < window.kernelW; ++kw) {
+                                    int64_t iw = ow * window.strideW - window.padLeft + kw * window.dilationW;
+                                    if (ih < 0 || ih >= window.inH || iw < 0 || iw >= window.inW) {
+                                        // Padding inside the padded extent counts towards the average
+                                        bool padded = ih < window.inH + window.padBottom &&
+                                                      iw < window.inW + window.padRight;
+                                        counted += includePad && padded ? 1 : 0;
+                                        continue;
+                                    }
+                                    float v = image[ih * window.inW + iw];
+                                    accumulator = isMax ? std::max(accumulator, v) : accumulator + v;
+                                    ++counted;
+                                }
+                            }
+                            *out++ = isMax ? accumulator : accumulator / static_cast<float>(std::max<int64_t>(1, counted));
+                        }
+                    }
+                }
+                break;
+            }
+            case OpKind::GlobalAveragePool:
+            case OpKind::GlobalMaxPool: {
+                const Value& x = in(0);
+                int64_t planes = x.shape[0] * x.shape[1];
+                int64_t size = Product(x.shape, 2, x.shape.size());
+                for (int64_t p = 0; p < planes; ++p) {
+                    const float* plane = x.Data() + p * size;
+                    out[p] = step.kind == OpKind::GlobalMaxPool
+                                 ? *std::max_element(plane, plane + size)
+                                 : std::accumulate(plane, plane + size, 0.0f) / static_cast<float>(size);
+                }
+                break;
+            }
+            case OpKind::QuantizeLinear:
+            case OpKind::DequantizeLinear: {
+                const Value& x = in(0);
+                const Value& scale = in(1);
+                int64_t channels = static_cast<int64_t>(scale.Size());
+                int64_t inner = 1;
+                if (channels > 1) {
+                    int64_t axis = ResolveAxis(node.GetInt("axis", 1), x.shape.size());
+                    inner = Product(x.shape, axis + 1, x.shape.size());
+                }
+                // Round half to even, then saturate to the range of the output type
+                bool quantize = step.kind == OpKind::QuantizeLinear;
+                float minimum = IsSigned(result.type) ? -128.0f : 0.0f;
+                float maximum = IsSigned(result.type) ? 127.0f : 255.0f;
+                for (size_t i = 0; i < x.Size(); ++i) {
+                    int64_t c = channels > 1 ? (static_cast<int64_t>(i) / inner) % channels : 0;
+                    float zeroPoint = hasInput2 ? in(2).Data()[c] : 0.0f;
+                    out[i] = quantize
+                                 ? std::clamp(std::nearbyint(x.Data()[i] / scale.Data()[c]) + zeroPoint, minimum, maximum)
+                                 : (x.Data()[i] - zeroPoint) * scale.Data()[c];
+                }
+                break;
+            }
+        }
+        if (m_Observer) {
+            m_Observer(result.name, result.Data(), result.shape);
+        }
+    }
+    return true;
+}
+
+const float* GraphExecutor::GetOutputData(size_t index) const {
+    return index < m_Outputs.size() ? m_Values[m_Outputs[index]].Data() : nullptr;
+}
+
+const Shape& GraphExecutor::GetOutputShape(size_t index) const {
+    static const Shape empty;
+    return index < m_Outputs.size() ? m_Values[m_Outputs[index]].shape : empty;
+}
+
+void GraphExecutor::RunQuantized(const Step& step) {
+    const QuantizedOp& op = *step.quantized;
+    const Node& node = *step.node;
+    const Value& x = m_Values[step.inputs[0]];
+    Value& result = m_Values[step.outputs[0]];
+    float* out = result.buffer;
+    const float* offset = op.offset.empty() ? nullptr : op.offset.data();
+    bool hasBias = step.inputs.size() > 2 && step.inputs[2] >= 0;
+
+    // Activations hold integers; signed ones are shifted into the unsigned range the kernels take
+    // Scratch space holds the activations, then for Conv the im2col rows and the product
+    int32_t shift = op.inputSigned ? 128 : 0;
+    auto* activations = reinterpret_cast<uint8_t*>(step.scratch);
+    std::transform(x.Data(), x.Data() + x.Size(), activations,
+                   [shift](float v) { return static_cast<uint8_t>(static_cast<int32_t>(v) + shift); });
+
+    if (step.kind != OpKind::Conv) {
+        // Batches of a MatMul share the 2-D weights, so they stack into one product
+        const PackedMatrixInt8& weights = op.weights[0];
+        int64_t K = weights.GetRows();
+        int64_t N = weights.GetColumns();
+        int64_t rows = K ? static_cast<int64_t>(x.Size()) / K : 0;
+        QGemm(rows, activations, K, op.inputZeroPoint, weights, op.scale.data(), offset, op.quantizeOutput,
+              op.minimum, op.maximum, out, N);
+        if (step.kind == OpKind::Gemm && hasBias) {
+            const Value& c = m_Values[step.inputs[2]];
+            const std::vector<int64_t>& strides = step.strides[0];
+            float beta = node.GetFloat("beta", 1.0f);
+            for (int64_t m = 0; m < rows; ++m) {
+                for (int64_t n = 0; n < N; ++n) {
+                    out[m * N + n] += beta * c.Data()[m * strides[0] + n * strides[1]];
+                }
+            }
+        }
+        return;
+    }
+
+    const Shape& w = m_Values[step.inputs[1]].shape;
+    const Window& window = step.window;
+    auto group = static_cast<int64_t>(op.weights.size());
+    int64_t channels = x.shape[1] / group;
+    int64_t filters = w[0] / group;
+    int64_t patch = channels * window.kernelH * window.kernelW;
+    int64_t pixels = window.outH * window.outW;
+    int64_t inPixels = window.inH * window.inW;
+    auto padding = static_cast<uint8_t>(op.inputZeroPoint);
+
+    // im2col with one row per output pixel, so the int8 weights stay the packed B operand
+    uint8_t* rows = activations + ArenaFloats(x.Size()) * sizeof(float);
+    float* product = reinterpret_cast<float*>(rows) + ArenaFloats(static_cast<size_t>(pixels * patch));
+    for (int64_t n = 0; n < x.shape[0]; ++n) {
+        for (int64_t g = 0; g < group; ++g) {
+            const uint8_t* image = activations + (n * x.shape[1] + g * channels) * inPixels;
+            uint8_t* row = rows;
+            for (int64_t oh = 0; oh < window.outH; ++oh) {
+                for (int64_t ow = 0; ow < window.outW; ++ow) {
+                    for (int64_t c = 0; c < channels; ++c) {
+                        for (int64_t kh = 0; kh < window.kernelH; ++kh) {
+                            int64_t ih = oh * window.strideH - window.padTop + kh * window.dilationH;
+                            for (int64_t kw = 0; kw < window.kernelW; ++kw) {
+                                int64_t iw = ow * window.strideW - window.padLeft + kw * window.dilationW;
+                                bool inside = ih >= 0 && ih < window.inH && iw >= 0 && iw < window.inW;
+                                *row++ = inside ? image[(c * window.inH + ih) * window.inW + iw] : padding;
+                            }
+                        }
+                    }
+                }
+            }
+            QGemm(pixels, rows, patch, op.inputZeroPoint, op.weights[g], op.scale.data() + g * filters,
+                  offset ? offset + g * filters : nullptr, op.quantizeOutput, op.minimum, op.maximum, product,
+                  filters);
+            float* target = out + (n * w[0] + g * filters) * pixels;
+            for (int64_t p = 0; p < pixels; ++p) {
+                for (int64_t f = 0; f < filters; ++f) {
+                    target[f * pixels + p] = product[p * filters + f];
+                }
+            }
+        }
+        if (hasBias) {
+            const float* bias = m_Values[step.inputs[2]].Data();
+            for (int64_t m = 0; m < w[0]; ++m) {
+                float* plane = out + (n * w[0] + m) * pixels;
+                std::transform(plane, plane + pixels, plane, [b = bias[m]](float v) { return v + b; });
+            }
+        }
+    }
+}
+
+} // namespace neural
+} // namespace gaia_matrix
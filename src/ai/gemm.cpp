@@ -0,0 +1,457 @@
+#include "gaia_matrix/neural_kernels.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define GAIA_NEURAL_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define GAIA_NEURAL_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace gaia_matrix {
+namespace neural {
+
+namespace {
+
+// Block sizes: a KC x NR panel of B stays in L1, an MC x KC block of A in L2
+// and a KC x NC block of B in L3. MC and NC are multiples of every MR and NR.
+constexpr int64_t KC = 256;
+constexpr int64_t MC = 120;
+constexpr int64_t NC = 3072;
+constexpr int64_t MAX_TILE = 8 * 32;
+
+/**
+ * Computes an MR x NR tile from packed panels: `a` is K x MR, `b` is K x NR,
+ * both k-major. Writes C = alpha * acc + beta * C; C is not read when beta is 0.
+ */
+using MicroKernelFn = void (*)(int64_t K, const float* a, const float* b, float* c, int64_t ldc, float alpha,
+                               float beta);
+
+struct MicroKernel {
+    KernelIsa isa;
+    int64_t mr;
+    int64_t nr;
+    MicroKernelFn run;
+};
+
+template <int MR, int NR>
+void KernelScalar(int64_t K, const float* a, const float* b, float* c, int64_t ldc, float alpha, float beta) {
+    float acc[MR][NR] = {};
+    for (int64_t k = 0; k < K; ++k, a += MR, b += NR) {
+        for (int i = 0; i < MR; ++i) {
+            for (int j = 0; j < NR; ++j) {
+                acc[i][j] += a[i] * b[j];
+            }
+        }
+    }
+    for (int i = 0; i < MR; ++i) {
+        for (int j = 0; j < NR; ++j) {
+            float& out = c[i * ldc + j];
+            out = beta == 0.0f ? alpha * acc[i][j] : alpha * acc[i][j] + beta * out;
+        }
+    }
+}
+
+#if GAIA_NEURAL_X86
+
+// 6 x 16: twelve ymm accumulators, two for B and one broadcast
+__attribute__((target("avx2,fma")))
+void KernelAvx2(int64_t K, const float* a, const float* b, float* c, int64_t ldc, float alpha, float beta) {
+    __m256 acc[6][2];
+    for (int i = 0; i < 6; ++i) {
+        acc[i][0] = _mm256_setzero_ps();
+        acc[i][1] = _mm256_setzero_ps();
+    }
+    for (int64_t k = 0; k < K; ++k, a += 6, b += 16) {
+        __m256 b0 = _mm256_loadu_ps(b);
+        __m256 b1 = _mm256_loadu_ps(b + 8);
+        for (int i = 0; i < 6; ++i) {
+            __m256 ai = _mm256_broadcast_ss(a + i);
+            acc[i][0] = _mm256_fmadd_ps(ai, b0, acc[i][0]);
+            acc[i][1] = _mm256_fmadd_ps(ai, b1, acc[i][1]);
+        }
+    }
+    __m256 va = _mm256_set1_ps(alpha);
+    __m256 vb = _mm256_set1_ps(beta);
+    for (int i = 0; i < 6; ++i) {
+        float* row = c + i * ldc;
+        for (int h = 0; h < 2; ++h) {
+            __m256 result = _mm256_mul_ps(acc[i][h], va);
+            if (beta != 0.0f) {
+                result = _mm256_fmadd_ps(vb, _mm256_loadu_ps(row + h * 8), result);
+            }
+            _mm256_storeu_ps(row + h * 8, result);
+        }
+    }
+}
+
+// 8 x 32: sixteen zmm accumulators
+__attribute__((target("avx512f")))
+void KernelAvx512(int64_t K, const float* a, const float* b, float* c, int64_t ldc, float alpha, float beta) {
+    __m512 acc[8][2];
+    for (int i = 0; i < 8; ++i) {
+        acc[i][0] = _mm512_setzero_ps();
+        acc[i][1] = _mm512_setzero_ps();
+    }
+    for (int64_t k = 0; k < K; ++k, a += 8, b += 32) {
+        __m512 b0 = _mm512_loadu_ps(b);
+        __m512 b1 = _mm512_loadu_ps(b + 16);
+        for (int i = 0; i < 8; ++i) {
+            __m512 ai = _mm512_set1_ps(a[i]);
+            acc[i][0] = _mm512_fmadd_ps(ai, b0, acc[i][0]);
+            acc[i][1] = _mm512_fmadd_ps(ai, b1, acc[i][1]);
+        }
+    }
+    __m512 va = _mm512_set1_ps(alpha);
+    __m512 vb = _mm512_set1_ps(beta);
+    for (int i = 0; i < 8; ++i) {
+        float* row = c + i * ldc;
+        for (int h = 0; h < 2; ++h) {
+            __m512 result = _mm512_mul_ps(acc[i][h], va);
+            if (beta != 0.0f) {
+                result = _mm512_fmadd_ps(vb, _mm512_loadu_ps(row + h * 16), result);
+            }
+            _mm512_storeu_ps(row + h * 16, result);
+        }
+    }
+}
+
+#endif
+
+#if GAIA_NEURAL_NEON
+
+// 8 x 8: sixteen q-register accumulators
+void KernelNeon(int64_t K, const float* a, const float* b, float* c, int64_t ldc, float alpha, float beta) {
+    float32x4_t acc[8][2];
+    for (int i = 0; i < 8; ++i) {
+        acc[i][0] = vdupq_n_f32(0.0f);
+        acc[i][1] = vdupq_n_f32(0.0f);
+    }
+    for (int64_t k = 0; k < K; ++k, a += 8, b += 8) {
+        float32x4_t b0 = vld1q_f32(b);
+        float32x4_t b1 = vld1q_f32(b + 4);
+        float32x4_t a0 = vld1q_f32(a);
+        float32x4_t a1 = vld1q_f32(a + 4);
+        for (int i = 0; i < 4; ++i) {
+            acc[i][0] = vfmaq_laneq_f32(acc[i][0], b0, a0, i);
+            acc[i][1] = vfmaq_laneq_f32(acc[i][1], b1, a0, i);
+            acc[i + 4][0] = vfmaq_laneq_f32(acc[i + 4][0], b0, a1, i);
+            acc[i + 4][1] = vfmaq_laneq_f32(acc[i + 4][1], b1, a1, i);
+        }
+    }
+    for (int i = 0; i < 8; ++i) {
+        float* row = c + i * ldc;
+        for (int h = 0; h < 2; ++h) {
+            float32x4_t result = vmulq_n_f32(acc[i][h], alpha);
+            if (beta != 0.0f) {
+                result = vfmaq_n_f32(result, vld1q_f32(row + h * 4), beta);
+            }
+            vst1q_f32(row + h * 4, result);
+        }
+    }
+}
+
+#endif
+
+// Indexed by KernelIsa
+const MicroKernel KERNELS[] = {
+    {KernelIsa::Scalar, 4, 4, KernelScalar<4, 4>},
+#if GAIA_NEURAL_NEON
+    {KernelIsa::Neon, 8, 8, KernelNeon},
+#else
+    {KernelIsa::Neon, 4, 4, nullptr},
+#endif
+#if GAIA_NEURAL_X86
+    {KernelIsa::Avx2, 6, 16, KernelAvx2},
+    {KernelIsa::Avx512, 8, 32, KernelAvx512},
+#else
+    {KernelIsa::Avx2, 4, 4, nullptr},
+    {KernelIsa::Avx512, 4, 4, nullptr},
+#endif
+};
+
+KernelIsa DetectKernelIsa() {
+#if GAIA_NEURAL_X86
+    __builtin_cpu_init();
+#endif
+    for (KernelIsa isa : {KernelIsa::Avx512, KernelIsa::Avx2, KernelIsa::Neon}) {
+        if (IsKernelIsaSupported(isa)) {
+            return isa;
+        }
+    }
+    return KernelIsa::Scalar;
+}
+
+std::atomic<int>& ActiveIsa() {
+    static std::atomic<int> isa(static_cast<int>(DetectKernelIsa()));
+    return isa;
+}
+
+int64_t RoundUp(int64_t value, int64_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+// MR-row panels of op(A)[row0 .. row0+mc, k0 .. k0+kc], zero-padded to whole panels
+void PackA(bool trans, const float* A, int64_t lda, int64_t row0, int64_t k0, int64_t mc, int64_t kc, int64_t mr,
+           float* dst) {
+    for (int64_t panel = 0; panel < mc; panel += mr) {
+        int64_t rows = std::min(mr, mc - panel);
+        for (int64_t k = 0; k < kc; ++k) {
+            for (int64_t i = 0; i < mr; ++i) {
+                int64_t r = row0 + panel + i;
+                *dst++ = i >= rows ? 0.0f : trans ? A[(k0 + k) * lda + r] : A[r * lda + k0 + k];
+            }
+        }
+    }
+}
+
+// NR-column panels of op(B)[k0 .. k0+kc, col0 .. col0+nc], zero-padded to whole panels
+void PackB(bool trans, const float* B, int64_t ldb, int64_t k0, int64_t col0, int64_t kc, int64_t nc, int64_t nr,
+           float* dst) {
+    for (int64_t panel = 0; panel < nc; panel += nr) {
+        int64_t cols = std::min(nr, nc - panel);
+        for (int64_t k = 0; k < kc; ++k) {
+            const float* row = trans ? nullptr : B + (k0 + k) * ldb + col0 + panel;
+            for (int64_t j = 0; j < nr; ++j) {
+                *dst++ = j >= cols ? 0.0f : trans ? B[(col0 + panel + j) * ldb + k0 + k] : row[j];
+            }
+        }
+    }
+}
+
+void ScaleC(int64_t M, int64_t N, float beta, float* C, int64_t ldc) {
+    for (int64_t m = 0; m < M; ++m) {
+        float* row = C + m * ldc;
+        for (int64_t n = 0; n < N; ++n) {
+            row[n] = beta == 0.0f ? 0.0f : row[n] * beta;
+        }
+    }
+}
+
+// Bias and activation over the rows x cols block of C at (row0, col0)
+void ApplyEpilogue(const GemmEpilogue& epilogue, float* c, int64_t ldc, int64_t row0, int64_t col0, int64_t rows,
+                   int64_t cols) {
+    for (int64_t i = 0; i < rows; ++i) {
+        float* row = c + i * ldc;
+        if (epilogue.bias && epilogue.biasPerRow) {
+            float bias = epilogue.bias[row0 + i];
+            for (int64_t j = 0; j < cols; ++j) {
+                row[j] += bias;
+            }
+        } else if (epilogue.bias) {
+            const float* bias = epilogue.bias + col0;
+            for (int64_t j = 0; j < cols; ++j) {
+                row[j] += bias[j];
+            }
+        }
+        ApplyActivation(epilogue.activation, row, static_cast<size_t>(cols));
+    }
+}
+
+// Full-K B panels from a PackedMatrix; 16-bit panels are widened one block at a time
+struct PackedPanels {
+    const float* data = nullptr;
+    const uint16_t* half = nullptr;
+    WeightPrecision precision = WeightPrecision::Float32;
+};
+
+/**
+ * Goto-style loop nest shared by Sgemm and SgemmPacked. With `packed` set,
+ * B is read from its full-K panels instead of being packed per block.
+ */
+void Drive(const MicroKernel& kernel, bool transA, bool transB, int64_t M, int64_t N, int64_t K, float alpha,
+           const float* A, int64_t lda, const float* B, int64_t ldb, const PackedPanels* packed, float beta, float* C,
+           int64_t ldc, const GemmEpilogue* epilogue) {
+    if (M <= 0 || N <= 0) {
+        return;
+    }
+    if (K <= 0 || alpha == 0.0f) {
+        ScaleC(M, N, beta, C, ldc);
+        if (epilogue) {
+            ApplyEpilogue(*epilogue, C, ldc, 0, 0, M, N);
+        }
+        return;
+    }
+
+    const int64_t mr = kernel.mr;
+    const int64_t nr = kernel.nr;
+    const int64_t paddedN = RoundUp(N, nr);
+    thread_local std::vector<float> packA;
+    thread_local std::vector<float> packB;
+    packA.resize(static_cast<size_t>(MC * KC));
+    if (!packed || packed->half) {
+        packB.resize(static_cast<size_t>(NC * KC));
+    }
+
+    alignas(64) float tile[MAX_TILE];
+    for (int64_t jc = 0; jc < N; jc += NC) {
+        int64_t nc = std::min(NC, N - jc);
+        for (int64_t pc = 0; pc < K; pc += KC) {
+            int64_t kc = std::min(KC, K - pc);
+            // Later K blocks accumulate onto the first; the last one finishes each tile
+            float blockBeta = pc == 0 ? beta : 1.0f;
+            const GemmEpilogue* blockEpilogue = pc + kc == K ? epilogue : nullptr;
+            const float* blockB = packB.data();
+            if (!packed) {
+                PackB(transB, B, ldb, pc, jc, kc, nc, nr, packB.data());
+            } else if (packed->half) {
+                // The block is widened once and reused by every row block of A
+                ConvertFromHalf(packed->precision, packed->half + pc * paddedN + jc * kc, packB.data(),
+                                static_cast<size_t>(RoundUp(nc, nr) * kc));
+            } else {
+                blockB = packed->data + pc * paddedN + jc * kc;
+            }
+
+            for (int64_t ic = 0; ic < M; ic += MC) {
+                int64_t mc = std::min(MC, M - ic);
+                PackA(transA, A, lda, ic, pc, mc, kc, mr, packA.data());
+
+                for (int64_t jr = 0; jr < nc; jr += nr) {
+                    int64_t cols = std::min(nr, nc - jr);
+                    for (int64_t ir = 0; ir < mc; ir += mr) {
+                        int64_t rows = std::min(mr, mc - ir);
+                        const float* a = packA.data() + ir * kc;
+                        const float* b = blockB + jr * kc;
+                        float* c = C + (ic + ir) * ldc + jc + jr;
+                        if (rows == mr && cols == nr) {
+                            kernel.run(kc, a, b, c, ldc, alpha, blockBeta);
+                        } else {
+                            // Edge tile: compute the full tile aside and merge the valid part
+                            kernel.run(kc, a, b, tile, nr, alpha, 0.0f);
+                            for (int64_t i = 0; i < rows; ++i) {
+                                for (int64_t j = 0; j < cols; ++j) {
+                                    float& out = c[i * ldc + j];
+                                    out = blockBeta == 0.0f ? tile[i * nr + j] : tile[i * nr + j] + blockBeta * out;
+                                }
+                            }
+                        }
+                        if (blockEpilogue) {
+                            ApplyEpilogue(*blockEpilogue, c, ldc, ic + ir, jc + jr, rows, cols);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+const char* GetKernelIsaName(KernelIsa isa) {
+    switch (isa) {
+        case KernelIsa::Scalar: return "scalar";
+        case KernelIsa::Neon: return "neon";
+        case KernelIsa::Avx2: return "avx2";
+        case KernelIsa::Avx512: return "avx512";
+    }
+    return "unknown";
+}
+
+bool IsKernelIsaSupported(KernelIsa isa) {
+    switch (isa) {
+        case KernelIsa::Scalar:
+            return true;
+        case KernelIsa::Neon:
+#if GAIA_NEURAL_NEON
+            return true;
+#else
+            return false;
+#endif
+        case KernelIsa::Avx2:
+#if GAIA_NEURAL_X86
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+            return false;
+#endif
+        case KernelIsa::Avx512:
+#if GAIA_NEURAL_X86
+            return __builtin_cpu_supports("avx512f");
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+KernelIsa GetKernelIsa() {
+    return static_cast<KernelIsa>(ActiveIsa().load(std::memory_order_relaxed));
+}
+
+bool SetKernelIsa(KernelIsa isa) {
+    if (!IsKernelIsaSupported(isa)) {
+        return false;
+    }
+    ActiveIsa().store(static_cast<int>(isa), std::memory_order_relaxed);
+    return true;
+}
+
+void PackedMatrix::Pack(bool trans, int64_t K, int64_t N, const float* data, int64_t ld,
+                        WeightPrecision precision) {
+    m_K = K;
+    m_N = N;
+    m_Isa = GetKernelIsa();
+    m_Precision = precision;
+    int64_t nr = KERNELS[static_cast<int>(m_Isa)].nr;
+    int64_t paddedN = RoundUp(N, nr);
+    m_Data.assign(static_cast<size_t>(paddedN * K), 0.0f);
+
+    // Same layout PackB produces per block, laid out block after block over all of N
+    for (int64_t pc = 0; pc < K; pc += KC) {
+        int64_t kc = std::min(KC, K - pc);
+        PackB(trans, data, ld, pc, 0, kc, N, nr, m_Data.data() + pc * paddedN);
+    }
+
+    m_Half.clear();
+    if (precision != WeightPrecision::Float32) {
+        m_Half.resize(m_Data.size());
+        ConvertToHalf(precision, m_Data.data(), m_Half.data(), m_Data.size());
+        std::vector<float>().swap(m_Data);
+    }
+}
+
+void ApplyActivation(Activation activation, float* data, size_t count) {
+    switch (activation) {
+        case Activation::None:
+            break;
+        case Activation::Relu:
+            for (size_t i = 0; i < count; ++i) {
+                data[i] = data[i] > 0.0f ? data[i] : 0.0f;
+            }
+            break;
+        case Activation::Sigmoid:
+            for (size_t i = 0; i < count; ++i) {
+                data[i] = 1.0f / (1.0f + std::exp(-data[i]));
+            }
+            break;
+        case Activation::Tanh:
+            for (size_t i = 0; i < count; ++i) {
+                data[i] = std::tanh(data[i]);
+            }
+            break;
+    }
+}
+
+void Sgemm(bool transA, bool transB, int64_t M, int64_t N, int64_t K, float alpha, const float* A, int64_t lda,
+           const float* B, int64_t ldb, float beta, float* C, int64_t ldc, const GemmEpilogue* epilogue) {
+    Drive(KERNELS[static_cast<int>(GetKernelIsa())], transA, transB, M, N, K, alpha, A, lda, B, ldb, nullptr, beta,
+          C, ldc, epilogue);
+}
+
+void SgemmPacked(bool transA, int64_t M, float alpha, const float* A, int64_t lda, const PackedMatrix& B, float beta,
+                 float* C, int64_t ldc, const GemmEpilogue* epilogue) {
+    // The panels only fit the kernel they were packed for
+    PackedPanels panels;
+    panels.data = B.m_Data.data();
+    panels.half = B.m_Half.empty() ? nullptr : B.m_Half.data();
+    panels.precision = B.m_Precision;
+    Drive(KERNELS[static_cast<int>(B.m_Isa)], transA, false, M, B.m_N, B.m_K, alpha, A, lda, nullptr, 0, &panels,
+          beta, C, ldc, epilogue);
+}
+
+} // namespace neural
+} // namespace gaia_matrix
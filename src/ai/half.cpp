@@ -0,0 +1,199 @@
+#include "gaia_matrix/neural_kernels.h"
+#include <cmath>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define GAIA_NEURAL_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define GAIA_NEURAL_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace gaia_matrix {
+namespace neural {
+
+namespace {
+
+uint32_t FloatBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, 4);
+    return bits;
+}
+
+float BitsFloat(uint32_t bits) {
+    float value;
+    std::memcpy(&value, &bits, 4);
+    return value;
+}
+
+uint16_t FloatToHalf(float value) {
+    uint32_t bits = FloatBits(value);
+    auto sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+    uint32_t magnitude = bits & 0x7FFFFFFF;
+    if (magnitude >= 0x7F800000) {
+        // Infinity stays infinite, NaN stays quiet
+        return sign | 0x7C00 | (magnitude > 0x7F800000 ? 0x200 : 0);
+    }
+    if (magnitude >= 0x477FF000) {
+        // 65520 and above round past the largest half
+        return sign | 0x7C00;
+    }
+    if (magnitude < 0x38800000) {
+        // Below the smallest normal half: scale to units of 2^-24, exact, and round to nearest even
+        return sign | static_cast<uint16_t>(std::nearbyint(BitsFloat(magnitude) * 16777216.0f));
+    }
+    // Rebias the exponent from 127 to 15 and round the dropped 13 bits to nearest even
+    magnitude += 0xC8000FFF + ((magnitude >> 13) & 1);
+    return sign | static_cast<uint16_t>(magnitude >> 13);
+}
+
+float HalfToFloat(uint16_t half) {
+    uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1F;
+    uint32_t mantissa = half & 0x3FF;
+    if (exponent == 0) {
+        // Zero or subnormal: mantissa units of 2^-24
+        float value = static_cast<float>(mantissa) * (1.0f / 16777216.0f);
+        return BitsFloat(sign | FloatBits(value));
+    }
+    if (exponent == 0x1F) {
+        return BitsFloat(sign | 0x7F800000 | (mantissa << 13));
+    }
+    return BitsFloat(sign | ((exponent + 127 - 15) << 23) | (mantissa << 13));
+}
+
+uint16_t FloatToBFloat16(float value) {
+    uint32_t bits = FloatBits(value);
+    if ((bits & 0x7FFFFFFF) > 0x7F800000) {
+        return static_cast<uint16_t>((bits >> 16) | 0x40);
+    }
+    bits += 0x7FFF + ((bits >> 16) & 1);
+    return static_cast<uint16_t>(bits >> 16);
+}
+
+float BFloat16ToFloat(uint16_t value) {
+    return BitsFloat(static_cast<uint32_t>(value) << 16);
+}
+
+#if GAIA_NEURAL_X86
+
+// The vector paths run only when the matching kernels are active, so
+// SetKernelIsa(KernelIsa::Scalar) also exercises the scalar conversions
+bool UseAvx2() {
+    KernelIsa isa = GetKernelIsa();
+    return isa == KernelIsa::Avx2 || isa == KernelIsa::Avx512;
+}
+
+__attribute__((target("avx,f16c")))
+size_t NarrowHalfF16c(const float* src, uint16_t* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i half = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), half);
+    }
+    return i;
+}
+
+__attribute__((target("avx,f16c")))
+size_t WidenHalfF16c(const uint16_t* src, float* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))));
+    }
+    return i;
+}
+
+// vcvtneps2bf16 flushes subnormal inputs to zero; weights that small do not matter
+__attribute__((target("avx512f,avx512bf16")))
+size_t NarrowBFloat16Avx512(const float* src, uint16_t* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256bh narrow = _mm512_cvtneps_pbh(_mm512_loadu_ps(src + i));
+        std::memcpy(dst + i, &narrow, sizeof(narrow));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+size_t WidenBFloat16Avx2(const uint16_t* src, float* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i wide = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_slli_epi32(wide, 16));
+    }
+    return i;
+}
+
+#endif
+
+#if GAIA_NEURAL_NEON
+
+size_t WidenHalfNeon(const uint16_t* src, float* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(dst + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(src + i))));
+    }
+    return i;
+}
+
+size_t WidenBFloat16Neon(const uint16_t* src, float* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(dst + i, vreinterpretq_f32_u32(vshll_n_u16(vld1_u16(src + i), 16)));
+    }
+    return i;
+}
+
+#endif
+
+} // namespace
+
+const char* GetWeightPrecisionName(WeightPrecision precision) {
+    switch (precision) {
+        case WeightPrecision::Float32: return "fp32";
+        case WeightPrecision::Float16: return "fp16";
+        case WeightPrecision::BFloat16: return "bf16";
+    }
+    return "unknown";
+}
+
+void ConvertToHalf(WeightPrecision precision, const float* src, uint16_t* dst, size_t count) {
+    size_t done = 0;
+    bool isHalf = precision == WeightPrecision::Float16;
+#if GAIA_NEURAL_X86
+    if (isHalf && UseAvx2() && __builtin_cpu_supports("f16c")) {
+        done = NarrowHalfF16c(src, dst, count);
+    } else if (!isHalf && GetKernelIsa() == KernelIsa::Avx512 && __builtin_cpu_supports("avx512bf16")) {
+        done = NarrowBFloat16Avx512(src, dst, count);
+    }
+#endif
+    for (size_t i = done; i < count; ++i) {
+        dst[i] = isHalf ? FloatToHalf(src[i]) : FloatToBFloat16(src[i]);
+    }
+}
+
+void ConvertFromHalf(WeightPrecision precision, const uint16_t* src, float* dst, size_t count) {
+    size_t done = 0;
+    bool isHalf = precision == WeightPrecision::Float16;
+#if GAIA_NEURAL_X86
+    if (isHalf && UseAvx2() && __builtin_cpu_supports("f16c")) {
+        done = WidenHalfF16c(src, dst, count);
+    } else if (!isHalf && UseAvx2()) {
+        done = WidenBFloat16Avx2(src, dst, count);
+    }
+#endif
+#if GAIA_NEURAL_NEON
+    if (GetKernelIsa() == KernelIsa::Neon) {
+        done = isHalf ? WidenHalfNeon(src, dst, count) : WidenBFloat16Neon(src, dst, count);
+    }
+#endif
+    for (size_t i = done; i < count; ++i) {
+        dst[i] = isHalf ? HalfToFloat(src[i]) : BFloat16ToFloat(src[i]);
+    }
+}
+
+} // namespace neural
+} // namespace gaia_matrix
@@ -1,8 +1,16 @@
 #include "gaia_matrix/neural_engine.h"
+#include "gaia_matrix/neural_executor.h"
+#include "gaia_matrix/neural_quantize.h"
 #include "gaia_matrix/platform.h"
 #include <iostream>
 #include <fstream>
-#include <random>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+
+namespace fs = std::filesystem;
 
 namespace gaia_matrix {
 
@@ -10,13 +18,165 @@ namespace gaia_matrix {
 struct NeuralEngine::Model {
     int id;
     std::string path;
-    std::vector<int> inputShape;
-    std::vector<int> outputShape;
+    std::vector<int64_t> inputShape;    // Declared shape of the first input; -1 for dynamic dimensions
+    std::vector<int64_t> outputShape;   // Inferred with dynamic input dimensions set to 1
+
+    std::shared_ptr<neural::Graph> graph;
+    neural::GraphExecutor executor;
+    std::mutex mutex;                   // Held while the executor runs or is prepared again
+
+    // Reused by every RunInference so a steady stream of same-sized inputs does not allocate
+    std::vector<const float*> inputs = {nullptr};
+    std::vector<neural::Shape> inputShapes = {{}};
+    std::vector<std::vector<float>> outputs;
+    std::vector<neural::Shape> outputShapes;
+    std::vector<std::vector<float>> staging;    // Converted tensor inputs that cannot be read in place
+    size_t batchRows = 0;               // Rows the executor's memory plan is reserved for while batching
+
+    // Registry state
+    int references = 0;
+    bool indexed = false;               // Reachable from the path and content indices
+    std::vector<std::string> paths;     // Canonical paths that resolve to this model
+    uint64_t contentHash = 0;
+    std::shared_ptr<const MappedFile> file;     // Mapping of the model file, to compare contents against
+    uintmax_t fileSize = 0;
+    fs::file_time_type writeTime;
+    bool cached = false;                // Unreferenced and kept in m_Unreferenced
+    size_t cachedBytes = 0;             // Weight bytes counted against the cache budget
+    std::list<int>::iterator unreferenced;
     
     // This would be replaced with actual ML model handle in production code
     void* modelHandle = nullptr;
+
+    // Declared last so it is destroyed first, running its queued requests while the executor is intact
+    std::unique_ptr<neural::InferenceBatcher> batcher;
+
+    // Weights read in place from a file rewritten since must not be run; see MapOnnxModel
+    bool CheckFiles() const {
+        std::string error;
+        if (!neural::CheckMappedFiles(*graph, error)) {
+            std::cerr << "Model " << path << ": " << error << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // The path still names the files the model was loaded from, unchanged
+    bool IsCurrent() const {
+        if (!file || !file->IsCurrent()) {
+            return false;
+        }
+        return std::all_of(graph->mappedFiles.begin(), graph->mappedFiles.end(),
+                           [](const auto& mapped) { return mapped->IsCurrent(); });
+    }
+
+    // Plan the executor's memory once for a full batch, so batches of any smaller size run inside it.
+    // Called with the mutex held, and again whenever the executor is prepared
+    bool ReserveBatch() {
+        if (batchRows == 0) {
+            executor.ClearReservedShapes();
+            return true;
+        }
+        neural::Shape shape = inputShape;
+        shape[0] = static_cast<int64_t>(batchRows);
+        if (std::any_of(shape.begin(), shape.end(), [](int64_t dim) { return dim < 0; })) {
+            return true;    // Other dynamic dimensions leave nothing to plan for ahead of time
+        }
+        std::string error;
+        if (!executor.ReserveShapes({shape}, error)) {
+            std::cerr << "Model " << path << " cannot run batches of " << batchRows << ": " << error << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // The vector interfaces take one tensor, for the first input
+    bool HasSingleInput() const {
+        if (graph->inputs.size() != 1) {
+            std::cerr << "Model " << path << " has " << graph->inputs.size()
+                      << " inputs; run it with TensorView inputs" << std::endl;
+            return false;
+        }
+        return true;
+    }
 };
 
+namespace {
+
+// FNV-1a over the whole file; 0 if it is not mapped
+uint64_t HashFile(const MappedFile* file) {
+    if (!file) {
+        return 0;
+    }
+    uint64_t hash = 14695981039346656037ull;
+    const auto* bytes = static_cast<const uint8_t*>(file->GetData());
+    for (size_t i = 0; i < file->GetSize(); ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+/**
+ * Map the engine's fixed 4-D shape onto the model input. The leading dims are
+ * used when the rest are 1 ({batch, features, 1, 1} for a 2-D input);
+ * otherwise the declared shape is used, with at most one dynamic dimension
+ * derived from the element count.
+ */
+bool ResolveInputShape(const neural::Shape& declared, const std::array<int, 4>& given, size_t elementCount,
+                       neural::Shape& shape) {
+    auto matches = [&](const neural::Shape& candidate) {
+        if (candidate.size() != declared.size() || neural::ElementCount(candidate) != static_cast<int64_t>(elementCount)) {
+            return false;
+        }
+        for (size_t i = 0; i < declared.size(); ++i) {
+            if (declared[i] >= 0 && declared[i] != candidate[i]) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    if (declared.size() <= given.size()) {
+        shape.assign(given.begin(), given.begin() + declared.size());
+        bool trailingOnes = std::all_of(given.begin() + declared.size(), given.end(), [](int d) { return d == 1; });
+        if (trailingOnes && matches(shape)) {
+            return true;
+        }
+    }
+
+    shape = declared;
+    int64_t known = 1;
+    int dynamic = -1;
+    for (size_t i = 0; i < shape.size(); ++i) {
+        if (shape[i] >= 0) {
+            known *= shape[i];
+        } else if (dynamic < 0) {
+            dynamic = static_cast<int>(i);
+        } else {
+            return false;
+        }
+    }
+    if (dynamic >= 0 && known > 0) {
+        shape[dynamic] = static_cast<int64_t>(elementCount) / known;
+    }
+    return matches(shape);
+}
+
+// Graph value a tensor view binds to: by name, or by position when unnamed; -1 if none
+int BindingIndex(const std::vector<neural::ValueInfo>& values, const neural::TensorView& view, size_t position) {
+    if (view.name.empty()) {
+        return position < values.size() ? static_cast<int>(position) : -1;
+    }
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (values[i].name == view.name) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+} // namespace
+
 NeuralEngine* NeuralEngine::s_Instance = nullptr;
 
 NeuralEngine::NeuralEngine() : 
@@ -63,16 +223,19 @@ void NeuralEngine::Shutdown() {
     }
     
     // Unload all models
-    for (auto& model : m_LoadedModels) {
+    for (auto& entry : m_Models) {
         // Release model resources
-        if (model->modelHandle) {
+        if (entry.second->modelHandle) {
             // In production code, this would call the appropriate API
             // to release Neural Engine resources
-            model->modelHandle = nullptr;
+            entry.second->modelHandle = nullptr;
         }
     }
     
-    m_LoadedModels.clear();
+    m_Models.clear();
+    m_ModelsByPath.clear();
+    m_ModelsByContent.clear();
+    m_Unreferenced.clear();
     m_IsInitialized = false;
 }
 
@@ -87,21 +250,116 @@ int NeuralEngine::LoadModel(const std::string& modelPath) {
         std::cerr << "Model file not found: " << modelPath << std::endl;
         return -1;
     }
+    auto start = std::chrono::steady_clock::now();
+    std::error_code ec;
+    std::string canonical = fs::weakly_canonical(modelPath, ec).string();
+    canonical = ec ? modelPath : canonical;
+    uintmax_t fileSize = fs::file_size(canonical, ec);
+    fs::file_time_type writeTime = fs::last_write_time(canonical, ec);
+
+    // Same file, unchanged since it was loaded
+    auto byPath = m_ModelsByPath.find(canonical);
+    if (byPath != m_ModelsByPath.end()) {
+        Model& cached = *m_Models.at(byPath->second);
+        if (cached.fileSize == fileSize && cached.writeTime == writeTime && cached.IsCurrent()) {
+            AddReference(cached);
+            ++m_CacheStats.pathHits;
+            return cached.id;
+        }
+        // Replaced or rewritten on disk: new loads get the new file. Current holders keep the old
+        // model if the file was replaced by rename; one rewritten in place stops running (CheckFiles)
+        int staleId = cached.id;
+        Detach(cached);
+        if (cached.references == 0) {
+            Destroy(staleId);
+        }
+    }
+
+    // Same bytes under another path. External data resolves against the model's
+    // directory, so models that use it only match within one directory.
+    // The hash only finds a candidate; the bytes are compared before it is trusted.
+    std::shared_ptr<const MappedFile> file = MappedFile::Open(canonical);
+    uint64_t contentHash = HashFile(file.get());
+    auto byContent = m_ModelsByContent.find(contentHash);
+    if (byContent != m_ModelsByContent.end()) {
+        Model& cached = *m_Models.at(byContent->second);
+        bool sameData = cached.graph->externalData.empty() ||
+                        fs::path(cached.paths.front()).parent_path() == fs::path(canonical).parent_path();
+        bool sameBytes = file && cached.file && cached.file->IsUnchanged() &&
+                         file->GetSize() == cached.file->GetSize() &&
+                         (file->GetSize() == 0 ||
+                          std::memcmp(file->GetData(), cached.file->GetData(), file->GetSize()) == 0);
+        if (sameBytes && sameData && cached.CheckFiles()) {
+            cached.paths.push_back(canonical);
+            m_ModelsByPath[canonical] = cached.id;
+            AddReference(cached);
+            ++m_CacheStats.contentHits;
+            return cached.id;
+        }
+    }
     
     // Create model instance
     auto model = std::make_unique<Model>();
     model->path = modelPath;
-    model->id = static_cast<int>(m_LoadedModels.size());
+    model->id = m_NextModelId;
     
-    // In production code, this would load the model using the appropriate API
-    // For now, we'll just simulate it
     std::cout << "Loading model: " << modelPath << std::endl;
-    model->modelHandle = nullptr; // This would be a real handle in production
-    
-    // Store and return model ID
-    int modelId = model->id;
-    m_LoadedModels.push_back(std::move(model));
-    
+    model->graph = std::make_shared<neural::Graph>();
+    std::string error;
+    // Weights stay in the shared page cache; only packed panels and decoded tensors are per process
+    if (!neural::MapOnnxModel(modelPath, *model->graph, error)) {
+        std::cerr << "Failed to load model " << modelPath << ": " << error << std::endl;
+        return -1;
+    }
+
+    std::vector<std::string> errors;
+    if (!model->executor.Prepare(model->graph, errors)) {
+        for (const auto& message : errors) {
+            std::cerr << "Model " << modelPath << ": " << message << std::endl;
+        }
+        return -1;
+    }
+    if (model->graph->inputs.empty() || model->graph->outputs.empty()) {
+        std::cerr << "Model " << modelPath << " must have at least one input and one output" << std::endl;
+        return -1;
+    }
+
+    // Derive the output shape from the graph, treating dynamic input dimensions as 1
+    model->inputShape = model->graph->inputs[0].shape;
+    std::vector<neural::Shape> probes;
+    for (const auto& input : model->graph->inputs) {
+        probes.push_back(input.shape);
+        std::replace(probes.back().begin(), probes.back().end(), int64_t(-1), int64_t(1));
+    }
+    model->inputs.assign(probes.size(), nullptr);
+    model->inputShapes.assign(probes.size(), {});
+    model->staging.resize(probes.size());
+    std::vector<neural::Shape> outputShapes;
+    if (!model->executor.InferShapes(probes, outputShapes, error)) {
+        std::cerr << "Model " << modelPath << ": " << error << std::endl;
+        return -1;
+    }
+    model->outputShape = model->graph->outputs[0].shape.empty() ? outputShapes[0] : model->graph->outputs[0].shape;
+    std::cout << "Planned " << model->executor.GetActivationBytes() << " bytes of activations for input "
+              << neural::FormatShape(probes[0]) << std::endl;
+    model->modelHandle = nullptr; // Reserved for a hardware accelerator handle
+
+    // Register and return model ID
+    int modelId = m_NextModelId++;
+    model->references = 1;
+    model->indexed = true;
+    model->paths.push_back(canonical);
+    model->contentHash = contentHash;
+    model->file = file;
+    model->fileSize = fileSize;
+    model->writeTime = writeTime;
+    m_ModelsByPath[canonical] = modelId;
+    m_ModelsByContent[contentHash] = modelId;
+    m_Models.emplace(modelId, std::move(model));
+
+    ++m_CacheStats.loads;
+    m_CacheStats.loadMilliseconds +=
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
     return modelId;
 }
 
@@ -111,22 +369,94 @@ void NeuralEngine::UnloadModel(int modelId) {
         return;
     }
     
-    // Find model by ID
-    for (auto it = m_LoadedModels.begin(); it != m_LoadedModels.end(); ++it) {
-        if ((*it)->id == modelId) {
-            // Release model resources
-            if ((*it)->modelHandle) {
-                // In production code, this would call the appropriate API
-                (*it)->modelHandle = nullptr;
-            }
-            
-            // Remove from loaded models
-            m_LoadedModels.erase(it);
-            return;
+    Model* model = FindModel(modelId);
+    if (!model) {
+        std::cerr << "Model ID not found: " << modelId << std::endl;
+        return;
+    }
+    if (--model->references > 0) {
+        return;
+    }
+    model->batcher.reset();     // Runs what is still queued
+    model->batchRows = 0;
+    model->ReserveBatch();
+
+    // Models that can be found again stay cached until the budget runs out
+    if (!model->indexed || m_CacheBudget == 0) {
+        Destroy(modelId);
+        return;
+    }
+    model->cached = true;
+    model->cachedBytes = model->executor.GetWeightBytes();
+    model->unreferenced = m_Unreferenced.insert(m_Unreferenced.begin(), modelId);
+    m_CacheStats.cachedBytes += model->cachedBytes;
+    EvictUnreferenced();
+}
+
+void NeuralEngine::SetCacheBudget(size_t bytes) {
+    m_CacheBudget = bytes;
+    EvictUnreferenced();
+}
+
+ModelCacheStats NeuralEngine::GetCacheStats() const {
+    ModelCacheStats stats = m_CacheStats;
+    stats.cachedModels = static_cast<uint32_t>(m_Unreferenced.size());
+    return stats;
+}
+
+NeuralEngine::Model* NeuralEngine::FindModel(int modelId) const {
+    auto found = m_Models.find(modelId);
+    return found != m_Models.end() && found->second->references > 0 ? found->second.get() : nullptr;
+}
+
+void NeuralEngine::AddReference(Model& model) {
+    if (model.cached) {
+        m_Unreferenced.erase(model.unreferenced);
+        m_CacheStats.cachedBytes -= model.cachedBytes;
+        model.cached = false;
+    }
+    ++model.references;
+}
+
+void NeuralEngine::Detach(Model& model) {
+    // Later loads of the model's files must not find it
+    for (const auto& path : model.paths) {
+        auto found = m_ModelsByPath.find(path);
+        if (found != m_ModelsByPath.end() && found->second == model.id) {
+            m_ModelsByPath.erase(found);
         }
     }
-    
-    std::cerr << "Model ID not found: " << modelId << std::endl;
+    auto found = m_ModelsByContent.find(model.contentHash);
+    if (found != m_ModelsByContent.end() && found->second == model.id) {
+        m_ModelsByContent.erase(found);
+    }
+    model.indexed = false;
+}
+
+void NeuralEngine::Destroy(int modelId) {
+    auto found = m_Models.find(modelId);
+    if (found == m_Models.end()) {
+        return;
+    }
+    Model& model = *found->second;
+    Detach(model);
+    if (model.cached) {
+        m_Unreferenced.erase(model.unreferenced);
+        m_CacheStats.cachedBytes -= model.cachedBytes;
+    }
+    // Release model resources
+    if (model.modelHandle) {
+        // In production code, this would call the appropriate API
+        model.modelHandle = nullptr;
+    }
+    m_Models.erase(found);
+}
+
+void NeuralEngine::EvictUnreferenced() {
+    while (!m_Unreferenced.empty() && (m_CacheStats.cachedBytes > m_CacheBudget || m_CacheBudget == 0)) {
+        Destroy(m_Unreferenced.back());
+        ++m_CacheStats.evictions;
+    }
 }
 
 std::vector<float> NeuralEngine::RunInference(int modelId, const std::vector<float>& inputData, const std::array<int, 4>& inputShape) {
@@ -136,36 +466,320 @@ std::vector<float> NeuralEngine::RunInference(int modelId, const std::vector<flo
     }
     
     // Find model by ID
-    Model* model = nullptr;
-    for (const auto& m : m_LoadedModels) {
-        if (m->id == modelId) {
-            model = m.get();
-            break;
-        }
-    }
-    
+    Model* model = FindModel(modelId);
     if (!model) {
         std::cerr << "Model ID not found: " << modelId << std::endl;
         return {};
     }
     
-    // In production code, this would run inference using the Neural Engine
-    // For now, we'll just return dummy data for demonstration
-    std::cout << "Running inference on model: " << model->path << std::endl;
-    
-    // Calculate output size (this would be determined by the model in production)
-    int outputSize = 10;
-    
-    // Generate random output data for demonstration
-    std::vector<float> outputData(outputSize);
-    std::default_random_engine generator;
-    std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
-    
-    for (int i = 0; i < outputSize; ++i) {
-        outputData[i] = distribution(generator);
+    if (!model->HasSingleInput() || !model->CheckFiles()) {
+        return {};
     }
-    
-    return outputData;
+
+    std::lock_guard<std::mutex> lock(model->mutex);
+    if (!ResolveInputShape(model->inputShape, inputShape, inputData.size(), model->inputShapes[0])) {
+        std::cerr << "Input of " << inputData.size() << " values does not fit model input "
+                  << neural::FormatShape(model->inputShape) << std::endl;
+        return {};
+    }
+
+    // The input is read in place and activations live in the executor's planned
+    // arena; the returned copy is the only allocation
+    model->inputs[0] = inputData.data();
+    std::string error;
+    if (!model->executor.Run(model->inputs, model->inputShapes, model->outputs, model->outputShapes, error)) {
+        std::cerr << "Inference failed on model " << model->path << ": " << error << std::endl;
+        return {};
+    }
+    return model->outputs[0];
+}
+
+bool NeuralEngine::RunInference(int modelId, const std::vector<neural::TensorView>& inputs,
+                                const std::vector<neural::TensorView>& outputs) {
+    if (!m_IsInitialized) {
+        std::cerr << "Neural Engine not initialized!" << std::endl;
+        return false;
+    }
+
+    Model* model = FindModel(modelId);
+    if (!model) {
+        std::cerr << "Model ID not found: " << modelId << std::endl;
+        return false;
+    }
+    if (!model->CheckFiles()) {
+        return false;
+    }
+    const neural::Graph& graph = *model->graph;
+    if (inputs.size() != graph.inputs.size()) {
+        std::cerr << "Model " << model->path << " has " << graph.inputs.size() << " input(s), got "
+                  << inputs.size() << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(model->mutex);
+    std::fill(model->inputs.begin(), model->inputs.end(), nullptr);
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        const neural::TensorView& view = inputs[i];
+        int index = BindingIndex(graph.inputs, view, i);
+        if (index < 0 || model->inputs[index]) {
+            std::cerr << "Model " << model->path << " has no unbound input "
+                      << (view.name.empty() ? "#" + std::to_string(i) : view.name) << std::endl;
+            return false;
+        }
+        int64_t count = view.Count();
+        if (count < 0) {
+            std::cerr << "Input " << graph.inputs[index].name << " has unknown shape "
+                      << neural::FormatShape(view.shape) << std::endl;
+            return false;
+        }
+        // fp32 in row-major order is read where it lies; anything else is converted once
+        if (view.type == neural::DataType::Float32 && view.IsContiguous() && view.data) {
+            model->inputs[index] = static_cast<const float*>(view.data);
+        } else {
+            std::vector<float>& staging = model->staging[index];
+            staging.resize(static_cast<size_t>(count));
+            if (!neural::ReadTensor(view, staging.data())) {
+                std::cerr << "Input " << graph.inputs[index].name << " is not a readable tensor of a supported type"
+                          << std::endl;
+                return false;
+            }
+            model->inputs[index] = staging.data();
+        }
+        model->inputShapes[index] = view.shape;
+    }
+
+    std::string error;
+    if (!model->executor.Run(model->inputs, model->inputShapes, error)) {
+        std::cerr << "Inference failed on model " << model->path << ": " << error << std::endl;
+        return false;
+    }
+
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        const neural::TensorView& view = outputs[i];
+        int index = BindingIndex(graph.outputs, view, i);
+        if (index < 0) {
+            std::cerr << "Model " << model->path << " has no output "
+                      << (view.name.empty() ? "#" + std::to_string(i) : view.name) << std::endl;
+            return false;
+        }
+        const neural::Shape& shape = model->executor.GetOutputShape(index);
+        if (view.shape != shape) {
+            std::cerr << "Output " << graph.outputs[index].name << " is " << neural::FormatShape(shape)
+                      << " but its buffer is " << neural::FormatShape(view.shape) << std::endl;
+            return false;
+        }
+        if (!neural::WriteTensor(model->executor.GetOutputData(index), view)) {
+            std::cerr << "Output " << graph.outputs[index].name << " is not a writable tensor of a supported type"
+                      << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool NeuralEngine::EnableBatching(int modelId, size_t maxBatchSize, std::chrono::microseconds maxWait) {
+    Model* model = FindModel(modelId);
+    if (!model) {
+        std::cerr << "Model ID not found: " << modelId << std::endl;
+        return false;
+    }
+    if (!model->HasSingleInput()) {
+        return false;
+    }
+    if (model->inputShape.empty() || model->inputShape[0] >= 0) {
+        std::cerr << "Model " << model->path << " input " << neural::FormatShape(model->inputShape)
+                  << " has no dynamic batch dimension" << std::endl;
+        return false;
+    }
+    if (maxBatchSize == 0) {
+        std::cerr << "Batch size must be at least 1" << std::endl;
+        return false;
+    }
+
+    // The batcher's worker runs batches through the same executor as RunInference
+    auto run = [model](const float* input, const neural::Shape& shape, std::vector<float>& output,
+                       neural::Shape& outputShape) {
+        std::lock_guard<std::mutex> lock(model->mutex);
+        if (!model->CheckFiles()) {
+            return false;
+        }
+        model->inputs[0] = input;
+        model->inputShapes[0] = shape;
+        std::string error;
+        if (!model->executor.Run(model->inputs, model->inputShapes, model->outputs, model->outputShapes, error)) {
+            std::cerr << "Batched inference failed on model " << model->path << ": " << error << std::endl;
+            return false;
+        }
+        output.swap(model->outputs[0]);
+        outputShape = model->outputShapes[0];
+        return true;
+    };
+    model->batcher.reset();
+    {
+        std::lock_guard<std::mutex> lock(model->mutex);
+        model->batchRows = maxBatchSize;
+        if (!model->ReserveBatch()) {
+            model->batchRows = 0;
+            return false;
+        }
+    }
+    model->batcher = std::make_unique<neural::InferenceBatcher>(run, maxBatchSize, maxWait);
+    return true;
+}
+
+void NeuralEngine::DisableBatching(int modelId) {
+    Model* model = FindModel(modelId);
+    if (!model) {
+        std::cerr << "Model ID not found: " << modelId << std::endl;
+        return;
+    }
+    model->batcher.reset();
+    std::lock_guard<std::mutex> lock(model->mutex);
+    model->batchRows = 0;
+    model->ReserveBatch();
+}
+
+std::future<std::vector<float>> NeuralEngine::SubmitInference(int modelId, std::vector<float> inputData,
+                                                              const std::array<int, 4>& inputShape) {
+    Model* model = m_IsInitialized ? FindModel(modelId) : nullptr;
+    if (!model || !model->batcher) {
+        // Not batching: run now and hand back a ready future
+        std::promise<std::vector<float>> result;
+        result.set_value(RunInference(modelId, inputData, inputShape));
+        return result.get_future();
+    }
+
+    neural::Shape shape;
+    if (!ResolveInputShape(model->inputShape, inputShape, inputData.size(), shape)) {
+        std::cerr << "Input of " << inputData.size() << " values does not fit model input "
+                  << neural::FormatShape(model->inputShape) << std::endl;
+        std::promise<std::vector<float>> result;
+        result.set_value({});
+        return result.get_future();
+    }
+    return model->batcher->Submit(std::move(inputData), std::move(shape));
+}
+
+neural::BatchingStats NeuralEngine::GetBatchingStats(int modelId) const {
+    Model* model = FindModel(modelId);
+    return model && model->batcher ? model->batcher->GetStats() : neural::BatchingStats();
+}
+
+std::vector<int64_t> NeuralEngine::GetInputShape(int modelId) const {
+    Model* model = FindModel(modelId);
+    return model ? model->inputShape : std::vector<int64_t>();
+}
+
+std::vector<neural::ValueInfo> NeuralEngine::GetInputInfo(int modelId) const {
+    Model* model = FindModel(modelId);
+    return model ? model->graph->inputs : std::vector<neural::ValueInfo>();
+}
+
+std::vector<neural::ValueInfo> NeuralEngine::GetOutputInfo(int modelId) const {
+    Model* model = FindModel(modelId);
+    return model ? model->graph->outputs : std::vector<neural::ValueInfo>();
+}
+
+std::vector<int64_t> NeuralEngine::GetOutputShape(int modelId) const {
+    Model* model = FindModel(modelId);
+    return model ? model->outputShape : std::vector<int64_t>();
+}
+
+bool NeuralEngine::QuantizeModel(int modelId, const std::vector<std::vector<float>>& calibrationData,
+                                 const std::array<int, 4>& inputShape) {
+    Model* model = FindModel(modelId);
+    if (!model) {
+        std::cerr << "Model ID not found: " << modelId << std::endl;
+        return false;
+    }
+
+    if (!model->HasSingleInput() || !model->CheckFiles()) {
+        return false;
+    }
+
+    std::vector<neural::CalibrationSample> samples;
+    for (const auto& data : calibrationData) {
+        neural::Shape shape;
+        if (!ResolveInputShape(model->inputShape, inputShape, data.size(), shape)) {
+            std::cerr << "Calibration input of " << data.size() << " values does not fit model input "
+                      << neural::FormatShape(model->inputShape) << std::endl;
+            return false;
+        }
+        samples.push_back({{data}, {shape}});
+    }
+
+    auto quantized = std::make_shared<neural::Graph>();
+    std::string error;
+    if (!neural::QuantizeGraph(*model->graph, samples, *quantized, error)) {
+        std::cerr << "Failed to quantize model " << model->path << ": " << error << std::endl;
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(model->mutex);
+    size_t floatBytes = model->executor.GetWeightBytes();
+    std::vector<std::string> errors;
+    if (!model->executor.Prepare(quantized, errors)) {
+        for (const auto& message : errors) {
+            std::cerr << "Quantized model " << model->path << ": " << message << std::endl;
+        }
+        errors.clear();
+        model->executor.Prepare(model->graph, errors);
+        model->ReserveBatch();
+        return false;
+    }
+    model->graph = quantized;
+    model->ReserveBatch();
+    Detach(*model);     // No longer what its file holds
+    std::cout << "Quantized model: " << model->path << " (weights " << floatBytes << " -> "
+              << model->executor.GetWeightBytes() << " bytes)" << std::endl;
+    return true;
+}
+
+bool NeuralEngine::SetWeightPrecision(int modelId, neural::WeightPrecision precision) {
+    Model* model = FindModel(modelId);
+    if (!model) {
+        std::cerr << "Model ID not found: " << modelId << std::endl;
+        return false;
+    }
+
+    if (!model->CheckFiles()) {
+        return false;
+    }
+
+    // Weights are converted when the executor packs them
+    std::lock_guard<std::mutex> lock(model->mutex);
+    neural::WeightPrecision previous = model->executor.GetWeightPrecision();
+    model->executor.SetWeightPrecision(precision);
+    std::vector<std::string> errors;
+    if (!model->executor.Prepare(model->graph, errors)) {
+        for (const auto& message : errors) {
+            std::cerr << "Model " << model->path << ": " << message << std::endl;
+        }
+        // Keep the model runnable at the precision it had
+        errors.clear();
+        model->executor.SetWeightPrecision(previous);
+        model->executor.Prepare(model->graph, errors);
+        model->ReserveBatch();
+        return false;
+    }
+    model->ReserveBatch();
+    if (precision != neural::WeightPrecision::Float32) {
+        Detach(*model);
+    }
+    return true;
+}
+
+size_t NeuralEngine::GetWeightBytes(int modelId) const {
+    Model* model = FindModel(modelId);
+    return model ? model->executor.GetWeightBytes() : 0;
+}
+
+size_t NeuralEngine::GetActivationBytes(int modelId) const {
+    Model* model = FindModel(modelId);
+    if (!model) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(model->mutex);
+    return model->executor.GetActivationBytes();
 }
 
 NeuralEngine& NeuralEngine::Get() {
@@ -213,4 +827,12 @@ const std::vector<float>& MCPModel::GetGeneratedData() const {
     return m_GeneratedData;
 }
 
+bool MCPModel::SetWeightPrecision(neural::WeightPrecision precision) {
+    if (m_ModelId < 0) {
+        std::cerr << "Invalid model ID!" << std::endl;
+        return false;
+    }
+    return NeuralEngine::Get().SetWeightPrecision(m_ModelId, precision);
+}
+
 } // namespace gaia_matrix
\ No newline at end of file
@@ -0,0 +1,687 @@
+#include "gaia_matrix/neural_graph.h"
+#include "gaia_matrix/neural_kernels.h"
+#include "gaia_matrix/platform.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+#include <unordered_map>
+
+namespace gaia_matrix {
+namespace neural {
+
+namespace {
+
+// Protobuf wire types
+enum WireType : uint32_t { VARINT = 0, FIXED64 = 1, BYTES = 2, FIXED32 = 5 };
+
+/**
+ * Minimal protobuf decoder over a byte range. Every read checks bounds and
+ * sets `failed` instead of throwing; callers test it once per message.
+ */
+class ProtoReader {
+public:
+    ProtoReader(const uint8_t* begin, const uint8_t* end) : m_Cursor(begin), m_End(end) {}
+
+    bool Next(uint32_t& field, uint32_t& wire) {
+        if (m_Failed || m_Cursor >= m_End) {
+            return false;
+        }
+        uint64_t key = Varint();
+        field = static_cast<uint32_t>(key >> 3);
+        wire = static_cast<uint32_t>(key & 7);
+        return !m_Failed && field != 0;
+    }
+
+    uint64_t Varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (m_Cursor >= m_End) {
+                break;
+            }
+            uint8_t byte = *m_Cursor++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        m_Failed = true;
+        return 0;
+    }
+
+    float Fixed32() {
+        float value = 0.0f;
+        if (m_End - m_Cursor < 4) {
+            m_Failed = true;
+            return value;
+        }
+        std::memcpy(&value, m_Cursor, 4);
+        m_Cursor += 4;
+        return value;
+    }
+
+    double Fixed64() {
+        double value = 0.0;
+        if (m_End - m_Cursor < 8) {
+            m_Failed = true;
+            return value;
+        }
+        std::memcpy(&value, m_Cursor, 8);
+        m_Cursor += 8;
+        return value;
+    }
+
+    ProtoReader Bytes() {
+        uint64_t size = Varint();
+        if (m_Failed || size > static_cast<uint64_t>(m_End - m_Cursor)) {
+            m_Failed = true;
+            return ProtoReader(m_End, m_End);
+        }
+        ProtoReader nested(m_Cursor, m_Cursor + size);
+        m_Cursor += size;
+        return nested;
+    }
+
+    std::string String() {
+        ProtoReader bytes = Bytes();
+        return std::string(reinterpret_cast<const char*>(bytes.m_Cursor), bytes.m_End - bytes.m_Cursor);
+    }
+
+    void Skip(uint32_t wire) {
+        switch (wire) {
+            case VARINT: Varint(); break;
+            case FIXED64: Fixed64(); break;
+            case BYTES: Bytes(); break;
+            case FIXED32: Fixed32(); break;
+            default: m_Failed = true; break;
+        }
+    }
+
+    // Repeated scalars may be packed into one BYTES field or sent one per field
+    void Int64s(uint32_t wire, std::vector<int64_t>& values) {
+        if (wire == BYTES) {
+            ProtoReader packed = Bytes();
+            while (packed.m_Cursor < packed.m_End && !packed.m_Failed) {
+                values.push_back(static_cast<int64_t>(packed.Varint()));
+            }
+            m_Failed |= packed.m_Failed;
+        } else {
+            values.push_back(static_cast<int64_t>(Varint()));
+        }
+    }
+
+    void Floats(uint32_t wire, std::vector<float>& values) {
+        if (wire == BYTES) {
+            ProtoReader packed = Bytes();
+            while (packed.m_Cursor < packed.m_End && !packed.m_Failed) {
+                values.push_back(packed.Fixed32());
+            }
+            m_Failed |= packed.m_Failed;
+        } else {
+            values.push_back(Fixed32());
+        }
+    }
+
+    void Doubles(uint32_t wire, std::vector<float>& values) {
+        if (wire == BYTES) {
+            ProtoReader packed = Bytes();
+            while (packed.m_Cursor < packed.m_End && !packed.m_Failed) {
+                values.push_back(static_cast<float>(packed.Fixed64()));
+            }
+            m_Failed |= packed.m_Failed;
+        } else {
+            values.push_back(static_cast<float>(Fixed64()));
+        }
+    }
+
+    const uint8_t* Data() const { return m_Cursor; }
+    size_t Size() const { return m_End - m_Cursor; }
+    bool Failed() const { return m_Failed; }
+    void Fail() { m_Failed = true; }
+
+private:
+    const uint8_t* m_Cursor;
+    const uint8_t* m_End;
+    bool m_Failed = false;
+};
+
+/**
+ * Where tensor bytes live while a model decodes. Without a directory, external
+ * data cannot be resolved; without `inPlace`, every tensor is copied.
+ */
+struct TensorSource {
+    std::string directory;
+    std::shared_ptr<MappedFile> model;      // Mapping the protobuf bytes come from, if any
+    bool inPlace = false;                   // Point aligned fp32 tensors into the mappings
+    std::unordered_map<std::string, std::shared_ptr<MappedFile>> externalFiles;    // Mapped once per load
+    std::vector<std::shared_ptr<const MappedFile>> readInPlace;                     // Files some tensor points into
+};
+
+// Map the file an external tensor lives in; locations must stay inside the model's directory
+std::shared_ptr<MappedFile> MapExternalFile(TensorSource& source, const std::string& location, std::string& error) {
+    std::filesystem::path relative(location);
+    bool escapes = relative.empty() || relative.is_absolute() || relative.has_root_name() ||
+                   std::any_of(relative.begin(), relative.end(), [](const auto& part) { return part == ".."; });
+    if (escapes) {
+        error = "external data location '" + location + "' is outside the model directory";
+        return nullptr;
+    }
+    auto found = source.externalFiles.find(location);
+    if (found != source.externalFiles.end()) {
+        return found->second;
+    }
+    auto file = MappedFile::Open((std::filesystem::path(source.directory) / relative).string());
+    if (!file) {
+        error = "cannot open external data file '" + location + "'";
+        return nullptr;
+    }
+    source.externalFiles.emplace(location, file);
+    return file;
+}
+
+// Widen little-endian raw_data of any supported type to floats
+bool DecodeRaw(DataType type, const uint8_t* raw, size_t size, std::vector<float>& values) {
+    auto decode = [&](auto sample, size_t width, auto convert) {
+        if (size % width) {
+            return false;
+        }
+        values.resize(size / width);
+        for (size_t i = 0; i < values.size(); ++i) {
+            decltype(sample) element;
+            std::memcpy(&element, raw + i * width, width);
+            values[i] = convert(element);
+        }
+        return true;
+    };
+    auto widen = [](auto element) { return static_cast<float>(element); };
+    auto widenHalf = [&](WeightPrecision precision) {
+        if (size % 2) {
+            return false;
+        }
+        std::vector<uint16_t> bits(size / 2);
+        std::memcpy(bits.data(), raw, size);
+        values.resize(bits.size());
+        ConvertFromHalf(precision, bits.data(), values.data(), bits.size());
+        return true;
+    };
+
+    switch (type) {
+        case DataType::Float32: return decode(float(), 4, widen);
+        case DataType::Float64: return decode(double(), 8, widen);
+        case DataType::Uint8:
+        case DataType::Bool: return decode(uint8_t(), 1, widen);
+        case DataType::Int8: return decode(int8_t(), 1, widen);
+        case DataType::Int32: return decode(int32_t(), 4, widen);
+        case DataType::Int64: return decode(int64_t(), 8, widen);
+        case DataType::Float16: return widenHalf(WeightPrecision::Float16);
+        case DataType::BFloat16: return widenHalf(WeightPrecision::BFloat16);
+        default: return false;
+    }
+}
+
+bool ParseTensor(ProtoReader reader, Initializer& tensor, TensorSource& source, std::string& error) {
+    const uint8_t* raw = nullptr;
+    size_t rawSize = 0;
+    std::shared_ptr<MappedFile> owner = source.model;     // Mapping that `raw` points into
+    bool external = false;
+    std::string location;
+    uint64_t offset = 0;
+    uint64_t length = 0;
+    bool hasLength = false;
+    std::vector<int64_t> ints;
+    std::vector<float> values;
+
+    uint32_t field, wire;
+    while (reader.Next(field, wire)) {
+        switch (field) {
+            case 1: reader.Int64s(wire, tensor.dims); break;
+            case 2: tensor.type = static_cast<DataType>(reader.Varint()); break;
+            case 4: reader.Floats(wire, values); break;
+            case 5:     // int32_data also carries int8, uint8, bool and 16-bit floats
+            case 7:     // int64_data
+            case 11:    // uint64_data
+                reader.Int64s(wire, ints);
+                break;
+            case 8: tensor.name = reader.String(); break;
+            case 9: {
+                ProtoReader bytes = reader.Bytes();
+                raw = bytes.Data();
+                rawSize = bytes.Size();
+                break;
+            }
+            case 10: reader.Doubles(wire, values); break;
+            case 13: {
+                // StringStringEntryProto: location, offset and length of the external bytes
+                ProtoReader entry = reader.Bytes();
+                std::string key, value;
+                uint32_t entryField, entryWire;
+                while (entry.Next(entryField, entryWire)) {
+                    if (entryField == 1 && entryWire == BYTES) {
+                        key = entry.String();
+                    } else if (entryField == 2 && entryWire == BYTES) {
+                        value = entry.String();
+                    } else {
+                        entry.Skip(entryWire);
+                    }
+                }
+                if (entry.Failed()) {
+                    reader.Fail();
+                } else if (key == "location") {
+                    location = value;
+                } else if (key == "offset") {
+                    offset = std::strtoull(value.c_str(), nullptr, 10);
+                } else if (key == "length") {
+                    length = std::strtoull(value.c_str(), nullptr, 10);
+                    hasLength = true;
+                }
+                break;
+            }
+            case 14: external = reader.Varint() == 1; break;
+            default: reader.Skip(wire); break;
+        }
+    }
+    if (reader.Failed()) {
+        error = "malformed tensor '" + tensor.name + "'";
+        return false;
+    }
+    if (external) {
+        if (source.directory.empty()) {
+            error = "tensor '" + tensor.name + "' uses external data, which needs the model's file path";
+            return false;
+        }
+        owner = MapExternalFile(source, location, error);
+        if (!owner) {
+            error = "tensor '" + tensor.name + "': " + error;
+            return false;
+        }
+        uint64_t available = offset <= owner->GetSize() ? owner->GetSize() - offset : 0;
+        if (offset > owner->GetSize() || (hasLength && length > available)) {
+            error = "tensor '" + tensor.name + "' lies past the end of '" + location + "'";
+            return false;
+        }
+        raw = static_cast<const uint8_t*>(owner->GetData()) + offset;
+        rawSize = static_cast<size_t>(hasLength ? length : available);
+    }
+
+    // Aligned fp32 bytes are already the values, so the tensor can read them where they are
+    int64_t expected = ElementCount(tensor.dims);
+    bool inPlace = raw && owner && source.inPlace && tensor.type == DataType::Float32 && expected >= 0 &&
+                   rawSize == static_cast<size_t>(expected) * sizeof(float) &&
+                   reinterpret_cast<uintptr_t>(raw) % alignof(float) == 0;
+    if (inPlace) {
+        tensor.mapped = reinterpret_cast<const float*>(raw);
+        tensor.mapping = owner;
+        if (std::find(source.readInPlace.begin(), source.readInPlace.end(), owner) == source.readInPlace.end()) {
+            source.readInPlace.push_back(owner);
+        }
+    } else if (raw) {
+        if (!DecodeRaw(tensor.type, raw, rawSize, tensor.data)) {
+            error = "unsupported raw data of type " + std::to_string(static_cast<int>(tensor.type)) + " in tensor '" +
+                    tensor.name + "'";
+            return false;
+        }
+    } else if (!ints.empty() && (tensor.type == DataType::Float16 || tensor.type == DataType::BFloat16)) {
+        // 16-bit floats travel as their bit patterns
+        std::vector<uint16_t> bits(ints.begin(), ints.end());
+        tensor.data.resize(bits.size());
+        ConvertFromHalf(tensor.type == DataType::Float16 ? WeightPrecision::Float16 : WeightPrecision::BFloat16,
+                        bits.data(), tensor.data.data(), bits.size());
+    } else if (!ints.empty()) {
+        tensor.data.assign(ints.begin(), ints.end());
+    } else {
+        tensor.data = std::move(values);
+    }
+
+    if (expected < 0 || static_cast<size_t>(expected) != tensor.Count()) {
+        error = "tensor '" + tensor.name + "' has " + std::to_string(tensor.Count()) + " values for shape " +
+                FormatShape(tensor.dims);
+        return false;
+    }
+    return true;
+}
+
+bool ParseAttribute(ProtoReader reader, Attribute& attribute, TensorSource& source, std::string& error) {
+    uint32_t field, wire;
+    while (reader.Next(field, wire)) {
+        switch (field) {
+            case 1: attribute.name = reader.String(); break;
+            case 2: attribute.f = reader.Fixed32(); break;
+            case 3: attribute.i = static_cast<int64_t>(reader.Varint()); break;
+            case 4: attribute.s = reader.String(); break;
+            case 5:
+                if (!ParseTensor(reader.Bytes(), attribute.t, source, error)) {
+                    return false;
+                }
+                break;
+            case 7: reader.Floats(wire, attribute.floats); break;
+            case 8: reader.Int64s(wire, attribute.ints); break;
+            case 9: attribute.strings.push_back(reader.String()); break;
+            case 20: {
+                // AttributeProto.AttributeType
+                static const Attribute::Type TYPES[] = {
+                    Attribute::Type::Undefined, Attribute::Type::Float, Attribute::Type::Int,
+                    Attribute::Type::String, Attribute::Type::Tensor, Attribute::Type::Undefined,
+                    Attribute::Type::Floats, Attribute::Type::Ints, Attribute::Type::Strings};
+                uint64_t type = reader.Varint();
+                attribute.type = type < std::size(TYPES) ? TYPES[type] : Attribute::Type::Undefined;
+                break;
+            }
+            default: reader.Skip(wire); break;
+        }
+    }
+    if (reader.Failed()) {
+        error = "malformed attribute '" + attribute.name + "'";
+        return false;
+    }
+    return true;
+}
+
+bool ParseNode(ProtoReader reader, Node& node, TensorSource& source, std::string& error) {
+    uint32_t field, wire;
+    while (reader.Next(field, wire)) {
+        switch (field) {
+            case 1: node.inputs.push_back(reader.String()); break;
+            case 2: node.outputs.push_back(reader.String()); break;
+            case 3: node.name = reader.String(); break;
+            case 4: node.opType = reader.String(); break;
+            case 5:
+                node.attributes.emplace_back();
+                if (!ParseAttribute(reader.Bytes(), node.attributes.back(), source, error)) {
+                    return false;
+                }
+                break;
+            case 7: node.domain = reader.String(); break;
+            default: reader.Skip(wire); break;
+        }
+    }
+    if (reader.Failed()) {
+        error = "malformed node '" + node.name + "'";
+        return false;
+    }
+    return true;
+}
+
+// TypeProto.Tensor: elem_type and shape
+void ParseTensorType(ProtoReader reader, ValueInfo& info) {
+    uint32_t field, wire;
+    while (reader.Next(field, wire)) {
+        if (field == 1 && wire == VARINT) {
+            info.type = static_cast<DataType>(reader.Varint());
+        } else if (field == 2 && wire == BYTES) {
+            ProtoReader shape = reader.Bytes();
+            while (shape.Next(field, wire)) {
+                if (field != 1 || wire != BYTES) {
+                    shape.Skip(wire);
+                    continue;
+                }
+                // Dimension: dim_value, or a symbolic dim_param resolved at run time
+                int64_t dim = -1;
+                ProtoReader dimension = shape.Bytes();
+                while (dimension.Next(field, wire)) {
+                    if (field == 1 && wire == VARINT) {
+                        dim = static_cast<int64_t>(dimension.Varint());
+                    } else {
+                        dimension.Skip(wire);
+                    }
+                }
+                info.shape.push_back(dim);
+            }
+        } else {
+            reader.Skip(wire);
+        }
+    }
+}
+
+bool ParseValueInfo(ProtoReader reader, ValueInfo& info) {
+    uint32_t field, wire;
+    while (reader.Next(field, wire)) {
+        if (field == 1 && wire == BYTES) {
+            info.name = reader.String();
+        } else if (field == 2 && wire == BYTES) {
+            ProtoReader type = reader.Bytes();
+            while (type.Next(field, wire)) {
+                if (field == 1 && wire == BYTES) {
+                    ParseTensorType(type.Bytes(), info);
+                } else {
+                    type.Skip(wire);
+                }
+            }
+        } else {
+            reader.Skip(wire);
+        }
+    }
+    return !reader.Failed();
+}
+
+bool ParseGraph(ProtoReader reader, Graph& graph, TensorSource& source, std::string& error) {
+    std::vector<ValueInfo> inputs;
+    uint32_t field, wire;
+    while (reader.Next(field, wire)) {
+        switch (field) {
+            case 1:
+                graph.nodes.emplace_back();
+                if (!ParseNode(reader.Bytes(), graph.nodes.back(), source, error)) {
+                    return false;
+                }
+                break;
+            case 2: graph.name = reader.String(); break;
+            case 5:
+                graph.initializers.emplace_back();
+                if (!ParseTensor(reader.Bytes(), graph.initializers.back(), source, error)) {
+                    return false;
+                }
+                break;
+            case 11:
+                inputs.emplace_back();
+                if (!ParseValueInfo(reader.Bytes(), inputs.back())) {
+                    error = "malformed graph input";
+                    return false;
+                }
+                break;
+            case 12:
+                graph.outputs.emplace_back();
+                if (!ParseValueInfo(reader.Bytes(), graph.outputs.back())) {
+                    error = "malformed graph output";
+                    return false;
+                }
+                break;
+            case 15:
+                error = "sparse initializers are not supported";
+                return false;
+            default: reader.Skip(wire); break;
+        }
+    }
+    if (reader.Failed()) {
+        error = "malformed graph";
+        return false;
+    }
+
+    // Models before IR version 4 list every initializer as an input too
+    for (auto& input : inputs) {
+        if (!graph.FindInitializer(input.name)) {
+            graph.inputs.push_back(std::move(input));
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+const Attribute* Node::FindAttribute(const std::string& attribute) const {
+    for (const auto& candidate : attributes) {
+        if (candidate.name == attribute) {
+            return &candidate;
+        }
+    }
+    return nullptr;
+}
+
+int64_t Node::GetInt(const std::string& attribute, int64_t fallback) const {
+    const Attribute* found = FindAttribute(attribute);
+    return found ? found->i : fallback;
+}
+
+float Node::GetFloat(const std::string& attribute, float fallback) const {
+    const Attribute* found = FindAttribute(attribute);
+    return found ? found->f : fallback;
+}
+
+std::string Node::GetString(const std::string& attribute, const std::string& fallback) const {
+    const Attribute* found = FindAttribute(attribute);
+    return found ? found->s : fallback;
+}
+
+std::vector<int64_t> Node::GetInts(const std::string& attribute) const {
+    const Attribute* found = FindAttribute(attribute);
+    return found ? found->ints : std::vector<int64_t>();
+}
+
+const float* Initializer::Values() const {
+    return mapped ? mapped : data.data();
+}
+
+size_t Initializer::Count() const {
+    return mapped ? static_cast<size_t>(ElementCount(dims)) : data.size();
+}
+
+const Initializer* Graph::FindInitializer(const std::string& initializer) const {
+    for (const auto& candidate : initializers) {
+        if (candidate.name == initializer) {
+            return &candidate;
+        }
+    }
+    return nullptr;
+}
+
+int64_t ElementCount(const Shape& shape) {
+    int64_t count = 1;
+    for (int64_t dim : shape) {
+        if (dim < 0) {
+            return -1;
+        }
+        count *= dim;
+    }
+    return count;
+}
+
+std::string FormatShape(const Shape& shape) {
+    std::ostringstream out;
+    out << "[";
+    for (size_t i = 0; i < shape.size(); ++i) {
+        out << (i ? ", " : "");
+        if (shape[i] < 0) {
+            out << "?";
+        } else {
+            out << shape[i];
+        }
+    }
+    out << "]";
+    return out.str();
+}
+
+namespace {
+
+bool DecodeModel(const void* data, size_t size, Graph& graph, TensorSource& source, std::string& error) {
+    graph = Graph();
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    ProtoReader reader(bytes, bytes + size);
+    bool hasGraph = false;
+
+    uint32_t field, wire;
+    while (reader.Next(field, wire)) {
+        switch (field) {
+            case 1: graph.irVersion = static_cast<int64_t>(reader.Varint()); break;
+            case 2: graph.producerName = reader.String(); break;
+            case 3: graph.producerVersion = reader.String(); break;
+            case 4: graph.domain = reader.String(); break;
+            case 5: graph.modelVersion = static_cast<int64_t>(reader.Varint()); break;
+            case 6: graph.docString = reader.String(); break;
+            case 7:
+                if (!ParseGraph(reader.Bytes(), graph, source, error)) {
+                    return false;
+                }
+                hasGraph = true;
+                break;
+            case 8: {
+                // OperatorSetIdProto: only the default domain matters to the executor
+                ProtoReader opset = reader.Bytes();
+                std::string domain;
+                int64_t version = 0;
+                while (opset.Next(field, wire)) {
+                    if (field == 1 && wire == BYTES) {
+                        domain = opset.String();
+                    } else if (field == 2 && wire == VARINT) {
+                        version = static_cast<int64_t>(opset.Varint());
+                    } else {
+                        opset.Skip(wire);
+                    }
+                }
+                if (domain.empty() || domain == "ai.onnx") {
+                    graph.opsetVersion = version;
+                }
+                break;
+            }
+            default: reader.Skip(wire); break;
+        }
+        // A wire type that does not fit the field means this is not a ModelProto
+        if (reader.Failed()) {
+            break;
+        }
+    }
+
+    if (reader.Failed() || !hasGraph || graph.irVersion <= 0) {
+        error = "not a valid ONNX model";
+        return false;
+    }
+    return true;
+}
+
+bool DecodeModelFile(const std::string& path, bool inPlace, Graph& graph, std::string& error) {
+    TensorSource source;
+    source.model = MappedFile::Open(path);
+    if (!source.model) {
+        error = "cannot open " + path;
+        return false;
+    }
+    source.directory = std::filesystem::path(path).parent_path().string();
+    source.directory = source.directory.empty() ? "." : source.directory;
+    source.inPlace = inPlace;
+    if (!DecodeModel(source.model->GetData(), source.model->GetSize(), graph, source, error)) {
+        return false;
+    }
+    for (const auto& file : source.externalFiles) {
+        graph.externalData.push_back((std::filesystem::path(source.directory) / file.first).string());
+    }
+    graph.mappedFiles = source.readInPlace;
+    return true;
+}
+
+} // namespace
+
+bool ParseOnnxModel(const void* data, size_t size, Graph& graph, std::string& error) {
+    TensorSource source;
+    return DecodeModel(data, size, graph, source, error);
+}
+
+bool LoadOnnxModel(const std::string& path, Graph& graph, std::string& error) {
+    return DecodeModelFile(path, false, graph, error);
+}
+
+bool MapOnnxModel(const std::string& path, Graph& graph, std::string& error) {
+    return DecodeModelFile(path, true, graph, error);
+}
+
+bool CheckMappedFiles(const Graph& graph, std::string& error) {
+    for (const auto& file : graph.mappedFiles) {
+        if (!file->IsUnchanged()) {
+            error = "'" + file->GetPath() + "' was rewritten in place while its weights were mapped; "
+                    "replace model files by renaming a new file over them";
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace neural
+} // namespace gaia_matrix
@@ -0,0 +1,290 @@
+#include "gaia_matrix/neural_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define GAIA_NEURAL_X86 1
+#include <immintrin.h>
+#endif
+
+#if (defined(__aarch64__) || defined(_M_ARM64)) && defined(__ARM_FEATURE_DOTPROD)
+#define GAIA_NEURAL_NEON_DOT 1
+#include <arm_neon.h>
+#endif
+
+namespace gaia_matrix {
+namespace neural {
+
+namespace {
+
+constexpr int64_t MC = 120;
+constexpr int64_t MAX_TILE = 8 * 32;
+
+/**
+ * Computes raw int32 dot products of an MR x NR tile into `c` (row stride NR).
+ * `a` holds MR rows and `b` NR columns per group of four k, four bytes each.
+ * Kernels with a nonzero `aShift` read A as signed (a - aShift); the driver
+ * adds aShift * column sum back.
+ */
+using Int8KernelFn = void (*)(int64_t quads, const uint8_t* a, const int8_t* b, int32_t* c);
+
+struct Int8Kernel {
+    KernelIsa isa;
+    int64_t mr;
+    int64_t nr;
+    int32_t aShift;
+    Int8KernelFn run;
+};
+
+void Int8KernelScalar(int64_t quads, const uint8_t* a, const int8_t* b, int32_t* c) {
+    int32_t acc[4][4] = {};
+    for (int64_t q = 0; q < quads; ++q, a += 16, b += 16) {
+        for (int m = 0; m < 4; ++m) {
+            for (int n = 0; n < 4; ++n) {
+                for (int t = 0; t < 4; ++t) {
+                    acc[m][n] += static_cast<int32_t>(a[m * 4 + t]) * b[n * 4 + t];
+                }
+            }
+        }
+    }
+    std::memcpy(c, acc, sizeof(acc));
+}
+
+#if GAIA_NEURAL_X86
+
+// 4 x 8 with vpmaddwd on sign-extended 16-bit values: exact, unlike vpmaddubsw,
+// whose pairwise sums saturate for full-range weights
+__attribute__((target("avx2")))
+void Int8KernelAvx2(int64_t quads, const uint8_t* a, const int8_t* b, int32_t* c) {
+    __m256i acc[4][2];
+    for (int m = 0; m < 4; ++m) {
+        acc[m][0] = _mm256_setzero_si256();
+        acc[m][1] = _mm256_setzero_si256();
+    }
+    for (int64_t q = 0; q < quads; ++q, a += 16, b += 32) {
+        __m256i b0 = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b)));
+        __m256i b1 = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + 16)));
+        __m256i rows = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a)));
+        __m256i a0 = _mm256_permute4x64_epi64(rows, 0x00);
+        __m256i a1 = _mm256_permute4x64_epi64(rows, 0x55);
+        __m256i a2 = _mm256_permute4x64_epi64(rows, 0xAA);
+        __m256i a3 = _mm256_permute4x64_epi64(rows, 0xFF);
+        acc[0][0] = _mm256_add_epi32(acc[0][0], _mm256_madd_epi16(a0, b0));
+        acc[0][1] = _mm256_add_epi32(acc[0][1], _mm256_madd_epi16(a0, b1));
+        acc[1][0] = _mm256_add_epi32(acc[1][0], _mm256_madd_epi16(a1, b0));
+        acc[1][1] = _mm256_add_epi32(acc[1][1], _mm256_madd_epi16(a1, b1));
+        acc[2][0] = _mm256_add_epi32(acc[2][0], _mm256_madd_epi16(a2, b0));
+        acc[2][1] = _mm256_add_epi32(acc[2][1], _mm256_madd_epi16(a2, b1));
+        acc[3][0] = _mm256_add_epi32(acc[3][0], _mm256_madd_epi16(a3, b0));
+        acc[3][1] = _mm256_add_epi32(acc[3][1], _mm256_madd_epi16(a3, b1));
+    }
+    for (int m = 0; m < 4; ++m) {
+        // Each column has two partial sums in adjacent lanes
+        __m256i sums = _mm256_permute4x64_epi64(_mm256_hadd_epi32(acc[m][0], acc[m][1]), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(c + m * 8), sums);
+    }
+}
+
+// 8 x 32 with vpdpbusd: four u8 x s8 products per lane straight into int32
+__attribute__((target("avx512f,avx512vnni")))
+void Int8KernelVnni(int64_t quads, const uint8_t* a, const int8_t* b, int32_t* c) {
+    __m512i acc[8][2];
+    for (int m = 0; m < 8; ++m) {
+        acc[m][0] = _mm512_setzero_si512();
+        acc[m][1] = _mm512_setzero_si512();
+    }
+    for (int64_t q = 0; q < quads; ++q, a += 32, b += 128) {
+        __m512i b0 = _mm512_loadu_si512(b);
+        __m512i b1 = _mm512_loadu_si512(b + 64);
+        for (int m = 0; m < 8; ++m) {
+            int32_t packed;
+            std::memcpy(&packed, a + m * 4, 4);
+            __m512i am = _mm512_set1_epi32(packed);
+            acc[m][0] = _mm512_dpbusd_epi32(acc[m][0], am, b0);
+            acc[m][1] = _mm512_dpbusd_epi32(acc[m][1], am, b1);
+        }
+    }
+    for (int m = 0; m < 8; ++m) {
+        _mm512_storeu_si512(c + m * 32, acc[m][0]);
+        _mm512_storeu_si512(c + m * 32 + 16, acc[m][1]);
+    }
+}
+
+#endif
+
+#if GAIA_NEURAL_NEON_DOT
+
+// 4 x 8 with sdot; A is flipped to signed, so the driver adds 128 * column sum
+void Int8KernelNeonDot(int64_t quads, const uint8_t* a, const int8_t* b, int32_t* c) {
+    int32x4_t acc[4][2];
+    for (int m = 0; m < 4; ++m) {
+        acc[m][0] = vdupq_n_s32(0);
+        acc[m][1] = vdupq_n_s32(0);
+    }
+    const uint8x16_t flip = vdupq_n_u8(0x80);
+    for (int64_t q = 0; q < quads; ++q, a += 16, b += 32) {
+        int8x16_t rows = vreinterpretq_s8_u8(veorq_u8(vld1q_u8(a), flip));
+        int8x16_t b0 = vld1q_s8(b);
+        int8x16_t b1 = vld1q_s8(b + 16);
+        acc[0][0] = vdotq_laneq_s32(acc[0][0], b0, rows, 0);
+        acc[0][1] = vdotq_laneq_s32(acc[0][1], b1, rows, 0);
+        acc[1][0] = vdotq_laneq_s32(acc[1][0], b0, rows, 1);
+        acc[1][1] = vdotq_laneq_s32(acc[1][1], b1, rows, 1);
+        acc[2][0] = vdotq_laneq_s32(acc[2][0], b0, rows, 2);
+        acc[2][1] = vdotq_laneq_s32(acc[2][1], b1, rows, 2);
+        acc[3][0] = vdotq_laneq_s32(acc[3][0], b0, rows, 3);
+        acc[3][1] = vdotq_laneq_s32(acc[3][1], b1, rows, 3);
+    }
+    for (int m = 0; m < 4; ++m) {
+        vst1q_s32(c + m * 8, acc[m][0]);
+        vst1q_s32(c + m * 8 + 4, acc[m][1]);
+    }
+}
+
+#endif
+
+const Int8Kernel INT8_KERNELS[] = {
+    {KernelIsa::Scalar, 4, 4, 0, Int8KernelScalar},
+#if GAIA_NEURAL_NEON_DOT
+    {KernelIsa::Neon, 4, 8, 128, Int8KernelNeonDot},
+#endif
+#if GAIA_NEURAL_X86
+    {KernelIsa::Avx2, 4, 8, 0, Int8KernelAvx2},
+    {KernelIsa::Avx512, 8, 32, 0, Int8KernelVnni},
+#endif
+};
+
+// Int8 kernel for the active instruction set; AVX-512 without VNNI uses the AVX2 kernel
+int SelectInt8Kernel() {
+    KernelIsa isa = GetKernelIsa();
+#if GAIA_NEURAL_X86
+    if (isa == KernelIsa::Avx512 && !__builtin_cpu_supports("avx512vnni")) {
+        isa = KernelIsa::Avx2;
+    }
+#endif
+    for (size_t i = 0; i < sizeof(INT8_KERNELS) / sizeof(INT8_KERNELS[0]); ++i) {
+        if (INT8_KERNELS[i].isa == isa) {
+            return static_cast<int>(i);
+        }
+    }
+    return 0;
+}
+
+int64_t RoundUp(int64_t value, int64_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+// MR-row panels of A[row0 .. row0+mc, :], four k per row per group, zero-padded
+void PackA(const uint8_t* A, int64_t lda, int64_t row0, int64_t mc, int64_t K, int64_t mr, uint8_t* dst,
+           int32_t* rowSums) {
+    int64_t quads = RoundUp(K, 4) / 4;
+    for (int64_t panel = 0; panel < mc; panel += mr) {
+        int64_t rows = std::min(mr, mc - panel);
+        for (int64_t q = 0; q < quads; ++q) {
+            for (int64_t i = 0; i < mr; ++i) {
+                const uint8_t* row = A + (row0 + panel + i) * lda;
+                for (int64_t t = 0; t < 4; ++t) {
+                    int64_t k = q * 4 + t;
+                    *dst++ = i < rows && k < K ? row[k] : 0;
+                }
+            }
+        }
+    }
+    for (int64_t i = 0; i < mc; ++i) {
+        const uint8_t* row = A + (row0 + i) * lda;
+        int32_t sum = 0;
+        for (int64_t k = 0; k < K; ++k) {
+            sum += row[k];
+        }
+        rowSums[i] = sum;
+    }
+}
+
+} // namespace
+
+KernelIsa PackedMatrixInt8::GetIsa() const {
+    return INT8_KERNELS[m_Kernel].isa;
+}
+
+void PackedMatrixInt8::Pack(bool trans, int64_t K, int64_t N, const int8_t* data, int64_t ld,
+                            const int32_t* zeroPoints) {
+    m_K = K;
+    m_N = N;
+    m_Kernel = SelectInt8Kernel();
+    int64_t nr = INT8_KERNELS[m_Kernel].nr;
+    int64_t quads = RoundUp(K, 4) / 4;
+    m_Data.assign(static_cast<size_t>(RoundUp(N, nr) * quads * 4), 0);
+    m_ColumnSums.assign(static_cast<size_t>(N), 0);
+
+    int8_t* dst = m_Data.data();
+    for (int64_t panel = 0; panel < N; panel += nr) {
+        for (int64_t q = 0; q < quads; ++q) {
+            for (int64_t j = 0; j < nr; ++j, dst += 4) {
+                int64_t n = panel + j;
+                for (int64_t t = 0; t < 4 && n < N; ++t) {
+                    int64_t k = q * 4 + t;
+                    if (k < K) {
+                        dst[t] = trans ? data[n * ld + k] : data[k * ld + n];
+                        m_ColumnSums[n] += dst[t];
+                    }
+                }
+            }
+        }
+    }
+
+    m_ZeroPoints.clear();
+    if (zeroPoints && std::any_of(zeroPoints, zeroPoints + N, [](int32_t z) { return z != 0; })) {
+        m_ZeroPoints.assign(zeroPoints, zeroPoints + N);
+    }
+}
+
+void QGemm(int64_t M, const uint8_t* A, int64_t lda, int32_t aZeroPoint, const PackedMatrixInt8& B, const float* scale,
+           const float* offset, bool quantize, float minimum, float maximum, float* C, int64_t ldc) {
+    const Int8Kernel& kernel = INT8_KERNELS[B.m_Kernel];
+    const int64_t K = B.m_K;
+    const int64_t N = B.m_N;
+    const int64_t quads = RoundUp(K, 4) / 4;
+    const int64_t mr = kernel.mr;
+    const int64_t nr = kernel.nr;
+    if (M <= 0 || N <= 0) {
+        return;
+    }
+
+    thread_local std::vector<uint8_t> packA;
+    thread_local std::vector<int32_t> rowSums;
+    packA.resize(static_cast<size_t>(MC * quads * 4));
+    rowSums.resize(static_cast<size_t>(MC));
+
+    alignas(64) int32_t tile[MAX_TILE];
+    for (int64_t ic = 0; ic < M; ic += MC) {
+        int64_t mc = std::min(MC, M - ic);
+        PackA(A, lda, ic, mc, K, mr, packA.data(), rowSums.data());
+
+        for (int64_t jr = 0; jr < N; jr += nr) {
+            int64_t cols = std::min(nr, N - jr);
+            for (int64_t ir = 0; ir < mc; ir += mr) {
+                int64_t rows = std::min(mr, mc - ir);
+                kernel.run(quads, packA.data() + ir * quads * 4, B.m_Data.data() + jr * quads * 4, tile);
+
+                // Sum (a - za)(b - zb) = sum ab - za sum b - zb (sum a - K za)
+                for (int64_t i = 0; i < rows; ++i) {
+                    float* out = C + (ic + ir + i) * ldc + jr;
+                    int32_t rowTerm = rowSums[ir + i] - static_cast<int32_t>(K) * aZeroPoint;
+                    for (int64_t j = 0; j < cols; ++j) {
+                        int64_t n = jr + j;
+                        int32_t acc = tile[i * nr + j] + (kernel.aShift - aZeroPoint) * B.m_ColumnSums[n];
+                        if (!B.m_ZeroPoints.empty()) {
+                            acc -= B.m_ZeroPoints[n] * rowTerm;
+                        }
+                        float value = static_cast<float>(acc) * scale[n] + (offset ? offset[n] : 0.0f);
+                        out[j] = quantize ? std::min(std::max(std::nearbyint(value), minimum), maximum) : value;
+                    }
+                }
+            }
+        }
+    }
+}
+
+} // namespace neural
+} // namespace gaia_matrix
@@ -0,0 +1,192 @@
+#include "gaia_matrix/neural_quantize.h"
+#include "gaia_matrix/neural_executor.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace gaia_matrix {
+namespace neural {
+
+namespace {
+
+// Observed range of an activation, widened to include 0 so zero is exact
+struct Range {
+    float minimum = 0.0f;
+    float maximum = 0.0f;
+};
+
+Node MakeNode(const std::string& opType, const std::string& name, std::vector<std::string> inputs,
+              const std::string& output) {
+    Node node;
+    node.opType = opType;
+    node.name = name;
+    node.inputs = std::move(inputs);
+    node.outputs = {output};
+    return node;
+}
+
+Initializer MakeInitializer(const std::string& name, DataType type, Shape dims, std::vector<float> data) {
+    Initializer initializer;
+    initializer.name = name;
+    initializer.type = type;
+    initializer.dims = std::move(dims);
+    initializer.data = std::move(data);
+    return initializer;
+}
+
+// Axis of the weights that runs along the output channels, or -1 if the node stays in fp32
+int64_t WeightAxis(const Node& node, const Initializer& weights) {
+    if (weights.type != DataType::Float32) {
+        return -1;
+    }
+    if (node.opType == "Conv") {
+        return weights.dims.size() >= 3 ? 0 : -1;
+    }
+    if (weights.dims.size() != 2) {
+        return -1;
+    }
+    if (node.opType == "MatMul") {
+        return 1;
+    }
+    if (node.opType == "Gemm" && node.GetInt("transA", 0) == 0) {
+        return node.GetInt("transB", 0) != 0 ? 0 : 1;
+    }
+    return -1;
+}
+
+} // namespace
+
+bool QuantizeGraph(const Graph& graph, const std::vector<CalibrationSample>& samples, Graph& quantized,
+                   std::string& error) {
+    if (samples.empty()) {
+        error = "no calibration samples";
+        return false;
+    }
+
+    // Calibrate: run the float graph and record the range of every value
+    auto source = std::make_shared<Graph>(graph);
+    GraphExecutor executor;
+    executor.SetFusion(false);      // Every node output needs a range, including those fusion skips
+    std::vector<std::string> errors;
+    if (!executor.Prepare(source, errors)) {
+        error = errors.empty() ? "graph cannot run" : errors.front();
+        return false;
+    }
+    std::unordered_map<std::string, Range> ranges;
+    executor.SetObserver([&ranges](const std::string& name, const float* data, const Shape& shape) {
+        Range& range = ranges[name];
+        int64_t count = ElementCount(shape);
+        if (count > 0) {
+            auto [low, high] = std::minmax_element(data, data + count);
+            range.minimum = std::min(range.minimum, *low);
+            range.maximum = std::max(range.maximum, *high);
+        }
+    });
+    std::vector<std::vector<float>> outputs;
+    std::vector<Shape> outputShapes;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        std::vector<const float*> inputs;
+        for (const auto& input : samples[i].inputs) {
+            inputs.push_back(input.data());
+        }
+        if (!executor.Run(inputs, samples[i].shapes, outputs, outputShapes, error)) {
+            error = "calibration sample " + std::to_string(i) + ": " + error;
+            return false;
+        }
+    }
+
+    quantized = graph;
+    quantized.nodes.clear();
+    std::unordered_set<std::string> activations;                // Already followed by Q/DQ
+    std::unordered_map<std::string, int64_t> weightAxes;        // Replaced float weights and their channel axis
+    for (const Node& node : graph.nodes) {
+        bool candidate = node.opType == "Gemm" || node.opType == "MatMul" || node.opType == "Conv";
+        const Initializer* weights = candidate && node.inputs.size() > 1 ? graph.FindInitializer(node.inputs[1])
+                                                                         : nullptr;
+        int64_t axis = weights ? WeightAxis(node, *weights) : -1;
+        auto range = axis >= 0 ? ranges.find(node.inputs[0]) : ranges.end();
+        auto known = weights ? weightAxes.find(weights->name) : weightAxes.end();
+        if (range == ranges.end() || (known != weightAxes.end() && known->second != axis)) {
+            quantized.nodes.push_back(node);
+            continue;
+        }
+
+        // Activation: per-tensor asymmetric uint8 over the calibrated range
+        const std::string& x = node.inputs[0];
+        if (activations.insert(x).second) {
+            float scale = (range->second.maximum - range->second.minimum) / 255.0f;
+            scale = scale > 0.0f ? scale : 1.0f;
+            float zeroPoint = std::clamp(std::nearbyint(-range->second.minimum / scale), 0.0f, 255.0f);
+            quantized.initializers.push_back(MakeInitializer(x + "_scale", DataType::Float32, {}, {scale}));
+            quantized.initializers.push_back(MakeInitializer(x + "_zero_point", DataType::Uint8, {}, {zeroPoint}));
+            quantized.nodes.push_back(MakeNode("QuantizeLinear", x + "_QuantizeLinear",
+                                               {x, x + "_scale", x + "_zero_point"}, x + "_quantized"));
+            quantized.nodes.push_back(MakeNode("DequantizeLinear", x + "_DequantizeLinear",
+                                               {x + "_quantized", x + "_scale", x + "_zero_point"},
+                                               x + "_dequantized"));
+        }
+
+        // Weights: per-channel symmetric int8, so every weight zero point is 0
+        const std::string& w = weights->name;
+        if (known == weightAxes.end()) {
+            weightAxes.emplace(w, axis);
+            int64_t channels = weights->dims[axis];
+            int64_t inner = 1;
+            for (size_t d = static_cast<size_t>(axis) + 1; d < weights->dims.size(); ++d) {
+                inner *= weights->dims[d];
+            }
+            const float* floats = weights->Values();
+            std::vector<float> scales(static_cast<size_t>(channels), 0.0f);
+            for (size_t i = 0; i < weights->Count(); ++i) {
+                float& peak = scales[(static_cast<int64_t>(i) / inner) % channels];
+                peak = std::max(peak, std::fabs(floats[i]));
+            }
+            std::transform(scales.begin(), scales.end(), scales.begin(),
+                           [](float peak) { return peak > 0.0f ? peak / 127.0f : 1.0f; });
+            std::vector<float> values(weights->Count());
+            for (size_t i = 0; i < values.size(); ++i) {
+                float scale = scales[(static_cast<int64_t>(i) / inner) % channels];
+                values[i] = std::clamp(std::nearbyint(floats[i] / scale), -127.0f, 127.0f);
+            }
+            quantized.initializers.push_back(
+                MakeInitializer(w + "_quantized", DataType::Int8, weights->dims, std::move(values)));
+            quantized.initializers.push_back(MakeInitializer(w + "_scale", DataType::Float32, {channels}, scales));
+            quantized.initializers.push_back(MakeInitializer(
+                w + "_zero_point", DataType::Int8, {channels}, std::vector<float>(static_cast<size_t>(channels), 0.0f)));
+            Node dequantize = MakeNode("DequantizeLinear", w + "_DequantizeLinear",
+                                       {w + "_quantized", w + "_scale", w + "_zero_point"}, w + "_dequantized");
+            Attribute attribute;
+            attribute.name = "axis";
+            attribute.type = Attribute::Type::Int;
+            attribute.i = axis;
+            dequantize.attributes.push_back(attribute);
+            quantized.nodes.push_back(std::move(dequantize));
+        }
+
+        Node rewritten = node;
+        rewritten.inputs[0] = x + "_dequantized";
+        rewritten.inputs[1] = w + "_dequantized";
+        quantized.nodes.push_back(std::move(rewritten));
+    }
+
+    // The float copies of replaced weights are dropped unless something else still reads them
+    std::unordered_set<std::string> used;
+    for (const Node& node : quantized.nodes) {
+        used.insert(node.inputs.begin(), node.inputs.end());
+    }
+    for (const ValueInfo& output : quantized.outputs) {
+        used.insert(output.name);
+    }
+    auto& initializers = quantized.initializers;
+    initializers.erase(std::remove_if(initializers.begin(), initializers.end(),
+                                      [&](const Initializer& initializer) {
+                                          return weightAxes.count(initializer.name) && !used.count(initializer.name);
+                                      }),
+                       initializers.end());
+    return true;
+}
+
+} // namespace neural
+} // namespace gaia_matrix
@@ -0,0 +1,263 @@
+#include "gaia_matrix/neural_tensor.h"
+#include "gaia_matrix/neural_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace gaia_matrix {
+namespace neural {
+
+namespace {
+
+bool IsHalf(DataType type) {
+    return type == DataType::Float16 || type == DataType::BFloat16;
+}
+
+WeightPrecision HalfPrecision(DataType type) {
+    return type == DataType::BFloat16 ? WeightPrecision::BFloat16 : WeightPrecision::Float16;
+}
+
+template <typename T>
+T LoadAs(const uint8_t* bytes) {
+    T value;
+    std::memcpy(&value, bytes, sizeof(T));
+    return value;
+}
+
+// Round to nearest and saturate to the range of T
+template <typename T>
+void StoreInteger(float value, uint8_t* bytes) {
+    double rounded = std::nearbyint(static_cast<double>(value));
+    T result = 0;
+    if (rounded >= static_cast<double>(std::numeric_limits<T>::max())) {
+        result = std::numeric_limits<T>::max();
+    } else if (rounded <= static_cast<double>(std::numeric_limits<T>::lowest())) {
+        result = std::numeric_limits<T>::lowest();
+    } else if (!std::isnan(rounded)) {
+        result = static_cast<T>(rounded);
+    }
+    std::memcpy(bytes, &result, sizeof(T));
+}
+
+float Load(DataType type, const uint8_t* bytes) {
+    switch (type) {
+        case DataType::Float32: return LoadAs<float>(bytes);
+        case DataType::Float64: return static_cast<float>(LoadAs<double>(bytes));
+        case DataType::Int8: return LoadAs<int8_t>(bytes);
+        case DataType::Uint8: return LoadAs<uint8_t>(bytes);
+        case DataType::Bool: return LoadAs<uint8_t>(bytes) != 0 ? 1.0f : 0.0f;
+        case DataType::Int32: return static_cast<float>(LoadAs<int32_t>(bytes));
+        case DataType::Int64: return static_cast<float>(LoadAs<int64_t>(bytes));
+        case DataType::Float16:
+        case DataType::BFloat16: {
+            uint16_t half = LoadAs<uint16_t>(bytes);
+            float value;
+            ConvertFromHalf(HalfPrecision(type), &half, &value, 1);
+            return value;
+        }
+        default: return 0.0f;
+    }
+}
+
+void Store(DataType type, float value, uint8_t* bytes) {
+    switch (type) {
+        case DataType::Float32: std::memcpy(bytes, &value, sizeof(float)); break;
+        case DataType::Float64: {
+            double wide = value;
+            std::memcpy(bytes, &wide, sizeof(double));
+            break;
+        }
+        case DataType::Int8: StoreInteger<int8_t>(value, bytes); break;
+        case DataType::Uint8: StoreInteger<uint8_t>(value, bytes); break;
+        case DataType::Bool: *bytes = value != 0.0f ? 1 : 0; break;
+        case DataType::Int32: StoreInteger<int32_t>(value, bytes); break;
+        case DataType::Int64: StoreInteger<int64_t>(value, bytes); break;
+        case DataType::Float16:
+        case DataType::BFloat16: {
+            uint16_t half;
+            ConvertToHalf(HalfPrecision(type), &value, &half, 1);
+            std::memcpy(bytes, &half, sizeof(uint16_t));
+            break;
+        }
+        default: break;
+    }
+}
+
+/**
+ * Call row(offset, stride, length, dense) for each run along the innermost
+ * dimension: the view's element offset and stride, the run's length and its
+ * offset in row-major order.
+ */
+template <typename RowFunction>
+bool ForEachRow(const TensorView& view, RowFunction row) {
+    int64_t count = view.Count();
+    if (!view.data || DataTypeSize(view.type) == 0 || count < 0 ||
+        (!view.strides.empty() && view.strides.size() != view.shape.size())) {
+        return false;
+    }
+    if (count == 0) {
+        return true;
+    }
+    if (view.shape.empty()) {
+        row(0, 1, 1, 0);
+        return true;
+    }
+
+    size_t rank = view.shape.size();
+    Shape strides = view.strides;
+    if (strides.empty()) {
+        strides.assign(rank, 1);
+        for (size_t d = rank - 1; d > 0; --d) {
+            strides[d - 1] = strides[d] * view.shape[d];
+        }
+    }
+    int64_t length = view.shape.back();
+    std::vector<int64_t> index(rank - 1, 0);
+    for (int64_t dense = 0; dense < count; dense += length) {
+        int64_t offset = 0;
+        for (size_t d = 0; d + 1 < rank; ++d) {
+            offset += index[d] * strides[d];
+        }
+        row(offset, strides.back(), length, dense);
+        for (size_t d = rank - 1; d-- > 0;) {
+            if (++index[d] < view.shape[d]) {
+                break;
+            }
+            index[d] = 0;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+size_t DataTypeSize(DataType type) {
+    switch (type) {
+        case DataType::Int8:
+        case DataType::Uint8:
+        case DataType::Bool: return 1;
+        case DataType::Float16:
+        case DataType::BFloat16: return 2;
+        case DataType::Float32:
+        case DataType::Int32: return 4;
+        case DataType::Float64:
+        case DataType::Int64: return 8;
+        default: return 0;
+    }
+}
+
+TensorView::TensorView(float* data, Shape shape, std::string name)
+    : data(data), shape(std::move(shape)), name(std::move(name)) {}
+
+TensorView::TensorView(const float* data, Shape shape, std::string name)
+    : data(const_cast<float*>(data)), shape(std::move(shape)), name(std::move(name)) {}
+
+TensorView::TensorView(void* data, DataType type, Shape shape, Shape strides, std::string name)
+    : data(data), type(type), shape(std::move(shape)), strides(std::move(strides)), name(std::move(name)) {}
+
+int64_t TensorView::Count() const {
+    return ElementCount(shape);
+}
+
+bool TensorView::IsContiguous() const {
+    if (strides.empty()) {
+        return true;
+    }
+    if (strides.size() != shape.size()) {
+        return false;
+    }
+    // Dimensions of size 1 are never stepped over, so their stride does not matter
+    int64_t expected = 1;
+    for (size_t d = shape.size(); d-- > 0;) {
+        if (shape[d] != 1 && strides[d] != expected) {
+            return false;
+        }
+        expected *= shape[d];
+    }
+    return true;
+}
+
+bool TensorView::IsAligned() const {
+    return reinterpret_cast<uintptr_t>(data) % TENSOR_ALIGNMENT == 0;
+}
+
+Tensor::Tensor(DataType type, Shape shape, std::string name) : m_Type(type), m_Name(std::move(name)) {
+    Resize(std::move(shape));
+}
+
+Tensor::Tensor(Tensor&& other) noexcept
+    : m_Type(other.m_Type), m_Shape(std::move(other.m_Shape)), m_Name(std::move(other.m_Name)),
+      m_Storage(std::move(other.m_Storage)), m_Data(other.m_Data), m_Bytes(other.m_Bytes) {
+    other.m_Data = nullptr;
+    other.m_Bytes = 0;
+}
+
+Tensor& Tensor::operator=(Tensor&& other) noexcept {
+    if (this != &other) {
+        m_Type = other.m_Type;
+        m_Shape = std::move(other.m_Shape);
+        m_Name = std::move(other.m_Name);
+        m_Storage = std::move(other.m_Storage);
+        m_Data = other.m_Data;
+        m_Bytes = other.m_Bytes;
+        other.m_Data = nullptr;
+        other.m_Bytes = 0;
+    }
+    return *this;
+}
+
+void Tensor::Resize(Shape shape) {
+    m_Shape = std::move(shape);
+    m_Bytes = static_cast<size_t>(std::max<int64_t>(ElementCount(m_Shape), 0)) * DataTypeSize(m_Type);
+    // Over-allocate by one alignment step and start at the first aligned byte, as the executor's arena does
+    if (m_Storage.size() < m_Bytes + TENSOR_ALIGNMENT) {
+        m_Storage.assign(m_Bytes + TENSOR_ALIGNMENT, 0);
+    }
+    auto address = reinterpret_cast<uintptr_t>(m_Storage.data());
+    m_Data = m_Storage.data() + (TENSOR_ALIGNMENT - address % TENSOR_ALIGNMENT) % TENSOR_ALIGNMENT;
+}
+
+TensorView Tensor::View() {
+    return TensorView(m_Data, m_Type, m_Shape, {}, m_Name);
+}
+
+bool ReadTensor(const TensorView& view, float* dst) {
+    const auto* base = static_cast<const uint8_t*>(view.data);
+    size_t size = DataTypeSize(view.type);
+    return ForEachRow(view, [&](int64_t offset, int64_t stride, int64_t length, int64_t dense) {
+        const uint8_t* src = base + offset * static_cast<int64_t>(size);
+        float* out = dst + dense;
+        if (stride == 1 && view.type == DataType::Float32) {
+            std::memcpy(out, src, static_cast<size_t>(length) * sizeof(float));
+        } else if (stride == 1 && IsHalf(view.type)) {
+            ConvertFromHalf(HalfPrecision(view.type), reinterpret_cast<const uint16_t*>(src), out,
+                            static_cast<size_t>(length));
+        } else {
+            for (int64_t i = 0; i < length; ++i) {
+                out[i] = Load(view.type, src + i * stride * static_cast<int64_t>(size));
+            }
+        }
+    });
+}
+
+bool WriteTensor(const float* src, const TensorView& view) {
+    auto* base = static_cast<uint8_t*>(view.data);
+    size_t size = DataTypeSize(view.type);
+    return ForEachRow(view, [&](int64_t offset, int64_t stride, int64_t length, int64_t dense) {
+        uint8_t* dst = base + offset * static_cast<int64_t>(size);
+        const float* in = src + dense;
+        if (stride == 1 && view.type == DataType::Float32) {
+            std::memcpy(dst, in, static_cast<size_t>(length) * sizeof(float));
+        } else if (stride == 1 && IsHalf(view.type)) {
+            ConvertToHalf(HalfPrecision(view.type), in, reinterpret_cast<uint16_t*>(dst), static_cast<size_t>(length));
+        } else {
+            for (int64_t i = 0; i < length; ++i) {
+                Store(view.type, in[i], dst + i * stride * static_cast<int64_t>(size));
+            }
+        }
+    });
+}
+
+} // namespace neural
+} // namespace gaia_matrix
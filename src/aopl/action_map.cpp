@@ -0,0 +1,185 @@
+#include "gaia_matrix/aopl_runtime.h"
+#include <algorithm>
+#include <sstream>
+
+namespace gaia_matrix {
+namespace aopl {
+
+namespace {
+
+const char* DEVICE_NAMES[INPUT_DEVICE_COUNT] = {"Keyboard", "Mouse", "Gamepad"};
+
+int CountTrailingZeros(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(value);
+#else
+    int count = 0;
+    while (!(value & 1)) {
+        value >>= 1;
+        ++count;
+    }
+    return count;
+#endif
+}
+
+bool InRange(int code) {
+    return code >= 0 && code < static_cast<int>(INPUT_CODE_COUNT);
+}
+
+// Key name if the code has one, otherwise the number
+std::string FormatKey(int code) {
+    if ((code >= 'A' && code <= 'Z') || (code >= '0' && code <= '9')) {
+        return std::string(1, static_cast<char>(code));
+    }
+    for (const char* name : {"Tab", "Enter", "Shift", "Ctrl", "Alt", "Escape", "Space", "Left", "Up", "Right", "Down"}) {
+        if (LookupKeyCode(name) == code) {
+            return name;
+        }
+    }
+    // A single digit would read back as a digit key
+    return (code < 10 ? "0" : "") + std::to_string(code);
+}
+
+// Key name or plain number; single digits are keys, so unnamed codes below 10 are written "05"
+int ParseCode(const std::string& token, bool keyNames) {
+    if (keyNames) {
+        int code = LookupKeyCode(token);
+        if (code >= 0 || token.size() == 1) {
+            return code;
+        }
+    }
+    if (token.empty() || token.find_first_not_of("0123456789") != std::string::npos || token.size() > 3) {
+        return -1;
+    }
+    int code = std::stoi(token);
+    return InRange(code) ? code : -1;
+}
+
+} // namespace
+
+int LookupInputDevice(const std::string& name) {
+    for (uint32_t device = 0; device < INPUT_DEVICE_COUNT; ++device) {
+        if (name == DEVICE_NAMES[device]) {
+            return static_cast<int>(device);
+        }
+    }
+    return -1;
+}
+
+ActionMap::ActionMap() : m_Table(INPUT_DEVICE_COUNT * INPUT_CODE_COUNT) {
+    Reset();
+}
+
+bool ActionMap::Bind(int action, InputDevice device, int code) {
+    auto index = static_cast<uint32_t>(device);
+    if (!InRange(action) || !InRange(code) || index >= INPUT_DEVICE_COUNT) {
+        return false;
+    }
+    m_Table[index * INPUT_CODE_COUNT + code][action >> 6] |= uint64_t(1) << (action & 63);
+    return true;
+}
+
+void ActionMap::Unbind(InputDevice device, int code) {
+    auto index = static_cast<uint32_t>(device);
+    if (InRange(code) && index < INPUT_DEVICE_COUNT) {
+        m_Table[index * INPUT_CODE_COUNT + code] = {0, 0, 0, 0};
+    }
+}
+
+void ActionMap::ClearAction(int action) {
+    if (!InRange(action)) {
+        return;
+    }
+    uint64_t mask = ~(uint64_t(1) << (action & 63));
+    for (auto& row : m_Table) {
+        row[action >> 6] &= mask;
+    }
+}
+
+void ActionMap::Clear() {
+    std::fill(m_Table.begin(), m_Table.end(), std::array<uint64_t, 4>{0, 0, 0, 0});
+}
+
+void ActionMap::Reset() {
+    Clear();
+    for (int code = 0; code < static_cast<int>(INPUT_CODE_COUNT); ++code) {
+        Bind(code, InputDevice::Keyboard, code);
+    }
+}
+
+std::vector<std::pair<InputDevice, int>> ActionMap::GetBindings(int action) const {
+    std::vector<std::pair<InputDevice, int>> bindings;
+    if (!InRange(action)) {
+        return bindings;
+    }
+    for (uint32_t row = 0; row < m_Table.size(); ++row) {
+        if ((m_Table[row][action >> 6] >> (action & 63)) & 1) {
+            bindings.emplace_back(static_cast<InputDevice>(row / INPUT_CODE_COUNT),
+                                  static_cast<int>(row % INPUT_CODE_COUNT));
+        }
+    }
+    return bindings;
+}
+
+bool ActionMap::LoadLayout(const std::string& text, std::vector<std::string>& errors) {
+    Clear();
+    std::istringstream lines(text);
+    std::string line;
+    size_t errorCount = errors.size();
+    for (int number = 1; std::getline(lines, line); ++number) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream tokens(line);
+        std::string action, equals, device, button, extra;
+        if (!(tokens >> action)) {
+            continue;
+        }
+
+        tokens >> equals >> device >> button;
+        int deviceIndex = LookupInputDevice(device);
+        int actionCode = ParseCode(action, true);
+        int code = deviceIndex >= 0 ? ParseCode(button, deviceIndex == static_cast<int>(InputDevice::Keyboard)) : -1;
+        std::string prefix = "layout line " + std::to_string(number) + ": ";
+        if (equals != "=" || button.empty() || (tokens >> extra)) {
+            errors.push_back(prefix + "expected '<Action> = <Device> <Button>'");
+        } else if (actionCode < 0) {
+            errors.push_back(prefix + "unknown action '" + action + "'");
+        } else if (deviceIndex < 0) {
+            errors.push_back(prefix + "unknown device '" + device + "'");
+        } else if (code < 0) {
+            errors.push_back(prefix + "unknown button '" + button + "'");
+        } else {
+            Bind(actionCode, static_cast<InputDevice>(deviceIndex), code);
+        }
+    }
+    return errors.size() == errorCount;
+}
+
+std::string ActionMap::SaveLayout() const {
+    std::ostringstream out;
+    for (int action = 0; action < static_cast<int>(INPUT_CODE_COUNT); ++action) {
+        for (const auto& [device, code] : GetBindings(action)) {
+            out << FormatKey(action) << " = " << DEVICE_NAMES[static_cast<uint32_t>(device)] << " "
+                << (device == InputDevice::Keyboard ? FormatKey(code) : std::to_string(code)) << "\n";
+        }
+    }
+    return out.str();
+}
+
+void ActionMap::Resolve(const std::array<InputState, INPUT_DEVICE_COUNT>& devices, InputState& actions) const {
+    actions.keys = {0, 0, 0, 0};
+    for (uint32_t device = 0; device < INPUT_DEVICE_COUNT; ++device) {
+        const auto* rows = m_Table.data() + device * INPUT_CODE_COUNT;
+        for (uint32_t word = 0; word < 4; ++word) {
+            // Only held buttons cost anything
+            for (uint64_t held = devices[device].keys[word]; held; held &= held - 1) {
+                const auto& row = rows[word * 64 + CountTrailingZeros(held)];
+                for (uint32_t i = 0; i < 4; ++i) {
+                    actions.keys[i] |= row[i];
+                }
+            }
+        }
+    }
+}
+
+} // namespace aopl
+} // namespace gaia_matrix
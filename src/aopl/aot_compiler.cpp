@@ -0,0 +1,349 @@
+#include "gaia_matrix/aopl_aot.h"
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <dlfcn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace gaia_matrix {
+namespace aopl {
+
+namespace {
+
+// Hex float literal so generated constants round-trip exactly
+std::string FloatLiteral(float value) {
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%af", static_cast<double>(value));
+    return buffer;
+}
+
+/**
+ * Accessor name for a slot path. The s_ prefix keeps slot names clear of C++
+ * keywords and of EntityView's own members; '.' becomes '_', and '_', 'X'
+ * and any other byte that cannot appear in an identifier become X and two hex
+ * digits, so distinct paths such as T.P and T_P get distinct names.
+ */
+#if !defined(_WIN32)
+std::vector<std::string> SplitWords(const std::string& text) {
+    std::vector<std::string> words;
+    std::istringstream stream(text);
+    for (std::string word; stream >> word;) {
+        words.push_back(word);
+    }
+    return words;
+}
+
+// Exit status of the program, or -1 if it could not be started
+int RunProcess(const std::vector<std::string>& arguments) {
+    if (arguments.empty()) {
+        return -1;
+    }
+    std::vector<char*> argv;
+    for (const auto& argument : arguments) {
+        argv.push_back(const_cast<char*>(argument.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    std::cout.flush();
+    pid_t pid = fork();
+    if (pid < 0) {
+        return -1;
+    }
+    if (pid == 0) {
+        execvp(argv[0], argv.data());
+        _exit(127);
+    }
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) {
+            return -1;
+        }
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+#endif
+
+std::string Identifier(const std::string& path) {
+    static const char* HEX = "0123456789ABCDEF";
+    std::string name = "s_";
+    for (char c : path) {
+        auto byte = static_cast<unsigned char>(c);
+        if (c == '.') {
+            name += '_';
+        } else if (std::isalnum(byte) && byte < 0x80 && c != 'X') {
+            name += c;
+        } else {
+            name += 'X';
+            name += HEX[byte >> 4];
+            name += HEX[byte & 15];
+        }
+    }
+    return name;
+}
+
+// Accessor expression for one slot, e.g. e.s_T_P(2) or e.s_grounded()
+class SlotNames {
+public:
+    explicit SlotNames(const Module& module) {
+        for (const auto& [path, range] : module.slots) {
+            // Skip per-axis aliases such as T.P.x; they are reached through T_P(i)
+            bool isAlias = range.width == 1 && path.find('.') != std::string::npos;
+            if (!isAlias) {
+                m_Accessors[range.index] = {path, range.width};
+            }
+        }
+    }
+
+    std::string Access(uint32_t slot) const {
+        auto it = m_Accessors.upper_bound(slot);
+        if (it != m_Accessors.begin()) {
+            --it;
+            const auto& [path, width] = it->second;
+            uint32_t offset = slot - it->first;
+            if (offset < width) {
+                std::string name = Identifier(path);
+                return width == 1 ? "e." + name + "()" : "e." + name + "(" + std::to_string(offset) + ")";
+            }
+        }
+        return "e.at(" + std::to_string(slot) + ")";
+    }
+
+    void WriteView(std::ostream& out) const {
+        out << "struct EntityView {\n";
+        out << "    float* lane;\n";
+        out << "    float& at(uint32_t slot) const { return lane[slot * CHUNK_SIZE]; }\n";
+        for (const auto& [index, accessor] : m_Accessors) {
+            const auto& [path, width] = accessor;
+            if (width == 1) {
+                out << "    float& " << Identifier(path) << "() const { return at(" << index << "); }\n";
+            } else {
+                out << "    float& " << Identifier(path) << "(uint32_t i) const { return at(" << index << " + i); }\n";
+            }
+        }
+        out << "};\n";
+    }
+
+private:
+    std::map<uint32_t, std::pair<std::string, uint32_t>> m_Accessors;
+};
+
+// `fail` is the statement run when a guard fails: `return 0;` or, inside a
+// fused segment emitted as `do { ... } while (0);`, `break;`
+void WriteInstruction(std::ostream& out, const Instruction& inst, const SlotNames& names, const char* fail) {
+    switch (inst.op) {
+        case OpCode::Nop:
+        case OpCode::Segment:
+            break;
+        case OpCode::TestKey:
+            out << "    if (!((keys[" << (inst.src >> 6) << "] >> " << (inst.src & 63) << ") & 1)) " << fail << "\n";
+            break;
+        case OpCode::TestFlag:
+            out << "    if (" << (inst.imm[0] != 0.0f ? "" : "!") << "(" << names.Access(inst.src)
+                << " == 0.0f)) " << fail << "\n";
+            break;
+        case OpCode::Store:
+            for (int i = 0; i < inst.width; ++i) {
+                out << "    " << names.Access(inst.dst + i) << " = " << FloatLiteral(inst.imm[i]) << ";\n";
+            }
+            break;
+        case OpCode::Add:
+            for (int i = 0; i < inst.width; ++i) {
+                out << "    " << names.Access(inst.dst + i) << " += " << FloatLiteral(inst.imm[i]) << ";\n";
+            }
+            break;
+        case OpCode::Copy:
+            for (int i = 0; i < inst.width; ++i) {
+                out << "    " << names.Access(inst.dst + i) << " = " << names.Access(inst.src + i) << ";\n";
+            }
+            break;
+        case OpCode::AddScaled:
+            for (int i = 0; i < inst.width; ++i) {
+                out << "    " << names.Access(inst.dst + i) << " += " << names.Access(inst.src + i) << " * dt;\n";
+            }
+            break;
+        case OpCode::Wait:
+            // Resumable handlers always run on the interpreter; their native code is never called
+            out << "    return 0;\n";
+            break;
+    }
+}
+
+} // namespace
+
+std::string AotCompiler::GetHandlerSymbol(size_t index) {
+    return "aopl_handler_" + std::to_string(index);
+}
+
+std::string AotCompiler::GenerateSource(const Module& module) {
+    SlotNames names(module);
+    std::ostringstream out;
+
+    out << "// Generated by the GAIA MATRIX AOPL AOT compiler. Do not edit.\n";
+    out << "#include <cstdint>\n\n";
+    out << "namespace {\n\n";
+    out << "constexpr uint32_t CHUNK_SIZE = " << CHUNK_SIZE << ";\n\n";
+    names.WriteView(out);
+    out << "\n} // namespace\n\n";
+
+    out << "extern \"C\" {\n\n";
+    out << "extern const uint64_t aopl_module_hash = " << HashModule(module) << "ull;\n";
+    out << "extern const uint32_t aopl_handler_count = " << module.handlers.size() << ";\n\n";
+
+    for (size_t i = 0; i < module.handlers.size(); ++i) {
+        const Handler& handler = module.handlers[i];
+        out << "// " << handler.behavior << "." << handler.name << " (line " << handler.location.line << ")\n";
+        out << "int " << GetHandlerSymbol(i) << "(float* lane, const uint64_t* keys, float dt, uint32_t) {\n";
+        out << "    EntityView e{lane};\n";
+        out << "    (void)e;\n";
+        out << "    (void)keys;\n";
+        out << "    (void)dt;\n";
+        size_t segmentEnd = 0;
+        for (size_t pc = 0; pc < handler.code.size(); ++pc) {
+            const Instruction& inst = handler.code[pc];
+            if (inst.op == OpCode::Segment) {
+                segmentEnd = pc + 1 + inst.dst;
+                out << "    do {\n";
+            }
+            WriteInstruction(out, inst, names, pc < segmentEnd ? "break;" : "return 0;");
+            if (segmentEnd != 0 && pc + 1 == segmentEnd) {
+                out << "    } while (0);\n";
+            }
+        }
+        out << "    return 1;\n";
+        out << "}\n\n";
+    }
+
+    out << "} // extern \"C\"\n";
+    return out.str();
+}
+
+bool AotCompiler::BuildLibrary(const Module& module, const std::string& outputPath, const AotOptions& options) {
+#if defined(_WIN32)
+    std::cerr << "AOPL AOT compilation is not supported on Windows" << std::endl;
+    return false;
+#else
+    try {
+        std::filesystem::path libraryPath(outputPath);
+        if (libraryPath.has_parent_path()) {
+            std::filesystem::create_directories(libraryPath.parent_path());
+        }
+
+        std::filesystem::path sourcePath = libraryPath;
+        sourcePath.replace_extension(".cpp");
+        {
+            std::ofstream sourceFile(sourcePath);
+            if (!sourceFile) {
+                std::cerr << "Failed to write AOT source: " << sourcePath << std::endl;
+                return false;
+            }
+            sourceFile << GenerateSource(module);
+        }
+
+        std::string compiler = options.compiler;
+        if (compiler.empty()) {
+            const char* cxx = std::getenv("CXX");
+            compiler = cxx && *cxx ? cxx : "c++";
+        }
+
+        // Run the compiler directly, without a shell, so paths are passed through verbatim
+        std::vector<std::string> arguments = SplitWords(compiler);
+        for (const auto& flag : SplitWords("-std=c++17 " + options.optimizationFlags)) {
+            arguments.push_back(flag);
+        }
+        for (const char* flag : {"-shared", "-fPIC", "-o"}) {
+            arguments.push_back(flag);
+        }
+        arguments.push_back(libraryPath.string());
+        arguments.push_back(sourcePath.string());
+        std::string command;
+        for (const auto& argument : arguments) {
+            command += (command.empty() ? "" : " ") + argument;
+        }
+        std::cout << "Building AOPL AOT library: " << libraryPath.string() << std::endl;
+        int status = RunProcess(arguments);
+
+        if (!options.keepGeneratedSource) {
+            std::filesystem::remove(sourcePath);
+        }
+
+        if (status != 0) {
+            std::cerr << "AOT compiler command failed: " << command << std::endl;
+            return false;
+        }
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error building AOT library: " << e.what() << std::endl;
+        return false;
+    }
+#endif
+}
+
+// Implementation of AotLibrary
+AotLibrary::~AotLibrary() {
+#if !defined(_WIN32)
+    if (m_Handle) {
+        dlclose(m_Handle);
+    }
+#endif
+}
+
+std::shared_ptr<AotLibrary> AotLibrary::Load(const std::string& path, const Module& module) {
+#if defined(_WIN32)
+    std::cerr << "AOPL AOT libraries are not supported on Windows" << std::endl;
+    return nullptr;
+#else
+    void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+        std::cerr << "Failed to load AOT library: " << dlerror() << std::endl;
+        return nullptr;
+    }
+
+    std::shared_ptr<AotLibrary> library(new AotLibrary());
+    library->m_Handle = handle;
+
+    const auto* hash = static_cast<const uint64_t*>(dlsym(handle, "aopl_module_hash"));
+    const auto* count = static_cast<const uint32_t*>(dlsym(handle, "aopl_handler_count"));
+    if (!hash || !count || *hash != HashModule(module) || *count != module.handlers.size()) {
+        std::cerr << "AOT library is stale or was built from a different module: " << path << std::endl;
+        return nullptr;
+    }
+    library->m_ModuleHash = *hash;
+
+    for (size_t i = 0; i < module.handlers.size(); ++i) {
+        void* symbol = dlsym(handle, AotCompiler::GetHandlerSymbol(i).c_str());
+        if (!symbol) {
+            std::cerr << "AOT library is missing symbol " << AotCompiler::GetHandlerSymbol(i) << std::endl;
+            return nullptr;
+        }
+        library->m_Handlers.push_back(reinterpret_cast<NativeHandler::EntryPoint>(symbol));
+    }
+
+    return library;
+#endif
+}
+
+NativeHandler::EntryPoint AotLibrary::GetHandler(size_t index) const {
+    return index < m_Handlers.size() ? m_Handlers[index] : nullptr;
+}
+
+size_t AotLibrary::GetHandlerCount() const {
+    return m_Handlers.size();
+}
+
+uint64_t AotLibrary::GetModuleHash() const {
+    return m_ModuleHash;
+}
+
+} // namespace aopl
+} // namespace gaia_matrix
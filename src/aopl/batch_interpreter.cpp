@@ -0,0 +1,206 @@
+#include "gaia_matrix/aopl_runtime.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define GAIA_AOPL_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace gaia_matrix {
+namespace aopl {
+
+namespace {
+
+// Lanes processed together; one SSE register of floats
+constexpr uint32_t LANE_GROUP = 4;
+
+/**
+ * @brief Per-lane execution mask: all bits set for active lanes, zero otherwise
+ */
+struct alignas(16) LaneMask {
+    uint32_t bits[CHUNK_SIZE];
+};
+
+#if GAIA_AOPL_SSE2
+
+inline __m128 LoadMask(const LaneMask& mask, uint32_t lane) {
+    return _mm_castsi128_ps(_mm_load_si128(reinterpret_cast<const __m128i*>(mask.bits + lane)));
+}
+
+// mask ? value : old
+inline __m128 Select(__m128 mask, __m128 value, __m128 old) {
+    return _mm_or_ps(_mm_and_ps(mask, value), _mm_andnot_ps(mask, old));
+}
+
+void StoreLanes(float* dst, float value, const LaneMask& mask, uint32_t groups) {
+    __m128 v = _mm_set1_ps(value);
+    for (uint32_t lane = 0; lane < groups * LANE_GROUP; lane += LANE_GROUP) {
+        _mm_storeu_ps(dst + lane, Select(LoadMask(mask, lane), v, _mm_loadu_ps(dst + lane)));
+    }
+}
+
+void AddLanes(float* dst, float value, const LaneMask& mask, uint32_t groups) {
+    __m128 v = _mm_set1_ps(value);
+    for (uint32_t lane = 0; lane < groups * LANE_GROUP; lane += LANE_GROUP) {
+        __m128 old = _mm_loadu_ps(dst + lane);
+        _mm_storeu_ps(dst + lane, Select(LoadMask(mask, lane), _mm_add_ps(old, v), old));
+    }
+}
+
+void CopyLanes(float* dst, const float* src, const LaneMask& mask, uint32_t groups) {
+    for (uint32_t lane = 0; lane < groups * LANE_GROUP; lane += LANE_GROUP) {
+        _mm_storeu_ps(dst + lane, Select(LoadMask(mask, lane), _mm_loadu_ps(src + lane), _mm_loadu_ps(dst + lane)));
+    }
+}
+
+void AddScaledLanes(float* dst, const float* src, float dt, const LaneMask& mask, uint32_t groups) {
+    __m128 scale = _mm_set1_ps(dt);
+    for (uint32_t lane = 0; lane < groups * LANE_GROUP; lane += LANE_GROUP) {
+        __m128 old = _mm_loadu_ps(dst + lane);
+        __m128 sum = _mm_add_ps(old, _mm_mul_ps(_mm_loadu_ps(src + lane), scale));
+        _mm_storeu_ps(dst + lane, Select(LoadMask(mask, lane), sum, old));
+    }
+}
+
+// Clear lanes whose flag does not match; NaN counts as non-zero like the scalar path
+bool TestFlagLanes(const float* src, bool expected, LaneMask& mask, uint32_t groups) {
+    __m128 zero = _mm_setzero_ps();
+    __m128 any = zero;
+    for (uint32_t lane = 0; lane < groups * LANE_GROUP; lane += LANE_GROUP) {
+        __m128 set = _mm_cmpneq_ps(_mm_loadu_ps(src + lane), zero);
+        __m128 pass = expected ? set : _mm_cmpeq_ps(set, zero);
+        __m128 active = _mm_and_ps(LoadMask(mask, lane), pass);
+        _mm_store_si128(reinterpret_cast<__m128i*>(mask.bits + lane), _mm_castps_si128(active));
+        any = _mm_or_ps(any, active);
+    }
+    return _mm_movemask_ps(any) != 0;
+}
+
+#else
+
+void StoreLanes(float* dst, float value, const LaneMask& mask, uint32_t groups) {
+    for (uint32_t lane = 0; lane < groups * LANE_GROUP; ++lane) {
+        dst[lane] = mask.bits[lane] ? value : dst[lane];
+    }
+}
+
+void AddLanes(float* dst, float value, const LaneMask& mask, uint32_t groups) {
+    for (uint32_t lane = 0; lane < groups * LANE_GROUP; ++lane) {
+        dst[lane] = mask.bits[lane] ? dst[lane] + value : dst[lane];
+    }
+}
+
+void CopyLanes(float* dst, const float* src, const LaneMask& mask, uint32_t groups) {
+    for (uint32_t lane = 0; lane < groups * LANE_GROUP; ++lane) {
+        dst[lane] = mask.bits[lane] ? src[lane] : dst[lane];
+    }
+}
+
+void AddScaledLanes(float* dst, const float* src, float dt, const LaneMask& mask, uint32_t groups) {
+    for (uint32_t lane = 0; lane < groups * LANE_GROUP; ++lane) {
+        dst[lane] = mask.bits[lane] ? dst[lane] + src[lane] * dt : dst[lane];
+    }
+}
+
+bool TestFlagLanes(const float* src, bool expected, LaneMask& mask, uint32_t groups) {
+    uint32_t any = 0;
+    for (uint32_t lane = 0; lane < groups * LANE_GROUP; ++lane) {
+        bool pass = (src[lane] != 0.0f) == expected;
+        mask.bits[lane] = pass ? mask.bits[lane] : 0u;
+        any |= mask.bits[lane];
+    }
+    return any != 0;
+}
+
+#endif
+
+} // namespace
+
+uint32_t InterpretChunk(const Handler& handler, float* chunk, uint32_t laneCount, const InputState& input, float dt,
+                        std::atomic<uint32_t>* cursor) {
+    const auto& code = handler.code;
+    uint32_t groups = (laneCount + LANE_GROUP - 1) / LANE_GROUP;
+
+    LaneMask active;
+    for (uint32_t lane = 0; lane < CHUNK_SIZE; ++lane) {
+        active.bits[lane] = lane < laneCount ? ~0u : 0u;
+    }
+
+    // Lanes active when the current fused segment started; restored at its end
+    LaneMask segmentMask;
+    size_t segmentEnd = 0;
+    bool inSegment = false;
+
+    for (size_t pc = 0; pc < code.size(); ++pc) {
+        if (inSegment && pc == segmentEnd) {
+            active = segmentMask;
+            inSegment = false;
+        }
+
+        const Instruction& inst = code[pc];
+        bool anyActive = true;
+        if (cursor) {
+            cursor->store(static_cast<uint32_t>(pc), std::memory_order_relaxed);
+        }
+
+        switch (inst.op) {
+            case OpCode::Nop:
+                break;
+            case OpCode::Segment:
+                segmentMask = active;
+                segmentEnd = pc + 1 + inst.dst;
+                inSegment = true;
+                break;
+            case OpCode::TestKey:
+                // Input is shared by every lane, so key guards never diverge
+                anyActive = input.IsKeyDown(inst.src);
+                break;
+            case OpCode::TestFlag:
+                anyActive = TestFlagLanes(chunk + inst.src * CHUNK_SIZE, inst.imm[0] != 0.0f, active, groups);
+                break;
+            case OpCode::Store:
+                for (int i = 0; i < inst.width; ++i) {
+                    StoreLanes(chunk + (inst.dst + i) * CHUNK_SIZE, inst.imm[i], active, groups);
+                }
+                break;
+            case OpCode::Add:
+                for (int i = 0; i < inst.width; ++i) {
+                    AddLanes(chunk + (inst.dst + i) * CHUNK_SIZE, inst.imm[i], active, groups);
+                }
+                break;
+            case OpCode::Copy:
+                for (int i = 0; i < inst.width; ++i) {
+                    CopyLanes(chunk + (inst.dst + i) * CHUNK_SIZE, chunk + (inst.src + i) * CHUNK_SIZE, active, groups);
+                }
+                break;
+            case OpCode::AddScaled:
+                for (int i = 0; i < inst.width; ++i) {
+                    AddScaledLanes(chunk + (inst.dst + i) * CHUNK_SIZE, chunk + (inst.src + i) * CHUNK_SIZE, dt, active,
+                                   groups);
+                }
+                break;
+            case OpCode::Wait:
+                // Suspension needs per-entity frames; the runtime never batches resumable handlers
+                return 0;
+        }
+
+        if (!anyActive) {
+            // Every lane failed the guard: skip the rest of the segment, or stop
+            if (!inSegment) {
+                return 0;
+            }
+            pc = segmentEnd - 1;
+        }
+    }
+    if (inSegment) {
+        active = segmentMask;
+    }
+
+    uint32_t completed = 0;
+    for (uint32_t lane = 0; lane < laneCount; ++lane) {
+        completed += active.bits[lane] ? 1 : 0;
+    }
+    return completed;
+}
+
+} // namespace aopl
+} // namespace gaia_matrix
@@ -0,0 +1,385 @@
+#include "gaia_matrix/aopl_runtime.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <iostream>
+
+namespace gaia_matrix {
+namespace aopl {
+
+namespace {
+
+// Built-in component slots, laid out before any script variables
+struct BuiltinSlot {
+    const char* path;
+    uint16_t index;
+};
+
+constexpr BuiltinSlot BUILTIN_VECTORS[] = {
+    {"T.P", 0},  // Position
+    {"T.R", 3},  // Rotation
+    {"T.S", 6},  // Scale
+    {"V", 9}     // Velocity
+};
+
+constexpr uint16_t BUILTIN_SLOT_COUNT = 12;
+
+bool ParseNumber(const std::string& token, float& value) {
+    if (token == "true") {
+        value = 1.0f;
+        return true;
+    }
+    if (token == "false") {
+        value = 0.0f;
+        return true;
+    }
+    if (token.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    value = std::strtof(token.c_str(), &end);
+    return end == token.c_str() + token.size();
+}
+
+// Durations of `⧖` stages: seconds, optionally suffixed `s` or `ms`
+bool ParseDuration(const std::string& token, float& seconds) {
+    std::string number = token;
+    float scale = 1.0f;
+    if (number.size() > 2 && number.compare(number.size() - 2, 2, "ms") == 0) {
+        number.resize(number.size() - 2);
+        scale = 0.001f;
+    } else if (number.size() > 1 && number.back() == 's') {
+        number.pop_back();
+    }
+    if (number == "true" || number == "false" || !ParseNumber(number, seconds) || !(seconds >= 0.0f)) {
+        return false;
+    }
+    seconds *= scale;
+    return true;
+}
+
+int AxisIndex(char axis) {
+    switch (axis) {
+        case 'x': return 0;
+        case 'y': return 1;
+        case 'z': return 2;
+        case 'w': return 3;
+        default: return -1;
+    }
+}
+
+class Lowering {
+public:
+    Lowering(Module& module, const TypeTable& types, std::vector<std::string>& errors)
+        : m_Module(module), m_Types(types), m_Errors(errors) {
+        for (const auto& builtin : BUILTIN_VECTORS) {
+            m_Module.slots[builtin.path] = {builtin.index, 3};
+            for (int i = 0; i < 3; ++i) {
+                m_Module.slots[std::string(builtin.path) + "." + "xyz"[i]] = {
+                    static_cast<uint16_t>(builtin.index + i), 1};
+            }
+        }
+        m_Module.slotCount = BUILTIN_SLOT_COUNT;
+    }
+
+    // Resolve a slot path, allocating script variables on first use
+    const Module::SlotRange* Resolve(const std::string& path, bool allowCreate) {
+        if (const auto* range = m_Module.FindSlot(path)) {
+            return range;
+        }
+        if (!allowCreate || path.empty() || path.find('.') != std::string::npos ||
+            !(std::isalpha(static_cast<unsigned char>(path[0])) || path[0] == '_')) {
+            return nullptr;
+        }
+        // Vector variables get contiguous slots plus per-axis aliases, like the built-ins
+        Module::SlotRange range;
+        range.index = m_Module.slotCount;
+        range.width = 1;
+        const TypeInfo* type = m_Types.Find(path);
+        if (type && type->type == ValueType::Vector && type->width > 1) {
+            range.width = type->width;
+            for (int i = 0; i < range.width; ++i) {
+                m_Module.slots[path + "." + "xyzw"[i]] = {static_cast<uint16_t>(range.index + i), 1};
+            }
+        }
+        m_Module.slotCount = static_cast<uint16_t>(m_Module.slotCount + range.width);
+        m_Module.slots[path] = range;
+        return m_Module.FindSlot(path);
+    }
+
+    // Script variables with an inferred numeric type may be used before their first `⊸`
+    bool IsTypedVariable(const std::string& path) const {
+        const TypeInfo* type = m_Types.Find(path);
+        return type && type->width > 0;
+    }
+
+    bool LowerStage(const Stage& stage, std::vector<Instruction>& code) {
+        const auto& tokens = stage.tokens;
+        Instruction inst;
+        inst.location = stage.location;
+
+        // Key guard: I.K W
+        if (tokens[0] == "I.K" && tokens.size() == 2) {
+            int keyCode = LookupKeyCode(tokens[1]);
+            if (keyCode < 0) {
+                return Error(stage, "unknown key '" + tokens[1] + "'");
+            }
+            inst.op = OpCode::TestKey;
+            inst.src = static_cast<uint16_t>(keyCode);
+            code.push_back(inst);
+            return true;
+        }
+
+        // Conditional guard: ⊿ grounded / ⊿ !grounded
+        if (tokens[0] == Symbol::CONDITIONAL && tokens.size() == 2) {
+            std::string name = tokens[1];
+            bool expected = true;
+            if (!name.empty() && name[0] == '!') {
+                expected = false;
+                name = name.substr(1);
+            }
+            const auto* range = Resolve(name, true);
+            if (!range || range->width != 1) {
+                return Error(stage, "invalid condition '" + tokens[1] + "'");
+            }
+            inst.op = OpCode::TestFlag;
+            inst.src = range->index;
+            inst.imm[0] = expected ? 1.0f : 0.0f;
+            code.push_back(inst);
+            return true;
+        }
+
+        // Suspension: ⧖ 2s / ⧖ 250ms, or a bare ⧖ to resume on the next tick
+        if (tokens[0] == Symbol::WAIT && tokens.size() <= 2) {
+            if (tokens.size() == 2 && !ParseDuration(tokens[1], inst.imm[0])) {
+                return Error(stage, "invalid duration '" + tokens[1] + "'");
+            }
+            inst.op = OpCode::Wait;
+            code.push_back(inst);
+            return true;
+        }
+
+        // Assignment: ⊸ grounded true
+        if (tokens[0] == Symbol::ASSIGNMENT && tokens.size() >= 3) {
+            return LowerStore(stage, tokens[1], 2, code);
+        }
+
+        const auto* target = Resolve(tokens[0], IsTypedVariable(tokens[0]));
+        if (!target) {
+            return Error(stage, "unsupported stage '" + tokens[0] + "'");
+        }
+
+        // Integration: T.P += V * dt
+        if (tokens.size() == 5 && tokens[1] == "+=" && tokens[3] == "*" && tokens[4] == "dt") {
+            const auto* source = Resolve(tokens[2], IsTypedVariable(tokens[2]));
+            if (!source || source->width != target->width) {
+                return Error(stage, "mismatched operand '" + tokens[2] + "'");
+            }
+            inst.op = OpCode::AddScaled;
+            inst.dst = target->index;
+            inst.src = source->index;
+            inst.width = target->width;
+            code.push_back(inst);
+            return true;
+        }
+
+        // Axis offset: T.P z+ 0.1
+        if (tokens.size() == 3 && tokens[1].size() == 2 && AxisIndex(tokens[1][0]) >= 0 &&
+            (tokens[1][1] == '+' || tokens[1][1] == '-')) {
+            int axis = AxisIndex(tokens[1][0]);
+            float amount = 0.0f;
+            if (axis >= target->width || !ParseNumber(tokens[2], amount)) {
+                return Error(stage, "invalid offset '" + tokens[1] + " " + tokens[2] + "'");
+            }
+            inst.op = OpCode::Add;
+            inst.dst = static_cast<uint16_t>(target->index + axis);
+            inst.imm[0] = tokens[1][1] == '+' ? amount : -amount;
+            code.push_back(inst);
+            return true;
+        }
+
+        // Copy: V T.R
+        if (tokens.size() == 2) {
+            if (const auto* source = Resolve(tokens[1], IsTypedVariable(tokens[1]))) {
+                if (source->width != target->width) {
+                    return Error(stage, "mismatched operand '" + tokens[1] + "'");
+                }
+                inst.op = OpCode::Copy;
+                inst.dst = target->index;
+                inst.src = source->index;
+                inst.width = target->width;
+                code.push_back(inst);
+                return true;
+            }
+        }
+
+        // Store: V.y 5 / T.P 0 1 0
+        return LowerStore(stage, tokens[0], 1, code);
+    }
+
+    bool LowerStore(const Stage& stage, const std::string& path, size_t firstValue, std::vector<Instruction>& code) {
+        const auto& tokens = stage.tokens;
+        const auto* target = Resolve(path, true);
+        if (!target) {
+            return Error(stage, "unknown target '" + path + "'");
+        }
+        if (tokens.size() - firstValue != target->width) {
+            return Error(stage, "expected " + std::to_string(target->width) + " value(s) for '" + path + "'");
+        }
+        Instruction inst;
+        inst.op = OpCode::Store;
+        inst.dst = target->index;
+        inst.width = target->width;
+        inst.location = stage.location;
+        for (size_t i = 0; i < target->width; ++i) {
+            if (!ParseNumber(tokens[firstValue + i], inst.imm[i])) {
+                return Error(stage, "invalid value '" + tokens[firstValue + i] + "'");
+            }
+        }
+        code.push_back(inst);
+        return true;
+    }
+
+    bool Error(const Stage& stage, const std::string& message) {
+        m_Errors.push_back("line " + std::to_string(stage.location.line) + ": " + message);
+        return false;
+    }
+
+private:
+    Module& m_Module;
+    const TypeTable& m_Types;
+    std::vector<std::string>& m_Errors;
+};
+
+} // namespace
+
+const Module::SlotRange* Module::FindSlot(const std::string& path) const {
+    auto it = slots.find(path);
+    return it != slots.end() ? &it->second : nullptr;
+}
+
+const EntityTemplate* Module::FindTemplate(const std::string& name) const {
+    for (const auto& entityTemplate : templates) {
+        if (entityTemplate.name == name) {
+            return &entityTemplate;
+        }
+    }
+    return nullptr;
+}
+
+bool IsResumable(const Handler& handler) {
+    for (const auto& inst : handler.code) {
+        if (inst.op == OpCode::Wait) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t HashModule(const Module& module) {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+
+    // Slot names are hashed in index order so map iteration order does not matter
+    std::vector<std::pair<uint32_t, std::string>> slots;
+    for (const auto& [path, range] : module.slots) {
+        slots.emplace_back((static_cast<uint32_t>(range.index) << 8) | range.width, path);
+    }
+    std::sort(slots.begin(), slots.end());
+    for (const auto& [key, path] : slots) {
+        mix(&key, sizeof(key));
+        mix(path.data(), path.size());
+    }
+    mix(&module.slotCount, sizeof(module.slotCount));
+
+    for (const auto& handler : module.handlers) {
+        mix(handler.name.data(), handler.name.size());
+        for (const auto& inst : handler.code) {
+            mix(&inst.op, sizeof(inst.op));
+            mix(&inst.width, sizeof(inst.width));
+            mix(&inst.dst, sizeof(inst.dst));
+            mix(&inst.src, sizeof(inst.src));
+            mix(inst.imm.data(), sizeof(float) * inst.imm.size());
+        }
+    }
+    return hash;
+}
+
+int LookupKeyCode(const std::string& name) {
+    // Virtual-key style codes: letters and digits map to their ASCII value
+    if (name.size() == 1) {
+        char c = name[0];
+        if (c >= 'a' && c <= 'z') {
+            c = static_cast<char>(c - 'a' + 'A');
+        }
+        if ((c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')) {
+            return c;
+        }
+        return -1;
+    }
+
+    static const std::unordered_map<std::string, int> namedKeys = {
+        {"Tab", 9}, {"Enter", 13}, {"Shift", 16}, {"Ctrl", 17}, {"Alt", 18},
+        {"Escape", 27}, {"Space", 32}, {"Left", 37}, {"Up", 38}, {"Right", 39}, {"Down", 40}
+    };
+    auto it = namedKeys.find(name);
+    return it != namedKeys.end() ? it->second : -1;
+}
+
+std::shared_ptr<Module> LowerModule(const Parser& parser, std::vector<std::string>& errors, TypeTable* types) {
+    TypeTable inferred;
+    TypeTable& table = types ? *types : inferred;
+    if (!InferTypes(parser, table)) {
+        for (const auto& error : table.errors) {
+            errors.push_back("line " + std::to_string(error.location.line) + ": " + error.message);
+        }
+        return nullptr;
+    }
+
+    auto module = std::make_shared<Module>();
+    Lowering lowering(*module, table, errors);
+    bool ok = true;
+
+    for (const auto& behavior : parser.GetBehaviors()) {
+        for (const auto& binding : behavior->GetBindings()) {
+            Handler handler;
+            handler.name = binding.handler;
+            handler.behavior = behavior->GetName();
+            handler.location = binding.location;
+            for (const auto& stage : binding.stages) {
+                ok = lowering.LowerStage(stage, handler.code) && ok;
+            }
+            module->handlers.push_back(std::move(handler));
+        }
+    }
+
+    if (!ok) {
+        return nullptr;
+    }
+
+    // Entity templates are laid out after all script variables are known
+    for (const auto& entity : parser.GetEntities()) {
+        EntityTemplate entityTemplate;
+        entityTemplate.name = entity->GetName();
+        entityTemplate.initialSlots.assign(module->slotCount, 0.0f);
+
+        Transform defaults;
+        const Transform& transform = entity->GetTransform() ? *entity->GetTransform() : defaults;
+        for (int i = 0; i < 3; ++i) {
+            entityTemplate.initialSlots[0 + i] = transform.position[i];
+            entityTemplate.initialSlots[3 + i] = transform.rotation[i];
+            entityTemplate.initialSlots[6 + i] = transform.scale[i];
+        }
+        module->templates.push_back(std::move(entityTemplate));
+    }
+
+    return module;
+}
+
+} // namespace aopl
+} // namespace gaia_matrix
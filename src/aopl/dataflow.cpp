@@ -0,0 +1,229 @@
+#include "gaia_matrix/aopl_dataflow.h"
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+
+namespace gaia_matrix {
+namespace aopl {
+
+namespace {
+
+void AddRange(std::vector<uint16_t>& slots, uint16_t base, uint8_t width) {
+    for (int i = 0; i < width; ++i) {
+        slots.push_back(static_cast<uint16_t>(base + i));
+    }
+}
+
+void SortUnique(std::vector<uint16_t>& slots) {
+    std::sort(slots.begin(), slots.end());
+    slots.erase(std::unique(slots.begin(), slots.end()), slots.end());
+}
+
+} // namespace
+
+DataflowGraph BuildDataflowGraph(const Module& module) {
+    DataflowGraph graph;
+    graph.nodes.resize(module.handlers.size());
+
+    // Last writer and readers since that write, per slot
+    constexpr uint32_t NONE = 0xFFFFFFFF;
+    std::vector<uint32_t> lastWriter(module.slotCount, NONE);
+    std::vector<std::vector<uint32_t>> readers(module.slotCount);
+
+    for (uint32_t index = 0; index < module.handlers.size(); ++index) {
+        const Handler& handler = module.handlers[index];
+        DataflowNode& node = graph.nodes[index];
+        node.handler = index;
+        node.serial = IsResumable(handler);
+
+        for (const auto& inst : handler.code) {
+            switch (inst.op) {
+                case OpCode::TestKey:
+                    node.readsInput = true;
+                    node.keys[(inst.src >> 6) & 3] |= uint64_t(1) << (inst.src & 63);
+                    break;
+                case OpCode::TestFlag:
+                    node.reads.push_back(inst.src);
+                    break;
+                case OpCode::Store:
+                    AddRange(node.writes, inst.dst, inst.width);
+                    break;
+                case OpCode::Add:
+                    AddRange(node.reads, inst.dst, inst.width);
+                    AddRange(node.writes, inst.dst, inst.width);
+                    break;
+                case OpCode::Copy:
+                    AddRange(node.reads, inst.src, inst.width);
+                    AddRange(node.writes, inst.dst, inst.width);
+                    break;
+                case OpCode::AddScaled:
+                    AddRange(node.reads, inst.src, inst.width);
+                    AddRange(node.reads, inst.dst, inst.width);
+                    AddRange(node.writes, inst.dst, inst.width);
+                    break;
+                default:
+                    break;
+            }
+        }
+        SortUnique(node.reads);
+        SortUnique(node.writes);
+
+        // Integrations and flag toggles read their own output, so they always run
+        std::vector<uint16_t> overlap;
+        std::set_intersection(node.reads.begin(), node.reads.end(), node.writes.begin(), node.writes.end(),
+                              std::back_inserter(overlap));
+        node.pure = !node.serial && overlap.empty();
+
+        // Read after write, write after write, write after read
+        for (uint16_t slot : node.reads) {
+            if (slot < module.slotCount && lastWriter[slot] != NONE) {
+                node.dependencies.push_back(lastWriter[slot]);
+            }
+        }
+        for (uint16_t slot : node.writes) {
+            if (slot >= module.slotCount) {
+                continue;
+            }
+            if (lastWriter[slot] != NONE) {
+                node.dependencies.push_back(lastWriter[slot]);
+            }
+            node.dependencies.insert(node.dependencies.end(), readers[slot].begin(), readers[slot].end());
+        }
+        std::sort(node.dependencies.begin(), node.dependencies.end());
+        node.dependencies.erase(std::unique(node.dependencies.begin(), node.dependencies.end()),
+                                node.dependencies.end());
+        node.dependencies.erase(std::remove(node.dependencies.begin(), node.dependencies.end(), index),
+                                node.dependencies.end());
+
+        for (uint32_t dependency : node.dependencies) {
+            node.level = std::max(node.level, graph.nodes[dependency].level + 1);
+        }
+        if (graph.levels.size() <= node.level) {
+            graph.levels.resize(node.level + 1);
+        }
+        graph.levels[node.level].push_back(index);
+
+        for (uint16_t slot : node.reads) {
+            if (slot < module.slotCount) {
+                readers[slot].push_back(index);
+            }
+        }
+        for (uint16_t slot : node.writes) {
+            if (slot < module.slotCount) {
+                lastWriter[slot] = index;
+                readers[slot].clear();
+            }
+        }
+    }
+    return graph;
+}
+
+std::string DataflowGraph::ToString(const Module& module) const {
+    std::ostringstream out;
+    for (size_t level = 0; level < levels.size(); ++level) {
+        out << "level " << level << ":";
+        for (uint32_t index : levels[level]) {
+            const Handler& handler = module.handlers[nodes[index].handler];
+            out << " " << (handler.name == handler.behavior ? handler.behavior : handler.behavior + "." + handler.name);
+            if (!nodes[index].dependencies.empty()) {
+                out << "(after";
+                for (uint32_t dependency : nodes[index].dependencies) {
+                    out << " " << dependency;
+                }
+                out << ")";
+            }
+            if (nodes[index].serial) {
+                out << "[serial]";
+            }
+        }
+        out << "\n";
+    }
+    return out.str();
+}
+
+// Implementation of WorkerPool
+WorkerPool::WorkerPool(uint32_t threadCount) {
+    uint32_t threads = threadCount ? threadCount : std::max(1u, std::thread::hardware_concurrency());
+    for (uint32_t i = 1; i < threads; ++i) {
+        m_Threads.emplace_back([this]() { WorkerLoop(); });
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stopping = true;
+    }
+    m_Wake.notify_all();
+    for (auto& thread : m_Threads) {
+        thread.join();
+    }
+}
+
+void WorkerPool::Run(size_t count, const std::function<void(size_t)>& task) {
+    if (m_Threads.empty() || count <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Task = &task;
+        m_Count = count;
+        m_Next = 0;
+        m_Finished = 0;
+        ++m_Generation;
+    }
+    m_Wake.notify_all();
+    Work();
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Done.wait(lock, [this]() { return m_Finished == m_Count; });
+    m_Task = nullptr;
+}
+
+void WorkerPool::Work() {
+    for (;;) {
+        const std::function<void(size_t)>* task;
+        size_t index;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            if (!m_Task || m_Next >= m_Count) {
+                return;
+            }
+            task = m_Task;
+            index = m_Next++;
+        }
+        (*task)(index);
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            if (++m_Finished == m_Count) {
+                m_Done.notify_all();
+            }
+        }
+    }
+}
+
+void WorkerPool::WorkerLoop() {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_Wake.wait(lock, [this, seen]() { return m_Stopping || m_Generation != seen; });
+            if (m_Stopping) {
+                return;
+            }
+            seen = m_Generation;
+        }
+        Work();
+    }
+}
+
+uint32_t WorkerPool::GetThreadCount() const {
+    return static_cast<uint32_t>(m_Threads.size()) + 1;
+}
+
+} // namespace aopl
+} // namespace gaia_matrix
@@ -0,0 +1,111 @@
+#include "gaia_matrix/aopl_hot_reload.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace gaia_matrix {
+namespace aopl {
+
+HotReloader::HotReloader(const std::string& directory, const ProjectConfig& config)
+    : m_Directory(directory), m_Project(config) {}
+
+bool HotReloader::Start() {
+    Scan();
+    m_Errors.clear();
+    if (!m_Project.Build()) {
+        m_Errors = m_Project.GetErrors();
+        return false;
+    }
+    m_Module = m_Project.GetModule();
+    return true;
+}
+
+void HotReloader::Attach(std::shared_ptr<Runtime> runtime) {
+    if (runtime) {
+        m_Runtimes.push_back(runtime);
+    }
+}
+
+HotReloadResult HotReloader::Poll() {
+    HotReloadResult result;
+    result.changedFiles = Scan();
+    if (result.changedFiles.empty()) {
+        return result;
+    }
+
+    m_Errors.clear();
+    bool built = m_Project.Build();
+    result.filesCompiled = m_Project.GetStats().filesCompiled;
+    if (!built) {
+        m_Errors = m_Project.GetErrors();
+        result.errors = m_Errors;
+        return result;
+    }
+
+    m_Module = m_Project.GetModule();
+    for (size_t i = 0; i < m_Runtimes.size(); ++i) {
+        ReloadStats stats = m_Runtimes[i]->Reload(m_Module);
+        if (i == 0) {
+            result.runtime = stats;
+        }
+    }
+    result.reloaded = true;
+    return result;
+}
+
+std::vector<std::string> HotReloader::Scan() {
+    std::vector<std::string> changed;
+    std::map<std::string, std::filesystem::file_time_type> seen;
+    try {
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(m_Directory)) {
+            if (!entry.is_regular_file() || entry.path().extension() != ".aopl") {
+                continue;
+            }
+            std::string path = std::filesystem::relative(entry.path(), m_Directory).generic_string();
+            auto timestamp = entry.last_write_time();
+            seen[path] = timestamp;
+
+            auto it = m_Timestamps.find(path);
+            if (it != m_Timestamps.end() && it->second == timestamp) {
+                continue;
+            }
+            std::ifstream file(entry.path());
+            if (!file) {
+                std::cerr << "Failed to read AOPL source: " << entry.path().string() << std::endl;
+                continue;
+            }
+            std::stringstream buffer;
+            buffer << file.rdbuf();
+            // Saving without edits only touches the timestamp
+            if (m_Project.UpdateFile(path, buffer.str())) {
+                changed.push_back(path);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error scanning AOPL directory " << m_Directory << ": " << e.what() << std::endl;
+        return changed;
+    }
+
+    for (const auto& [path, timestamp] : m_Timestamps) {
+        if (!seen.count(path) && m_Project.RemoveFile(path)) {
+            changed.push_back(path);
+        }
+    }
+    m_Timestamps = std::move(seen);
+    return changed;
+}
+
+std::shared_ptr<const Module> HotReloader::GetModule() const {
+    return m_Module;
+}
+
+const std::vector<std::string>& HotReloader::GetErrors() const {
+    return m_Errors;
+}
+
+const std::string& HotReloader::GetDirectory() const {
+    return m_Directory;
+}
+
+} // namespace aopl
+} // namespace gaia_matrix
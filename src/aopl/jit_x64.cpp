@@ -0,0 +1,272 @@
+#include "gaia_matrix/aopl_runtime.h"
+#include <cstring>
+#include <iostream>
+
+#if (defined(__x86_64__) || defined(_M_X64)) && !defined(_WIN32)
+#define GAIA_AOPL_JIT_X64 1
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace gaia_matrix {
+namespace aopl {
+
+#if GAIA_AOPL_JIT_X64
+
+namespace {
+
+/**
+ * @brief Minimal x86-64 machine code emitter for the AOPL instruction set
+ *
+ * Register use follows the System V ABI of NativeHandler::EntryPoint:
+ * rdi = entity lane, rsi = key bitset, xmm0 = dt, edx = layout epoch.
+ * xmm1/xmm2 and eax are scratch.
+ */
+class X64Emitter {
+public:
+    void Byte(uint8_t value) {
+        m_Code.push_back(value);
+    }
+
+    void Bytes(std::initializer_list<uint8_t> values) {
+        m_Code.insert(m_Code.end(), values);
+    }
+
+    void Imm32(uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            Byte(static_cast<uint8_t>(value >> (i * 8)));
+        }
+    }
+
+    void Float32(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        Imm32(bits);
+    }
+
+    // Offset of a slot relative to the lane pointer
+    static uint32_t SlotOffset(uint32_t slot) {
+        return slot * CHUNK_SIZE * sizeof(float);
+    }
+
+    // jcc rel32 to a label that is bound later
+    void JumpTo(uint8_t condition, std::vector<size_t>& fixups) {
+        Bytes({0x0F, condition});
+        fixups.push_back(m_Code.size());
+        Imm32(0);
+    }
+
+    void Bind(const std::vector<size_t>& fixups) {
+        for (size_t at : fixups) {
+            uint32_t rel = static_cast<uint32_t>(m_Code.size() - (at + 4));
+            std::memcpy(&m_Code[at], &rel, sizeof(rel));
+        }
+    }
+
+    // movss xmm1, [rdi + slot]
+    void LoadXmm1(uint32_t slot) {
+        Bytes({0xF3, 0x0F, 0x10, 0x8F});
+        Imm32(SlotOffset(slot));
+    }
+
+    // movss [rdi + slot], xmm1
+    void StoreXmm1(uint32_t slot) {
+        Bytes({0xF3, 0x0F, 0x11, 0x8F});
+        Imm32(SlotOffset(slot));
+    }
+
+    // mov eax, imm32 ; ret
+    void Return(uint32_t value) {
+        if (value == 0) {
+            Bytes({0x31, 0xC0}); // xor eax, eax
+        } else {
+            Byte(0xB8);
+            Imm32(value);
+        }
+        Byte(0xC3);
+    }
+
+    const std::vector<uint8_t>& GetCode() const {
+        return m_Code;
+    }
+
+    static constexpr uint8_t JE = 0x84;
+    static constexpr uint8_t JNE = 0x85;
+    static constexpr uint8_t JP = 0x8A;
+
+private:
+    std::vector<uint8_t> m_Code;
+};
+
+// `abortFixups` receives the jumps taken when a guard fails: the end of the
+// current fused segment, or the shared abort tail outside of segments.
+bool EmitInstruction(X64Emitter& e, const Instruction& inst, std::vector<size_t>& abortFixups) {
+    switch (inst.op) {
+        case OpCode::Nop:
+        case OpCode::Segment:
+            return true;
+
+        case OpCode::TestKey:
+            // test byte [rsi + key / 8], 1 << (key % 8) ; jz abort
+            e.Bytes({0xF6, 0x86});
+            e.Imm32(inst.src >> 3);
+            e.Byte(static_cast<uint8_t>(1u << (inst.src & 7)));
+            e.JumpTo(X64Emitter::JE, abortFixups);
+            return true;
+
+        case OpCode::TestFlag: {
+            // ucomiss slot, 0.0 ; NaN compares unordered and counts as non-zero
+            e.LoadXmm1(inst.src);
+            e.Bytes({0x0F, 0x57, 0xD2});     // xorps xmm2, xmm2
+            e.Bytes({0x0F, 0x2E, 0xCA});     // ucomiss xmm1, xmm2
+            if (inst.imm[0] != 0.0f) {
+                std::vector<size_t> unordered;
+                e.JumpTo(X64Emitter::JP, unordered);
+                e.JumpTo(X64Emitter::JE, abortFixups);
+                e.Bind(unordered);
+            } else {
+                e.JumpTo(X64Emitter::JP, abortFixups);
+                e.JumpTo(X64Emitter::JNE, abortFixups);
+            }
+            return true;
+        }
+
+        case OpCode::Store:
+            for (int i = 0; i < inst.width; ++i) {
+                // mov dword [rdi + slot], imm32
+                e.Bytes({0xC7, 0x87});
+                e.Imm32(X64Emitter::SlotOffset(inst.dst + i));
+                e.Float32(inst.imm[i]);
+            }
+            return true;
+
+        case OpCode::Add:
+            for (int i = 0; i < inst.width; ++i) {
+                e.LoadXmm1(inst.dst + i);
+                e.Byte(0xB8);                      // mov eax, imm32
+                e.Float32(inst.imm[i]);
+                e.Bytes({0x66, 0x0F, 0x6E, 0xD0}); // movd xmm2, eax
+                e.Bytes({0xF3, 0x0F, 0x58, 0xCA}); // addss xmm1, xmm2
+                e.StoreXmm1(inst.dst + i);
+            }
+            return true;
+
+        case OpCode::Copy:
+            for (int i = 0; i < inst.width; ++i) {
+                e.Bytes({0x8B, 0x87});             // mov eax, [rdi + src]
+                e.Imm32(X64Emitter::SlotOffset(inst.src + i));
+                e.Bytes({0x89, 0x87});             // mov [rdi + dst], eax
+                e.Imm32(X64Emitter::SlotOffset(inst.dst + i));
+            }
+            return true;
+
+        case OpCode::AddScaled:
+            for (int i = 0; i < inst.width; ++i) {
+                e.LoadXmm1(inst.src + i);
+                e.Bytes({0xF3, 0x0F, 0x59, 0xC8}); // mulss xmm1, xmm0
+                e.Bytes({0xF3, 0x0F, 0x58, 0x8F}); // addss xmm1, [rdi + dst]
+                e.Imm32(X64Emitter::SlotOffset(inst.dst + i));
+                e.StoreXmm1(inst.dst + i);
+            }
+            return true;
+
+        case OpCode::Wait:
+            // Suspended frames are interpreter state; resumable handlers stay interpreted
+            return false;
+    }
+    return false;
+}
+
+} // namespace
+
+bool JitCompiler::IsSupported() {
+    return true;
+}
+
+std::unique_ptr<NativeHandler> JitCompiler::Compile(const Handler& handler, uint32_t layoutEpoch) {
+    X64Emitter e;
+    std::vector<size_t> abortFixups;
+    std::vector<size_t> deoptFixups;
+
+    // Entry guard: cmp edx, layoutEpoch ; jne deopt
+    e.Bytes({0x81, 0xFA});
+    e.Imm32(layoutEpoch);
+    e.JumpTo(X64Emitter::JNE, deoptFixups);
+
+    std::vector<size_t> segmentFixups;
+    size_t segmentEnd = 0;
+    for (size_t pc = 0; pc < handler.code.size(); ++pc) {
+        if (pc == segmentEnd) {
+            e.Bind(segmentFixups);
+            segmentFixups.clear();
+        }
+
+        const Instruction& inst = handler.code[pc];
+        if (inst.op == OpCode::Segment) {
+            segmentEnd = pc + 1 + inst.dst;
+        }
+        if (!EmitInstruction(e, inst, pc < segmentEnd ? segmentFixups : abortFixups)) {
+            return nullptr;
+        }
+    }
+    e.Bind(segmentFixups);
+
+    e.Return(NativeHandler::Completed);
+    e.Bind(abortFixups);
+    e.Return(NativeHandler::Aborted);
+    e.Bind(deoptFixups);
+    e.Return(NativeHandler::Deoptimize);
+
+    // Write the code into fresh pages, then flip them to read+execute (W^X)
+    const auto& code = e.GetCode();
+    size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t size = (code.size() + pageSize - 1) / pageSize * pageSize;
+
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        std::cerr << "AOPL JIT: failed to map executable memory" << std::endl;
+        return nullptr;
+    }
+    std::memcpy(memory, code.data(), code.size());
+    if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0) {
+        std::cerr << "AOPL JIT: failed to protect executable memory" << std::endl;
+        munmap(memory, size);
+        return nullptr;
+    }
+
+    return std::make_unique<NativeHandler>(memory, size);
+}
+
+NativeHandler::~NativeHandler() {
+    if (m_Memory) {
+        munmap(m_Memory, m_Size);
+    }
+}
+
+#else
+
+bool JitCompiler::IsSupported() {
+    return false;
+}
+
+std::unique_ptr<NativeHandler> JitCompiler::Compile(const Handler&, uint32_t) {
+    return nullptr;
+}
+
+NativeHandler::~NativeHandler() {}
+
+#endif
+
+NativeHandler::NativeHandler(void* memory, size_t size) : m_Memory(memory), m_Size(size) {}
+
+int NativeHandler::Invoke(float* lane, const InputState& input, float dt, uint32_t layoutEpoch) const {
+    auto entry = reinterpret_cast<EntryPoint>(m_Memory);
+    return entry(lane, input.keys.data(), dt, layoutEpoch);
+}
+
+size_t NativeHandler::GetCodeSize() const {
+    return m_Size;
+}
+
+} // namespace aopl
+} // namespace gaia_matrix
@@ -0,0 +1,485 @@
+#include "gaia_matrix/aopl_cache.h"
+#include "gaia_matrix.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace gaia_matrix {
+namespace aopl {
+
+namespace {
+
+/*
+ * File layout (native endianness, every section 8-byte aligned):
+ *
+ *   CacheHeader
+ *   SymbolRecord[symbolCount]          slot table
+ *   HandlerRecord[handlerCount]
+ *   InstructionRecord[instructionCount] bytecode of all handlers
+ *   TemplateRecord[templateCount]
+ *   float[valueCount]                  constant pool of template initial slots
+ *   uint32_t[nameCount]                declarations, references, paths (string offsets)
+ *   char[stringBytes]                  NUL-terminated string pool
+ */
+constexpr char CACHE_MAGIC[8] = {'A', 'O', 'P', 'L', 'C', 0, 0, 0};
+
+struct CacheHeader {
+    char magic[8];
+    uint32_t formatVersion;
+    uint32_t slotCount;
+    uint64_t key;
+    uint64_t moduleHash;
+    uint32_t symbolCount;
+    uint32_t handlerCount;
+    uint32_t instructionCount;
+    uint32_t templateCount;
+    uint32_t valueCount;
+    uint32_t declarationCount;
+    uint32_t referenceCount;
+    uint32_t pathCount;
+    uint32_t stringBytes;
+    uint32_t reserved;
+};
+
+struct SymbolRecord {
+    uint32_t name;
+    uint16_t index;
+    uint8_t width;
+    uint8_t reserved;
+};
+
+struct HandlerRecord {
+    uint32_t name;
+    uint32_t behavior;
+    int32_t line;
+    uint32_t firstInstruction;
+    uint32_t instructionCount;
+};
+
+struct InstructionRecord {
+    uint8_t op;
+    uint8_t width;
+    uint16_t dst;
+    uint16_t src;
+    uint16_t stage;
+    float imm[4];
+    int32_t line;
+};
+
+struct TemplateRecord {
+    uint32_t name;
+    uint32_t firstValue;
+    uint32_t valueCount;
+};
+
+size_t Align(size_t offset) {
+    return (offset + 7) & ~size_t(7);
+}
+
+double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+class Writer {
+public:
+    uint32_t Intern(const std::string& text) {
+        uint32_t offset = static_cast<uint32_t>(m_Strings.size());
+        m_Strings.append(text);
+        m_Strings.push_back('\0');
+        return offset;
+    }
+
+    template <typename T>
+    void Section(const std::vector<T>& records) {
+        m_Buffer.resize(Align(m_Buffer.size()), '\0');
+        m_Buffer.append(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(T));
+    }
+
+    void Header(const CacheHeader& header) {
+        m_Buffer.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+    std::string Finish() {
+        m_Buffer.resize(Align(m_Buffer.size()), '\0');
+        m_Buffer.append(m_Strings);
+        return std::move(m_Buffer);
+    }
+
+    const std::string& GetStrings() const {
+        return m_Strings;
+    }
+
+private:
+    std::string m_Buffer;
+    std::string m_Strings;
+};
+
+// Bounds-checked view over the mapped file
+class Reader {
+public:
+    Reader(const char* data, size_t size) : m_Data(data), m_Size(size) {}
+
+    template <typename T>
+    const T* Section(size_t count) {
+        m_Offset = Align(m_Offset);
+        if (count > (m_Size - std::min(m_Offset, m_Size)) / sizeof(T)) {
+            m_Failed = true;
+            return nullptr;
+        }
+        const T* records = reinterpret_cast<const T*>(m_Data + m_Offset);
+        m_Offset += count * sizeof(T);
+        return records;
+    }
+
+    bool Strings(uint32_t bytes) {
+        m_Strings = Section<char>(bytes);
+        m_StringBytes = bytes;
+        // The pool must end with a terminator so every offset yields a bounded string
+        return m_Strings && (bytes == 0 || m_Strings[bytes - 1] == '\0');
+    }
+
+    std::string String(uint32_t offset) {
+        if (offset >= m_StringBytes) {
+            m_Failed = true;
+            return std::string();
+        }
+        return std::string(m_Strings + offset);
+    }
+
+    bool Failed() const {
+        return m_Failed;
+    }
+
+private:
+    const char* m_Data;
+    size_t m_Size;
+    size_t m_Offset = 0;
+    const char* m_Strings = nullptr;
+    uint32_t m_StringBytes = 0;
+    bool m_Failed = false;
+};
+
+std::string Serialize(uint64_t key, const ModuleCacheEntry& entry) {
+    const Module& module = *entry.module;
+    Writer writer;
+
+    std::vector<SymbolRecord> symbols;
+    for (const auto& [path, range] : module.slots) {
+        symbols.push_back({writer.Intern(path), range.index, range.width, 0});
+    }
+
+    std::vector<HandlerRecord> handlers;
+    std::vector<InstructionRecord> instructions;
+    for (const auto& handler : module.handlers) {
+        handlers.push_back({writer.Intern(handler.name), writer.Intern(handler.behavior), handler.location.line,
+                            static_cast<uint32_t>(instructions.size()), static_cast<uint32_t>(handler.code.size())});
+        for (const auto& inst : handler.code) {
+            InstructionRecord record = {};
+            record.op = static_cast<uint8_t>(inst.op);
+            record.width = inst.width;
+            record.dst = inst.dst;
+            record.src = inst.src;
+            std::memcpy(record.imm, inst.imm.data(), sizeof(record.imm));
+            record.line = inst.location.line;
+            record.stage = static_cast<uint16_t>(inst.location.stage);
+            instructions.push_back(record);
+        }
+    }
+
+    std::vector<TemplateRecord> templates;
+    std::vector<float> values;
+    for (const auto& entityTemplate : module.templates) {
+        templates.push_back({writer.Intern(entityTemplate.name), static_cast<uint32_t>(values.size()),
+                             static_cast<uint32_t>(entityTemplate.initialSlots.size())});
+        values.insert(values.end(), entityTemplate.initialSlots.begin(), entityTemplate.initialSlots.end());
+    }
+
+    std::vector<uint32_t> names;
+    for (const auto* list : {&entry.declarations, &entry.references, &entry.paths}) {
+        for (const auto& name : *list) {
+            names.push_back(writer.Intern(name));
+        }
+    }
+
+    CacheHeader header = {};
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.formatVersion = ModuleCache::FORMAT_VERSION;
+    header.slotCount = module.slotCount;
+    header.key = key;
+    header.moduleHash = HashModule(module);
+    header.symbolCount = static_cast<uint32_t>(symbols.size());
+    header.handlerCount = static_cast<uint32_t>(handlers.size());
+    header.instructionCount = static_cast<uint32_t>(instructions.size());
+    header.templateCount = static_cast<uint32_t>(templates.size());
+    header.valueCount = static_cast<uint32_t>(values.size());
+    header.declarationCount = static_cast<uint32_t>(entry.declarations.size());
+    header.referenceCount = static_cast<uint32_t>(entry.references.size());
+    header.pathCount = static_cast<uint32_t>(entry.paths.size());
+    header.stringBytes = static_cast<uint32_t>(writer.GetStrings().size());
+
+    writer.Header(header);
+    writer.Section(symbols);
+    writer.Section(handlers);
+    writer.Section(instructions);
+    writer.Section(templates);
+    writer.Section(values);
+    writer.Section(names);
+    return writer.Finish();
+}
+
+// The runtime indexes entity slots with instruction operands unchecked, so an
+// instruction that would reach past the slots is rejected like a bad hash
+bool IsValidInstruction(const InstructionRecord& inst, uint32_t slotCount, uint32_t following) {
+    if (inst.op > static_cast<uint8_t>(OpCode::Wait) || inst.width == 0 || inst.width > 4) {
+        return false;
+    }
+    switch (static_cast<OpCode>(inst.op)) {
+        case OpCode::Copy:
+        case OpCode::AddScaled:
+            return inst.dst + inst.width <= slotCount && inst.src + inst.width <= slotCount;
+        case OpCode::Store:
+        case OpCode::Add:
+            return inst.dst + inst.width <= slotCount;
+        case OpCode::TestFlag:
+            return inst.src + inst.width <= slotCount;
+        case OpCode::TestKey:
+            return inst.src < 256;          // Key codes index InputState::keys
+        case OpCode::Segment:
+            return inst.dst <= following;     // Instructions the segment covers
+        default:
+            return true;
+    }
+}
+
+bool Deserialize(const char* data, size_t size, uint64_t key, ModuleCacheEntry& entry) {
+    Reader reader(data, size);
+    const auto* header = reader.Section<CacheHeader>(1);
+    if (!header || std::memcmp(header->magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+        header->formatVersion != ModuleCache::FORMAT_VERSION || header->key != key) {
+        return false;
+    }
+
+    const auto* symbols = reader.Section<SymbolRecord>(header->symbolCount);
+    const auto* handlers = reader.Section<HandlerRecord>(header->handlerCount);
+    const auto* instructions = reader.Section<InstructionRecord>(header->instructionCount);
+    const auto* templates = reader.Section<TemplateRecord>(header->templateCount);
+    const auto* values = reader.Section<float>(header->valueCount);
+    const auto* names = reader.Section<uint32_t>(header->declarationCount + header->referenceCount + header->pathCount);
+    if (reader.Failed() || !reader.Strings(header->stringBytes) || header->slotCount > UINT16_MAX) {
+        return false;
+    }
+
+    auto module = std::make_shared<Module>();
+    module->slotCount = static_cast<uint16_t>(header->slotCount);
+    for (uint32_t i = 0; i < header->symbolCount; ++i) {
+        if (symbols[i].index + symbols[i].width > header->slotCount) {
+            return false;
+        }
+        module->slots[reader.String(symbols[i].name)] = {symbols[i].index, symbols[i].width};
+    }
+
+    module->handlers.resize(header->handlerCount);
+    for (uint32_t i = 0; i < header->handlerCount; ++i) {
+        const HandlerRecord& record = handlers[i];
+        if (record.firstInstruction > header->instructionCount ||
+            record.instructionCount > header->instructionCount - record.firstInstruction) {
+            return false;
+        }
+        Handler& handler = module->handlers[i];
+        handler.name = reader.String(record.name);
+        handler.behavior = reader.String(record.behavior);
+        handler.location.line = record.line;
+        handler.code.resize(record.instructionCount);
+        for (uint32_t pc = 0; pc < record.instructionCount; ++pc) {
+            const InstructionRecord& source = instructions[record.firstInstruction + pc];
+            if (!IsValidInstruction(source, header->slotCount, record.instructionCount - pc - 1)) {
+                return false;
+            }
+            Instruction& inst = handler.code[pc];
+            inst.op = static_cast<OpCode>(source.op);
+            inst.width = source.width;
+            inst.dst = source.dst;
+            inst.src = source.src;
+            std::memcpy(inst.imm.data(), source.imm, sizeof(source.imm));
+            inst.location.line = source.line;
+            inst.location.stage = source.stage;
+        }
+    }
+
+    module->templates.resize(header->templateCount);
+    for (uint32_t i = 0; i < header->templateCount; ++i) {
+        const TemplateRecord& record = templates[i];
+        // Spawning copies a full set of slots from the template
+        if (record.valueCount != header->slotCount || record.firstValue > header->valueCount ||
+            record.valueCount > header->valueCount - record.firstValue) {
+            return false;
+        }
+        module->templates[i].name = reader.String(record.name);
+        module->templates[i].initialSlots.assign(values + record.firstValue,
+                                                 values + record.firstValue + record.valueCount);
+    }
+
+    uint32_t next = 0;
+    for (auto [list, count] : {std::make_pair(&entry.declarations, header->declarationCount),
+                               std::make_pair(&entry.references, header->referenceCount),
+                               std::make_pair(&entry.paths, header->pathCount)}) {
+        list->clear();
+        for (uint32_t i = 0; i < count; ++i) {
+            list->push_back(reader.String(names[next++]));
+        }
+    }
+
+    // Integrity check: the rebuilt module must hash to what was written
+    if (reader.Failed() || HashModule(*module) != header->moduleHash) {
+        return false;
+    }
+    entry.module = module;
+    return true;
+}
+
+} // namespace
+
+ModuleCache::ModuleCache(const std::string& directory) : m_Directory(directory) {}
+
+uint64_t ModuleCache::ComputeKey(const std::string& source, const OptimizerConfig& config) {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+
+    uint32_t format = FORMAT_VERSION;
+    mix(&format, sizeof(format));
+    const char* version = Version::GetVersionString();
+    mix(version, std::strlen(version));
+    const bool passes[] = {config.constantFolding, config.commonSubexpressions, config.deadStores, config.deadCode,
+                           config.flowFusion};
+    mix(passes, sizeof(passes));
+    mix(source.data(), source.size());
+    return hash;
+}
+
+std::string ModuleCache::GetPath(uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.aoplc", static_cast<unsigned long long>(key));
+    return (std::filesystem::path(m_Directory) / name).string();
+}
+
+bool ModuleCache::Load(uint64_t key, ModuleCacheEntry& entry, const std::string& label) {
+    auto start = std::chrono::steady_clock::now();
+    std::string path = GetPath(key);
+    bool exists = false;
+    bool loaded = false;
+
+#if !defined(_WIN32)
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        exists = true;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            size_t size = static_cast<size_t>(info.st_size);
+            void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                loaded = Deserialize(static_cast<const char*>(data), size, key, entry);
+                munmap(data, size);
+            }
+        }
+        close(fd);
+    }
+#else
+    std::ifstream file(path, std::ios::binary);
+    if (file) {
+        exists = true;
+        std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        loaded = Deserialize(data.data(), data.size(), key, entry);
+    }
+#endif
+
+    double milliseconds = MillisecondsSince(start);
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (loaded) {
+        ++m_Stats.hits;
+    } else {
+        ++m_Stats.misses;
+        if (exists) {
+            ++m_Stats.rejected;
+        }
+    }
+    m_Stats.loadMilliseconds += milliseconds;
+    m_Lookups.push_back({label, loaded, milliseconds});
+    return loaded;
+}
+
+bool ModuleCache::Store(uint64_t key, const ModuleCacheEntry& entry) {
+    if (!entry.module) {
+        return false;
+    }
+
+    try {
+        std::filesystem::create_directories(m_Directory);
+        std::string path = GetPath(key);
+
+        // Write next to the target and rename, so readers never see a partial file
+        std::ostringstream temporary;
+        temporary << path << ".tmp" << std::hash<std::thread::id>()(std::this_thread::get_id());
+        {
+            std::ofstream file(temporary.str(), std::ios::binary | std::ios::trunc);
+            std::string data = Serialize(key, entry);
+            file.write(data.data(), static_cast<std::streamsize>(data.size()));
+            if (!file) {
+                std::cerr << "Failed to write AOPL cache file: " << temporary.str() << std::endl;
+                return false;
+            }
+        }
+        std::filesystem::rename(temporary.str(), path);
+    } catch (const std::exception& e) {
+        std::cerr << "Error writing AOPL cache: " << e.what() << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    ++m_Stats.stores;
+    return true;
+}
+
+ModuleCacheStats ModuleCache::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Stats;
+}
+
+std::string ModuleCache::GetReport() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    std::ostringstream report;
+    report << "AOPL cache " << m_Directory << ": " << m_Stats.hits << " hit(s), " << m_Stats.misses << " miss(es)";
+    if (m_Stats.rejected > 0) {
+        report << ", " << m_Stats.rejected << " stale or corrupt";
+    }
+    report << "\n";
+    for (const auto& lookup : m_Lookups) {
+        report << "  " << (lookup.hit ? "hit  " : "miss ") << lookup.label;
+        if (lookup.hit) {
+            report << " (" << std::fixed << std::setprecision(3) << lookup.milliseconds << " ms)";
+        }
+        report << "\n";
+    }
+    return report.str();
+}
+
+} // namespace aopl
+} // namespace gaia_matrix
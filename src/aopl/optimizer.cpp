@@ -0,0 +1,374 @@
+#include "gaia_matrix/aopl_runtime.h"
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace gaia_matrix {
+namespace aopl {
+
+namespace {
+
+bool IsGuard(const Instruction& inst) {
+    return inst.op == OpCode::TestKey || inst.op == OpCode::TestFlag;
+}
+
+bool IsFused(const Handler& handler) {
+    for (const auto& inst : handler.code) {
+        if (inst.op == OpCode::Segment) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SameBits(float a, float b) {
+    return std::memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+// Segment markers are bookkeeping, not work, and are not counted
+uint32_t CountInstructions(const Module& module) {
+    uint32_t count = 0;
+    for (const auto& handler : module.handlers) {
+        for (const auto& inst : handler.code) {
+            count += inst.op != OpCode::Segment ? 1 : 0;
+        }
+    }
+    return count;
+}
+
+// Propagate values written by constant stores, fold reads of known slots and
+// resolve guards on known flags.
+void FoldConstants(Handler& handler, OptimizerStats& stats) {
+    std::unordered_map<uint16_t, float> known;
+    std::vector<Instruction> out;
+
+    auto allKnown = [&known](uint16_t base, uint8_t width) {
+        for (int i = 0; i < width; ++i) {
+            if (!known.count(static_cast<uint16_t>(base + i))) {
+                return false;
+            }
+        }
+        return true;
+    };
+    auto forget = [&known](uint16_t base, uint8_t width) {
+        for (int i = 0; i < width; ++i) {
+            known.erase(static_cast<uint16_t>(base + i));
+        }
+    };
+
+    for (size_t pc = 0; pc < handler.code.size(); ++pc) {
+        Instruction inst = handler.code[pc];
+        switch (inst.op) {
+            case OpCode::Wait:
+                // Other handlers and the host may write any slot while the handler is suspended
+                known.clear();
+                break;
+            case OpCode::TestFlag: {
+                auto it = known.find(inst.src);
+                if (it == known.end()) {
+                    break;
+                }
+                ++stats.guardsFolded;
+                if ((it->second != 0.0f) == (inst.imm[0] != 0.0f)) {
+                    continue; // Always passes
+                }
+                // Always fails: nothing after this guard can run
+                stats.deadInstructionsRemoved += static_cast<uint32_t>(handler.code.size() - pc - 1);
+                handler.code = std::move(out);
+                return;
+            }
+            case OpCode::Store: {
+                bool redundant = allKnown(inst.dst, inst.width);
+                for (int i = 0; redundant && i < inst.width; ++i) {
+                    redundant = SameBits(known[static_cast<uint16_t>(inst.dst + i)], inst.imm[i]);
+                }
+                if (redundant) {
+                    ++stats.deadStoresRemoved;
+                    continue;
+                }
+                break;
+            }
+            case OpCode::Add:
+                if (allKnown(inst.dst, inst.width)) {
+                    for (int i = 0; i < inst.width; ++i) {
+                        inst.imm[i] = known[static_cast<uint16_t>(inst.dst + i)] + inst.imm[i];
+                    }
+                    inst.op = OpCode::Store;
+                    ++stats.constantsFolded;
+                }
+                break;
+            case OpCode::Copy:
+                if (allKnown(inst.src, inst.width)) {
+                    for (int i = 0; i < inst.width; ++i) {
+                        inst.imm[i] = known[static_cast<uint16_t>(inst.src + i)];
+                    }
+                    inst.op = OpCode::Store;
+                    ++stats.constantsFolded;
+                }
+                break;
+            default:
+                break;
+        }
+
+        // Track slot contents after the (possibly rewritten) instruction
+        switch (inst.op) {
+            case OpCode::Store:
+                for (int i = 0; i < inst.width; ++i) {
+                    known[static_cast<uint16_t>(inst.dst + i)] = inst.imm[i];
+                }
+                break;
+            case OpCode::Add:
+            case OpCode::Copy:
+            case OpCode::AddScaled:
+                forget(inst.dst, inst.width);
+                break;
+            default:
+                break;
+        }
+        out.push_back(inst);
+    }
+    handler.code = std::move(out);
+}
+
+// Input and flags cannot change between two identical guards unless the
+// flag slot is written in between; likewise for repeated copies.
+void EliminateCommonSubexpressions(Handler& handler, OptimizerStats& stats) {
+    std::unordered_set<uint16_t> testedKeys;
+    std::unordered_map<uint16_t, float> testedFlags;
+    std::vector<Instruction> copies;
+    std::vector<Instruction> out;
+
+    auto overlaps = [](uint16_t a, uint8_t aWidth, uint16_t b, uint8_t bWidth) {
+        return a < b + bWidth && b < a + aWidth;
+    };
+
+    for (const Instruction& inst : handler.code) {
+        if (inst.op == OpCode::Wait) {
+            // Input and slots may change while suspended
+            testedKeys.clear();
+            testedFlags.clear();
+            copies.clear();
+        } else if (inst.op == OpCode::TestKey) {
+            if (!testedKeys.insert(inst.src).second) {
+                ++stats.guardsDeduplicated;
+                continue;
+            }
+        } else if (inst.op == OpCode::TestFlag) {
+            auto it = testedFlags.find(inst.src);
+            if (it != testedFlags.end() && (it->second != 0.0f) == (inst.imm[0] != 0.0f)) {
+                ++stats.guardsDeduplicated;
+                continue;
+            }
+            testedFlags[inst.src] = inst.imm[0];
+        } else if (inst.op == OpCode::Copy) {
+            bool repeated = false;
+            for (const auto& copy : copies) {
+                repeated = repeated || (copy.dst == inst.dst && copy.src == inst.src && copy.width == inst.width);
+            }
+            if (repeated) {
+                ++stats.copiesDeduplicated;
+                continue;
+            }
+        }
+
+        // Any write invalidates facts about the slots it touches
+        if (inst.op == OpCode::Store || inst.op == OpCode::Add || inst.op == OpCode::Copy ||
+            inst.op == OpCode::AddScaled) {
+            for (int i = 0; i < inst.width; ++i) {
+                testedFlags.erase(static_cast<uint16_t>(inst.dst + i));
+            }
+            std::vector<Instruction> stillValid;
+            for (const auto& copy : copies) {
+                if (!overlaps(copy.dst, copy.width, inst.dst, inst.width) &&
+                    !overlaps(copy.src, copy.width, inst.dst, inst.width)) {
+                    stillValid.push_back(copy);
+                }
+            }
+            copies = std::move(stillValid);
+            if (inst.op == OpCode::Copy && !overlaps(inst.dst, inst.width, inst.src, inst.width)) {
+                copies.push_back(inst);
+            }
+        }
+        out.push_back(inst);
+    }
+    handler.code = std::move(out);
+}
+
+// Backwards scan: a write is dead if the slot is fully overwritten later
+// with no read or guard in between. Guards make every earlier write
+// observable because an abort leaves the entity state as-is; so does a
+// `⧖`, since the state is visible to everyone while the handler waits.
+void EliminateDeadStores(Handler& handler, OptimizerStats& stats) {
+    std::unordered_set<uint16_t> overwritten;
+    std::vector<Instruction> reversed;
+
+    auto allOverwritten = [&overwritten](uint16_t base, uint8_t width) {
+        for (int i = 0; i < width; ++i) {
+            if (!overwritten.count(static_cast<uint16_t>(base + i))) {
+                return false;
+            }
+        }
+        return true;
+    };
+    auto mark = [&overwritten](uint16_t base, uint8_t width, bool written) {
+        for (int i = 0; i < width; ++i) {
+            if (written) {
+                overwritten.insert(static_cast<uint16_t>(base + i));
+            } else {
+                overwritten.erase(static_cast<uint16_t>(base + i));
+            }
+        }
+    };
+
+    for (auto it = handler.code.rbegin(); it != handler.code.rend(); ++it) {
+        const Instruction& inst = *it;
+        switch (inst.op) {
+            case OpCode::TestKey:
+            case OpCode::TestFlag:
+            case OpCode::Wait:
+                overwritten.clear();
+                break;
+            case OpCode::Store:
+            case OpCode::Copy:
+                if (allOverwritten(inst.dst, inst.width)) {
+                    ++stats.deadStoresRemoved;
+                    continue;
+                }
+                mark(inst.dst, inst.width, true);
+                if (inst.op == OpCode::Copy) {
+                    mark(inst.src, inst.width, false);
+                }
+                break;
+            case OpCode::Add:
+            case OpCode::AddScaled:
+                if (allOverwritten(inst.dst, inst.width)) {
+                    ++stats.deadStoresRemoved;
+                    continue;
+                }
+                mark(inst.dst, inst.width, false);
+                if (inst.op == OpCode::AddScaled) {
+                    mark(inst.src, inst.width, false);
+                }
+                break;
+            default:
+                break;
+        }
+        reversed.push_back(inst);
+    }
+    handler.code.assign(reversed.rbegin(), reversed.rend());
+}
+
+// Drop no-ops and trailing guards; a guard with nothing after it cannot
+// change entity state.
+void EliminateDeadCode(Handler& handler, OptimizerStats& stats) {
+    std::vector<Instruction> out;
+    for (const Instruction& inst : handler.code) {
+        if (inst.op == OpCode::Nop) {
+            ++stats.deadInstructionsRemoved;
+            continue;
+        }
+        out.push_back(inst);
+    }
+    while (!out.empty() && IsGuard(out.back())) {
+        out.pop_back();
+        ++stats.deadInstructionsRemoved;
+    }
+    handler.code = std::move(out);
+}
+
+// Handlers only touch the slots of the entity they run on, so running a
+// behavior's handlers back to back per entity is equivalent to running
+// each over the whole world in turn, and costs one pass instead of many.
+// Resumable handlers are left alone: a suspended segment would hold up
+// the segments after it.
+void FuseFlows(Module& module, OptimizerStats& stats) {
+    auto fusable = [&module](size_t index) {
+        return !IsFused(module.handlers[index]) && !IsResumable(module.handlers[index]);
+    };
+
+    std::vector<Handler> fused;
+    for (size_t i = 0; i < module.handlers.size();) {
+        size_t end = i + 1;
+        while (end < module.handlers.size() && module.handlers[end].behavior == module.handlers[i].behavior &&
+               fusable(end) && fusable(i)) {
+            ++end;
+        }
+
+        if (end - i == 1) {
+            fused.push_back(std::move(module.handlers[i]));
+            i = end;
+            continue;
+        }
+
+        Handler flow;
+        flow.name = module.handlers[i].behavior;
+        flow.behavior = module.handlers[i].behavior;
+        flow.location = module.handlers[i].location;
+        for (size_t h = i; h < end; ++h) {
+            Handler& handler = module.handlers[h];
+            bool hasGuard = false;
+            for (const auto& inst : handler.code) {
+                hasGuard = hasGuard || IsGuard(inst);
+            }
+            if (hasGuard) {
+                Instruction segment;
+                segment.op = OpCode::Segment;
+                segment.dst = static_cast<uint16_t>(handler.code.size());
+                segment.location = handler.location;
+                flow.code.push_back(segment);
+            }
+            flow.code.insert(flow.code.end(), handler.code.begin(), handler.code.end());
+        }
+        stats.handlersFused += static_cast<uint32_t>(end - i);
+        fused.push_back(std::move(flow));
+        i = end;
+    }
+    module.handlers = std::move(fused);
+}
+
+} // namespace
+
+OptimizerStats OptimizeModule(Module& module, const OptimizerConfig& config) {
+    OptimizerStats stats;
+    stats.instructionsBefore = CountInstructions(module);
+
+    for (auto& handler : module.handlers) {
+        if (IsFused(handler)) {
+            continue;
+        }
+        if (config.constantFolding) {
+            FoldConstants(handler, stats);
+        }
+        if (config.commonSubexpressions) {
+            EliminateCommonSubexpressions(handler, stats);
+        }
+        if (config.deadStores) {
+            EliminateDeadStores(handler, stats);
+        }
+        if (config.deadCode) {
+            EliminateDeadCode(handler, stats);
+        }
+    }
+
+    if (config.deadCode) {
+        std::vector<Handler> live;
+        for (auto& handler : module.handlers) {
+            if (handler.code.empty()) {
+                ++stats.handlersRemoved;
+            } else {
+                live.push_back(std::move(handler));
+            }
+        }
+        module.handlers = std::move(live);
+    }
+
+    if (config.flowFusion) {
+        FuseFlows(module, stats);
+    }
+
+    stats.instructionsAfter = CountInstructions(module);
+    return stats;
+}
+
+} // namespace aopl
+} // namespace gaia_matrix
@@ -1,12 +1,289 @@
 #include "gaia_matrix/aopl.h"
+#include "gaia_matrix/aopl_runtime.h"
 #include <iostream>
-#include <sstream>
 #include <vector>
 #include <unordered_map>
+#include <map>
+#include <algorithm>
+#include <cctype>
 
 namespace gaia_matrix {
 namespace aopl {
 
+namespace {
+
+std::string Trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+bool StartsWith(const std::string& text, const std::string& prefix) {
+    return text.compare(0, prefix.size(), prefix) == 0;
+}
+
+// Remove a trailing `# comment`, ignoring '#' inside string literals
+std::string StripComment(const std::string& line) {
+    bool inString = false;
+    for (size_t i = 0; i < line.size(); ++i) {
+        if (line[i] == '"') {
+            inString = !inString;
+        } else if (line[i] == '#' && !inString) {
+            return line.substr(0, i);
+        }
+    }
+    return line;
+}
+
+// Extract the text between the first 〈 〉 pair at or after `from`
+bool ExtractAngle(const std::string& text, size_t from, std::string& inner, size_t& endPos) {
+    size_t open = text.find(Symbol::ANGLE_OPEN, from);
+    if (open == std::string::npos) {
+        return false;
+    }
+    size_t innerBegin = open + std::string(Symbol::ANGLE_OPEN).size();
+    size_t close = text.find(Symbol::ANGLE_CLOSE, innerBegin);
+    if (close == std::string::npos) {
+        return false;
+    }
+    inner = Trim(text.substr(innerBegin, close - innerBegin));
+    endPos = close + std::string(Symbol::ANGLE_CLOSE).size();
+    return true;
+}
+
+std::vector<std::string> SplitOn(const std::string& text, const std::string& separator) {
+    std::vector<std::string> parts;
+    size_t start = 0;
+    while (true) {
+        size_t pos = text.find(separator, start);
+        parts.push_back(Trim(text.substr(start, pos == std::string::npos ? std::string::npos : pos - start)));
+        if (pos == std::string::npos) {
+            break;
+        }
+        start = pos + separator.size();
+    }
+    return parts;
+}
+
+bool IsIdentifier(const std::string& text) {
+    if (text.empty() || !(std::isalpha(static_cast<unsigned char>(text[0])) || text[0] == '_')) {
+        return false;
+    }
+    for (char c : text) {
+        if (!(std::isalnum(static_cast<unsigned char>(c)) || c == '_')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string Unquote(const std::string& token) {
+    if (token.size() >= 2 && token.front() == '"' && token.back() == '"') {
+        return token.substr(1, token.size() - 2);
+    }
+    return token;
+}
+
+// Tokenise on whitespace, keeping quoted strings together
+std::vector<std::string> Tokenize(const std::string& text) {
+    std::vector<std::string> tokens;
+    std::string current;
+    bool inString = false;
+    for (char c : text) {
+        if (c == '"') {
+            inString = !inString;
+            current += c;
+        } else if (!inString && (c == ' ' || c == '\t')) {
+            if (!current.empty()) {
+                tokens.push_back(current);
+                current.clear();
+            }
+        } else {
+            current += c;
+        }
+    }
+    if (!current.empty()) {
+        tokens.push_back(current);
+    }
+    return tokens;
+}
+
+// Split on '\n' only; a trailing newline yields a final empty line, so
+// there is always at least one line to place an edit cursor on
+std::vector<std::string> SplitLines(const std::string& text) {
+    std::vector<std::string> lines;
+    size_t start = 0;
+    while (true) {
+        size_t pos = text.find('\n', start);
+        lines.push_back(text.substr(start, pos == std::string::npos ? std::string::npos : pos - start));
+        if (pos == std::string::npos) {
+            break;
+        }
+        start = pos + 1;
+    }
+    return lines;
+}
+
+// Node declaration lines start a new block. Must agree with the declaration
+// forms recognised by Parser::ParseLine.
+bool IsDeclaration(const std::string& line) {
+    if (line.empty()) {
+        return false;
+    }
+    if (line[0] == Symbol::NODE && StartsWith(Trim(line.substr(1)), Symbol::DECLARATION)) {
+        return true;
+    }
+    for (const char* kind : {Symbol::NEURAL_NET, Symbol::REINFORCE, Symbol::GENETIC}) {
+        if (StartsWith(line, std::string(kind) + Symbol::ANGLE_OPEN)) {
+            return true;
+        }
+    }
+    return StartsWith(line, std::string(Symbol::ANGLE_OPEN) + Symbol::MODEL_PROC + Symbol::ANGLE_CLOSE) ||
+           StartsWith(line, std::string(1, Symbol::NODE) + Symbol::ANGLE_OPEN);
+}
+
+void ShiftStages(std::vector<Stage>& stages, int delta) {
+    for (auto& stage : stages) {
+        stage.location.line += delta;
+    }
+}
+
+bool SameStages(const std::vector<Stage>& a, const std::vector<Stage>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].tokens != b[i].tokens) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SameEntity(const Entity& a, const Entity& b) {
+    const auto& left = a.GetComponents();
+    const auto& right = b.GetComponents();
+    if (left.size() != right.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < left.size(); ++i) {
+        if (left[i]->GetType() != right[i]->GetType() || !SameStages(left[i]->GetStages(), right[i]->GetStages())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SameAINode(const AINode& a, const AINode& b) {
+    return a.GetKind() == b.GetKind() && SameStages(a.GetFlow(), b.GetFlow()) &&
+           a.GetProperties() == b.GetProperties();
+}
+
+// Bindings grouped by handler name, in source order
+std::map<std::string, std::vector<const Binding*>> GroupBindings(const Behavior& behavior) {
+    std::map<std::string, std::vector<const Binding*>> handlers;
+    for (const auto& binding : behavior.GetBindings()) {
+        handlers[binding.handler].push_back(&binding);
+    }
+    return handlers;
+}
+
+// Report what differs between the nodes of the reparsed region before and after an edit
+void DiffNodes(const std::vector<std::shared_ptr<Node>>& before, const std::vector<std::shared_ptr<Node>>& after,
+               ParseChanges& changes) {
+    std::map<std::string, std::shared_ptr<Entity>> entities[2];
+    std::map<std::string, std::shared_ptr<Behavior>> behaviors[2];
+    std::map<std::string, std::shared_ptr<AINode>> aiNodes[2];
+    const std::vector<std::shared_ptr<Node>>* sides[2] = {&before, &after};
+    for (int side = 0; side < 2; ++side) {
+        for (const auto& node : *sides[side]) {
+            if (auto entity = std::dynamic_pointer_cast<Entity>(node)) {
+                entities[side][entity->GetName()] = entity;
+            } else if (auto behavior = std::dynamic_pointer_cast<Behavior>(node)) {
+                behaviors[side][behavior->GetName()] = behavior;
+            } else if (auto aiNode = std::dynamic_pointer_cast<AINode>(node)) {
+                aiNodes[side][aiNode->GetName()] = aiNode;
+            }
+        }
+    }
+
+    // Walk the union of names of both sides; `same` is only called when both exist
+    auto diff = [](const auto& old, const auto& now, std::vector<std::string>& changed, auto same) {
+        auto names = old;
+        names.insert(now.begin(), now.end());
+        for (const auto& [name, node] : names) {
+            auto left = old.find(name);
+            auto right = now.find(name);
+            if (left == old.end() || right == now.end() || !same(left->second, right->second)) {
+                changed.push_back(name);
+            }
+        }
+    };
+
+    diff(entities[0], entities[1], changes.changedEntities,
+         [](const auto& a, const auto& b) { return SameEntity(*a, *b); });
+    diff(aiNodes[0], aiNodes[1], changes.changedAINodes,
+         [](const auto& a, const auto& b) { return SameAINode(*a, *b); });
+    diff(behaviors[0], behaviors[1], changes.changedBehaviors, [](const auto& a, const auto& b) {
+        const auto& left = a->GetBindings();
+        const auto& right = b->GetBindings();
+        if (!SameStages(a->GetFlow(), b->GetFlow()) || left.size() != right.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < left.size(); ++i) {
+            if (left[i].handler != right[i].handler || !SameStages(left[i].stages, right[i].stages)) {
+                return false;
+            }
+        }
+        return true;
+    });
+
+    for (const auto& behaviorName : changes.changedBehaviors) {
+        std::map<std::string, std::vector<const Binding*>> handlers[2];
+        for (int side = 0; side < 2; ++side) {
+            auto it = behaviors[side].find(behaviorName);
+            if (it != behaviors[side].end()) {
+                handlers[side] = GroupBindings(*it->second);
+            }
+        }
+        std::vector<std::string> changedHandlers;
+        diff(handlers[0], handlers[1], changedHandlers,
+             [](const std::vector<const Binding*>& a, const std::vector<const Binding*>& b) {
+                 if (a.size() != b.size()) {
+                     return false;
+                 }
+                 for (size_t i = 0; i < a.size(); ++i) {
+                     if (!SameStages(a[i]->stages, b[i]->stages)) {
+                         return false;
+                     }
+                 }
+                 return true;
+             });
+        for (const auto& handler : changedHandlers) {
+            changes.changedHandlers.push_back(behaviorName + "." + handler);
+        }
+    }
+}
+
+} // namespace
+
+std::vector<Stage> SplitFlow(const std::string& text, int line) {
+    std::vector<Stage> stages;
+    for (const auto& part : SplitOn(text, Symbol::DATAFLOW)) {
+        Stage stage;
+        stage.tokens = Tokenize(part);
+        stage.location.line = line;
+        stage.location.stage = static_cast<int>(stages.size());
+        if (!stage.tokens.empty()) {
+            stages.push_back(std::move(stage));
+        }
+    }
+    return stages;
+}
+
 // Implementation of Node class
 Node::Node(const std::string& name) : m_Name(name) {}
 
@@ -14,10 +291,49 @@ const std::string& Node::GetName() const {
     return m_Name;
 }
 
+const SourceLocation& Node::GetLocation() const {
+    return m_Location;
+}
+
+void Node::SetLocation(const SourceLocation& location) {
+    m_Location = location;
+}
+
+void Node::ShiftLines(int delta) {
+    m_Location.line += delta;
+}
+
+// Implementation of Component class
+Component::Component(char type, const std::vector<Stage>& stages)
+    : Node(std::string(1, type)), m_Type(type), m_Stages(stages) {}
+
+char Component::GetType() const {
+    return m_Type;
+}
+
+const std::vector<Stage>& Component::GetStages() const {
+    return m_Stages;
+}
+
+void Component::SetStages(const std::vector<Stage>& stages) {
+    m_Stages = stages;
+}
+
+void Component::ShiftLines(int delta) {
+    Node::ShiftLines(delta);
+    ShiftStages(m_Stages, delta);
+}
+
+// Implementation of Transform class
+Transform::Transform() : Component(Symbol::TRANSFORM) {}
+
 // Implementation of Entity class
 Entity::Entity(const std::string& name) : Node(name) {}
 
 void Entity::AddComponent(std::shared_ptr<Component> component) {
+    if (auto transform = std::dynamic_pointer_cast<Transform>(component)) {
+        m_Transform = transform;
+    }
     m_Components.push_back(component);
 }
 
@@ -29,83 +345,500 @@ std::shared_ptr<Transform> Entity::GetTransform() const {
     return m_Transform;
 }
 
+std::shared_ptr<Component> Entity::GetComponent(char type) const {
+    for (const auto& component : m_Components) {
+        if (component->GetType() == type) {
+            return component;
+        }
+    }
+    return nullptr;
+}
+
+void Entity::ShiftLines(int delta) {
+    Node::ShiftLines(delta);
+    for (const auto& component : m_Components) {
+        component->ShiftLines(delta);
+    }
+}
+
+// Implementation of Behavior class
+Behavior::Behavior(const std::string& name, const std::vector<Stage>& flow)
+    : Node(name), m_Flow(flow) {}
+
+void Behavior::AddBinding(const Binding& binding) {
+    m_Bindings.push_back(binding);
+}
+
+const std::vector<Binding>& Behavior::GetBindings() const {
+    return m_Bindings;
+}
+
+const std::vector<Stage>& Behavior::GetFlow() const {
+    return m_Flow;
+}
+
+void Behavior::ShiftLines(int delta) {
+    Node::ShiftLines(delta);
+    ShiftStages(m_Flow, delta);
+    for (auto& binding : m_Bindings) {
+        binding.location.line += delta;
+        ShiftStages(binding.stages, delta);
+    }
+}
+
+// Implementation of AINode class
+AINode::AINode(const std::string& kind, const std::string& name, const std::vector<Stage>& flow)
+    : Node(name), m_Kind(kind), m_Flow(flow) {}
+
+const std::string& AINode::GetKind() const {
+    return m_Kind;
+}
+
+const std::vector<Stage>& AINode::GetFlow() const {
+    return m_Flow;
+}
+
+void AINode::SetProperty(const std::string& key, const std::vector<std::string>& values) {
+    m_Properties[key] = values;
+}
+
+const std::vector<std::string>* AINode::GetProperty(const std::string& key) const {
+    auto it = m_Properties.find(key);
+    return it != m_Properties.end() ? &it->second : nullptr;
+}
+
+const std::unordered_map<std::string, std::vector<std::string>>& AINode::GetProperties() const {
+    return m_Properties;
+}
+
+void AINode::ShiftLines(int delta) {
+    Node::ShiftLines(delta);
+    ShiftStages(m_Flow, delta);
+}
+
 // Implementation of Parser class
 Parser::Parser() {}
 
 Parser::~Parser() {}
 
 bool Parser::Parse(const std::string& code) {
-    // Clear previous parsing results
+    m_Module = nullptr;
+    m_Lines = SplitLines(code);
+    m_Blocks = SplitBlocks(1, static_cast<int>(m_Lines.size()) + 1);
+    for (auto& block : m_Blocks) {
+        ParseBlock(block);
+    }
+    RebuildFromBlocks();
+
+    m_IsParsed = true;
+    return m_Errors.empty();
+}
+
+bool Parser::ApplyEdit(const TextEdit& edit, ParseChanges& changes) {
+    changes = ParseChanges();
+    if (!m_IsParsed) {
+        std::cerr << "Cannot apply edit: code has not been parsed yet" << std::endl;
+        return false;
+    }
+
+    auto validPosition = [this](int line, int column) {
+        return line >= 1 && line <= static_cast<int>(m_Lines.size()) && column >= 0 &&
+               column <= static_cast<int>(m_Lines[line - 1].size());
+    };
+    if (!validPosition(edit.startLine, edit.startColumn) || !validPosition(edit.endLine, edit.endColumn) ||
+        edit.endLine < edit.startLine || (edit.endLine == edit.startLine && edit.endColumn < edit.startColumn)) {
+        std::cerr << "Invalid AOPL edit range: " << edit.startLine << ":" << edit.startColumn << "-" << edit.endLine
+                  << ":" << edit.endColumn << std::endl;
+        return false;
+    }
+
+    auto findBlock = [this](int line) {
+        auto it = std::upper_bound(m_Blocks.begin(), m_Blocks.end(), line,
+                                   [](int value, const Block& block) { return value < block.firstLine; });
+        return static_cast<size_t>(it - m_Blocks.begin()) - 1;
+    };
+    size_t first = findBlock(edit.startLine);
+    size_t last = findBlock(edit.endLine);
+    // Editing a declaration line may merge its block into the previous one
+    if (first > 0 && edit.startLine == m_Blocks[first].firstLine) {
+        --first;
+    }
+    int regionBegin = m_Blocks[first].firstLine;
+    int regionEnd = m_Blocks[last].firstLine + m_Blocks[last].lineCount;
+
+    // Splice the replacement into the line buffer
+    std::string merged = m_Lines[edit.startLine - 1].substr(0, edit.startColumn) + edit.text +
+                         m_Lines[edit.endLine - 1].substr(edit.endColumn);
+    std::vector<std::string> replacement = SplitLines(merged);
+    int delta = static_cast<int>(replacement.size()) - (edit.endLine - edit.startLine + 1);
+    m_Lines.erase(m_Lines.begin() + (edit.startLine - 1), m_Lines.begin() + edit.endLine);
+    m_Lines.insert(m_Lines.begin() + (edit.startLine - 1), std::make_move_iterator(replacement.begin()),
+                   std::make_move_iterator(replacement.end()));
+
+    std::vector<Block> reparsed = SplitBlocks(regionBegin, regionEnd + delta);
+    std::vector<std::shared_ptr<Node>> before;
+    std::vector<std::shared_ptr<Node>> after;
+    for (size_t i = first; i <= last; ++i) {
+        before.push_back(m_Blocks[i].node);
+    }
+    bool clean = true;
+    for (auto& block : reparsed) {
+        ParseBlock(block);
+        after.push_back(block.node);
+        clean = clean && block.errors.empty();
+    }
+    changes.blocksReparsed = static_cast<uint32_t>(reparsed.size());
+    changes.blocksReused = static_cast<uint32_t>(first);
+
+    // Blocks after the edit keep their nodes; only their line numbers move
+    for (size_t i = last + 1; i < m_Blocks.size(); ++i) {
+        Block& block = m_Blocks[i];
+        block.firstLine += delta;
+        if (delta != 0 && !block.errors.empty()) {
+            // Error messages carry line numbers, so regenerate them
+            ParseBlock(block);
+            ++changes.blocksReparsed;
+            continue;
+        }
+        if (delta != 0 && block.node) {
+            block.node->ShiftLines(delta);
+        }
+        ++changes.blocksReused;
+    }
+
+    m_Blocks.erase(m_Blocks.begin() + first, m_Blocks.begin() + last + 1);
+    m_Blocks.insert(m_Blocks.begin() + first, std::make_move_iterator(reparsed.begin()),
+                    std::make_move_iterator(reparsed.end()));
+    RebuildFromBlocks();
+    DiffNodes(before, after, changes);
+
+    m_Module = nullptr;
+    return clean;
+}
+
+std::string Parser::GetSource() const {
+    std::string source;
+    for (size_t i = 0; i < m_Lines.size(); ++i) {
+        if (i > 0) {
+            source += '\n';
+        }
+        source += m_Lines[i];
+    }
+    return source;
+}
+
+std::vector<Parser::Block> Parser::SplitBlocks(int firstLine, int endLine) const {
+    std::vector<Block> blocks;
+    for (int line = firstLine; line < endLine; ++line) {
+        if (blocks.empty() || IsDeclaration(Trim(StripComment(m_Lines[line - 1])))) {
+            Block block;
+            block.firstLine = line;
+            blocks.push_back(block);
+        }
+        ++blocks.back().lineCount;
+    }
+    return blocks;
+}
+
+void Parser::ParseBlock(Block& block) {
+    // Blocks do not depend on each other: every declaration resets the current node
+    m_CurrentEntity = nullptr;
+    m_CurrentBehavior = nullptr;
+    m_CurrentAINode = nullptr;
+    m_Errors.clear();
+
+    for (int lineNumber = block.firstLine; lineNumber < block.firstLine + block.lineCount; ++lineNumber) {
+        // Skip empty lines and comments
+        std::string line = Trim(StripComment(m_Lines[lineNumber - 1]));
+        if (line.empty()) {
+            continue;
+        }
+        ParseLine(line, lineNumber);
+    }
+
+    if (m_CurrentEntity) {
+        block.node = m_CurrentEntity;
+    } else if (m_CurrentBehavior) {
+        block.node = m_CurrentBehavior;
+    } else {
+        block.node = m_CurrentAINode;
+    }
+    block.errors = std::move(m_Errors);
+    m_Errors.clear();
+}
+
+void Parser::RebuildFromBlocks() {
     m_Entities.clear();
+    m_Behaviors.clear();
+    m_AINodes.clear();
     m_NodeRegistry.clear();
-    m_IsParsed = false;
-    
-    std::istringstream stream(code);
-    std::string line;
-    
-    std::shared_ptr<Entity> currentEntity = nullptr;
-    
-    while (std::getline(stream, line)) {
-        // Skip empty lines and comments
-        if (line.empty() || line[0] == '#') {
+    m_CurrentEntity = nullptr;
+    m_CurrentBehavior = nullptr;
+    m_CurrentAINode = nullptr;
+    CollectBlockErrors();
+
+    for (const auto& block : m_Blocks) {
+        if (!block.node) {
             continue;
         }
-        
-        // Parse line
-        // Entity definition: N ⊢ E〈T⊕C⊕I〉
-        if (line[0] == Symbol::NODE && line.find('E') != std::string::npos) {
-            // Extract entity name (if any)
-            std::string entityName = "Entity";
-            size_t anglePos = line.find('<');
-            if (anglePos != std::string::npos) {
-                entityName = line.substr(line.find('E') + 1, anglePos - line.find('E') - 1);
-                if (entityName.empty()) {
-                    entityName = "Entity";
+        if (auto entity = std::dynamic_pointer_cast<Entity>(block.node)) {
+            m_Entities.push_back(entity);
+        } else if (auto behavior = std::dynamic_pointer_cast<Behavior>(block.node)) {
+            m_Behaviors.push_back(behavior);
+        } else if (auto aiNode = std::dynamic_pointer_cast<AINode>(block.node)) {
+            m_AINodes.push_back(aiNode);
+        }
+        m_NodeRegistry[block.node->GetName()] = block.node;
+    }
+}
+
+void Parser::CollectBlockErrors() {
+    m_Errors.clear();
+    for (const auto& block : m_Blocks) {
+        m_Errors.insert(m_Errors.end(), block.errors.begin(), block.errors.end());
+    }
+}
+
+void Parser::ParseLine(const std::string& line, int lineNumber) {
+    SourceLocation location;
+    location.line = lineNumber;
+
+    // Entity definition: N ⊢ E〈Name〉〈T⊕C⊕I〉
+    if (line[0] == Symbol::NODE && StartsWith(Trim(line.substr(1)), Symbol::DECLARATION)) {
+        size_t entityPos = line.find(Symbol::ENTITY);
+        std::string entityName;
+        size_t endPos = 0;
+        if (entityPos == std::string::npos || !ExtractAngle(line, entityPos, entityName, endPos) || entityName.empty()) {
+            entityName = "Entity";
+            endPos = line.size();
+        }
+
+        m_CurrentEntity = std::make_shared<Entity>(entityName);
+        m_CurrentEntity->SetLocation(location);
+        m_CurrentBehavior = nullptr;
+        m_CurrentAINode = nullptr;
+        m_Entities.push_back(m_CurrentEntity);
+        m_NodeRegistry[entityName] = m_CurrentEntity;
+
+        // Declared component list, e.g. 〈T⊕C⊕I〉
+        std::string componentList;
+        size_t listEnd = 0;
+        if (ExtractAngle(line, endPos, componentList, listEnd)) {
+            for (const auto& type : SplitOn(componentList, Symbol::COMPOSITION)) {
+                if (type.size() != 1) {
+                    continue;
                 }
+                std::shared_ptr<Component> component;
+                if (type[0] == Symbol::TRANSFORM) {
+                    component = std::make_shared<Transform>();
+                } else {
+                    component = std::make_shared<Component>(type[0]);
+                }
+                component->SetLocation(location);
+                m_CurrentEntity->AddComponent(component);
             }
-            
-            currentEntity = std::make_shared<Entity>(entityName);
-            m_Entities.push_back(currentEntity);
-            m_NodeRegistry[entityName] = currentEntity;
-            
-            // TODO: Parse components in the entity definition
-            
-            continue;
         }
-        
-        // Transform component: T: P 0 0 0 → R 0 0 0 → S 1 1 1
-        if (line[0] == Symbol::TRANSFORM && currentEntity) {
-            // TODO: Parse transform component
-            continue;
+        return;
+    }
+
+    // AI nodes: NN〈Name〉: ..., RL〈Name〉: ..., GA〈Name〉: ..., 〈MCP〉 Name:
+    for (const char* kind : {Symbol::NEURAL_NET, Symbol::REINFORCE, Symbol::GENETIC}) {
+        if (StartsWith(line, std::string(kind) + Symbol::ANGLE_OPEN)) {
+            std::string name;
+            size_t endPos = 0;
+            ExtractAngle(line, 0, name, endPos);
+            size_t colon = line.find(':', endPos);
+            std::string flow = colon != std::string::npos ? line.substr(colon + 1) : "";
+
+            m_CurrentAINode = std::make_shared<AINode>(kind, name, SplitFlow(flow, lineNumber));
+            m_CurrentAINode->SetLocation(location);
+            m_CurrentEntity = nullptr;
+            m_CurrentBehavior = nullptr;
+            m_AINodes.push_back(m_CurrentAINode);
+            m_NodeRegistry[name] = m_CurrentAINode;
+            return;
         }
-        
-        // Component definition: C: F → ⊻ OnUpdate OnCollision
-        if (line[0] == Symbol::COMPONENT && currentEntity) {
-            // TODO: Parse component definition
-            continue;
+    }
+    if (StartsWith(line, std::string(Symbol::ANGLE_OPEN) + Symbol::MODEL_PROC + Symbol::ANGLE_CLOSE)) {
+        std::string rest = Trim(line.substr(std::string(Symbol::ANGLE_OPEN).size() +
+                                            std::string(Symbol::MODEL_PROC).size() +
+                                            std::string(Symbol::ANGLE_CLOSE).size()));
+        size_t colon = rest.find(':');
+        std::string name = Trim(rest.substr(0, colon));
+        std::string flow = colon != std::string::npos ? rest.substr(colon + 1) : "";
+
+        m_CurrentAINode = std::make_shared<AINode>(Symbol::MODEL_PROC, name, SplitFlow(flow, lineNumber));
+        m_CurrentAINode->SetLocation(location);
+        m_CurrentEntity = nullptr;
+        m_CurrentBehavior = nullptr;
+        m_AINodes.push_back(m_CurrentAINode);
+        m_NodeRegistry[name] = m_CurrentAINode;
+        return;
+    }
+
+    // Behavior node: N〈PlayerController〉: V ⊢ I → F Move → A Jump → C Collision
+    if (StartsWith(line, std::string(1, Symbol::NODE) + Symbol::ANGLE_OPEN)) {
+        std::string name;
+        size_t endPos = 0;
+        ExtractAngle(line, 0, name, endPos);
+        size_t colon = line.find(':', endPos);
+        std::string flow = colon != std::string::npos ? line.substr(colon + 1) : "";
+
+        m_CurrentBehavior = std::make_shared<Behavior>(name, SplitFlow(flow, lineNumber));
+        m_CurrentBehavior->SetLocation(location);
+        m_CurrentEntity = nullptr;
+        m_CurrentAINode = nullptr;
+        m_Behaviors.push_back(m_CurrentBehavior);
+        m_NodeRegistry[name] = m_CurrentBehavior;
+        return;
+    }
+
+    // Property: ⊸ Model "models/player_animator.onnx"
+    if (StartsWith(line, Symbol::ASSIGNMENT)) {
+        if (m_CurrentAINode) {
+            auto tokens = Tokenize(line.substr(std::string(Symbol::ASSIGNMENT).size()));
+            if (!tokens.empty()) {
+                std::vector<std::string> values;
+                for (size_t i = 1; i < tokens.size(); ++i) {
+                    values.push_back(Unquote(tokens[i]));
+                }
+                m_CurrentAINode->SetProperty(tokens[0], values);
+            }
         }
-        
-        // TODO: Parse other AOPL constructs
+        return;
     }
-    
-    m_IsParsed = true;
-    return true;
+
+    size_t colon = line.find(':');
+    if (colon == std::string::npos) {
+        m_Errors.push_back("line " + std::to_string(lineNumber) + ": unrecognized statement");
+        return;
+    }
+    std::string label = Trim(line.substr(0, colon));
+    std::vector<Stage> stages = SplitFlow(line.substr(colon + 1), lineNumber);
+
+    // Component line of the current entity: T: ..., C: ..., I: ...
+    if (m_CurrentEntity && label.size() == 1) {
+        std::shared_ptr<Component> component = m_CurrentEntity->GetComponent(label[0]);
+        if (!component) {
+            component = label[0] == Symbol::TRANSFORM ? std::make_shared<Transform>()
+                                                       : std::make_shared<Component>(label[0]);
+            m_CurrentEntity->AddComponent(component);
+        }
+        component->SetLocation(location);
+        component->SetStages(stages);
+
+        // Transform component: T: P 0 0 0 → R 0 0 0 → S 1 1 1
+        if (auto transform = std::dynamic_pointer_cast<Transform>(component)) {
+            for (const auto& stage : stages) {
+                if (stage.tokens.size() != 4 || stage.tokens[0].size() != 1) {
+                    continue;
+                }
+                std::array<float, 3>* target = nullptr;
+                switch (stage.tokens[0][0]) {
+                    case 'P': target = &transform->position; break;
+                    case 'R': target = &transform->rotation; break;
+                    case 'S': target = &transform->scale; break;
+                    default: break;
+                }
+                if (!target) {
+                    continue;
+                }
+                try {
+                    for (int i = 0; i < 3; ++i) {
+                        (*target)[i] = std::stof(stage.tokens[i + 1]);
+                    }
+                } catch (const std::exception&) {
+                    m_Errors.push_back("line " + std::to_string(lineNumber) + ": invalid transform value");
+                }
+            }
+        }
+        return;
+    }
+
+    // Handler binding inside a behavior: Move: I.K W → T.P z+ 0.1
+    if (m_CurrentBehavior && IsIdentifier(label)) {
+        Binding binding;
+        binding.handler = label;
+        binding.stages = stages;
+        binding.location = location;
+        m_CurrentBehavior->AddBinding(binding);
+        return;
+    }
+
+    m_Errors.push_back("line " + std::to_string(lineNumber) + ": unrecognized statement");
 }
 
 const std::vector<std::shared_ptr<Entity>>& Parser::GetEntities() const {
     return m_Entities;
 }
 
+const std::vector<std::shared_ptr<Behavior>>& Parser::GetBehaviors() const {
+    return m_Behaviors;
+}
+
+const std::vector<std::shared_ptr<AINode>>& Parser::GetAINodes() const {
+    return m_AINodes;
+}
+
+std::shared_ptr<Node> Parser::FindNode(const std::string& name) const {
+    auto it = m_NodeRegistry.find(name);
+    return it != m_NodeRegistry.end() ? it->second : nullptr;
+}
+
 bool Parser::Compile() {
     if (!m_IsParsed) {
         std::cerr << "Cannot compile: code has not been parsed yet" << std::endl;
         return false;
     }
-    
-    // TODO: Implement compilation
-    
+
+    // Parse errors stay reported, and a script that has any does not compile
+    CollectBlockErrors();
+    m_Warnings.clear();
+    if (!m_Errors.empty()) {
+        for (const auto& error : m_Errors) {
+            std::cerr << "AOPL parse error: " << error << std::endl;
+        }
+        return false;
+    }
+    auto module = LowerModule(*this, m_Errors, &m_Types);
+    for (const auto& ambiguity : m_Types.ambiguities) {
+        m_Warnings.push_back("line " + std::to_string(ambiguity.location.line) + ": " + ambiguity.message);
+    }
+    if (!module) {
+        for (const auto& error : m_Errors) {
+            std::cerr << "AOPL compile error: " << error << std::endl;
+        }
+        return false;
+    }
+
+    m_OptimizerStats = OptimizeModule(*module, m_OptimizerConfig);
+    m_Module = module;
     return true;
 }
 
+void Parser::SetOptimizerConfig(const OptimizerConfig& config) {
+    m_OptimizerConfig = config;
+}
+
+const OptimizerStats& Parser::GetOptimizerStats() const {
+    return m_OptimizerStats;
+}
+
+std::shared_ptr<const Module> Parser::GetModule() const {
+    return m_Module;
+}
+
+const TypeTable& Parser::GetTypes() const {
+    return m_Types;
+}
+
+const std::vector<std::string>& Parser::GetWarnings() const {
+    return m_Warnings;
+}
+
+const std::vector<std::string>& Parser::GetErrors() const {
+    return m_Errors;
+}
+
 } // namespace aopl
-} // namespace gaia_matrix
\ No newline at end of file
+} // namespace gaia_matrix
@@ -0,0 +1,252 @@
+#include "gaia_matrix/aopl_profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <tuple>
+
+namespace gaia_matrix {
+namespace aopl {
+
+namespace {
+
+std::string HandlerLabel(const Handler& handler) {
+    // Fused handlers carry the behavior name
+    return handler.name == handler.behavior ? handler.behavior : handler.behavior + "." + handler.name;
+}
+
+} // namespace
+
+std::string ProfileEntry::GetLocation() const {
+    std::string location = file.empty() ? "line " + std::to_string(line) : file + ":" + std::to_string(line);
+    if (stage >= 0) {
+        location += " →" + std::to_string(stage);
+    }
+    return location;
+}
+
+Profiler::Profiler(const ProfilerConfig& config) : m_Config(config) {}
+
+Profiler::~Profiler() {
+    m_Running = false;
+    if (m_Sampler.joinable()) {
+        m_Sampler.join();
+    }
+}
+
+void Profiler::Reset(std::shared_ptr<const Module> module) {
+    m_Running = false;
+    if (m_Sampler.joinable()) {
+        m_Sampler.join();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Module = module;
+        m_Handlers.assign(module ? module->handlers.size() : 0, HandlerProfile());
+        for (size_t i = 0; i < m_Handlers.size(); ++i) {
+            size_t size = module->handlers[i].code.size();
+            m_Handlers[i].counts.assign(size, 0);
+            m_Handlers[i].samples.assign(size + 1, 0);
+        }
+    }
+    m_Handler = IDLE;
+    m_Cursor = IDLE;
+
+    if (module && m_Config.mode == ProfileMode::Sampling) {
+        m_Running = true;
+        m_Sampler = std::thread([this]() {
+            auto interval = std::chrono::microseconds(std::max<uint32_t>(1, m_Config.sampleIntervalMicroseconds));
+            while (m_Running) {
+                std::this_thread::sleep_for(interval);
+                Sample();
+            }
+        });
+    }
+}
+
+ProfileMode Profiler::GetMode() const {
+    return m_Config.mode;
+}
+
+void Profiler::Enter(size_t index) {
+    m_Cursor.store(IDLE, std::memory_order_relaxed);
+    m_Handler.store(static_cast<uint32_t>(index), std::memory_order_relaxed);
+}
+
+void Profiler::Leave() {
+    m_Handler.store(IDLE, std::memory_order_relaxed);
+}
+
+void Profiler::Record(size_t index, uint64_t invocations, double milliseconds) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (index < m_Handlers.size()) {
+        m_Handlers[index].invocations += invocations;
+        m_Handlers[index].milliseconds += milliseconds;
+    }
+}
+
+uint64_t* Profiler::GetInstructionCounts(size_t index) {
+    return m_Handlers[index].counts.data();
+}
+
+std::atomic<uint32_t>* Profiler::GetCursor() {
+    return &m_Cursor;
+}
+
+void Profiler::Sample() {
+    uint32_t handler = m_Handler.load(std::memory_order_relaxed);
+    uint32_t pc = m_Cursor.load(std::memory_order_relaxed);
+    if (handler == IDLE) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (handler >= m_Handlers.size()) {
+        return;
+    }
+    // The last bucket collects native code, whose position is not published
+    auto& samples = m_Handlers[handler].samples;
+    ++samples[std::min<size_t>(pc, samples.size() - 1)];
+}
+
+std::vector<ProfileEntry> Profiler::GetEntries(ProfileLevel level) const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    std::vector<ProfileEntry> entries;
+    if (!m_Module) {
+        return entries;
+    }
+
+    double total = 0.0;
+    for (const auto& profile : m_Handlers) {
+        total += profile.milliseconds;
+    }
+
+    for (size_t index = 0; index < m_Handlers.size(); ++index) {
+        const Handler& handler = m_Module->handlers[index];
+        const HandlerProfile& profile = m_Handlers[index];
+
+        ProfileEntry base;
+        base.file = handler.file;
+        base.line = handler.location.line;
+        base.handler = HandlerLabel(handler);
+
+        if (level == ProfileLevel::Handler) {
+            base.invocations = profile.invocations;
+            base.milliseconds = profile.milliseconds;
+            for (uint64_t samples : profile.samples) {
+                base.samples += samples;
+            }
+            entries.push_back(base);
+            continue;
+        }
+
+        // Weight of each instruction: executions (exact) or sampler hits
+        bool exact = m_Config.mode == ProfileMode::Exact;
+        const auto& weights = exact ? profile.counts : profile.samples;
+        uint64_t totalWeight = 0;
+        for (uint64_t weight : weights) {
+            totalWeight += weight;
+        }
+
+        std::map<std::pair<int, int>, ProfileEntry> sites;
+        auto site = [&](int line, int stage) -> ProfileEntry& {
+            auto key = std::make_pair(line, level == ProfileLevel::Stage ? stage : -1);
+            auto it = sites.find(key);
+            if (it == sites.end()) {
+                ProfileEntry entry = base;
+                entry.line = key.first;
+                entry.stage = key.second;
+                it = sites.emplace(key, entry).first;
+            }
+            return it->second;
+        };
+
+        std::map<std::pair<int, int>, bool> reached;
+        for (size_t pc = 0; pc < weights.size(); ++pc) {
+            bool native = pc == handler.code.size();
+            int line = native ? handler.location.line : handler.code[pc].location.line;
+            int stage = native ? -1 : handler.code[pc].location.stage;
+            ProfileEntry& entry = site(line, stage);
+            if (!exact) {
+                entry.samples += weights[pc];
+            } else if (!reached[{entry.line, entry.stage}]) {
+                // Entities reaching a line or stage run its first instruction
+                reached[{entry.line, entry.stage}] = true;
+                entry.invocations = weights[pc];
+            }
+            if (totalWeight > 0) {
+                entry.milliseconds += profile.milliseconds * static_cast<double>(weights[pc]) / totalWeight;
+            }
+        }
+        for (auto& [key, entry] : sites) {
+            if (entry.milliseconds > 0.0 || entry.invocations > 0 || entry.samples > 0) {
+                entries.push_back(entry);
+            }
+        }
+    }
+
+    for (auto& entry : entries) {
+        entry.percent = total > 0.0 ? 100.0 * entry.milliseconds / total : 0.0;
+    }
+    std::stable_sort(entries.begin(), entries.end(), [](const ProfileEntry& a, const ProfileEntry& b) {
+        if (a.milliseconds != b.milliseconds) {
+            return a.milliseconds > b.milliseconds;
+        }
+        return std::tie(a.file, a.line, a.stage) < std::tie(b.file, b.line, b.stage);
+    });
+    return entries;
+}
+
+std::string Profiler::GetReport() const {
+    auto handlers = GetEntries(ProfileLevel::Handler);
+    auto lines = GetEntries(ProfileLevel::Line);
+    auto stages = GetEntries(ProfileLevel::Stage);
+    bool exact = m_Config.mode == ProfileMode::Exact;
+
+    double total = 0.0;
+    uint64_t samples = 0;
+    for (const auto& entry : handlers) {
+        total += entry.milliseconds;
+        samples += entry.samples;
+    }
+
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(3);
+    report << "AOPL profile (" << (exact ? "exact" : "sampling, " + std::to_string(samples) + " samples") << "): "
+           << total << " ms in " << handlers.size() << " handler(s)\n";
+
+    auto row = [&report, exact](const ProfileEntry& entry, const char* indent, bool counts) {
+        report << indent << std::setw(6) << std::setprecision(1) << entry.percent << "%  " << std::setw(9)
+               << std::setprecision(3) << entry.milliseconds << " ms";
+        if (counts) {
+            report << "  " << std::setw(9) << entry.invocations << " runs";
+        } else if (!exact) {
+            report << "  " << std::setw(9) << entry.samples << " hits";
+        }
+        report << "  " << entry.GetLocation();
+    };
+
+    for (const auto& handler : handlers) {
+        row(handler, "  ", true);
+        report << "  " << handler.handler << "\n";
+        for (const auto& line : lines) {
+            if (line.handler != handler.handler || line.file != handler.file) {
+                continue;
+            }
+            row(line, "    ", exact);
+            report << "\n";
+            for (const auto& stage : stages) {
+                if (stage.handler == line.handler && stage.file == line.file && stage.line == line.line) {
+                    row(stage, "      ", exact);
+                    report << (stage.stage < 0 ? "  (native code)" : "") << "\n";
+                }
+            }
+        }
+    }
+    return report.str();
+}
+
+} // namespace aopl
+} // namespace gaia_matrix
@@ -0,0 +1,429 @@
+#include "gaia_matrix/aopl_project.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+namespace gaia_matrix {
+namespace aopl {
+
+namespace {
+
+constexpr uint16_t UNMAPPED = 0xFFFF;
+
+double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Collect `E Name` stages of a node header
+void CollectReferences(const std::vector<Stage>& stages, ProjectFile& file) {
+    for (const auto& stage : stages) {
+        if (stage.tokens.size() == 2 && stage.tokens[0].size() == 1 && stage.tokens[0][0] == Symbol::ENTITY) {
+            file.references.push_back(stage.tokens[1]);
+        }
+    }
+}
+
+} // namespace
+
+ProjectCompiler::ProjectCompiler(const ProjectConfig& config) : m_Config(config) {
+    if (!m_Config.cacheDirectory.empty()) {
+        m_Cache = std::make_unique<ModuleCache>(m_Config.cacheDirectory);
+    }
+}
+
+void ProjectCompiler::AddFile(const std::string& path, const std::string& source) {
+    ProjectFile file;
+    file.path = path;
+    file.source = source;
+    m_Files.push_back(std::move(file));
+}
+
+bool ProjectCompiler::UpdateFile(const std::string& path, const std::string& source) {
+    for (auto& file : m_Files) {
+        if (file.path == path) {
+            if (file.source == source) {
+                return false;
+            }
+            file.source = source;
+            file.dirty = true;
+            return true;
+        }
+    }
+    AddFile(path, source);
+    return true;
+}
+
+bool ProjectCompiler::RemoveFile(const std::string& path) {
+    auto it = std::find_if(m_Files.begin(), m_Files.end(), [&path](const ProjectFile& file) {
+        return file.path == path;
+    });
+    if (it == m_Files.end()) {
+        return false;
+    }
+    m_Files.erase(it);
+    return true;
+}
+
+size_t ProjectCompiler::AddDirectory(const std::string& directory) {
+    std::vector<std::filesystem::path> paths;
+    try {
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(directory)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".aopl") {
+                paths.push_back(entry.path());
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error scanning AOPL directory " << directory << ": " << e.what() << std::endl;
+        return 0;
+    }
+    std::sort(paths.begin(), paths.end());
+
+    size_t added = 0;
+    for (const auto& path : paths) {
+        std::ifstream file(path);
+        if (!file) {
+            std::cerr << "Failed to read AOPL source: " << path.string() << std::endl;
+            continue;
+        }
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        AddFile(std::filesystem::relative(path, directory).generic_string(), buffer.str());
+        ++added;
+    }
+    return added;
+}
+
+bool ProjectCompiler::Build() {
+    m_Module = nullptr;
+    m_BuildOrder.clear();
+    m_Errors.clear();
+    m_Stats = ProjectStats();
+
+    // Parallel phase: every changed file is parsed, lowered and optimized on its own
+    auto compileStart = std::chrono::steady_clock::now();
+    uint32_t threads = m_Config.threadCount ? m_Config.threadCount : std::thread::hardware_concurrency();
+
+    // Files compiled by an earlier Build() and not changed since are kept as they are
+    std::vector<size_t> pending;
+    for (size_t i = 0; i < m_Files.size(); ++i) {
+        if (m_Files[i].dirty || !m_Files[i].module) {
+            pending.push_back(i);
+        }
+    }
+    threads = std::max<uint32_t>(1, std::min<uint32_t>(threads, static_cast<uint32_t>(pending.size())));
+
+    std::atomic<size_t> next{0};
+    auto worker = [this, &next, &pending]() {
+        for (size_t i = next++; i < pending.size(); i = next++) {
+            CompileFile(m_Files[pending[i]]);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (uint32_t i = 1; i < threads; ++i) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+
+    m_Stats.filesCompiled = static_cast<uint32_t>(pending.size());
+    m_Stats.threadsUsed = threads;
+    m_Stats.compileMilliseconds = MillisecondsSince(compileStart);
+
+    for (size_t index : pending) {
+        if (m_Cache) {
+            ++(m_Files[index].fromCache ? m_Stats.cacheHits : m_Stats.cacheMisses);
+        }
+    }
+    for (const auto& file : m_Files) {
+        for (const auto& error : file.errors) {
+            m_Errors.push_back(file.path + ": " + error);
+        }
+    }
+    if (!m_Errors.empty()) {
+        return false;
+    }
+
+    // Serial phase: resolve cross-file references, order and link
+    auto linkStart = std::chrono::steady_clock::now();
+    if (!ResolveDependencies() || !SortFiles()) {
+        return false;
+    }
+    if (!Link()) {
+        return false;
+    }
+    m_Stats.linkMilliseconds = MillisecondsSince(linkStart);
+    return true;
+}
+
+void ProjectCompiler::CompileFile(ProjectFile& file) {
+    file.declarations.clear();
+    file.references.clear();
+    file.paths.clear();
+    file.dependencies.clear();
+    file.module = nullptr;
+    file.errors.clear();
+    file.fromCache = false;
+    file.dirty = false;
+
+    uint64_t key = 0;
+    if (m_Cache) {
+        key = ModuleCache::ComputeKey(file.source, m_Config.optimizer);
+        ModuleCacheEntry entry;
+        if (m_Cache->Load(key, entry, file.path)) {
+            file.module = entry.module;
+            file.declarations = std::move(entry.declarations);
+            file.references = std::move(entry.references);
+            file.paths = std::move(entry.paths);
+            file.fromCache = true;
+            return;
+        }
+    }
+
+    Parser parser;
+    parser.SetOptimizerConfig(m_Config.optimizer);
+    parser.Parse(file.source);
+    file.errors = parser.GetErrors();
+
+    for (const auto& entity : parser.GetEntities()) {
+        file.declarations.push_back(entity->GetName());
+    }
+    for (const auto& behavior : parser.GetBehaviors()) {
+        file.declarations.push_back(behavior->GetName());
+        CollectReferences(behavior->GetFlow(), file);
+    }
+    for (const auto& aiNode : parser.GetAINodes()) {
+        file.declarations.push_back(aiNode->GetName());
+        CollectReferences(aiNode->GetFlow(), file);
+        for (const auto& [key, values] : aiNode->GetProperties()) {
+            for (const auto& value : values) {
+                if (value.find('.') != std::string::npos) {
+                    file.paths.push_back(value);
+                }
+            }
+        }
+    }
+
+    if (!file.errors.empty()) {
+        return;
+    }
+    if (!parser.Compile()) {
+        file.errors = parser.GetErrors();
+        return;
+    }
+    file.module = parser.GetModule();
+
+    // Only clean compiles are cached, so errors are always reported afresh
+    if (m_Cache) {
+        m_Cache->Store(key, {file.module, file.declarations, file.references, file.paths});
+    }
+}
+
+bool ProjectCompiler::ResolveDependencies() {
+    std::unordered_map<std::string, size_t> owners;
+    for (size_t i = 0; i < m_Files.size(); ++i) {
+        for (const auto& name : m_Files[i].declarations) {
+            auto [it, inserted] = owners.emplace(name, i);
+            if (!inserted && it->second != i) {
+                m_Errors.push_back(m_Files[i].path + ": '" + name + "' is already declared in " +
+                                   m_Files[it->second].path);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < m_Files.size(); ++i) {
+        ProjectFile& file = m_Files[i];
+        std::set<size_t> dependencies;
+        for (const auto& name : file.references) {
+            auto it = owners.find(name);
+            if (it == owners.end()) {
+                m_Errors.push_back(file.path + ": unresolved reference '" + name + "'");
+            } else if (it->second != i) {
+                dependencies.insert(it->second);
+            }
+        }
+        // Property paths only add edges; their root may be a built-in such as `V`
+        for (const auto& path : file.paths) {
+            auto it = owners.find(path.substr(0, path.find('.')));
+            if (it != owners.end() && it->second != i) {
+                dependencies.insert(it->second);
+            }
+        }
+        file.dependencies.assign(dependencies.begin(), dependencies.end());
+    }
+    return m_Errors.empty();
+}
+
+bool ProjectCompiler::SortFiles() {
+    // Kahn's algorithm, taking ready files in the order they were added
+    std::vector<size_t> pending(m_Files.size());
+    std::vector<std::vector<size_t>> dependents(m_Files.size());
+    for (size_t i = 0; i < m_Files.size(); ++i) {
+        pending[i] = m_Files[i].dependencies.size();
+        for (size_t dependency : m_Files[i].dependencies) {
+            dependents[dependency].push_back(i);
+        }
+    }
+
+    std::set<size_t> ready;
+    for (size_t i = 0; i < m_Files.size(); ++i) {
+        if (pending[i] == 0) {
+            ready.insert(i);
+        }
+    }
+    while (!ready.empty()) {
+        size_t index = *ready.begin();
+        ready.erase(ready.begin());
+        m_BuildOrder.push_back(index);
+        for (size_t dependent : dependents[index]) {
+            if (--pending[dependent] == 0) {
+                ready.insert(dependent);
+            }
+        }
+    }
+
+    if (m_BuildOrder.size() != m_Files.size()) {
+        std::string cycle;
+        for (size_t i = 0; i < m_Files.size(); ++i) {
+            if (pending[i] != 0) {
+                cycle += (cycle.empty() ? "" : ", ") + m_Files[i].path;
+            }
+        }
+        m_Errors.push_back("cyclic dependency between " + cycle);
+        m_BuildOrder.clear();
+        return false;
+    }
+    return true;
+}
+
+bool ProjectCompiler::Link() {
+    // An empty parser lowers to the built-in slot layout
+    std::vector<std::string> errors;
+    auto module = LowerModule(Parser(), errors);
+
+    // File-local slot index -> project slot index, per file
+    std::vector<std::vector<uint16_t>> remaps(m_Files.size());
+
+    for (size_t index : m_BuildOrder) {
+        const Module& local = *m_Files[index].module;
+        std::vector<uint16_t>& remap = remaps[index];
+        remap.assign(local.slotCount, UNMAPPED);
+
+        // Allocate in local index order so the linked layout is deterministic; a
+        // vector variable comes before its per-axis aliases
+        std::vector<std::pair<const std::string*, Module::SlotRange>> ranges;
+        for (const auto& [path, range] : local.slots) {
+            ranges.emplace_back(&path, range);
+        }
+        std::sort(ranges.begin(), ranges.end(), [](const auto& a, const auto& b) {
+            if (a.second.index != b.second.index) {
+                return a.second.index < b.second.index;
+            }
+            return a.second.width != b.second.width ? a.second.width > b.second.width : *a.first < *b.first;
+        });
+        for (const auto& [path, range] : ranges) {
+            Module::SlotRange target;
+            if (const auto* existing = module->FindSlot(*path)) {
+                if (existing->width != range.width) {
+                    m_Errors.push_back(m_Files[index].path + ": '" + *path + "' has " +
+                                       std::to_string(range.width) + " component(s) here but " +
+                                       std::to_string(existing->width) + " in another file");
+                    return false;
+                }
+                target = *existing;
+            } else if (remap[range.index] != UNMAPPED) {
+                // Alias inside a range that was just allocated
+                target.index = remap[range.index];
+                target.width = range.width;
+                module->slots[*path] = target;
+            } else {
+                target.index = module->slotCount;
+                target.width = range.width;
+                module->slotCount = static_cast<uint16_t>(module->slotCount + range.width);
+                module->slots[*path] = target;
+            }
+            for (int i = 0; i < range.width; ++i) {
+                remap[range.index + i] = static_cast<uint16_t>(target.index + i);
+            }
+        }
+
+        for (Handler handler : local.handlers) {
+            handler.file = m_Files[index].path;
+            for (auto& inst : handler.code) {
+                switch (inst.op) {
+                    case OpCode::TestFlag:
+                        inst.src = remap[inst.src];
+                        break;
+                    case OpCode::Store:
+                    case OpCode::Add:
+                        inst.dst = remap[inst.dst];
+                        break;
+                    case OpCode::Copy:
+                    case OpCode::AddScaled:
+                        inst.dst = remap[inst.dst];
+                        inst.src = remap[inst.src];
+                        break;
+                    default:
+                        break;
+                }
+            }
+            module->handlers.push_back(std::move(handler));
+        }
+    }
+
+    // Templates are laid out once the final slot count is known
+    for (size_t index : m_BuildOrder) {
+        const Module& local = *m_Files[index].module;
+        for (const auto& localTemplate : local.templates) {
+            EntityTemplate entityTemplate;
+            entityTemplate.name = localTemplate.name;
+            entityTemplate.initialSlots.assign(module->slotCount, 0.0f);
+            for (size_t slot = 0; slot < localTemplate.initialSlots.size(); ++slot) {
+                entityTemplate.initialSlots[remaps[index][slot]] = localTemplate.initialSlots[slot];
+            }
+            module->templates.push_back(std::move(entityTemplate));
+        }
+    }
+
+    m_Module = module;
+    return true;
+}
+
+std::shared_ptr<const Module> ProjectCompiler::GetModule() const {
+    return m_Module;
+}
+
+const std::vector<ProjectFile>& ProjectCompiler::GetFiles() const {
+    return m_Files;
+}
+
+std::vector<std::string> ProjectCompiler::GetBuildOrder() const {
+    std::vector<std::string> order;
+    for (size_t index : m_BuildOrder) {
+        order.push_back(m_Files[index].path);
+    }
+    return order;
+}
+
+const std::vector<std::string>& ProjectCompiler::GetErrors() const {
+    return m_Errors;
+}
+
+const ProjectStats& ProjectCompiler::GetStats() const {
+    return m_Stats;
+}
+
+const ModuleCache* ProjectCompiler::GetCache() const {
+    return m_Cache.get();
+}
+
+} // namespace aopl
+} // namespace gaia_matrix
@@ -0,0 +1,824 @@
+#include "gaia_matrix/aopl_runtime.h"
+#include "gaia_matrix/aopl_aot.h"
+#include "gaia_matrix/aopl_dataflow.h"
+#include "gaia_matrix/aopl_profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace gaia_matrix {
+namespace aopl {
+
+// Implementation of InputState
+void InputState::SetKey(int code, bool down) {
+    if (code < 0 || code >= 256) {
+        return;
+    }
+    uint64_t bit = uint64_t(1) << (code & 63);
+    if (down) {
+        keys[code >> 6] |= bit;
+    } else {
+        keys[code >> 6] &= ~bit;
+    }
+}
+
+bool InputState::IsKeyDown(int code) const {
+    if (code < 0 || code >= 256) {
+        return false;
+    }
+    return (keys[code >> 6] >> (code & 63)) & 1;
+}
+
+// Implementation of World
+World::World(uint16_t slotCount) : m_SlotCount(slotCount) {}
+
+EntityId World::Spawn(const EntityTemplate& entityTemplate) {
+    uint32_t lane = m_EntityCount % CHUNK_SIZE;
+    if (lane == 0) {
+        m_Chunks.emplace_back(static_cast<size_t>(m_SlotCount) * CHUNK_SIZE, 0.0f);
+    }
+
+    std::vector<float>& chunk = m_Chunks.back();
+    for (uint16_t slot = 0; slot < m_SlotCount && slot < entityTemplate.initialSlots.size(); ++slot) {
+        chunk[slot * CHUNK_SIZE + lane] = entityTemplate.initialSlots[slot];
+    }
+
+    return static_cast<EntityId>(m_EntityCount++);
+}
+
+uint32_t World::GetEntityCount() const {
+    return m_EntityCount;
+}
+
+float World::GetSlot(EntityId entity, uint16_t slot) const {
+    return m_Chunks[entity / CHUNK_SIZE][slot * CHUNK_SIZE + entity % CHUNK_SIZE];
+}
+
+void World::SetSlot(EntityId entity, uint16_t slot, float value) {
+    m_Chunks[entity / CHUNK_SIZE][slot * CHUNK_SIZE + entity % CHUNK_SIZE] = value;
+}
+
+uint32_t World::GetChunkCount() const {
+    return static_cast<uint32_t>(m_Chunks.size());
+}
+
+uint32_t World::GetChunkLaneCount(uint32_t chunk) const {
+    if (chunk + 1 < m_Chunks.size()) {
+        return CHUNK_SIZE;
+    }
+    uint32_t remainder = m_EntityCount % CHUNK_SIZE;
+    return remainder == 0 && m_EntityCount > 0 ? CHUNK_SIZE : remainder;
+}
+
+float* World::GetChunkData(uint32_t chunk) {
+    return m_Chunks[chunk].data();
+}
+
+uint16_t World::GetSlotCount() const {
+    return m_SlotCount;
+}
+
+void World::Migrate(uint16_t slotCount, const std::vector<int32_t>& sources) {
+    for (auto& chunk : m_Chunks) {
+        std::vector<float> migrated(static_cast<size_t>(slotCount) * CHUNK_SIZE, 0.0f);
+        for (uint16_t slot = 0; slot < slotCount && slot < sources.size(); ++slot) {
+            if (sources[slot] >= 0 && sources[slot] < m_SlotCount) {
+                std::copy_n(chunk.begin() + static_cast<size_t>(sources[slot]) * CHUNK_SIZE, CHUNK_SIZE,
+                            migrated.begin() + static_cast<size_t>(slot) * CHUNK_SIZE);
+            }
+        }
+        chunk = std::move(migrated);
+    }
+    m_SlotCount = slotCount;
+}
+
+namespace {
+
+constexpr uint16_t NO_TEMPLATE = 0xFFFF;
+
+bool SameCode(const Handler& a, const Handler& b) {
+    if (a.code.size() != b.code.size()) {
+        return false;
+    }
+    for (size_t pc = 0; pc < a.code.size(); ++pc) {
+        const Instruction& x = a.code[pc];
+        const Instruction& y = b.code[pc];
+        if (x.op != y.op || x.width != y.width || x.dst != y.dst || x.src != y.src || x.imm != y.imm) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+// Interpreter
+ExecutionResult InterpretFrom(const Handler& handler, uint32_t& start, float* lane, const InputState& input, float dt,
+                              float& wait, uint64_t* counts, std::atomic<uint32_t>* cursor) {
+    const auto& code = handler.code;
+    size_t segmentEnd = 0;
+
+    for (size_t pc = start; pc < code.size(); ++pc) {
+        const Instruction& inst = code[pc];
+        bool passed = true;
+        if (counts) {
+            ++counts[pc];
+        }
+        if (cursor) {
+            cursor->store(static_cast<uint32_t>(pc), std::memory_order_relaxed);
+        }
+
+        switch (inst.op) {
+            case OpCode::Nop:
+                break;
+            case OpCode::Segment:
+                segmentEnd = pc + 1 + inst.dst;
+                break;
+            case OpCode::TestKey:
+                passed = input.IsKeyDown(inst.src);
+                break;
+            case OpCode::TestFlag:
+                passed = (lane[inst.src * CHUNK_SIZE] != 0.0f) == (inst.imm[0] != 0.0f);
+                break;
+            case OpCode::Store:
+                for (int i = 0; i < inst.width; ++i) {
+                    lane[(inst.dst + i) * CHUNK_SIZE] = inst.imm[i];
+                }
+                break;
+            case OpCode::Add:
+                for (int i = 0; i < inst.width; ++i) {
+                    lane[(inst.dst + i) * CHUNK_SIZE] += inst.imm[i];
+                }
+                break;
+            case OpCode::Copy:
+                for (int i = 0; i < inst.width; ++i) {
+                    lane[(inst.dst + i) * CHUNK_SIZE] = lane[(inst.src + i) * CHUNK_SIZE];
+                }
+                break;
+            case OpCode::AddScaled:
+                for (int i = 0; i < inst.width; ++i) {
+                    lane[(inst.dst + i) * CHUNK_SIZE] += lane[(inst.src + i) * CHUNK_SIZE] * dt;
+                }
+                break;
+            case OpCode::Wait:
+                start = static_cast<uint32_t>(pc + 1);
+                wait = inst.imm[0];
+                return ExecutionResult::Suspended;
+        }
+
+        if (!passed) {
+            // A failed guard ends the current fused segment, or the whole handler
+            if (pc >= segmentEnd) {
+                return ExecutionResult::Aborted;
+            }
+            pc = segmentEnd - 1;
+        }
+    }
+    return ExecutionResult::Completed;
+}
+
+bool Interpret(const Handler& handler, float* lane, const InputState& input, float dt, uint64_t* counts,
+               std::atomic<uint32_t>* cursor) {
+    uint32_t pc = 0;
+    float wait = 0.0f;
+    return InterpretFrom(handler, pc, lane, input, dt, wait, counts, cursor) == ExecutionResult::Completed;
+}
+
+// Implementation of Runtime
+Runtime::Runtime(std::shared_ptr<const Module> module, const RuntimeConfig& config)
+    : m_Module(module), m_Config(config), m_World(module->slotCount), m_Timers(config.timerResolution) {
+    m_HandlerStates.resize(m_Module->handlers.size());
+    for (size_t i = 0; i < m_HandlerStates.size(); ++i) {
+        m_HandlerStates[i].resumable = IsResumable(m_Module->handlers[i]);
+    }
+    if (m_Config.enableJit && !JitCompiler::IsSupported()) {
+        std::cout << "AOPL JIT not supported on this platform, using interpreter" << std::endl;
+        m_Config.enableJit = false;
+    }
+    m_Graph = std::make_unique<DataflowGraph>(BuildDataflowGraph(*m_Module));
+    if (m_Config.threadCount != 1) {
+        m_Workers = std::make_unique<WorkerPool>(m_Config.threadCount);
+    }
+}
+
+Runtime::~Runtime() {}
+
+EntityId Runtime::Spawn(const std::string& templateName) {
+    const EntityTemplate* entityTemplate = m_Module->FindTemplate(templateName);
+    if (!entityTemplate) {
+        std::cerr << "AOPL entity template not found: " << templateName << std::endl;
+        return -1;
+    }
+    m_EntityTemplates.push_back(static_cast<uint16_t>(entityTemplate - m_Module->templates.data()));
+    EntityId entity = m_World.Spawn(*entityTemplate);
+    MarkChanged(entity);
+    return entity;
+}
+
+void Runtime::MarkChanged(EntityId entity) {
+    if (!m_Config.reactive || entity < 0 || static_cast<uint32_t>(entity) >= m_World.GetEntityCount()) {
+        return;
+    }
+    size_t slotCount = m_World.GetSlotCount();
+    m_RowVersions.resize(m_World.GetChunkCount() * slotCount, 0);
+    uint64_t version = ++m_Version;
+    auto rows = m_RowVersions.begin() + static_cast<size_t>(entity / CHUNK_SIZE) * slotCount;
+    std::fill(rows, rows + slotCount, version);
+}
+
+void Runtime::Tick(float dt) {
+    m_ActionMap.Resolve(m_Devices, m_Actions);
+
+    // Frames that yielded last tick resume before the ones the timer wheel releases
+    m_Timers.Advance(dt, m_Due);
+    m_Due.insert(m_Due.begin(), m_Yielded.begin(), m_Yielded.end());
+    m_Yielded.clear();
+
+    if (m_Config.reactive) {
+        for (size_t i = 0; i < m_ChangedKeys.size(); ++i) {
+            m_ChangedKeys[i] = m_Actions.keys[i] ^ m_PreviousKeys[i];
+        }
+        m_PreviousKeys = m_Actions.keys;
+        // Sized up front so parallel tasks never reallocate them
+        for (size_t i = 0; i < m_HandlerStates.size(); ++i) {
+            if (m_Graph->nodes[i].pure) {
+                m_HandlerStates[i].stamps.resize(m_World.GetChunkCount(), 0);
+            }
+        }
+    }
+    for (const Frame& frame : m_Due) {
+        Resume(frame, dt);
+    }
+
+    if (m_Workers && !m_Profiler) {
+        RunParallel(dt);
+    } else {
+        for (size_t i = 0; i < m_Module->handlers.size(); ++i) {
+            if (m_Profiler) {
+                RunProfiled(i, dt);
+            } else {
+                RunHandler(i, dt);
+            }
+        }
+    }
+
+    for (const Frame& frame : m_Resumed) {
+        SetSuspended(m_HandlerStates[frame.handler], frame.entity, false);
+    }
+    m_Resumed.clear();
+}
+
+size_t Runtime::GetSuspendedCount() const {
+    return m_Timers.GetPendingCount() + m_Yielded.size();
+}
+
+const TimerWheel& Runtime::GetTimers() const {
+    return m_Timers;
+}
+
+const DataflowGraph& Runtime::GetDataflowGraph() const {
+    return *m_Graph;
+}
+
+bool Runtime::IsSuspended(const HandlerState& state, EntityId entity) const {
+    size_t word = static_cast<size_t>(entity) >> 6;
+    return word < state.suspended.size() && ((state.suspended[word] >> (entity & 63)) & 1);
+}
+
+void Runtime::SetSuspended(HandlerState& state, EntityId entity, bool suspended) {
+    size_t word = static_cast<size_t>(entity) >> 6;
+    if (word >= state.suspended.size()) {
+        if (!suspended) {
+            return;
+        }
+        state.suspended.resize(word + 1, 0);
+    }
+    uint64_t bit = uint64_t(1) << (entity & 63);
+    state.suspended[word] = suspended ? state.suspended[word] | bit : state.suspended[word] & ~bit;
+}
+
+void Runtime::Suspend(size_t index, EntityId entity, uint32_t pc, float wait) {
+    Frame frame;
+    frame.entity = entity;
+    frame.handler = static_cast<uint16_t>(index);
+    frame.pc = static_cast<uint16_t>(pc);
+    if (wait > 0.0f) {
+        m_Timers.Schedule(frame, wait);
+    } else {
+        m_Yielded.push_back(frame);
+    }
+    SetSuspended(m_HandlerStates[index], entity, true);
+    ++m_Stats.suspensions;
+}
+
+void Runtime::Resume(const Frame& frame, float dt) {
+    const Handler& handler = m_Module->handlers[frame.handler];
+    uint64_t* counts = nullptr;
+    if (m_Profiler && m_Profiler->GetMode() == ProfileMode::Exact) {
+        counts = m_Profiler->GetInstructionCounts(frame.handler);
+    }
+
+    float* data = m_World.GetChunkData(static_cast<uint32_t>(frame.entity) / CHUNK_SIZE);
+    uint32_t pc = frame.pc;
+    float wait = 0.0f;
+    ExecutionResult result = InterpretFrom(handler, pc, data + frame.entity % CHUNK_SIZE, m_Actions, dt, wait, counts);
+    ++m_Stats.resumptions;
+    ++m_Stats.interpretedInvocations;
+    MarkWrites(frame.handler, static_cast<uint32_t>(frame.entity) / CHUNK_SIZE);
+
+    if (result == ExecutionResult::Suspended) {
+        // Waiting again: the entity's bit stays set
+        Suspend(frame.handler, frame.entity, pc, wait);
+    } else {
+        // The handler has had its run this tick; the bit is cleared after the handler pass
+        m_Resumed.push_back(frame);
+    }
+}
+
+void Runtime::RunResumable(size_t index, float dt, uint64_t* counts, std::atomic<uint32_t>* cursor) {
+    const Handler& handler = m_Module->handlers[index];
+    const HandlerState& state = m_HandlerStates[index];
+
+    for (uint32_t chunk = 0; chunk < m_World.GetChunkCount(); ++chunk) {
+        float* data = m_World.GetChunkData(chunk);
+        uint32_t lanes = m_World.GetChunkLaneCount(chunk);
+        for (uint32_t lane = 0; lane < lanes; ++lane) {
+            auto entity = static_cast<EntityId>(chunk * CHUNK_SIZE + lane);
+            if (IsSuspended(state, entity)) {
+                continue;
+            }
+            uint32_t pc = 0;
+            float wait = 0.0f;
+            if (InterpretFrom(handler, pc, data + lane, m_Actions, dt, wait, counts, cursor) ==
+                ExecutionResult::Suspended) {
+                Suspend(index, entity, pc, wait);
+            }
+            ++m_Stats.interpretedInvocations;
+        }
+        MarkWrites(index, chunk);
+    }
+}
+
+void Runtime::RunProfiled(size_t index, float dt) {
+    auto start = std::chrono::steady_clock::now();
+
+    if (m_Profiler->GetMode() == ProfileMode::Exact && m_HandlerStates[index].resumable) {
+        RunResumable(index, dt, m_Profiler->GetInstructionCounts(index), nullptr);
+    } else if (m_Profiler->GetMode() == ProfileMode::Exact) {
+        // Counts are only exact on the interpreter, so native tiers are bypassed
+        const Handler& handler = m_Module->handlers[index];
+        uint64_t* counts = m_Profiler->GetInstructionCounts(index);
+        for (uint32_t chunk = 0; chunk < m_World.GetChunkCount(); ++chunk) {
+            float* data = m_World.GetChunkData(chunk);
+            uint32_t lanes = m_World.GetChunkLaneCount(chunk);
+            for (uint32_t lane = 0; lane < lanes; ++lane) {
+                Interpret(handler, data + lane, m_Actions, dt, counts);
+            }
+            m_Stats.interpretedInvocations += lanes;
+            MarkWrites(index, chunk);
+        }
+    } else {
+        m_Profiler->Enter(index);
+        RunHandler(index, dt);
+        m_Profiler->Leave();
+    }
+
+    double milliseconds =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    m_Profiler->Record(index, m_World.GetEntityCount(), milliseconds);
+}
+
+void Runtime::RunHandler(size_t index, float dt) {
+    HandlerState& state = m_HandlerStates[index];
+    std::atomic<uint32_t>* cursor = m_Profiler ? m_Profiler->GetCursor() : nullptr;
+
+    if (state.resumable) {
+        // Suspension needs per-entity frames, which only the lane interpreter keeps
+        RunResumable(index, dt, nullptr, cursor);
+        return;
+    }
+    RunChunks(index, 0, m_World.GetChunkCount(), dt, m_Stats, state.invocations, true, cursor);
+}
+
+// With `tierUp` off (parallel tasks) the handler state is only read; the
+// caller merges `stats` and `invocations` and tiers up after the barrier.
+// In reactive mode each task owns the stamps and written rows of its
+// chunks, and handlers of one level never share rows.
+void Runtime::RunChunks(size_t index, uint32_t begin, uint32_t end, float dt, RuntimeStats& stats,
+                        uint32_t& invocations, bool tierUp, std::atomic<uint32_t>* cursor) {
+    if (!m_Config.reactive) {
+        for (uint32_t chunk = begin; chunk < end; ++chunk) {
+            RunChunk(index, chunk, dt, stats, invocations, tierUp, cursor);
+        }
+        return;
+    }
+
+    const DataflowNode& node = m_Graph->nodes[index];
+    HandlerState& state = m_HandlerStates[index];
+    thread_local std::vector<float> before;
+    before.resize(node.writes.size() * CHUNK_SIZE);
+
+    for (uint32_t chunk = begin; chunk < end; ++chunk) {
+        uint32_t lanes = m_World.GetChunkLaneCount(chunk);
+        if (node.pure && IsUpToDate(index, chunk)) {
+            stats.skippedEvaluations += lanes;
+            ++stats.skippedChunks;
+            continue;
+        }
+
+        // Only rows whose values actually change wake up the handlers reading them
+        float* data = m_World.GetChunkData(chunk);
+        for (size_t i = 0; i < node.writes.size(); ++i) {
+            std::copy_n(data + node.writes[i] * CHUNK_SIZE, lanes, before.data() + i * CHUNK_SIZE);
+        }
+        RunChunk(index, chunk, dt, stats, invocations, tierUp, cursor);
+        uint64_t* rows = m_RowVersions.data() + static_cast<size_t>(chunk) * m_World.GetSlotCount();
+        for (size_t i = 0; i < node.writes.size(); ++i) {
+            if (std::memcmp(data + node.writes[i] * CHUNK_SIZE, before.data() + i * CHUNK_SIZE,
+                            lanes * sizeof(float)) != 0) {
+                rows[node.writes[i]] = ++m_Version;
+            }
+        }
+        if (node.pure) {
+            state.stamps[chunk] = m_Version.load();
+        }
+    }
+}
+
+void Runtime::RunChunk(size_t index, uint32_t chunk, float dt, RuntimeStats& stats, uint32_t& invocations,
+                       bool tierUp, std::atomic<uint32_t>* cursor) {
+    const Handler& handler = m_Module->handlers[index];
+    HandlerState& state = m_HandlerStates[index];
+    float* data = m_World.GetChunkData(chunk);
+    uint32_t lanes = m_World.GetChunkLaneCount(chunk);
+
+    if (state.aot) {
+        for (uint32_t lane = 0; lane < lanes; ++lane) {
+            state.aot(data + lane, m_Actions.keys.data(), dt, m_LayoutEpoch);
+        }
+        stats.aotInvocations += lanes;
+        return;
+    }
+
+    if (m_Config.batchChunks && !(state.native && m_Config.enableJit)) {
+        InterpretChunk(handler, data, lanes, m_Actions, dt, cursor);
+        stats.interpretedInvocations += lanes;
+        ++stats.batchedChunks;
+
+        invocations += lanes;
+        if (tierUp) {
+            TierUp(index);
+        }
+        return;
+    }
+
+    for (uint32_t lane = 0; lane < lanes; ++lane) {
+        if (state.native && m_Config.enableJit) {
+            int result = state.native->Invoke(data + lane, m_Actions, dt, m_LayoutEpoch);
+            if (result != NativeHandler::Deoptimize) {
+                ++stats.nativeInvocations;
+                continue;
+            }
+
+            // Layout guard failed: drop the code and fall back to the interpreter
+            ++stats.deoptimizations;
+            if (tierUp) {
+                state.native.reset();
+                state.invocations = 0;
+            }
+        }
+
+        Interpret(handler, data + lane, m_Actions, dt, nullptr, cursor);
+        ++stats.interpretedInvocations;
+
+        ++invocations;
+        if (tierUp) {
+            TierUp(index);
+        }
+    }
+}
+
+bool Runtime::IsUpToDate(size_t index, uint32_t chunk) const {
+    const DataflowNode& node = m_Graph->nodes[index];
+    const HandlerState& state = m_HandlerStates[index];
+    if (chunk >= state.stamps.size() || state.stamps[chunk] == 0) {
+        return false;
+    }
+    for (size_t i = 0; i < m_ChangedKeys.size(); ++i) {
+        if (node.keys[i] & m_ChangedKeys[i]) {
+            return false;
+        }
+    }
+
+    // Writes count too: rerunning restores values something else overwrote
+    uint64_t stamp = state.stamps[chunk];
+    const uint64_t* rows = m_RowVersions.data() + static_cast<size_t>(chunk) * m_World.GetSlotCount();
+    for (uint16_t slot : node.reads) {
+        if (rows[slot] > stamp) {
+            return false;
+        }
+    }
+    for (uint16_t slot : node.writes) {
+        if (rows[slot] > stamp) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Per-entity paths (resumed frames, exact profiling) mark every written
+// row instead of diffing them
+void Runtime::MarkWrites(size_t index, uint32_t chunk) {
+    if (!m_Config.reactive) {
+        return;
+    }
+    uint64_t* rows = m_RowVersions.data() + static_cast<size_t>(chunk) * m_World.GetSlotCount();
+    for (uint16_t slot : m_Graph->nodes[index].writes) {
+        rows[slot] = ++m_Version;
+    }
+}
+
+void Runtime::RunParallel(float dt) {
+    // Entities per task: enough to amortise the hand-off, few enough to balance
+    constexpr uint32_t CHUNKS_PER_TASK = 16;
+
+    struct Task {
+        uint32_t handler;
+        uint32_t begin;
+        uint32_t end;
+        RuntimeStats stats;
+        uint32_t invocations;
+    };
+    std::vector<Task> tasks;
+    uint32_t chunkCount = m_World.GetChunkCount();
+
+    for (const auto& level : m_Graph->levels) {
+        tasks.clear();
+        for (uint32_t index : level) {
+            HandlerState& state = m_HandlerStates[index];
+            if (state.resumable) {
+                // Suspending touches the timer wheel, so these run on this thread
+                RunHandler(index, dt);
+                continue;
+            }
+            // Deoptimize before the tasks start, so they never change the handler state
+            if (state.native && state.nativeEpoch != m_LayoutEpoch) {
+                state.native.reset();
+                state.invocations = 0;
+                ++m_Stats.deoptimizations;
+            }
+            for (uint32_t begin = 0; begin < chunkCount; begin += CHUNKS_PER_TASK) {
+                tasks.push_back({index, begin, std::min(begin + CHUNKS_PER_TASK, chunkCount), RuntimeStats(), 0});
+            }
+        }
+
+        m_Workers->Run(tasks.size(), [this, &tasks, dt](size_t i) {
+            Task& task = tasks[i];
+            RunChunks(task.handler, task.begin, task.end, dt, task.stats, task.invocations, false, nullptr);
+        });
+
+        // Barrier passed: merge counters and tier up serially
+        for (const Task& task : tasks) {
+            m_Stats.interpretedInvocations += task.stats.interpretedInvocations;
+            m_Stats.nativeInvocations += task.stats.nativeInvocations;
+            m_Stats.aotInvocations += task.stats.aotInvocations;
+            m_Stats.batchedChunks += task.stats.batchedChunks;
+            m_Stats.deoptimizations += task.stats.deoptimizations;
+            m_Stats.skippedEvaluations += task.stats.skippedEvaluations;
+            m_Stats.skippedChunks += task.stats.skippedChunks;
+            m_HandlerStates[task.handler].invocations += task.invocations;
+        }
+        for (uint32_t index : level) {
+            if (!m_HandlerStates[index].resumable) {
+                TierUp(index);
+            }
+        }
+        if (tasks.size() > 1) {
+            ++m_Stats.parallelLevels;
+            m_Stats.parallelTasks += tasks.size();
+        }
+    }
+}
+
+void Runtime::TierUp(size_t index) {
+    HandlerState& state = m_HandlerStates[index];
+    if (!m_Config.enableJit || state.native || state.jitFailed || state.invocations < m_Config.jitThreshold) {
+        return;
+    }
+
+    state.native = JitCompiler::Compile(m_Module->handlers[index], m_LayoutEpoch);
+    state.nativeEpoch = m_LayoutEpoch;
+    if (state.native) {
+        ++m_Stats.compiledHandlers;
+    } else {
+        state.jitFailed = true;
+    }
+}
+
+float Runtime::GetValue(EntityId entity, const std::string& path) const {
+    const auto* range = m_Module->FindSlot(path);
+    if (!range || entity < 0 || static_cast<uint32_t>(entity) >= m_World.GetEntityCount()) {
+        return 0.0f;
+    }
+    return m_World.GetSlot(entity, range->index);
+}
+
+bool Runtime::SetValue(EntityId entity, const std::string& path, float value) {
+    const auto* range = m_Module->FindSlot(path);
+    if (!range || entity < 0 || static_cast<uint32_t>(entity) >= m_World.GetEntityCount()) {
+        return false;
+    }
+    m_World.SetSlot(entity, range->index, value);
+    if (m_Config.reactive) {
+        m_RowVersions[(entity / CHUNK_SIZE) * m_World.GetSlotCount() + range->index] = ++m_Version;
+    }
+    return true;
+}
+
+ReloadStats Runtime::Reload(std::shared_ptr<const Module> module) {
+    ReloadStats stats;
+    const Module& previous = *m_Module;
+
+    // Map every new slot to the old slot of the same name
+    std::vector<int32_t> sources(module->slotCount, -1);
+    for (const auto& [path, range] : module->slots) {
+        const auto* old = previous.FindSlot(path);
+        if (!old) {
+            continue;
+        }
+        for (int i = 0; i < std::min(range.width, old->width); ++i) {
+            sources[range.index + i] = old->index + i;
+        }
+    }
+    std::vector<bool> kept(previous.slotCount, false);
+    for (uint16_t slot = 0; slot < module->slotCount; ++slot) {
+        if (sources[slot] >= 0) {
+            kept[sources[slot]] = true;
+            ++stats.slotsMigrated;
+            stats.layoutChanged |= sources[slot] != slot;
+        } else {
+            ++stats.slotsAdded;
+        }
+    }
+    for (bool slotKept : kept) {
+        stats.slotsRemoved += slotKept ? 0 : 1;
+    }
+    stats.layoutChanged |= stats.slotsAdded > 0 || stats.slotsRemoved > 0;
+
+    // Templates are matched by name; entities of a removed template keep NO_TEMPLATE
+    std::vector<uint16_t> templates(previous.templates.size(), NO_TEMPLATE);
+    for (size_t i = 0; i < previous.templates.size(); ++i) {
+        if (const EntityTemplate* entityTemplate = module->FindTemplate(previous.templates[i].name)) {
+            templates[i] = static_cast<uint16_t>(entityTemplate - module->templates.data());
+        }
+    }
+    for (auto& index : m_EntityTemplates) {
+        index = index < templates.size() ? templates[index] : NO_TEMPLATE;
+    }
+
+    if (stats.layoutChanged) {
+        m_World.Migrate(module->slotCount, sources);
+
+        // New slots start from the template each entity was spawned from
+        for (uint32_t entity = 0; entity < m_EntityTemplates.size(); ++entity) {
+            uint16_t index = m_EntityTemplates[entity];
+            if (index == NO_TEMPLATE) {
+                continue;
+            }
+            const auto& initial = module->templates[index].initialSlots;
+            for (uint16_t slot = 0; slot < module->slotCount && slot < initial.size(); ++slot) {
+                if (sources[slot] < 0) {
+                    m_World.SetSlot(static_cast<EntityId>(entity), slot, initial[slot]);
+                }
+            }
+        }
+    }
+
+    // Handlers with identical code keep their native code, tier counters and suspended frames
+    std::vector<HandlerState> states(module->handlers.size());
+    std::vector<bool> taken(previous.handlers.size(), false);
+    std::vector<int32_t> handlerMap(previous.handlers.size(), -1);
+    for (size_t i = 0; i < module->handlers.size(); ++i) {
+        const Handler& handler = module->handlers[i];
+        bool reused = false;
+        for (size_t j = 0; j < previous.handlers.size() && !reused; ++j) {
+            const Handler& old = previous.handlers[j];
+            if (!taken[j] && old.behavior == handler.behavior && old.name == handler.name && SameCode(old, handler)) {
+                states[i] = std::move(m_HandlerStates[j]);
+                states[i].aot = nullptr;
+                taken[j] = true;
+                handlerMap[j] = static_cast<int32_t>(i);
+                reused = true;
+            }
+        }
+        states[i].resumable = IsResumable(handler);
+        ++(reused ? stats.handlersReused : stats.handlersReplaced);
+    }
+
+    // A frame's resume point is only meaningful in the code it was suspended in
+    auto remap = [&handlerMap](Frame& frame) {
+        if (handlerMap[frame.handler] < 0) {
+            return false;
+        }
+        frame.handler = static_cast<uint16_t>(handlerMap[frame.handler]);
+        return true;
+    };
+    stats.framesDropped = m_Timers.Retain(remap);
+    std::vector<Frame> yielded;
+    for (Frame frame : m_Yielded) {
+        if (remap(frame)) {
+            yielded.push_back(frame);
+        } else {
+            ++stats.framesDropped;
+        }
+    }
+    m_Yielded = std::move(yielded);
+    stats.framesKept = static_cast<uint32_t>(GetSuspendedCount());
+
+    m_HandlerStates = std::move(states);
+    m_AotLibrary = nullptr;
+    m_Module = module;
+    m_Graph = std::make_unique<DataflowGraph>(BuildDataflowGraph(*m_Module));
+    if (m_Config.reactive) {
+        // Handlers may have changed under the same index, so everything reruns once
+        m_RowVersions.assign(static_cast<size_t>(m_World.GetChunkCount()) * m_Module->slotCount, ++m_Version);
+        for (auto& state : m_HandlerStates) {
+            state.stamps.clear();
+        }
+    }
+    if (m_Profiler) {
+        m_Profiler->Reset(m_Module);
+    }
+    return stats;
+}
+
+bool Runtime::AttachLibrary(std::shared_ptr<AotLibrary> library) {
+    if (!library || library->GetModuleHash() != HashModule(*m_Module) ||
+        library->GetHandlerCount() != m_HandlerStates.size()) {
+        std::cerr << "AOPL AOT library does not match the loaded module" << std::endl;
+        return false;
+    }
+
+    m_AotLibrary = library;
+    for (size_t i = 0; i < m_HandlerStates.size(); ++i) {
+        m_HandlerStates[i].aot = library->GetHandler(i);
+    }
+    return true;
+}
+
+void Runtime::SetProfiler(std::shared_ptr<Profiler> profiler) {
+    m_Profiler = profiler;
+    if (m_Profiler) {
+        m_Profiler->Reset(m_Module);
+    }
+}
+
+std::shared_ptr<Profiler> Runtime::GetProfiler() const {
+    return m_Profiler;
+}
+
+void Runtime::SetJitEnabled(bool enabled) {
+    m_Config.enableJit = enabled && JitCompiler::IsSupported();
+}
+
+bool Runtime::IsJitEnabled() const {
+    return m_Config.enableJit;
+}
+
+void Runtime::InvalidateLayout() {
+    ++m_LayoutEpoch;
+
+    // AOT code bakes in the slot layout, so it cannot survive a layout change
+    for (auto& state : m_HandlerStates) {
+        state.aot = nullptr;
+    }
+    m_AotLibrary = nullptr;
+}
+
+InputState& Runtime::GetInput(InputDevice device) {
+    return m_Devices[static_cast<size_t>(device) % INPUT_DEVICE_COUNT];
+}
+
+ActionMap& Runtime::GetActionMap() {
+    return m_ActionMap;
+}
+
+const InputState& Runtime::GetActions() const {
+    return m_Actions;
+}
+
+World& Runtime::GetWorld() {
+    return m_World;
+}
+
+const Module& Runtime::GetModule() const {
+    return *m_Module;
+}
+
+const RuntimeStats& Runtime::GetStats() const {
+    return m_Stats;
+}
+
+} // namespace aopl
+} // namespace gaia_matrix
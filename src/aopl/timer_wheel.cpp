@@ -0,0 +1,140 @@
+#include "gaia_matrix/aopl_runtime.h"
+#include <algorithm>
+#include <cmath>
+
+namespace gaia_matrix {
+namespace aopl {
+
+namespace {
+
+// Slack, in ticks, for float delays and frame times that land a hair short of a tick boundary
+constexpr double TICK_EPSILON = 1e-6;
+
+} // namespace
+
+TimerWheel::TimerWheel(float resolution, uint32_t bucketCount)
+    : m_Resolution(resolution > 0.0f ? resolution : 0.001f) {
+    // 0.001f is not exactly a millisecond; snap to the nearest whole rate per second
+    double rate = std::round(1.0 / m_Resolution);
+    if (rate >= 1.0 && std::abs(1.0 / m_Resolution - rate) < 1e-3) {
+        m_Resolution = 1.0 / rate;
+    }
+    uint32_t buckets = 1;
+    while (buckets < bucketCount) {
+        buckets <<= 1;
+    }
+    m_Mask = buckets - 1;
+    m_Buckets.assign(buckets, NONE);
+}
+
+void TimerWheel::Schedule(const Frame& frame, float delay) {
+    uint32_t index;
+    if (m_FreeList != NONE) {
+        index = m_FreeList;
+        m_FreeList = m_Nodes[index].next;
+    } else {
+        index = static_cast<uint32_t>(m_Nodes.size());
+        m_Nodes.emplace_back();
+    }
+
+    // Time already accumulated towards the next tick counts against the delay
+    double ticks = std::ceil((std::max(0.0, static_cast<double>(delay)) + m_Remainder) / m_Resolution - TICK_EPSILON);
+    Node& node = m_Nodes[index];
+    node.frame = frame;
+    node.sequence = m_Sequence++;
+    node.due = m_Now + std::max<uint64_t>(1, static_cast<uint64_t>(ticks));
+    Link(index);
+    ++m_Pending;
+}
+
+void TimerWheel::Link(uint32_t index) {
+    uint32_t& head = m_Buckets[m_Nodes[index].due & m_Mask];
+    m_Nodes[index].next = head;
+    head = index;
+}
+
+void TimerWheel::Advance(float dt, std::vector<Frame>& due) {
+    due.clear();
+    m_Remainder += std::max(0.0f, dt);
+    auto ticks = static_cast<uint64_t>(m_Remainder / m_Resolution + TICK_EPSILON);
+    if (ticks == 0) {
+        return;
+    }
+    m_Remainder = std::max(0.0, m_Remainder - ticks * m_Resolution);
+    uint64_t target = m_Now + ticks;
+    if (m_Pending == 0) {
+        m_Now = target;
+        return;
+    }
+
+    // Visit each bucket at most once, even when dt spans several revolutions
+    std::vector<std::pair<uint64_t, uint32_t>> expired;
+    uint64_t steps = std::min<uint64_t>(ticks, m_Mask + 1);
+    for (uint64_t step = 1; step <= steps; ++step) {
+        uint32_t* link = &m_Buckets[(m_Now + step) & m_Mask];
+        while (*link != NONE) {
+            Node& node = m_Nodes[*link];
+            if (node.due > target) {
+                link = &node.next;
+                continue;
+            }
+            uint32_t index = *link;
+            *link = node.next;
+            expired.emplace_back(node.due, index);
+        }
+    }
+    m_Now = target;
+
+    std::sort(expired.begin(), expired.end(), [this](const auto& a, const auto& b) {
+        return a.first != b.first ? a.first < b.first : m_Nodes[a.second].sequence < m_Nodes[b.second].sequence;
+    });
+    for (const auto& [tick, index] : expired) {
+        due.push_back(m_Nodes[index].frame);
+        m_Nodes[index].next = m_FreeList;
+        m_FreeList = index;
+    }
+    m_Pending -= expired.size();
+}
+
+uint32_t TimerWheel::Retain(const std::function<bool(Frame&)>& keep) {
+    uint32_t dropped = 0;
+    for (uint32_t& head : m_Buckets) {
+        uint32_t* link = &head;
+        while (*link != NONE) {
+            Node& node = m_Nodes[*link];
+            if (keep(node.frame)) {
+                link = &node.next;
+                continue;
+            }
+            uint32_t index = *link;
+            *link = node.next;
+            node.next = m_FreeList;
+            m_FreeList = index;
+            ++dropped;
+        }
+    }
+    m_Pending -= dropped;
+    return dropped;
+}
+
+void TimerWheel::Clear() {
+    std::fill(m_Buckets.begin(), m_Buckets.end(), NONE);
+    m_Nodes.clear();
+    m_FreeList = NONE;
+    m_Pending = 0;
+}
+
+size_t TimerWheel::GetPendingCount() const {
+    return m_Pending;
+}
+
+size_t TimerWheel::GetMemoryUsage() const {
+    return m_Nodes.capacity() * sizeof(Node) + m_Buckets.capacity() * sizeof(uint32_t);
+}
+
+double TimerWheel::GetTime() const {
+    return m_Now * m_Resolution + m_Remainder;
+}
+
+} // namespace aopl
+} // namespace gaia_matrix
@@ -0,0 +1,331 @@
+#include "gaia_matrix/aopl.h"
+#include "gaia_matrix/aopl_runtime.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <set>
+
+namespace gaia_matrix {
+namespace aopl {
+
+namespace {
+
+constexpr const char* BUILTIN_VECTORS[] = {"T.P", "T.R", "T.S", "V"};
+
+bool IsNumber(const std::string& token) {
+    if (token.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    std::strtof(token.c_str(), &end);
+    return end == token.c_str() + token.size();
+}
+
+// Type of the literal tokens [first, end) of a stage
+TypeInfo LiteralType(const Stage& stage, size_t first) {
+    const auto& tokens = stage.tokens;
+    size_t count = tokens.size() - first;
+    TypeInfo info;
+    info.location = stage.location;
+    if (count == 1) {
+        const std::string& token = tokens[first];
+        if (token == "true" || token == "false") {
+            info.type = ValueType::Bool;
+            info.width = 1;
+        } else if (token.size() >= 2 && token.front() == '"' && token.back() == '"') {
+            info.type = ValueType::String;
+        } else if (IsNumber(token)) {
+            info.type = ValueType::Number;
+            info.width = 1;
+        }
+        return info;
+    }
+    if (count >= 2 && count <= 4) {
+        for (size_t i = first; i < tokens.size(); ++i) {
+            if (!IsNumber(tokens[i])) {
+                return info;
+            }
+        }
+        info.type = ValueType::Vector;
+        info.width = static_cast<uint8_t>(count);
+    }
+    return info;
+}
+
+bool IsNumeric(const TypeInfo& info) {
+    return info.type == ValueType::Number || info.type == ValueType::Bool || info.type == ValueType::Vector;
+}
+
+int AxisIndex(char axis) {
+    switch (axis) {
+        case 'x': return 0;
+        case 'y': return 1;
+        case 'z': return 2;
+        case 'w': return 3;
+        default: return -1;
+    }
+}
+
+class Inference {
+public:
+    explicit Inference(TypeTable& types) : m_Types(types) {
+        for (const char* path : BUILTIN_VECTORS) {
+            m_Types.values[path] = {ValueType::Vector, 3, SourceLocation()};
+            for (int i = 0; i < 3; ++i) {
+                m_Types.values[std::string(path) + "." + "xyz"[i]] = {ValueType::Number, 1, SourceLocation()};
+            }
+        }
+    }
+
+    // Header stages: `E PlayerEntity` references and `N ⊢ speed` declarations
+    void Header(const Stage& stage) {
+        const auto& tokens = stage.tokens;
+        if (tokens.size() == 2 && tokens[0].size() == 1 && tokens[0][0] == Symbol::ENTITY) {
+            Assign(tokens[1], {ValueType::Entity, 0, stage.location});
+            return;
+        }
+        // Single capitals on the right (`V ⊢ I`) are component flows, not declarations
+        if (tokens.size() != 3 || tokens[1] != Symbol::DECLARATION || tokens[0].size() != 1 ||
+            !IsVariableName(tokens[2])) {
+            return;
+        }
+        TypeInfo info;
+        switch (tokens[0][0]) {
+            case 'N': info = {ValueType::Number, 1, stage.location}; break;
+            case 'B': info = {ValueType::Bool, 1, stage.location}; break;
+            case 'V': info = {ValueType::Vector, 0, stage.location}; break;
+            case 'S': info = {ValueType::String, 0, stage.location}; break;
+            case 'E': info = {ValueType::Entity, 0, stage.location}; break;
+            default: return;
+        }
+        Assign(tokens[2], info);
+    }
+
+    // First pass: literal assignments, so later stages know every variable
+    void Definition(const Stage& stage) {
+        const auto& tokens = stage.tokens;
+        if (tokens.size() >= 3 && tokens[0] == Symbol::ASSIGNMENT) {
+            Assign(tokens[1], LiteralType(stage, 2));
+        }
+    }
+
+    // Second pass: uses that constrain or equate values
+    void Use(const Stage& stage) {
+        const auto& tokens = stage.tokens;
+        if (tokens.empty() || tokens[0] == "I.K" || tokens[0] == Symbol::ASSIGNMENT) {
+            return;
+        }
+
+        if (tokens[0] == Symbol::CONDITIONAL && tokens.size() == 2) {
+            std::string name = tokens[1];
+            if (!name.empty() && name[0] == '!') {
+                name = name.substr(1);
+            }
+            m_Types.values.emplace(name, TypeInfo());
+            m_Conditions.push_back({name, "", stage.location, 0});
+            return;
+        }
+
+        const std::string& target = tokens[0];
+        if (!m_Types.values.count(target)) {
+            return;
+        }
+        if (tokens.size() == 5 && tokens[1] == "+=" && tokens[3] == "*" && tokens[4] == "dt") {
+            m_Types.values.emplace(tokens[2], TypeInfo());
+            m_Equalities.push_back({target, tokens[2], stage.location, 0});
+        } else if (tokens.size() == 3 && tokens[1].size() == 2 && AxisIndex(tokens[1][0]) >= 0 &&
+                   (tokens[1][1] == '+' || tokens[1][1] == '-')) {
+            m_Axes.push_back({target, "", stage.location, AxisIndex(tokens[1][0])});
+        } else if (tokens.size() == 2 && m_Types.values.count(tokens[1])) {
+            m_Equalities.push_back({target, tokens[1], stage.location, 0});
+        } else {
+            Assign(target, LiteralType(stage, 1));
+        }
+    }
+
+    bool Finish() {
+        // Propagate through copies and integrations until nothing changes
+        for (bool changed = true; changed;) {
+            changed = false;
+            for (const auto& use : m_Equalities) {
+                TypeInfo& a = m_Types.values[use.name];
+                TypeInfo& b = m_Types.values[use.other];
+                if (a.type == ValueType::Unknown && b.type != ValueType::Unknown) {
+                    a = {b.type, b.width, use.location};
+                    changed = true;
+                } else if (b.type == ValueType::Unknown && a.type != ValueType::Unknown) {
+                    b = {a.type, a.width, use.location};
+                    changed = true;
+                } else if (a.type == ValueType::Vector && b.type == ValueType::Vector && (!a.width) != (!b.width)) {
+                    a.width = b.width = std::max(a.width, b.width);
+                    changed = true;
+                }
+            }
+        }
+
+        std::set<std::string> reported;
+        for (const auto& use : m_Equalities) {
+            const TypeInfo& a = m_Types.values[use.name];
+            const TypeInfo& b = m_Types.values[use.other];
+            for (const std::string* name : {&use.name, &use.other}) {
+                if (m_Types.values[*name].type == ValueType::Unknown && reported.insert(*name).second) {
+                    Ambiguity(*name, "type of '" + *name + "' cannot be inferred; assign it a literal or declare it",
+                              use.location);
+                }
+            }
+            if (a.type == ValueType::Unknown || b.type == ValueType::Unknown) {
+                continue;
+            }
+            if (!IsNumeric(a) || !IsNumeric(b)) {
+                Error(use.name, "'" + use.name + "' and '" + use.other + "' must be numeric", use.location);
+            } else if (a.width != b.width && a.width && b.width) {
+                Error(use.name, "'" + use.name + "' is " + FormatType(a) + " but '" + use.other + "' is " +
+                                    FormatType(b), use.location);
+            }
+        }
+
+        for (const auto& use : m_Conditions) {
+            TypeInfo& info = m_Types.values[use.name];
+            if (info.type == ValueType::Unknown) {
+                // Only ever tested: a flag set by the host or another script
+                info = {ValueType::Bool, 1, use.location};
+            } else if (info.type != ValueType::Bool && info.type != ValueType::Number) {
+                Error(use.name, "'" + use.name + "' is " + FormatType(info) + " and cannot be used as a condition",
+                      use.location);
+            }
+        }
+
+        for (const auto& use : m_Axes) {
+            const TypeInfo& info = m_Types.values[use.name];
+            if (info.type == ValueType::Vector && info.width == 0) {
+                Ambiguity(use.name, "vector width of '" + use.name + "' cannot be inferred", use.location);
+            } else if (info.type != ValueType::Unknown && use.axis >= info.width) {
+                Error(use.name, "'" + use.name + "' is " + FormatType(info) + " and has no axis '" +
+                                    std::string(1, "xyzw"[use.axis]) + "'", use.location);
+            }
+        }
+
+        for (const auto& [name, info] : m_Types.values) {
+            if (info.type == ValueType::Vector && info.width == 0 && !reported.count(name)) {
+                Ambiguity(name, "vector width of '" + name + "' cannot be inferred", info.location);
+            }
+        }
+        return m_Types.errors.empty();
+    }
+
+private:
+    struct Constraint {
+        std::string name;
+        std::string other;
+        SourceLocation location;
+        int axis;
+    };
+
+    static bool IsVariableName(const std::string& name) {
+        if (name.empty() || !(std::isalpha(static_cast<unsigned char>(name[0])) || name[0] == '_')) {
+            return false;
+        }
+        if (name.size() == 1 && std::isupper(static_cast<unsigned char>(name[0]))) {
+            return false;
+        }
+        for (char c : name) {
+            if (!(std::isalnum(static_cast<unsigned char>(c)) || c == '_')) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void Assign(const std::string& name, const TypeInfo& info) {
+        TypeInfo& current = m_Types.values[name];
+        if (info.type == ValueType::Unknown) {
+            return;
+        }
+        if (current.type == ValueType::Unknown) {
+            current = info;
+            return;
+        }
+        if (current.type == info.type && (current.width == info.width || info.width == 0)) {
+            return;
+        }
+        if (current.type == ValueType::Vector && info.type == ValueType::Vector && current.width == 0) {
+            current.width = info.width;
+            return;
+        }
+        if ((current.type == ValueType::Number && info.type == ValueType::Bool) ||
+            (current.type == ValueType::Bool && info.type == ValueType::Number)) {
+            // Both are a single float slot; keep it numeric but point the author at the mix
+            current.type = ValueType::Number;
+            Ambiguity(name, "'" + name + "' mixes boolean and numeric values", info.location);
+            return;
+        }
+        Error(name, "'" + name + "' is " + FormatType(current) + " (line " + std::to_string(current.location.line) +
+                        ") but is used as " + FormatType(info), info.location);
+    }
+
+    void Error(const std::string& name, const std::string& message, const SourceLocation& location) {
+        m_Types.errors.push_back({name, message, location});
+    }
+
+    void Ambiguity(const std::string& name, const std::string& message, const SourceLocation& location) {
+        m_Types.ambiguities.push_back({name, message, location});
+    }
+
+    TypeTable& m_Types;
+    std::vector<Constraint> m_Equalities;
+    std::vector<Constraint> m_Conditions;
+    std::vector<Constraint> m_Axes;
+};
+
+} // namespace
+
+const TypeInfo* TypeTable::Find(const std::string& name) const {
+    auto it = values.find(name);
+    return it != values.end() ? &it->second : nullptr;
+}
+
+std::string FormatType(const TypeInfo& info) {
+    switch (info.type) {
+        case ValueType::Number: return "number";
+        case ValueType::Bool: return "bool";
+        case ValueType::Vector: return info.width ? "vec" + std::to_string(info.width) : "vector";
+        case ValueType::String: return "string";
+        case ValueType::Entity: return "entity";
+        default: return "unknown";
+    }
+}
+
+bool InferTypes(const Parser& parser, TypeTable& types) {
+    types = TypeTable();
+    Inference inference(types);
+
+    for (const auto& entity : parser.GetEntities()) {
+        types.values[entity->GetName()] = {ValueType::Entity, 0, entity->GetLocation()};
+    }
+    for (const auto& aiNode : parser.GetAINodes()) {
+        for (const auto& stage : aiNode->GetFlow()) {
+            inference.Header(stage);
+        }
+    }
+    for (const auto& behavior : parser.GetBehaviors()) {
+        for (const auto& stage : behavior->GetFlow()) {
+            inference.Header(stage);
+        }
+        for (const auto& binding : behavior->GetBindings()) {
+            for (const auto& stage : binding.stages) {
+                inference.Definition(stage);
+            }
+        }
+    }
+    for (const auto& behavior : parser.GetBehaviors()) {
+        for (const auto& binding : behavior->GetBindings()) {
+            for (const auto& stage : binding.stages) {
+                inference.Use(stage);
+            }
+        }
+    }
+    return inference.Finish();
+}
+
+} // namespace aopl
+} // namespace gaia_matrix
@@ -1,4 +1,6 @@
 #include "gaia_matrix/editor.h"
+#include "gaia_matrix/aopl_hot_reload.h"
+#include <filesystem>
 #include <iostream>
 
 namespace gaia_matrix {
@@ -51,6 +53,7 @@ void Editor::Run() {
     bool running = true;
     while (running) {
         // Process events
+        ReloadScripts();
         // Update editor UI
         // Render editor UI
         
@@ -66,11 +69,59 @@ bool Editor::OpenProject(const std::string& projectPath) {
     }
     
     s_Instance->m_Config.projectPath = projectPath;
+    s_Instance->m_ScriptReloader.reset();
+    s_Instance->m_ScriptRuntime.reset();
+
+    if (std::filesystem::is_directory(projectPath)) {
+        auto reloader = std::make_unique<aopl::HotReloader>(projectPath);
+        if (!reloader->Start()) {
+            // Keep watching: the scripts start once the errors are fixed
+            for (const auto& error : reloader->GetErrors()) {
+                std::cerr << "AOPL error: " << error << std::endl;
+            }
+        } else {
+            s_Instance->m_ScriptRuntime = std::make_shared<aopl::Runtime>(reloader->GetModule());
+            reloader->Attach(s_Instance->m_ScriptRuntime);
+        }
+        s_Instance->m_ScriptReloader = std::move(reloader);
+    }
     std::cout << "Project opened: " << projectPath << std::endl;
     
     return true;
 }
 
+bool Editor::ReloadScripts() {
+    if (!s_Instance || !s_Instance->m_ScriptReloader) {
+        return false;
+    }
+
+    aopl::HotReloader& reloader = *s_Instance->m_ScriptReloader;
+    aopl::HotReloadResult result = reloader.Poll();
+    for (const auto& error : result.errors) {
+        std::cerr << "AOPL error: " << error << std::endl;
+    }
+    if (!result.reloaded) {
+        return false;
+    }
+
+    if (!s_Instance->m_ScriptRuntime) {
+        s_Instance->m_ScriptRuntime = std::make_shared<aopl::Runtime>(reloader.GetModule());
+        reloader.Attach(s_Instance->m_ScriptRuntime);
+    }
+    std::cout << "Reloaded " << result.changedFiles.size() << " AOPL file(s): " << result.runtime.handlersReplaced
+              << " handler(s) replaced, " << result.runtime.handlersReused << " reused";
+    if (result.runtime.layoutChanged) {
+        std::cout << ", " << result.runtime.slotsAdded << " slot(s) added, " << result.runtime.slotsRemoved
+                  << " removed";
+    }
+    std::cout << std::endl;
+    return true;
+}
+
+std::shared_ptr<aopl::Runtime> Editor::GetScriptRuntime() const {
+    return m_ScriptRuntime;
+}
+
 bool Editor::CreateProject(const std::string& projectName, const std::string& projectPath) {
     if (!s_Instance || !s_Instance->m_IsInitialized) {
         std::cerr << "Editor not initialized!" << std::endl;
@@ -13,10 +13,12 @@
  * @param includeEditor Whether to include the browser-based editor
  * @param format Output format (ESNext, ES5, WASM)
  * @param minify Whether to minify the output
+ * @param aoplCacheDir Precompiled AOPL cache directory, empty to always compile
  * @return True if build succeeded
  */
 bool BuildWebVersion(const std::string& outputDir, bool includeEditor, 
-                    gaia_matrix::WebOutputFormat format, bool minify) {
+                    gaia_matrix::WebOutputFormat format, bool minify,
+                    const std::string& aoplCacheDir) {
     // Initialize web compiler
     gaia_matrix::WebCompilerConfig config;
     config.outputFormat = format;
@@ -28,20 +30,30 @@ bool BuildWebVersion(const std::string& outputDir, bool includeEditor,
         return false;
     }
     
-    // Collect AOPL source files
+    // Compile the AOPL project; files are parsed and compiled in parallel and
+    // cross-file references are checked before anything is generated
     std::map<std::string, std::string> aoplSources;
     if (std::filesystem::exists("examples")) {
-        for (const auto& entry : std::filesystem::directory_iterator("examples")) {
-            if (entry.path().extension() == ".aopl") {
-                std::string filename = entry.path().filename().string();
-                std::ifstream file(entry.path());
-                
-                if (file) {
-                    std::stringstream buffer;
-                    buffer << file.rdbuf();
-                    aoplSources[filename] = buffer.str();
-                }
+        gaia_matrix::aopl::ProjectConfig projectConfig;
+        projectConfig.cacheDirectory = aoplCacheDir;
+        gaia_matrix::aopl::ProjectCompiler project(projectConfig);
+        project.AddDirectory("examples");
+        if (!project.Build()) {
+            for (const auto& error : project.GetErrors()) {
+                std::cerr << "AOPL error: " << error << std::endl;
             }
+            gaia_matrix::WebCompiler::Shutdown();
+            return false;
+        }
+
+        const auto& stats = project.GetStats();
+        std::cout << "Compiled " << stats.filesCompiled << " AOPL files on " << stats.threadsUsed << " threads in "
+                  << stats.compileMilliseconds << " ms (link " << stats.linkMilliseconds << " ms)" << std::endl;
+        if (const auto* cache = project.GetCache()) {
+            std::cout << cache->GetReport();
+        }
+        for (const auto& file : project.GetFiles()) {
+            aoplSources[file.path] = file.source;
         }
     }
     
@@ -74,6 +86,45 @@ bool BuildWebVersion(const std::string& outputDir, bool includeEditor,
     return true;
 }
 
+/**
+ * @brief Ahead-of-time compile every AOPL script in examples/ to a shared library
+ * @param outputDir Directory to write one library per script into
+ * @return True if every script compiled
+ */
+bool BuildAotLibraries(const std::string& outputDir) {
+    if (!std::filesystem::exists("examples")) {
+        std::cerr << "No examples directory to compile" << std::endl;
+        return false;
+    }
+
+    bool success = true;
+    for (const auto& entry : std::filesystem::directory_iterator("examples")) {
+        if (entry.path().extension() != ".aopl") {
+            continue;
+        }
+
+        std::ifstream file(entry.path());
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+
+        gaia_matrix::aopl::Parser parser;
+        if (!parser.Parse(buffer.str()) || !parser.Compile()) {
+            std::cerr << "Failed to compile AOPL source: " << entry.path().string() << std::endl;
+            success = false;
+            continue;
+        }
+
+#if defined(__APPLE__)
+        const char* extension = ".dylib";
+#else
+        const char* extension = ".so";
+#endif
+        std::string libraryPath = outputDir + "/" + entry.path().stem().string() + extension;
+        success = gaia_matrix::aopl::AotCompiler::BuildLibrary(*parser.GetModule(), libraryPath) && success;
+    }
+    return success;
+}
+
 /**
  * @brief Print command line usage
  * @param programName Name of the executable
@@ -89,6 +140,8 @@ void PrintUsage(const char* programName) {
     std::cout << "  --web-editor         Include browser editor in web build" << std::endl;
     std::cout << "  --web-format <fmt>   Web output format: esnext, es5, wasm (default: esnext)" << std::endl;
     std::cout << "  --no-minify          Disable minification of web output" << std::endl;
+    std::cout << "  --aopl-cache <dir>   Reuse precompiled AOPL modules from specified directory" << std::endl;
+    std::cout << "  --aot-build <dir>    Compile AOPL scripts to native libraries in specified directory" << std::endl;
     std::cout << "  --help               Show this help message" << std::endl;
 }
 
@@ -112,6 +165,8 @@ int main(int argc, char** argv) {
     std::string appName = "GAIA MATRIX";
     std::string projectPath = "";
     std::string webOutputDir = "./web_build";
+    std::string aotOutputDir = "";
+    std::string aoplCacheDir = "";
     
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
@@ -144,6 +199,10 @@ int main(int argc, char** argv) {
             }
         } else if (arg == "--no-minify") {
             minify = false;
+        } else if (arg == "--aopl-cache" && i + 1 < argc) {
+            aoplCacheDir = argv[++i];
+        } else if (arg == "--aot-build" && i + 1 < argc) {
+            aotOutputDir = argv[++i];
         } else if (arg == "--help") {
             PrintUsage(argv[0]);
             return 0;
@@ -153,7 +212,7 @@ int main(int argc, char** argv) {
     // Handle web build mode
     if (webBuild) {
         std::cout << "Building web version to: " << webOutputDir << std::endl;
-        if (BuildWebVersion(webOutputDir, webEditor, webFormat, minify)) {
+        if (BuildWebVersion(webOutputDir, webEditor, webFormat, minify, aoplCacheDir)) {
             std::cout << "Web build successful!" << std::endl;
             return 0;
         } else {
@@ -162,6 +221,18 @@ int main(int argc, char** argv) {
         }
     }
     
+    // Handle AOT build mode
+    if (!aotOutputDir.empty()) {
+        std::cout << "Building AOPL AOT libraries to: " << aotOutputDir << std::endl;
+        if (BuildAotLibraries(aotOutputDir)) {
+            std::cout << "AOT build successful!" << std::endl;
+            return 0;
+        } else {
+            std::cerr << "AOT build failed!" << std::endl;
+            return 1;
+        }
+    }
+    
     // Initialize engine
     if (!Engine::Initialize(appName, enableNeuralEngine)) {
         std::cerr << "Failed to initialize GAIA MATRIX Engine!" << std::endl;
@@ -184,6 +255,11 @@ int main(int argc, char** argv) {
             std::cerr << "Warning: Failed to initialize AI Assistant" << std::endl;
         }
         
+        // Open the project so its scripts are compiled and watched for changes
+        if (!projectPath.empty()) {
+            Editor::Get().OpenProject(projectPath);
+        }
+        
         // Run editor
         Editor::Get().Run();
     } else {
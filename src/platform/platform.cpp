@@ -7,6 +7,13 @@
 #include <TargetConditionals.h>
 #endif
 
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace fs = std::filesystem;
 
 namespace gaia_matrix {
@@ -186,4 +193,90 @@ std::vector<std::string> FileSystem::GetFilesInDirectory(const std::string& path
     return files;
 }
 
+// MappedFile implementation
+namespace {
+
+#if !defined(_WIN32)
+int64_t ModifiedNanoseconds(const struct stat& info) {
+#if defined(__APPLE__)
+    const struct timespec& modified = info.st_mtimespec;
+#else
+    const struct timespec& modified = info.st_mtim;
+#endif
+    return static_cast<int64_t>(modified.tv_sec) * 1000000000 + modified.tv_nsec;
+}
+#endif
+
+} // namespace
+
+MappedFile::~MappedFile() {
+#if !defined(_WIN32)
+    if (m_Data && m_Buffer.empty()) {
+        munmap(const_cast<void*>(m_Data), m_Size);
+    }
+    if (m_File >= 0) {
+        close(m_File);
+    }
+#endif
+}
+
+std::shared_ptr<MappedFile> MappedFile::Open(const std::string& path) {
+    std::shared_ptr<MappedFile> file(new MappedFile());
+    file->m_Path = path;
+#if !defined(_WIN32)
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat info;
+    bool opened = fstat(fd, &info) == 0 && S_ISREG(info.st_mode);
+    if (opened && info.st_size > 0) {
+        // Shared and read-only: clean pages can be dropped and re-read instead of swapped
+        void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED) {
+            opened = false;
+        } else {
+            file->m_Data = data;
+            file->m_Size = static_cast<size_t>(info.st_size);
+        }
+    }
+    if (!opened) {
+        close(fd);
+        return nullptr;
+    }
+    file->m_File = fd;
+    file->m_Modified = ModifiedNanoseconds(info);
+#else
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream) {
+        return nullptr;
+    }
+    file->m_Buffer.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    file->m_Data = file->m_Buffer.empty() ? nullptr : file->m_Buffer.data();
+    file->m_Size = file->m_Buffer.size();
+#endif
+    return file;
+}
+
+bool MappedFile::IsUnchanged() const {
+#if !defined(_WIN32)
+    // A file replaced by rename leaves this descriptor on the old, untouched file
+    struct stat info;
+    return fstat(m_File, &info) == 0 && static_cast<size_t>(info.st_size) == m_Size &&
+           ModifiedNanoseconds(info) == m_Modified;
+#else
+    return true;
+#endif
+}
+
+bool MappedFile::IsCurrent() const {
+#if !defined(_WIN32)
+    struct stat named, mapped;
+    return stat(m_Path.c_str(), &named) == 0 && fstat(m_File, &mapped) == 0 && named.st_dev == mapped.st_dev &&
+           named.st_ino == mapped.st_ino && IsUnchanged();
+#else
+    return true;    // Read into memory, so later changes to the file do not reach it
+#endif
+}
+
 } // namespace gaia_matrix
\ No newline at end of file
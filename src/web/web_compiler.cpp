@@ -284,6 +284,7 @@ bool WebCompiler::GenerateWebApp(
         for (const auto& [filename, source] : aoplSources) {
             std::string outputPath = outputDir + "/compiled/" + filename + 
                 (m_Config.outputFormat == WebOutputFormat::WASM ? ".wasm" : ".js");
+            std::filesystem::create_directories(std::filesystem::path(outputPath).parent_path());
             
             if (!CompileAOPL(source, outputPath)) {
                 std::cerr << "Failed to compile AOPL source: " << filename << std::endl;
@@ -1097,6 +1098,7 @@ std::string WebCompiler::GenerateAOPLRuntime() {
     js << "    EVENT: '⊻',     // Event handler\n";
     js << "    CONDITIONAL: '⊿', // Conditional\n";
     js << "    ASSIGN: '⊸',    // Assignment\n";
+    js << "    WAIT: '⧖',      // Suspend a handler\n";
     js << "    FLOW: '→',      // Data flow\n";
     js << "    NN: 'NN',       // Neural network\n";
     js << "    RL: 'RL',       // Reinforcement learning\n";
@@ -0,0 +1,197 @@
+#include <gtest/gtest.h>
+#include "gaia_matrix.h"
+#include <filesystem>
+#include <fstream>
+#include <functional>
+
+using namespace gaia_matrix;
+using namespace gaia_matrix::aopl;
+
+namespace {
+
+const char* PLAYER_SOURCE = R"(
+    N ⊢ E〈PlayerEntity〉〈T⊕C⊕I〉
+    T: P 0 1 0 → R 0 0 0 → S 1 1 1
+
+    N〈PlayerController〉: E PlayerEntity → F Move
+    Move: I.K W → T.P z+ 0.1
+    Collision: ⊿ ground → ⊸ grounded true
+)";
+
+class AOPLCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        m_Directory = (std::filesystem::temp_directory_path() /
+                       ("gaia_aopl_cache_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name())))
+                          .string();
+        std::filesystem::remove_all(m_Directory);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(m_Directory);
+    }
+
+    std::string m_Directory;
+};
+
+ModuleCacheEntry CompileEntry(const std::string& source) {
+    Parser parser;
+    EXPECT_TRUE(parser.Parse(source));
+    EXPECT_TRUE(parser.Compile());
+    ModuleCacheEntry entry;
+    entry.module = parser.GetModule();
+    entry.declarations = {"PlayerEntity", "PlayerController"};
+    entry.references = {"PlayerEntity"};
+    return entry;
+}
+
+} // namespace
+
+TEST_F(AOPLCacheTest, RoundTripsCompiledModule) {
+    ModuleCache cache(m_Directory);
+    uint64_t key = ModuleCache::ComputeKey(PLAYER_SOURCE, OptimizerConfig());
+    ModuleCacheEntry stored = CompileEntry(PLAYER_SOURCE);
+
+    ModuleCacheEntry loaded;
+    EXPECT_FALSE(cache.Load(key, loaded, "player.aopl"));
+    ASSERT_TRUE(cache.Store(key, stored));
+    ASSERT_TRUE(cache.Load(key, loaded, "player.aopl"));
+
+    ASSERT_NE(loaded.module, nullptr);
+    EXPECT_EQ(HashModule(*loaded.module), HashModule(*stored.module));
+    EXPECT_EQ(loaded.module->slotCount, stored.module->slotCount);
+    EXPECT_EQ(loaded.declarations, stored.declarations);
+    EXPECT_EQ(loaded.references, stored.references);
+
+    // The loaded module runs like the original
+    Runtime runtime(loaded.module);
+    EntityId player = runtime.Spawn("PlayerEntity");
+    runtime.GetInput().SetKey(LookupKeyCode("W"), true);
+    runtime.Tick(0.016f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(player, "T.P.y"), 1.0f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(player, "T.P.z"), 0.1f);
+
+    ModuleCacheStats stats = cache.GetStats();
+    EXPECT_EQ(stats.hits, 1);
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_EQ(stats.stores, 1);
+    EXPECT_NE(cache.GetReport().find("hit  player.aopl"), std::string::npos);
+}
+
+TEST_F(AOPLCacheTest, KeyCoversSourceAndOptimizerConfig) {
+    OptimizerConfig config;
+    uint64_t key = ModuleCache::ComputeKey(PLAYER_SOURCE, config);
+    EXPECT_EQ(key, ModuleCache::ComputeKey(PLAYER_SOURCE, config));
+    EXPECT_NE(key, ModuleCache::ComputeKey(std::string(PLAYER_SOURCE) + " ", config));
+    config.flowFusion = false;
+    EXPECT_NE(key, ModuleCache::ComputeKey(PLAYER_SOURCE, config));
+}
+
+TEST_F(AOPLCacheTest, RejectsCorruptFiles) {
+    ModuleCache cache(m_Directory);
+    uint64_t key = ModuleCache::ComputeKey(PLAYER_SOURCE, OptimizerConfig());
+    ASSERT_TRUE(cache.Store(key, CompileEntry(PLAYER_SOURCE)));
+
+    // Flip one byte of the bytecode area; the module hash no longer matches
+    std::string path = cache.GetPath(key);
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(static_cast<std::streamoff>(std::filesystem::file_size(path) / 2));
+    file.put('\x7f');
+    file.close();
+
+    ModuleCacheEntry loaded;
+    EXPECT_FALSE(cache.Load(key, loaded, "player.aopl"));
+    EXPECT_EQ(cache.GetStats().rejected, 1);
+
+    // Truncated files are rejected as well
+    std::filesystem::resize_file(path, 16);
+    EXPECT_FALSE(cache.Load(key, loaded, "player.aopl"));
+    EXPECT_EQ(cache.GetStats().rejected, 2);
+}
+
+TEST_F(AOPLCacheTest, RejectsOperandsOutsideSlots) {
+    // Each file is written consistently, so only the bounds checks can reject it
+    ModuleCache cache(m_Directory);
+    uint64_t key = ModuleCache::ComputeKey(PLAYER_SOURCE, OptimizerConfig());
+    ModuleCacheEntry entry = CompileEntry(PLAYER_SOURCE);
+    const Module original = *entry.module;
+    uint16_t slots = original.slotCount;
+    ASSERT_GT(original.handlers.size(), 0u);
+    ASSERT_GT(original.handlers[0].code.size(), 1u);
+    OpCode last = original.handlers[0].code.back().op;
+    ASSERT_TRUE(last == OpCode::Store || last == OpCode::Add);
+
+    std::vector<std::function<void(Module&)>> corruptions = {
+        [](Module& module) { module.handlers[0].code.back().op = static_cast<OpCode>(9); },
+        [](Module& module) { module.handlers[0].code.back().width = 0; },
+        [](Module& module) { module.handlers[0].code.back().width = 5; },
+        [slots](Module& module) { module.handlers[0].code.back().dst = slots; },
+        [slots](Module& module) {
+            Instruction& inst = module.handlers[0].code.back();
+            inst.op = OpCode::Copy;
+            inst.src = static_cast<uint16_t>(slots - 1);
+            inst.width = 3;
+        },
+        [](Module& module) {
+            Instruction& inst = module.handlers[0].code.front();
+            inst.op = OpCode::Segment;
+            inst.width = 1;
+            inst.dst = 100;
+        },
+        [](Module& module) {
+            Instruction& inst = module.handlers[0].code.front();
+            inst.op = OpCode::TestKey;
+            inst.width = 1;
+            inst.src = 256;
+        },
+        [](Module& module) { module.templates[0].initialSlots.pop_back(); },
+        [slots](Module& module) { module.slots["stray"] = {slots, 1}; },
+    };
+    for (size_t i = 0; i < corruptions.size(); ++i) {
+        auto module = std::make_shared<Module>(original);
+        corruptions[i](*module);
+        entry.module = module;
+        ASSERT_TRUE(cache.Store(key, entry));
+        ModuleCacheEntry loaded;
+        EXPECT_FALSE(cache.Load(key, loaded, "player.aopl")) << "corruption " << i;
+        EXPECT_EQ(loaded.module, nullptr);
+    }
+    EXPECT_EQ(cache.GetStats().rejected, static_cast<int>(corruptions.size()));
+
+    // The untouched module still loads
+    entry.module = std::make_shared<Module>(original);
+    ASSERT_TRUE(cache.Store(key, entry));
+    ModuleCacheEntry loaded;
+    EXPECT_TRUE(cache.Load(key, loaded, "player.aopl"));
+}
+
+TEST_F(AOPLCacheTest, ProjectBuildReusesCachedFiles) {
+    ProjectConfig config;
+    config.cacheDirectory = m_Directory;
+
+    ProjectCompiler first(config);
+    first.AddFile("player.aopl", PLAYER_SOURCE);
+    ASSERT_TRUE(first.Build());
+    EXPECT_EQ(first.GetStats().cacheMisses, 1);
+    EXPECT_EQ(first.GetStats().cacheHits, 0);
+
+    ProjectCompiler second(config);
+    second.AddFile("player.aopl", PLAYER_SOURCE);
+    ASSERT_TRUE(second.Build());
+    EXPECT_EQ(second.GetStats().cacheHits, 1);
+    EXPECT_TRUE(second.GetFiles()[0].fromCache);
+    EXPECT_EQ(second.GetFiles()[0].declarations, first.GetFiles()[0].declarations);
+    EXPECT_EQ(HashModule(*second.GetModule()), HashModule(*first.GetModule()));
+
+    // An edited file misses and is recompiled
+    ProjectCompiler third(config);
+    third.AddFile("player.aopl", std::string(PLAYER_SOURCE) + "    Jump: I.K Space → V y+ 5\n");
+    ASSERT_TRUE(third.Build());
+    EXPECT_EQ(third.GetStats().cacheMisses, 1);
+    EXPECT_FALSE(third.GetFiles()[0].fromCache);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include "gaia_matrix.h"
+#include "../test_utils/test_helpers.h"
+
+using namespace gaia_matrix;
+using namespace gaia_matrix::aopl;
+using gaia_matrix::test::TestHelpers;
+
+TEST(AOPLCoroutineTest, WaitDelaysTheRestOfTheHandler) {
+    RuntimeConfig config;
+    config.jitThreshold = 1;
+    Runtime runtime(TestHelpers::CompileAOPL(R"(
+        N ⊢ E〈Hero〉〈T⊕C〉
+        N〈Jumper〉: E Hero
+        Jump: I.K Space → T.P x+ 1 → ⧖ 2s → V.y 5
+    )"), config);
+    EntityId hero = runtime.Spawn("Hero");
+    runtime.GetInput().SetKey(LookupKeyCode("Space"), true);
+
+    // The wait starts at the first tick's time (0.5 s) and ends at 2.5 s.
+    // While suspended the handler does not start over, even with Space held.
+    for (int i = 0; i < 4; ++i) {
+        runtime.Tick(0.5f);
+    }
+    EXPECT_FLOAT_EQ(runtime.GetValue(hero, "T.P.x"), 1.0f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(hero, "V.y"), 0.0f);
+    EXPECT_EQ(runtime.GetSuspendedCount(), 1);
+
+    runtime.Tick(0.5f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(hero, "V.y"), 5.0f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(hero, "T.P.x"), 1.0f);
+    EXPECT_EQ(runtime.GetSuspendedCount(), 0);
+
+    runtime.Tick(0.5f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(hero, "T.P.x"), 2.0f);
+    EXPECT_EQ(runtime.GetStats().suspensions, 2);
+    EXPECT_EQ(runtime.GetStats().resumptions, 1);
+    EXPECT_EQ(runtime.GetStats().compiledHandlers, 0);
+}
+
+TEST(AOPLCoroutineTest, BareWaitYieldsUntilTheNextTick) {
+    Runtime runtime(TestHelpers::CompileAOPL(R"(
+        N ⊢ E〈Walker〉〈T⊕C〉
+        N〈Stepper〉: E Walker
+        Step: T.P x+ 1 → ⧖ → T.P y+ 1
+    )"));
+    EntityId walker = runtime.Spawn("Walker");
+
+    runtime.Tick(0.016f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(walker, "T.P.x"), 1.0f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(walker, "T.P.y"), 0.0f);
+
+    runtime.Tick(0.016f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(walker, "T.P.x"), 1.0f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(walker, "T.P.y"), 1.0f);
+
+    runtime.Tick(0.016f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(walker, "T.P.x"), 2.0f);
+}
+
+TEST(AOPLCoroutineTest, GuardsAfterAWaitSeeChangesMadeWhileSuspended) {
+    // Constant folding must not carry `armed = true` across the wait
+    Runtime runtime(TestHelpers::CompileAOPL(R"(
+        N ⊢ E〈Turret〉〈T⊕C〉
+        N〈Trigger〉: E Turret
+        Fire: ⊸ armed true → ⧖ 1 → ⊿ armed → V.y 3
+    )"));
+    EntityId turret = runtime.Spawn("Turret");
+
+    runtime.Tick(0.5f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(turret, "armed"), 1.0f);
+    runtime.SetValue(turret, "armed", 0.0f);
+
+    runtime.Tick(1.0f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(turret, "V.y"), 0.0f);
+    EXPECT_EQ(runtime.GetSuspendedCount(), 0);
+}
+
+TEST(AOPLCoroutineTest, TimerWheelReleasesFramesInDueOrder) {
+    // Eight 10 ms buckets: the 500 ms frame goes round the wheel several times
+    TimerWheel wheel(0.01f, 8);
+    wheel.Schedule({1, 0, 1}, 0.5f);
+    wheel.Schedule({2, 0, 1}, 0.05f);
+    wheel.Schedule({3, 0, 1}, 0.05f);
+    wheel.Schedule({4, 0, 1}, 0.02f);
+    EXPECT_EQ(wheel.GetPendingCount(), 4);
+
+    std::vector<Frame> due;
+    wheel.Advance(0.03f, due);
+    ASSERT_EQ(due.size(), 1);
+    EXPECT_EQ(due[0].entity, 4);
+
+    wheel.Advance(0.03f, due);
+    ASSERT_EQ(due.size(), 2);
+    EXPECT_EQ(due[0].entity, 2);
+    EXPECT_EQ(due[1].entity, 3);
+
+    wheel.Advance(0.3f, due);
+    EXPECT_TRUE(due.empty());
+    wheel.Advance(1.0f, due);
+    ASSERT_EQ(due.size(), 1);
+    EXPECT_EQ(due[0].entity, 1);
+    EXPECT_EQ(wheel.GetPendingCount(), 0);
+}
+
+TEST(AOPLCoroutineTest, SuspendedScriptsCostOnlyTheirFrames) {
+    Runtime runtime(TestHelpers::CompileAOPL(R"(
+        N ⊢ E〈Mine〉〈T⊕C〉
+        N〈Fuse〉: E Mine
+        Arm: ⧖ 10 → ⊸ exploded true
+    )"));
+    const int count = 20000;
+    for (int i = 0; i < count; ++i) {
+        runtime.Spawn("Mine");
+    }
+
+    runtime.Tick(0.0f);
+    EXPECT_EQ(runtime.GetSuspendedCount(), count);
+    // A few dozen bytes per waiting script, including pool growth slack
+    EXPECT_LT(runtime.GetTimers().GetMemoryUsage(), count * 64);
+
+    for (int i = 0; i < 10; ++i) {
+        runtime.Tick(1.0f);
+    }
+    EXPECT_EQ(runtime.GetStats().resumptions, count);
+    EXPECT_FLOAT_EQ(runtime.GetValue(0, "exploded"), 1.0f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(count - 1, "exploded"), 1.0f);
+}
+
+TEST(AOPLCoroutineTest, ReloadKeepsFramesOfUnchangedHandlers) {
+    Runtime runtime(TestHelpers::CompileAOPL(R"(
+        N ⊢ E〈Door〉〈T⊕C〉
+        N〈Opener〉: E Door
+        Open: ⧖ 1 → ⊸ open true
+        N〈Alarm〉: E Door
+        Ring: ⧖ 1 → ⊸ ringing true
+    )"));
+    EntityId door = runtime.Spawn("Door");
+    runtime.Tick(0.5f);
+    ASSERT_EQ(runtime.GetSuspendedCount(), 2);
+
+    ReloadStats stats = runtime.Reload(TestHelpers::CompileAOPL(R"(
+        N ⊢ E〈Door〉〈T⊕C〉
+        N〈Opener〉: E Door
+        Open: ⧖ 1 → ⊸ open true
+        N〈Alarm〉: E Door
+        Ring: ⧖ 2 → ⊸ ringing true
+    )"));
+    EXPECT_EQ(stats.framesKept, 1);
+    EXPECT_EQ(stats.framesDropped, 1);
+
+    runtime.Tick(1.0f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(door, "open"), 1.0f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(door, "ringing"), 0.0f);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include "gaia_matrix.h"
+#include "../test_utils/test_helpers.h"
+#include <atomic>
+
+using namespace gaia_matrix;
+using namespace gaia_matrix::aopl;
+using gaia_matrix::test::TestHelpers;
+
+namespace {
+
+// One binding per behavior so flow fusion keeps every handler separate
+const char* WORLD_SOURCE = R"(
+    N ⊢ E〈Body〉〈T⊕C〉
+    T: P 0 10 0 → R 0 0 0 → S 1 1 1
+    N〈Integrate〉: E Body
+    Step: T.P += V * dt
+    N〈Gravity〉: E Body
+    Fall: ⊿ !grounded → V y- 0.5
+    N〈Spin〉: E Body
+    Turn: T.R y+ 1
+    N〈Grow〉: E Body
+    Scale: ⊿ grounded → T.S y+ 0.1
+    N〈Land〉: E Body
+    Touch: ⊸ grounded true
+    N〈Push〉: E Body
+    Drive: I.K W → V.z 2
+    N〈Pulse〉: E Body
+    Beat: T.S x+ 1 → ⧖ 0.1 → T.S x- 1
+)";
+
+const DataflowNode* FindNode(const DataflowGraph& graph, const Module& module, const std::string& behavior) {
+    for (const auto& node : graph.nodes) {
+        if (module.handlers[node.handler].behavior == behavior) {
+            return &node;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+TEST(AOPLDataflowTest, BuildsLevelsFromReadAndWriteSets) {
+    auto module = TestHelpers::CompileAOPL(WORLD_SOURCE);
+    DataflowGraph graph = BuildDataflowGraph(*module);
+    ASSERT_EQ(graph.nodes.size(), 7);
+
+    const DataflowNode* integrate = FindNode(graph, *module, "Integrate");
+    const DataflowNode* gravity = FindNode(graph, *module, "Gravity");
+    const DataflowNode* spin = FindNode(graph, *module, "Spin");
+    const DataflowNode* grow = FindNode(graph, *module, "Grow");
+    const DataflowNode* land = FindNode(graph, *module, "Land");
+    const DataflowNode* push = FindNode(graph, *module, "Push");
+    const DataflowNode* pulse = FindNode(graph, *module, "Pulse");
+
+    // Independent of everything before them
+    EXPECT_EQ(integrate->level, 0);
+    EXPECT_EQ(spin->level, 0);
+    EXPECT_EQ(grow->level, 0);
+
+    // Gravity writes V after Integrate read it; Land writes the flag Gravity and Grow read
+    EXPECT_EQ(gravity->level, 1);
+    EXPECT_EQ(gravity->dependencies, std::vector<uint32_t>{integrate->handler});
+    EXPECT_EQ(land->level, 2);
+    EXPECT_EQ(land->dependencies, (std::vector<uint32_t>{gravity->handler, grow->handler}));
+
+    // Push writes V.z after Gravity wrote V.y only, but Integrate read all of V
+    EXPECT_EQ(push->level, 1);
+    EXPECT_TRUE(push->readsInput);
+
+    // Pulse writes T.S.x, which Grow does not touch
+    EXPECT_EQ(pulse->level, 0);
+    EXPECT_TRUE(pulse->serial);
+
+    size_t scheduled = 0;
+    for (const auto& level : graph.levels) {
+        scheduled += level.size();
+    }
+    EXPECT_EQ(scheduled, graph.nodes.size());
+    EXPECT_NE(graph.ToString(*module).find("level 2: Land"), std::string::npos);
+}
+
+TEST(AOPLDataflowTest, ParallelTicksMatchSerialTicks) {
+    auto module = TestHelpers::CompileAOPL(WORLD_SOURCE);
+
+    for (bool batch : {true, false}) {
+        RuntimeConfig serialConfig;
+        serialConfig.batchChunks = batch;
+        serialConfig.jitThreshold = 50;
+        RuntimeConfig parallelConfig = serialConfig;
+        parallelConfig.threadCount = 4;
+
+        Runtime serial(module, serialConfig);
+        Runtime parallel(module, parallelConfig);
+        for (int i = 0; i < 5000; ++i) {
+            EntityId a = serial.Spawn("Body");
+            EntityId b = parallel.Spawn("Body");
+            serial.SetValue(a, "V", i % 7);
+            parallel.SetValue(b, "V", i % 7);
+        }
+
+        for (int frame = 0; frame < 30; ++frame) {
+            bool drive = frame % 3 == 0;
+            serial.GetInput().SetKey(LookupKeyCode("W"), drive);
+            parallel.GetInput().SetKey(LookupKeyCode("W"), drive);
+            serial.Tick(0.05f);
+            parallel.Tick(0.05f);
+        }
+
+        World& a = serial.GetWorld();
+        World& b = parallel.GetWorld();
+        ASSERT_EQ(a.GetEntityCount(), b.GetEntityCount());
+        size_t mismatches = 0;
+        for (EntityId entity = 0; entity < static_cast<EntityId>(a.GetEntityCount()); ++entity) {
+            for (uint16_t slot = 0; slot < a.GetSlotCount(); ++slot) {
+                mismatches += a.GetSlot(entity, slot) != b.GetSlot(entity, slot) ? 1 : 0;
+            }
+        }
+        EXPECT_EQ(mismatches, 0) << (batch ? "batched" : "per entity");
+        EXPECT_GT(parallel.GetStats().parallelLevels, 0);
+        EXPECT_EQ(serial.GetStats().parallelLevels, 0);
+        EXPECT_EQ(parallel.GetStats().resumptions, serial.GetStats().resumptions);
+    }
+}
+
+TEST(AOPLDataflowTest, WorkerPoolRunsEveryTaskOnce) {
+    WorkerPool pool(4);
+    EXPECT_EQ(pool.GetThreadCount(), 4);
+
+    std::vector<std::atomic<int>> hits(1000);
+    for (int round = 0; round < 50; ++round) {
+        pool.Run(hits.size(), [&hits](size_t i) { ++hits[i]; });
+    }
+    for (const auto& count : hits) {
+        EXPECT_EQ(count.load(), 50);
+    }
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include "gaia_matrix.h"
+#include "../test_utils/test_helpers.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+using namespace gaia_matrix;
+using namespace gaia_matrix::aopl;
+using gaia_matrix::test::TestHelpers;
+
+namespace {
+
+const char* DRONE_FILE = R"(
+    N ⊢ E〈Drone〉〈T⊕C〉
+    T: P 0 1 0 → R 0 0 0 → S 1 1 1
+)";
+
+const char* CONTROLLER_V1 = R"(
+    N〈Controller〉: E Drone
+    Move: T.P z+ 1
+    Count: ⊸ fuel 10
+)";
+
+// Adds `heading` and `refuel` before `fuel`, so fuel moves to another slot
+const char* CONTROLLER_V2 = R"(
+    N〈Controller〉: E Drone
+    Move: T.P z+ 1
+    Aim: ⊸ heading 0 0 1
+    Refuel: ⊿ refuel → ⊸ fuel 10
+    Count: fuel x- 1
+)";
+
+const OptimizerConfig UNOPTIMIZED = {false, false, false, false, false};
+
+void WriteFile(const std::filesystem::path& path, const std::string& source) {
+    // Step the timestamp forward so the change is seen even on coarse file systems
+    bool existed = std::filesystem::exists(path);
+    auto previous = existed ? std::filesystem::last_write_time(path) : std::filesystem::file_time_type();
+    std::ofstream(path) << source;
+    if (existed) {
+        std::filesystem::last_write_time(path, previous + std::chrono::seconds(1));
+    }
+}
+
+} // namespace
+
+TEST(AOPLHotReloadTest, ReloadMigratesEntityState) {
+    RuntimeConfig config;
+    config.enableJit = false;
+    auto first = TestHelpers::CompileAOPL(std::string(DRONE_FILE) + CONTROLLER_V1, UNOPTIMIZED);
+    Runtime runtime(first, config);
+    EntityId drone = runtime.Spawn("Drone");
+    runtime.Tick(0.016f);
+    runtime.Tick(0.016f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(drone, "T.P.z"), 2.0f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(drone, "fuel"), 10.0f);
+
+    auto second = TestHelpers::CompileAOPL(std::string(DRONE_FILE) + CONTROLLER_V2, UNOPTIMIZED);
+    ASSERT_NE(second->FindSlot("fuel")->index, first->FindSlot("fuel")->index);
+    ReloadStats stats = runtime.Reload(second);
+    EXPECT_TRUE(stats.layoutChanged);
+    EXPECT_EQ(stats.slotsAdded, 4);     // heading (3 slots) and refuel
+    EXPECT_EQ(stats.slotsRemoved, 0);
+    EXPECT_EQ(stats.handlersReused, 1); // Move
+    EXPECT_EQ(stats.handlersReplaced, 3);
+
+    // State carried over to the new layout; the edited handler runs from here on
+    EXPECT_FLOAT_EQ(runtime.GetValue(drone, "T.P.z"), 2.0f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(drone, "fuel"), 10.0f);
+    runtime.Tick(0.016f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(drone, "T.P.z"), 3.0f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(drone, "fuel"), 9.0f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(drone, "heading.z"), 1.0f);
+}
+
+TEST(AOPLHotReloadTest, UnchangedHandlersKeepNativeCode) {
+    if (!JitCompiler::IsSupported()) {
+        GTEST_SKIP() << "JIT not supported on this platform";
+    }
+    RuntimeConfig config;
+    config.jitThreshold = 1;
+    config.batchChunks = false;
+    Runtime runtime(TestHelpers::CompileAOPL(std::string(DRONE_FILE) + CONTROLLER_V1, UNOPTIMIZED), config);
+    runtime.Spawn("Drone");
+    runtime.Tick(0.016f);
+    ASSERT_EQ(runtime.GetStats().compiledHandlers, 2);
+
+    runtime.Reload(TestHelpers::CompileAOPL(std::string(DRONE_FILE) + CONTROLLER_V2, UNOPTIMIZED));
+    uint64_t native = runtime.GetStats().nativeInvocations;
+    runtime.Tick(0.016f);
+
+    // Move runs native straight away; the other handlers are interpreted until they tier up again
+    EXPECT_EQ(runtime.GetStats().nativeInvocations, native + 1);
+    EXPECT_EQ(runtime.GetStats().compiledHandlers, 5);
+}
+
+TEST(AOPLHotReloadTest, WatcherRecompilesChangedFiles) {
+    auto directory = std::filesystem::temp_directory_path() / "gaia_aopl_hot_reload";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    WriteFile(directory / "drone.aopl", DRONE_FILE);
+    WriteFile(directory / "controller.aopl", CONTROLLER_V1);
+
+    HotReloader reloader(directory.string());
+    ASSERT_TRUE(reloader.Start());
+    auto runtime = std::make_shared<Runtime>(reloader.GetModule());
+    reloader.Attach(runtime);
+    EntityId drone = runtime->Spawn("Drone");
+    runtime->Tick(0.016f);
+
+    EXPECT_FALSE(reloader.Poll().reloaded);
+
+    WriteFile(directory / "controller.aopl", CONTROLLER_V2);
+    HotReloadResult result = reloader.Poll();
+    ASSERT_TRUE(result.reloaded);
+    EXPECT_EQ(result.changedFiles, std::vector<std::string>{"controller.aopl"});
+    EXPECT_EQ(result.filesCompiled, 1);
+    EXPECT_FLOAT_EQ(runtime->GetValue(drone, "T.P.z"), 1.0f);
+    runtime->Tick(0.016f);
+    EXPECT_FLOAT_EQ(runtime->GetValue(drone, "fuel"), 9.0f);
+
+    // A broken edit is reported and the previous module keeps running
+    WriteFile(directory / "controller.aopl", "N〈Controller〉: E Missing\n");
+    result = reloader.Poll();
+    EXPECT_FALSE(result.reloaded);
+    ASSERT_EQ(result.errors.size(), 1);
+    EXPECT_EQ(result.errors[0], "controller.aopl: unresolved reference 'Missing'");
+    runtime->Tick(0.016f);
+    EXPECT_FLOAT_EQ(runtime->GetValue(drone, "T.P.z"), 3.0f);
+
+    std::filesystem::remove_all(directory);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include "gaia_matrix.h"
+#include "../test_utils/test_helpers.h"
+
+using namespace gaia_matrix;
+using namespace gaia_matrix::aopl;
+using gaia_matrix::test::TestHelpers;
+
+namespace {
+
+const char* PLAYER_SOURCE = R"(
+    N ⊢ E〈Player〉〈T⊕C〉
+    N〈PlayerController〉: E Player
+    Move: I.K W → T.P z+ 0.1
+    Jump: I.K Space → V.y 5
+)";
+
+} // namespace
+
+TEST(AOPLInputTest, DefaultLayoutMapsKeysToTheirOwnAction) {
+    ActionMap map;
+    std::array<InputState, INPUT_DEVICE_COUNT> devices;
+    devices[0].SetKey(LookupKeyCode("W"), true);
+    devices[0].SetKey(LookupKeyCode("Space"), true);
+    devices[static_cast<size_t>(InputDevice::Gamepad)].SetKey(0, true);
+
+    InputState actions;
+    map.Resolve(devices, actions);
+    EXPECT_TRUE(actions.IsKeyDown(LookupKeyCode("W")));
+    EXPECT_TRUE(actions.IsKeyDown(LookupKeyCode("Space")));
+    EXPECT_FALSE(actions.IsKeyDown(0));
+    EXPECT_FALSE(actions.IsKeyDown(LookupKeyCode("S")));
+}
+
+TEST(AOPLInputTest, RemappedButtonsDriveBindings) {
+    Runtime runtime(TestHelpers::CompileAOPL(PLAYER_SOURCE));
+    EntityId player = runtime.Spawn("Player");
+
+    // Move on Up as well as W, jump on gamepad button 0 instead of Space
+    ActionMap& map = runtime.GetActionMap();
+    int space = LookupKeyCode("Space");
+    EXPECT_TRUE(map.Bind(LookupKeyCode("W"), InputDevice::Keyboard, LookupKeyCode("Up")));
+    map.ClearAction(space);
+    EXPECT_TRUE(map.Bind(space, InputDevice::Gamepad, 0));
+    EXPECT_FALSE(map.Bind(space, InputDevice::Gamepad, 300));
+
+    runtime.GetInput().SetKey(space, true);
+    runtime.GetInput().SetKey(LookupKeyCode("Up"), true);
+    runtime.Tick(0.016f);
+    EXPECT_NEAR(runtime.GetValue(player, "T.P.z"), 0.1f, 1e-6f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(player, "V.y"), 0.0f);
+
+    runtime.GetInput(InputDevice::Gamepad).SetKey(0, true);
+    runtime.Tick(0.016f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(player, "V.y"), 5.0f);
+    EXPECT_TRUE(runtime.GetActions().IsKeyDown(space));
+
+    // Unbinding a button releases every action it drove
+    map.Unbind(InputDevice::Keyboard, LookupKeyCode("Up"));
+    runtime.Tick(0.016f);
+    EXPECT_NEAR(runtime.GetValue(player, "T.P.z"), 0.2f, 1e-6f);
+    EXPECT_FALSE(runtime.GetActions().IsKeyDown(LookupKeyCode("W")));
+}
+
+TEST(AOPLInputTest, LayoutsRoundTripThroughText) {
+    ActionMap map;
+    std::vector<std::string> errors;
+    EXPECT_TRUE(map.LoadLayout(R"(
+        # Southpaw
+        W = Keyboard Up
+        W = Gamepad 12
+        Space = Mouse 1
+        5 = Keyboard 05
+    )", errors));
+    EXPECT_TRUE(errors.empty());
+
+    auto bindings = map.GetBindings(LookupKeyCode("W"));
+    ASSERT_EQ(bindings.size(), 2);
+    EXPECT_EQ(bindings[0], std::make_pair(InputDevice::Keyboard, LookupKeyCode("Up")));
+    EXPECT_EQ(bindings[1], std::make_pair(InputDevice::Gamepad, 12));
+    EXPECT_TRUE(map.GetBindings(LookupKeyCode("S")).empty());
+    EXPECT_EQ(map.GetBindings('5')[0], std::make_pair(InputDevice::Keyboard, 5));
+
+    ActionMap copy;
+    EXPECT_TRUE(copy.LoadLayout(map.SaveLayout(), errors));
+    EXPECT_EQ(copy.SaveLayout(), map.SaveLayout());
+
+    EXPECT_FALSE(map.LoadLayout("W = Joystick 1\nJump = Keyboard Space\nW Keyboard Up\nS = Keyboard Down", errors));
+    ASSERT_EQ(errors.size(), 3);
+    EXPECT_NE(errors[0].find("line 1: unknown device"), std::string::npos);
+    EXPECT_NE(errors[1].find("line 2: unknown action"), std::string::npos);
+    EXPECT_NE(errors[2].find("line 3: expected"), std::string::npos);
+    EXPECT_EQ(map.GetBindings(LookupKeyCode("S")).size(), 1);
+}
+
+TEST(AOPLInputTest, ThousandsOfEntitiesShareOneResolve) {
+    RuntimeConfig config;
+    config.jitThreshold = 100;
+    Runtime runtime(TestHelpers::CompileAOPL(PLAYER_SOURCE), config);
+    const int count = 5000;
+    for (int i = 0; i < count; ++i) {
+        runtime.Spawn("Player");
+    }
+    runtime.GetActionMap().Bind(LookupKeyCode("W"), InputDevice::Gamepad, 3);
+
+    for (int frame = 0; frame < 10; ++frame) {
+        runtime.GetInput(InputDevice::Gamepad).SetKey(3, frame % 2 == 0);
+        runtime.Tick(0.016f);
+    }
+    EXPECT_NEAR(runtime.GetValue(0, "T.P.z"), 0.5f, 1e-5f);
+    EXPECT_NEAR(runtime.GetValue(count - 1, "T.P.z"), 0.5f, 1e-5f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(count - 1, "V.y"), 0.0f);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
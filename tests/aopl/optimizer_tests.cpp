@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include "gaia_matrix.h"
+
+using namespace gaia_matrix;
+using namespace gaia_matrix::aopl;
+
+class AOPLOptimizerTest : public ::testing::Test {
+protected:
+    // Compile with a single optimizer pass enabled
+    std::shared_ptr<const Module> CompileWith(const std::string& code, OptimizerConfig config) {
+        EXPECT_TRUE(parser.Parse(code));
+        parser.SetOptimizerConfig(config);
+        EXPECT_TRUE(parser.Compile());
+        return parser.GetModule();
+    }
+
+    static OptimizerConfig Only(bool OptimizerConfig::*pass) {
+        OptimizerConfig config{false, false, false, false, false};
+        config.*pass = true;
+        return config;
+    }
+
+    Parser parser;
+};
+
+TEST_F(AOPLOptimizerTest, FoldsConstants) {
+    auto module = CompileWith(R"(
+        N〈Controller〉: V
+        Reset: ⊸ speed 2 → speed x+ 3 → V.y speed → ⊿ speed → ⊸ speed 5
+        Dead: ⊸ armed false → ⊿ armed → V.x 1
+    )", Only(&OptimizerConfig::constantFolding));
+
+    const auto& stats = parser.GetOptimizerStats();
+    EXPECT_EQ(stats.constantsFolded, 2);  // speed + 3 and V.y = speed
+    EXPECT_EQ(stats.guardsFolded, 2);     // ⊿ speed always passes, ⊿ armed always fails
+    EXPECT_EQ(stats.deadStoresRemoved, 1);// ⊸ speed 5 when speed is already 5
+
+    const auto& reset = module->handlers[0].code;
+    ASSERT_EQ(reset.size(), 3);
+    EXPECT_EQ(reset[1].op, OpCode::Store);
+    EXPECT_FLOAT_EQ(reset[1].imm[0], 5.0f);
+    EXPECT_EQ(reset[2].op, OpCode::Store);
+    EXPECT_FLOAT_EQ(reset[2].imm[0], 5.0f);
+
+    // Everything after the failing guard is gone
+    ASSERT_EQ(module->handlers[1].code.size(), 1);
+}
+
+TEST_F(AOPLOptimizerTest, EliminatesDeadStoresAndCode) {
+    auto module = CompileWith(R"(
+        N〈Controller〉: V
+        Land: V.y 3 → V.y 0 → I.K W → V.x 1 → ⊿ grounded
+    )", Only(&OptimizerConfig::deadStores));
+    EXPECT_EQ(parser.GetOptimizerStats().deadStoresRemoved, 1);
+    EXPECT_EQ(module->handlers[0].code.size(), 4);
+
+    module = CompileWith(R"(
+        N〈Controller〉: V
+        Land: V.y 0 → I.K W → V.x 1 → ⊿ grounded → I.K S
+    )", Only(&OptimizerConfig::deadCode));
+    EXPECT_EQ(parser.GetOptimizerStats().deadInstructionsRemoved, 2);
+    EXPECT_EQ(module->handlers[0].code.size(), 3);
+
+    module = CompileWith(R"(
+        N〈Controller〉: V
+        Idle: I.K W → ⊿ grounded
+        Move: I.K D → T.P x+ 0.1
+    )", Only(&OptimizerConfig::deadCode));
+    EXPECT_EQ(parser.GetOptimizerStats().handlersRemoved, 1);
+    ASSERT_EQ(module->handlers.size(), 1);
+    EXPECT_EQ(module->handlers[0].name, "Move");
+}
+
+TEST_F(AOPLOptimizerTest, DeduplicatesGuards) {
+    auto module = CompileWith(R"(
+        N〈Controller〉: V
+        Dash: I.K Shift → ⊿ grounded → V.x 4 → I.K Shift → ⊿ grounded → V.z 4 → ⊸ grounded false → ⊿ grounded
+    )", Only(&OptimizerConfig::commonSubexpressions));
+
+    // The last guard follows a write to grounded and must stay
+    EXPECT_EQ(parser.GetOptimizerStats().guardsDeduplicated, 2);
+    EXPECT_EQ(module->handlers[0].code.size(), 6);
+}
+
+TEST_F(AOPLOptimizerTest, FusesFlowsWithoutChangingResults) {
+    const std::string code = R"(
+        N ⊢ E〈PlayerEntity〉〈T⊕C⊕I〉
+        T: P 0 1 0 → R 0 0 0 → S 1 1 1
+
+        N〈PlayerController〉: V ⊢ I → F Move → A Jump → C Collision
+        Move: I.K W → T.P z+ 0.1
+        Move: I.K S → T.P z- 0.1
+        Move: I.K A → T.P x- 0.1
+        Move: I.K D → T.P x+ 0.1
+        Jump: I.K Space → V.y 5 → ⊿ grounded
+        Collision: ⊿ ground → ⊸ grounded true → V.y 0
+    )";
+
+    auto plain = CompileWith(code, {false, false, false, false, false});
+    auto optimized = CompileWith(code, OptimizerConfig());
+    const auto& stats = parser.GetOptimizerStats();
+    EXPECT_EQ(stats.handlersFused, 6);
+    EXPECT_LT(stats.instructionsAfter, stats.instructionsBefore);
+    ASSERT_EQ(optimized->handlers.size(), 1);
+    EXPECT_EQ(optimized->handlers[0].name, "PlayerController");
+
+    RuntimeConfig config;
+    config.jitThreshold = 8;
+    Runtime reference(plain, config);
+    Runtime fused(optimized, config);
+    for (int i = 0; i < 16; ++i) {
+        reference.Spawn("PlayerEntity");
+        fused.Spawn("PlayerEntity");
+    }
+
+    for (int frame = 0; frame < 12; ++frame) {
+        for (Runtime* runtime : {&reference, &fused}) {
+            runtime->GetInput().SetKey(LookupKeyCode("W"), frame % 2 == 0);
+            runtime->GetInput().SetKey(LookupKeyCode("D"), frame % 3 == 0);
+            runtime->GetInput().SetKey(LookupKeyCode("Space"), frame % 4 == 0);
+            runtime->SetValue(frame % 16, "ground", 1.0f);
+            runtime->Tick(0.016f);
+        }
+    }
+
+    for (EntityId entity = 0; entity < 16; ++entity) {
+        for (const char* path : {"T.P.x", "T.P.z", "V.y", "grounded"}) {
+            EXPECT_FLOAT_EQ(fused.GetValue(entity, path), reference.GetValue(entity, path));
+        }
+    }
+
+    // Generated AOT source uses a breakable block per fused segment
+    EXPECT_NE(AotCompiler::GenerateSource(*optimized).find("} while (0);"), std::string::npos);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -138,7 +138,141 @@ TEST_F(AOPLParserTest, Compilation) {
     EXPECT_TRUE(parser->Compile());
 }
 
+TEST_F(AOPLParserTest, ParseErrorsBlockCompilation) {
+    // A line that matches no statement is reported instead of dropped
+    const std::string code = R"(
+        N ⊢ E〈TestEntity〉〈T〉
+        T: P 0 1 0
+        stray words
+    )";
+    EXPECT_FALSE(parser->Parse(code));
+    ASSERT_EQ(parser->GetErrors().size(), 1);
+    EXPECT_EQ(parser->GetErrors()[0], "line 4: unrecognized statement");
+
+    // Compiling keeps the parse errors and fails on them
+    EXPECT_FALSE(parser->Compile());
+    ASSERT_EQ(parser->GetErrors().size(), 1);
+    EXPECT_EQ(parser->GetModule(), nullptr);
+}
+
+TEST_F(AOPLParserTest, InvalidTransformFailsParseAndCompile) {
+    const std::string code = R"(
+        N ⊢ E〈TestEntity〉〈T〉
+        T: P 0 abc 0 → R 0 0 0 → S 1 1 1
+    )";
+    EXPECT_FALSE(parser->Parse(code));
+    ASSERT_EQ(parser->GetErrors().size(), 1);
+    EXPECT_EQ(parser->GetErrors()[0], "line 3: invalid transform value");
+    EXPECT_FALSE(parser->Compile());
+    EXPECT_EQ(parser->GetErrors().size(), 1);
+
+    // Fixing the value through an edit clears the error; breaking it again fails the edit
+    ParseChanges changes;
+    TextEdit edit;
+    edit.startLine = edit.endLine = 3;
+    edit.startColumn = 15;
+    edit.endColumn = 18;
+    edit.text = "2";
+    EXPECT_TRUE(parser->ApplyEdit(edit, changes));
+    EXPECT_TRUE(parser->GetErrors().empty());
+    EXPECT_TRUE(parser->Compile());
+
+    edit.endColumn = 16;
+    edit.text = "x";
+    EXPECT_FALSE(parser->ApplyEdit(edit, changes));
+    EXPECT_EQ(parser->GetErrors().size(), 1);
+    EXPECT_FALSE(parser->Compile());
+}
+
+TEST_F(AOPLParserTest, IncrementalEditReportsChangedHandlers) {
+    const std::string code =
+        "N ⊢ E〈Player〉〈T⊕C⊕I〉\n"
+        "T: P 0 1 0 → R 0 0 0 → S 1 1 1\n"
+        "\n"
+        "N〈PlayerController〉: V ⊢ I → F Move → A Jump\n"
+        "Move: I.K W → T.P z+ 0.1\n"
+        "Jump: I.K Space → V.y 5\n"
+        "\n"
+        "NN〈Animator〉: E Player → O Animation\n"
+        "⊸ Model \"models/animator.onnx\"\n";
+    ASSERT_TRUE(parser->Parse(code));
+    auto player = parser->GetEntities()[0];
+    auto animator = parser->GetAINodes()[0];
+
+    // Change the speed of Move: "0.1" -> "0.25" on line 5 (columns are bytes)
+    TextEdit edit;
+    edit.startLine = 5;
+    edit.startColumn = static_cast<int>(std::string("Move: I.K W → T.P z+ ").size());
+    edit.endLine = 5;
+    edit.endColumn = edit.startColumn + 3;
+    edit.text = "0.25";
+    ParseChanges changes;
+    ASSERT_TRUE(parser->ApplyEdit(edit, changes));
+
+    EXPECT_EQ(changes.changedHandlers, std::vector<std::string>{"PlayerController.Move"});
+    EXPECT_EQ(changes.changedBehaviors, std::vector<std::string>{"PlayerController"});
+    EXPECT_TRUE(changes.changedEntities.empty());
+    EXPECT_TRUE(changes.changedAINodes.empty());
+    EXPECT_EQ(changes.blocksReparsed, 1);
+    EXPECT_EQ(changes.blocksReused, 2);
+
+    // Untouched blocks keep their nodes
+    EXPECT_EQ(parser->GetEntities()[0], player);
+    EXPECT_EQ(parser->GetAINodes()[0], animator);
+    EXPECT_EQ(parser->GetBehaviors()[0]->GetBindings()[0].stages[1].tokens.back(), "0.25");
+
+    // Inserting lines shifts later nodes without reparsing them
+    edit = TextEdit();
+    edit.startLine = 7;
+    edit.endLine = 7;
+    edit.text = "Land: ⊿ ground → V.y 0\n";
+    ASSERT_TRUE(parser->ApplyEdit(edit, changes));
+    EXPECT_EQ(changes.changedHandlers, std::vector<std::string>{"PlayerController.Land"});
+    EXPECT_EQ(parser->GetAINodes()[0], animator);
+    EXPECT_EQ(animator->GetLocation().line, 9);
+
+    // The incremental result matches a full parse of the same text
+    Parser fresh;
+    ASSERT_TRUE(fresh.Parse(parser->GetSource()));
+    ASSERT_TRUE(fresh.Compile());
+    ASSERT_TRUE(parser->Compile());
+    EXPECT_EQ(HashModule(*parser->GetModule()), HashModule(*fresh.GetModule()));
+    EXPECT_EQ(parser->GetBehaviors()[0]->GetBindings()[2].location.line,
+              fresh.GetBehaviors()[0]->GetBindings()[2].location.line);
+}
+
+TEST_F(AOPLParserTest, IncrementalEditSplitsAndMergesBlocks) {
+    ASSERT_TRUE(parser->Parse("N ⊢ E〈A〉\nT: P 1 2 3\nN ⊢ E〈B〉\n"));
+    ParseChanges changes;
+
+    // Turning a component line into a declaration splits the block
+    TextEdit edit;
+    edit.startLine = 2;
+    edit.endLine = 2;
+    edit.endColumn = static_cast<int>(std::string("T: P 1 2 3").size());
+    edit.text = "N ⊢ E〈C〉";
+    ASSERT_TRUE(parser->ApplyEdit(edit, changes));
+    ASSERT_EQ(parser->GetEntities().size(), 3);
+    EXPECT_EQ(parser->GetEntities()[1]->GetName(), "C");
+    EXPECT_EQ(changes.changedEntities, (std::vector<std::string>{"A", "C"}));
+
+    // Deleting the declaration line removes the entity again
+    edit = TextEdit();
+    edit.startLine = 2;
+    edit.endLine = 3;
+    ASSERT_TRUE(parser->ApplyEdit(edit, changes));
+    ASSERT_EQ(parser->GetEntities().size(), 2);
+    EXPECT_EQ(parser->GetEntities()[1]->GetName(), "B");
+    EXPECT_EQ(parser->GetEntities()[1]->GetLocation().line, 2);
+    EXPECT_EQ(changes.changedEntities, std::vector<std::string>{"C"});
+
+    // Out-of-range edits are rejected
+    edit.startLine = 1;
+    edit.endLine = 99;
+    EXPECT_FALSE(parser->ApplyEdit(edit, changes));
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
-}
\ No newline at end of file
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include "gaia_matrix.h"
+#include "../test_utils/test_helpers.h"
+#include <chrono>
+
+using namespace gaia_matrix;
+using namespace gaia_matrix::aopl;
+using gaia_matrix::test::TestHelpers;
+
+namespace {
+
+const char* DRONE_SOURCE = R"(
+    N ⊢ E〈Drone〉〈T⊕C〉
+    N〈Controller〉: E Drone
+    Move: ⊿ active → T.P z+ 0.1
+    Spin: T.R y+ 1
+)";
+
+const ProfileEntry* FindEntry(const std::vector<ProfileEntry>& entries, int line, int stage) {
+    for (const auto& entry : entries) {
+        if (entry.line == line && entry.stage == stage) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+TEST(AOPLProfilerTest, ExactModeCountsHandlersLinesAndStages) {
+    Runtime runtime(TestHelpers::CompileAOPL(DRONE_SOURCE));
+    for (int i = 0; i < 100; ++i) {
+        EntityId drone = runtime.Spawn("Drone");
+        runtime.SetValue(drone, "active", i % 2 ? 1.0f : 0.0f);
+    }
+
+    ProfilerConfig config;
+    config.mode = ProfileMode::Exact;
+    auto profiler = std::make_shared<Profiler>(config);
+    runtime.SetProfiler(profiler);
+    for (int i = 0; i < 3; ++i) {
+        runtime.Tick(0.016f);
+    }
+
+    // Move and Spin are fused into one handler per behavior
+    auto handlers = profiler->GetEntries(ProfileLevel::Handler);
+    ASSERT_EQ(handlers.size(), 1);
+    EXPECT_EQ(handlers[0].handler, "Controller");
+    EXPECT_EQ(handlers[0].invocations, 300);
+    EXPECT_FLOAT_EQ(handlers[0].percent, 100.0f);
+
+    auto lines = profiler->GetEntries(ProfileLevel::Line);
+    ASSERT_NE(FindEntry(lines, 4, -1), nullptr);
+    ASSERT_NE(FindEntry(lines, 5, -1), nullptr);
+    EXPECT_EQ(FindEntry(lines, 4, -1)->invocations, 300);
+
+    // Only active drones get past the guard to the second stage
+    auto stages = profiler->GetEntries(ProfileLevel::Stage);
+    ASSERT_NE(FindEntry(stages, 4, 0), nullptr);
+    ASSERT_NE(FindEntry(stages, 4, 1), nullptr);
+    EXPECT_EQ(FindEntry(stages, 4, 0)->invocations, 300);
+    EXPECT_EQ(FindEntry(stages, 4, 1)->invocations, 150);
+    EXPECT_EQ(FindEntry(stages, 4, 1)->GetLocation(), "line 4 →1");
+
+    EXPECT_FLOAT_EQ(runtime.GetValue(1, "T.P.z"), 0.3f);
+    EXPECT_EQ(runtime.GetStats().nativeInvocations, 0);
+    EXPECT_NE(profiler->GetReport().find("AOPL profile (exact)"), std::string::npos);
+}
+
+TEST(AOPLProfilerTest, SamplingAttributesTimeToHandlers) {
+    Runtime runtime(TestHelpers::CompileAOPL(DRONE_SOURCE));
+    for (int i = 0; i < 64 * 64; ++i) {
+        runtime.Spawn("Drone");
+    }
+
+    ProfilerConfig config;
+    config.sampleIntervalMicroseconds = 100;
+    auto profiler = std::make_shared<Profiler>(config);
+    runtime.SetProfiler(profiler);
+
+    // Run until the sampler has caught the handler, bounded in case the machine is very loaded
+    auto start = std::chrono::steady_clock::now();
+    uint64_t samples = 0;
+    while (samples == 0 && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+        runtime.Tick(0.016f);
+        samples = profiler->GetEntries(ProfileLevel::Handler)[0].samples;
+    }
+    EXPECT_GT(samples, 0);
+
+    auto handlers = profiler->GetEntries(ProfileLevel::Handler);
+    EXPECT_GT(handlers[0].invocations, 0);
+    EXPECT_GT(handlers[0].milliseconds, 0.0);
+    EXPECT_NE(profiler->GetReport().find("Controller"), std::string::npos);
+}
+
+TEST(AOPLProfilerTest, ReportsProjectFileLocations) {
+    ProjectCompiler project;
+    project.AddFile("drone.aopl", DRONE_SOURCE);
+    ASSERT_TRUE(project.Build());
+
+    Runtime runtime(project.GetModule());
+    runtime.Spawn("Drone");
+    ProfilerConfig config;
+    config.mode = ProfileMode::Exact;
+    auto profiler = std::make_shared<Profiler>(config);
+    runtime.SetProfiler(profiler);
+    runtime.Tick(0.016f);
+
+    auto lines = profiler->GetEntries(ProfileLevel::Line);
+    ASSERT_NE(FindEntry(lines, 5, -1), nullptr);
+    EXPECT_EQ(FindEntry(lines, 5, -1)->GetLocation(), "drone.aopl:5");
+    EXPECT_NE(profiler->GetReport().find("drone.aopl:4 →0"), std::string::npos);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
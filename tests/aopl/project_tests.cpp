@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include "gaia_matrix.h"
+
+using namespace gaia_matrix;
+using namespace gaia_matrix::aopl;
+
+namespace {
+
+const char* PLAYER_FILE = R"(
+    N ⊢ E〈PlayerEntity〉〈T⊕C⊕I〉
+    T: P 0 1 0 → R 0 0 0 → S 1 1 1
+)";
+
+const char* CONTROLLER_FILE = R"(
+    N〈PlayerController〉: E PlayerEntity → F Move
+    Move: I.K W → T.P z+ 0.1
+    Collision: ⊿ ground → ⊸ grounded true
+)";
+
+const char* ANIMATOR_FILE = R"(
+    NN〈PlayerAnimator〉: E PlayerEntity → O Animation
+    ⊸ Model "models/player_animator.onnx"
+
+    N〈AnimatorDriver〉: V ⊢ I
+    Blend: ⊿ grounded → ⊸ blend 1
+)";
+
+} // namespace
+
+TEST(AOPLProjectTest, LinksFilesInDependencyOrder) {
+    ProjectConfig config;
+    config.threadCount = 3;
+    ProjectCompiler compiler(config);
+    compiler.AddFile("animator.aopl", ANIMATOR_FILE);
+    compiler.AddFile("controller.aopl", CONTROLLER_FILE);
+    compiler.AddFile("player.aopl", PLAYER_FILE);
+
+    ASSERT_TRUE(compiler.Build());
+    EXPECT_EQ(compiler.GetStats().filesCompiled, 3);
+    EXPECT_EQ(compiler.GetStats().threadsUsed, 3);
+
+    // Both files reference PlayerEntity, so player.aopl links first
+    auto order = compiler.GetBuildOrder();
+    ASSERT_EQ(order.size(), 3);
+    EXPECT_EQ(order[0], "player.aopl");
+    EXPECT_EQ(compiler.GetFiles()[0].dependencies, std::vector<size_t>{2});
+
+    // `grounded` is written in one file and read in another: they must share a slot
+    auto module = compiler.GetModule();
+    ASSERT_NE(module, nullptr);
+    ASSERT_NE(module->FindTemplate("PlayerEntity"), nullptr);
+    Runtime runtime(module);
+    EntityId player = runtime.Spawn("PlayerEntity");
+    EXPECT_FLOAT_EQ(runtime.GetValue(player, "T.P.y"), 1.0f);
+    runtime.SetValue(player, "ground", 1.0f);
+    runtime.GetInput().SetKey(LookupKeyCode("W"), true);
+    runtime.Tick(0.016f);
+    runtime.Tick(0.016f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(player, "grounded"), 1.0f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(player, "blend"), 1.0f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(player, "T.P.z"), 0.2f);
+}
+
+TEST(AOPLProjectTest, ReportsUnresolvedAndDuplicateNames) {
+    ProjectCompiler missing;
+    missing.AddFile("animator.aopl", ANIMATOR_FILE);
+    EXPECT_FALSE(missing.Build());
+    ASSERT_EQ(missing.GetErrors().size(), 1);
+    EXPECT_EQ(missing.GetErrors()[0], "animator.aopl: unresolved reference 'PlayerEntity'");
+    EXPECT_EQ(missing.GetModule(), nullptr);
+
+    ProjectCompiler duplicate;
+    duplicate.AddFile("a.aopl", PLAYER_FILE);
+    duplicate.AddFile("b.aopl", PLAYER_FILE);
+    EXPECT_FALSE(duplicate.Build());
+    ASSERT_EQ(duplicate.GetErrors().size(), 1);
+    EXPECT_EQ(duplicate.GetErrors()[0], "b.aopl: 'PlayerEntity' is already declared in a.aopl");
+}
+
+TEST(AOPLProjectTest, RejectsCyclicReferences) {
+    ProjectCompiler compiler;
+    compiler.AddFile("a.aopl", "N ⊢ E〈A〉\nNN〈UsesB〉: E B → O Out\n");
+    compiler.AddFile("b.aopl", "N ⊢ E〈B〉\nNN〈UsesA〉: E A → O Out\n");
+    EXPECT_FALSE(compiler.Build());
+    ASSERT_EQ(compiler.GetErrors().size(), 1);
+    EXPECT_EQ(compiler.GetErrors()[0], "cyclic dependency between a.aopl, b.aopl");
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
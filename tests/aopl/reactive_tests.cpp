@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+#include "gaia_matrix.h"
+#include "../test_utils/test_helpers.h"
+
+using namespace gaia_matrix;
+using namespace gaia_matrix::aopl;
+using gaia_matrix::test::TestHelpers;
+
+namespace {
+
+// One binding per behavior so flow fusion keeps the pure ones separate
+const char* WORLD_SOURCE = R"(
+    N ⊢ E〈Body〉〈T⊕C〉
+    T: P 0 10 0 → R 0 0 0 → S 1 1 1
+    N〈Integrate〉: E Body
+    Step: T.P += V * dt
+    N〈Jumper〉: E Body
+    Jump: I.K Space → V.y 5 → ⊸ airborne true
+    N〈Aim〉: E Body
+    Face: ⊿ airborne → T.R T.P
+    N〈Brake〉: E Body
+    Stop: I.K S → V 0 0 0
+)";
+
+size_t CountMismatches(World& a, World& b) {
+    size_t mismatches = 0;
+    for (EntityId entity = 0; entity < static_cast<EntityId>(a.GetEntityCount()); ++entity) {
+        for (uint16_t slot = 0; slot < a.GetSlotCount(); ++slot) {
+            mismatches += a.GetSlot(entity, slot) != b.GetSlot(entity, slot) ? 1 : 0;
+        }
+    }
+    return mismatches;
+}
+
+} // namespace
+
+TEST(AOPLReactiveTest, ClassifiesPureHandlers) {
+    auto module = TestHelpers::CompileAOPL(WORLD_SOURCE);
+    DataflowGraph graph = BuildDataflowGraph(*module);
+    ASSERT_EQ(graph.nodes.size(), 4);
+
+    EXPECT_FALSE(graph.nodes[0].pure);   // Integration reads its own output
+    EXPECT_TRUE(graph.nodes[1].pure);
+    EXPECT_TRUE(graph.nodes[2].pure);
+    EXPECT_TRUE(graph.nodes[3].pure);
+
+    int space = LookupKeyCode("Space");
+    EXPECT_TRUE((graph.nodes[1].keys[space >> 6] >> (space & 63)) & 1);
+    EXPECT_EQ(graph.nodes[2].keys, (std::array<uint64_t, 4>{0, 0, 0, 0}));
+}
+
+TEST(AOPLReactiveTest, IdleChunksAreSkipped) {
+    RuntimeConfig config;
+    config.reactive = true;
+    Runtime runtime(TestHelpers::CompileAOPL(WORLD_SOURCE), config);
+    const int count = 640;
+    for (int i = 0; i < count; ++i) {
+        runtime.Spawn("Body");
+    }
+
+    // The first tick evaluates everything; after that nothing moves and only the integration runs
+    runtime.Tick(0.1f);
+    EXPECT_EQ(runtime.GetStats().skippedEvaluations, 0);
+    for (int frame = 0; frame < 10; ++frame) {
+        runtime.Tick(0.1f);
+    }
+    EXPECT_EQ(runtime.GetStats().skippedEvaluations, 10u * 3 * count);
+    EXPECT_EQ(runtime.GetStats().skippedChunks, 10u * 3 * count / CHUNK_SIZE);
+
+    // A host write wakes the pure handlers of that entity's chunk only
+    EntityId mover = 200;
+    runtime.SetValue(mover, "airborne", 1.0f);
+    runtime.SetValue(mover, "V.x", 2.0f);
+    uint64_t skipped = runtime.GetStats().skippedEvaluations;
+    runtime.Tick(0.5f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(mover, "T.R.x"), 1.0f);
+    EXPECT_EQ(runtime.GetStats().skippedEvaluations - skipped, 3u * count - CHUNK_SIZE * 3);
+
+    // Pressing a key wakes every handler that tests it
+    runtime.GetInput().SetKey(LookupKeyCode("Space"), true);
+    runtime.Tick(0.1f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(0, "V.y"), 5.0f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(count - 1, "airborne"), 1.0f);
+}
+
+TEST(AOPLReactiveTest, ReactiveTicksMatchFullTicks) {
+    auto module = TestHelpers::CompileAOPL(WORLD_SOURCE);
+
+    for (uint32_t threads : {1u, 4u}) {
+        for (bool batch : {true, false}) {
+            RuntimeConfig fullConfig;
+            fullConfig.batchChunks = batch;
+            fullConfig.jitThreshold = 50;
+            RuntimeConfig reactiveConfig = fullConfig;
+            reactiveConfig.reactive = true;
+            reactiveConfig.threadCount = threads;
+
+            Runtime full(module, fullConfig);
+            Runtime reactive(module, reactiveConfig);
+            for (int i = 0; i < 3000; ++i) {
+                full.Spawn("Body");
+                reactive.Spawn("Body");
+            }
+
+            for (int frame = 0; frame < 40; ++frame) {
+                bool jump = frame % 10 == 3;
+                bool brake = frame % 10 == 7;
+                for (Runtime* runtime : {&full, &reactive}) {
+                    runtime->GetInput().SetKey(LookupKeyCode("Space"), jump);
+                    runtime->GetInput().SetKey(LookupKeyCode("S"), brake);
+                    if (frame % 5 == 0) {
+                        runtime->SetValue(frame * 37 % 3000, "airborne", 0.0f);
+                        runtime->SetValue(frame * 53 % 3000, "V.z", 1.5f);
+                    }
+                    runtime->Tick(0.05f);
+                }
+            }
+
+            EXPECT_EQ(CountMismatches(full.GetWorld(), reactive.GetWorld()), 0)
+                << threads << " thread(s), " << (batch ? "batched" : "per entity");
+            EXPECT_GT(reactive.GetStats().skippedEvaluations, 0);
+            EXPECT_EQ(full.GetStats().skippedEvaluations, 0);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
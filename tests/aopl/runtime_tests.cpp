@@ -0,0 +1,308 @@
+#include <gtest/gtest.h>
+#include "gaia_matrix.h"
+#include "../test_utils/test_helpers.h"
+#include <filesystem>
+
+using namespace gaia_matrix;
+using namespace gaia_matrix::aopl;
+
+namespace {
+
+const char* PLAYER_SCRIPT = R"(
+    N ⊢ E〈PlayerEntity〉〈T⊕C⊕I〉
+    T: P 0 1 0 → R 0 0 0 → S 1 1 1
+
+    N〈PlayerController〉: V ⊢ I → F Move → A Jump → C Collision
+    Move: I.K W → T.P z+ 0.1
+    Move: I.K S → T.P z- 0.1
+    Jump: I.K Space → V.y 5 → ⊿ grounded
+    Collision: ⊿ ground → ⊸ grounded true → V.y 0
+)";
+
+} // namespace
+
+class AOPLRuntimeTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(parser.Parse(PLAYER_SCRIPT));
+        ASSERT_TRUE(parser.Compile());
+        module = parser.GetModule();
+        ASSERT_NE(module, nullptr);
+    }
+
+    Parser parser;
+    std::shared_ptr<const Module> module;
+};
+
+TEST_F(AOPLRuntimeTest, LowersBindings) {
+    // Inspect the raw lowering, without optimization
+    parser.SetOptimizerConfig({false, false, false, false, false});
+    ASSERT_TRUE(parser.Compile());
+    module = parser.GetModule();
+
+    ASSERT_EQ(module->handlers.size(), 4);
+    EXPECT_EQ(module->handlers[0].name, "Move");
+    EXPECT_EQ(module->handlers[0].behavior, "PlayerController");
+    ASSERT_EQ(module->handlers[0].code.size(), 2);
+    EXPECT_EQ(module->handlers[0].code[0].op, OpCode::TestKey);
+    EXPECT_EQ(module->handlers[0].code[1].op, OpCode::Add);
+    EXPECT_NE(module->FindSlot("grounded"), nullptr);
+}
+
+TEST_F(AOPLRuntimeTest, InterpretsHandlers) {
+    RuntimeConfig config;
+    config.enableJit = false;
+    Runtime runtime(module, config);
+
+    EntityId player = runtime.Spawn("PlayerEntity");
+    ASSERT_GE(player, 0);
+    EXPECT_FLOAT_EQ(runtime.GetValue(player, "T.P.y"), 1.0f);
+
+    runtime.GetInput().SetKey(LookupKeyCode("W"), true);
+    runtime.Tick(0.016f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(player, "T.P.z"), 0.1f);
+
+    // Jump sets V.y before the grounded guard stops the flow
+    runtime.GetInput().SetKey(LookupKeyCode("Space"), true);
+    runtime.Tick(0.016f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(player, "V.y"), 5.0f);
+
+    // Landing resets velocity and sets the grounded flag
+    runtime.SetValue(player, "ground", 1.0f);
+    runtime.Tick(0.016f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(player, "grounded"), 1.0f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(player, "V.y"), 0.0f);
+    EXPECT_EQ(runtime.GetStats().nativeInvocations, 0);
+}
+
+TEST_F(AOPLRuntimeTest, RejectsUnknownStages) {
+    Parser badParser;
+    ASSERT_TRUE(badParser.Parse("N〈Broken〉: V\nMove: I.K Nowhere → T.P z+ 0.1\n"));
+    EXPECT_FALSE(badParser.Compile());
+    ASSERT_FALSE(badParser.GetErrors().empty());
+    EXPECT_NE(badParser.GetErrors()[0].find("line 2"), std::string::npos);
+}
+
+TEST_F(AOPLRuntimeTest, JitMatchesInterpreter) {
+    if (!JitCompiler::IsSupported()) {
+        GTEST_SKIP() << "JIT not supported on this platform";
+    }
+
+    RuntimeConfig interpretedConfig;
+    interpretedConfig.enableJit = false;
+    RuntimeConfig jitConfig;
+    jitConfig.jitThreshold = 4;
+
+    Runtime interpreted(module, interpretedConfig);
+    Runtime jitted(module, jitConfig);
+    for (int i = 0; i < 100; ++i) {
+        interpreted.Spawn("PlayerEntity");
+        jitted.Spawn("PlayerEntity");
+    }
+
+    for (int frame = 0; frame < 20; ++frame) {
+        for (Runtime* runtime : {&interpreted, &jitted}) {
+            runtime->GetInput().SetKey(LookupKeyCode("W"), frame % 2 == 0);
+            runtime->GetInput().SetKey(LookupKeyCode("Space"), frame % 3 == 0);
+            runtime->SetValue(frame % 100, "ground", frame % 5 == 0 ? 1.0f : 0.0f);
+            runtime->Tick(0.016f);
+        }
+    }
+
+    EXPECT_GT(jitted.GetStats().compiledHandlers, 0);
+    EXPECT_GT(jitted.GetStats().nativeInvocations, 0);
+    for (EntityId entity = 0; entity < 100; ++entity) {
+        for (const char* path : {"T.P.z", "V.y", "grounded"}) {
+            EXPECT_FLOAT_EQ(jitted.GetValue(entity, path), interpreted.GetValue(entity, path));
+        }
+    }
+}
+
+TEST_F(AOPLRuntimeTest, BatchedChunksMatchPerEntityExecution) {
+    RuntimeConfig perEntityConfig;
+    perEntityConfig.enableJit = false;
+    perEntityConfig.batchChunks = false;
+    RuntimeConfig batchedConfig;
+    batchedConfig.enableJit = false;
+
+    // 150 entities: two full chunks and a partial one
+    Runtime perEntity(module, perEntityConfig);
+    Runtime batched(module, batchedConfig);
+    for (int i = 0; i < 150; ++i) {
+        perEntity.Spawn("PlayerEntity");
+        batched.Spawn("PlayerEntity");
+    }
+
+    for (int frame = 0; frame < 12; ++frame) {
+        for (Runtime* runtime : {&perEntity, &batched}) {
+            runtime->GetInput().SetKey(LookupKeyCode("W"), frame % 2 == 0);
+            runtime->GetInput().SetKey(LookupKeyCode("Space"), frame % 3 == 0);
+            // Divergent guards within every lane group
+            for (EntityId entity = frame % 3; entity < 150; entity += 3) {
+                runtime->SetValue(entity, "ground", frame % 2 == 0 ? 1.0f : 0.0f);
+            }
+            runtime->Tick(0.016f);
+        }
+    }
+
+    EXPECT_GT(batched.GetStats().batchedChunks, 0);
+    EXPECT_EQ(perEntity.GetStats().batchedChunks, 0);
+    EXPECT_EQ(batched.GetStats().interpretedInvocations, perEntity.GetStats().interpretedInvocations);
+    for (EntityId entity = 0; entity < 150; ++entity) {
+        for (const char* path : {"T.P.z", "V.y", "grounded", "ground"}) {
+            EXPECT_FLOAT_EQ(batched.GetValue(entity, path), perEntity.GetValue(entity, path));
+        }
+    }
+}
+
+TEST_F(AOPLRuntimeTest, DeoptimizesOnLayoutChange) {
+    if (!JitCompiler::IsSupported()) {
+        GTEST_SKIP() << "JIT not supported on this platform";
+    }
+
+    RuntimeConfig config;
+    config.jitThreshold = 1;
+    Runtime runtime(module, config);
+    EntityId player = runtime.Spawn("PlayerEntity");
+    runtime.GetInput().SetKey(LookupKeyCode("W"), true);
+
+    runtime.Tick(0.016f);
+    ASSERT_GT(runtime.GetStats().compiledHandlers, 0);
+
+    runtime.InvalidateLayout();
+    runtime.Tick(0.016f);
+    EXPECT_GT(runtime.GetStats().deoptimizations, 0);
+    EXPECT_FLOAT_EQ(runtime.GetValue(player, "T.P.z"), 0.2f);
+
+    runtime.SetJitEnabled(false);
+    EXPECT_FALSE(runtime.IsJitEnabled());
+}
+
+TEST_F(AOPLRuntimeTest, AotLibraryMatchesInterpreter) {
+    const std::string source = AotCompiler::GenerateSource(*module);
+    EXPECT_NE(source.find(AotCompiler::GetHandlerSymbol(0)), std::string::npos);
+    EXPECT_NE(source.find("e.s_T_P(2)"), std::string::npos);
+
+#if defined(_WIN32)
+    GTEST_SKIP() << "AOT libraries not supported on this platform";
+#else
+    std::string directory = test::TestHelpers::CreateTempDirectory();
+    std::string libraryPath = directory + "/player.so";
+    if (!AotCompiler::BuildLibrary(*module, libraryPath)) {
+        test::TestHelpers::DeleteTempDirectory(directory);
+        GTEST_SKIP() << "No system C++ compiler available";
+    }
+
+    auto library = AotLibrary::Load(libraryPath, *module);
+    ASSERT_NE(library, nullptr);
+
+    RuntimeConfig config;
+    config.enableJit = false;
+    Runtime interpreted(module, config);
+    Runtime native(module, config);
+    ASSERT_TRUE(native.AttachLibrary(library));
+
+    EntityId player = interpreted.Spawn("PlayerEntity");
+    native.Spawn("PlayerEntity");
+    for (Runtime* runtime : {&interpreted, &native}) {
+        runtime->GetInput().SetKey(LookupKeyCode("W"), true);
+        runtime->GetInput().SetKey(LookupKeyCode("Space"), true);
+        runtime->SetValue(player, "ground", 1.0f);
+        runtime->Tick(0.016f);
+    }
+
+    EXPECT_GT(native.GetStats().aotInvocations, 0);
+    EXPECT_EQ(native.GetStats().interpretedInvocations, 0);
+    for (const char* path : {"T.P.z", "V.y", "grounded"}) {
+        EXPECT_FLOAT_EQ(native.GetValue(player, path), interpreted.GetValue(player, path));
+    }
+
+    // A library built from a different module must be rejected
+    Parser otherParser;
+    ASSERT_TRUE(otherParser.Parse("N〈Other〉: V\nMove: I.K W → T.P x+ 1\n"));
+    ASSERT_TRUE(otherParser.Compile());
+    EXPECT_EQ(AotLibrary::Load(libraryPath, *otherParser.GetModule()), nullptr);
+
+    library.reset();
+    test::TestHelpers::DeleteTempDirectory(directory);
+#endif
+}
+
+TEST_F(AOPLRuntimeTest, AotBuildPassesPathsVerbatim) {
+#if defined(_WIN32)
+    GTEST_SKIP() << "AOT libraries not supported on this platform";
+#else
+    // Shell metacharacters in the path must reach the compiler as plain characters
+    std::string directory = test::TestHelpers::CreateTempDirectory();
+    std::string checkPath = directory + "/check.so";
+    if (!AotCompiler::BuildLibrary(*module, checkPath)) {
+        test::TestHelpers::DeleteTempDirectory(directory);
+        GTEST_SKIP() << "No system C++ compiler available";
+    }
+    std::string libraryPath = directory + "/a \"b\" $(touch injected) `touch injected`/player.so";
+    EXPECT_TRUE(AotCompiler::BuildLibrary(*module, libraryPath));
+    EXPECT_TRUE(std::filesystem::exists(libraryPath));
+    EXPECT_FALSE(std::filesystem::exists("injected"));
+    EXPECT_NE(AotLibrary::Load(libraryPath, *module), nullptr);
+    test::TestHelpers::DeleteTempDirectory(directory);
+#endif
+}
+
+TEST_F(AOPLRuntimeTest, AotNamesSlotsSafely) {
+    // Slots named like C++ keywords, EntityView members, or the mangled form of another path
+    Parser keywords;
+    ASSERT_TRUE(keywords.Parse(R"(
+        N ⊢ E〈Probe〉〈T〉
+        N〈Probe〉: V ⊢ C Collision
+        Collision: ⊿ ground → ⊸ lane true → ⊸ int true → ⊸ at true → ⊸ T_P true → V.y 0
+    )"));
+    ASSERT_TRUE(keywords.Compile());
+    auto probe = keywords.GetModule();
+    const std::string source = AotCompiler::GenerateSource(*probe);
+    EXPECT_NE(source.find("e.s_int()"), std::string::npos);
+    EXPECT_NE(source.find("e.s_lane()"), std::string::npos);
+    EXPECT_NE(source.find("e.s_TX5FP()"), std::string::npos);
+    EXPECT_EQ(source.find("float& int("), std::string::npos);
+
+#if defined(_WIN32)
+    GTEST_SKIP() << "AOT libraries not supported on this platform";
+#else
+    std::string directory = test::TestHelpers::CreateTempDirectory();
+    std::string libraryPath = directory + "/probe.so";
+    if (!AotCompiler::BuildLibrary(*probe, libraryPath)) {
+        // Tell a missing compiler apart from generated code that does not compile
+        std::string checkPath = directory + "/check.so";
+        bool hasCompiler = AotCompiler::BuildLibrary(*module, checkPath);
+        test::TestHelpers::DeleteTempDirectory(directory);
+        ASSERT_FALSE(hasCompiler) << "Generated source does not compile:\n" << source;
+        GTEST_SKIP() << "No system C++ compiler available";
+    }
+
+    auto library = AotLibrary::Load(libraryPath, *probe);
+    ASSERT_NE(library, nullptr);
+    RuntimeConfig config;
+    config.enableJit = false;
+    Runtime interpreted(probe, config);
+    Runtime native(probe, config);
+    ASSERT_TRUE(native.AttachLibrary(library));
+    EntityId entity = interpreted.Spawn("Probe");
+    native.Spawn("Probe");
+    for (Runtime* runtime : {&interpreted, &native}) {
+        runtime->SetValue(entity, "ground", 1.0f);
+        runtime->Tick(0.016f);
+    }
+    EXPECT_GT(native.GetStats().aotInvocations, 0);
+    for (const char* path : {"lane", "int", "at", "T_P"}) {
+        EXPECT_FLOAT_EQ(native.GetValue(entity, path), 1.0f) << path;
+        EXPECT_FLOAT_EQ(interpreted.GetValue(entity, path), 1.0f) << path;
+    }
+
+    library.reset();
+    test::TestHelpers::DeleteTempDirectory(directory);
+#endif
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
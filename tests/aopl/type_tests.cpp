@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include "gaia_matrix.h"
+
+using namespace gaia_matrix;
+using namespace gaia_matrix::aopl;
+
+TEST(AOPLTypeTest, InfersTypesFromLiteralsAndFlows) {
+    Parser parser;
+    ASSERT_TRUE(parser.Parse(R"(
+        N ⊢ E〈Drone〉〈T⊕C〉
+
+        N〈Autopilot〉: E Drone → N ⊢ speed → V ⊢ heading
+        Aim: ⊸ target 1 2 3 → heading target → ⊸ armed true
+        Fly: ⊿ armed → V heading → T.P += V * dt → speed x+ 0.5
+        Hover: ⊿ landing → target y+ 1
+    )"));
+    ASSERT_TRUE(parser.Compile());
+    EXPECT_TRUE(parser.GetWarnings().empty());
+
+    const TypeTable& types = parser.GetTypes();
+    auto typeOf = [&types](const std::string& name) {
+        const TypeInfo* info = types.Find(name);
+        return info ? FormatType(*info) : std::string("missing");
+    };
+    EXPECT_EQ(typeOf("target"), "vec3");
+    EXPECT_EQ(typeOf("heading"), "vec3");   // Declared `V`, width from the copy of target
+    EXPECT_EQ(typeOf("armed"), "bool");
+    EXPECT_EQ(typeOf("landing"), "bool");   // Only tested, never assigned
+    EXPECT_EQ(typeOf("speed"), "number");
+    EXPECT_EQ(typeOf("Drone"), "entity");
+    EXPECT_EQ(typeOf("T.P.z"), "number");
+
+    // Vector variables occupy contiguous slots and are moved with one instruction
+    auto module = parser.GetModule();
+    const auto* target = module->FindSlot("target");
+    ASSERT_NE(target, nullptr);
+    EXPECT_EQ(target->width, 3);
+    ASSERT_NE(module->FindSlot("target.y"), nullptr);
+    EXPECT_EQ(module->FindSlot("target.y")->index, target->index + 1);
+
+    Runtime runtime(module);
+    EntityId drone = runtime.Spawn("Drone");
+    runtime.Tick(1.0f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(drone, "heading.z"), 3.0f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(drone, "V.y"), 2.0f);
+    EXPECT_FLOAT_EQ(runtime.GetValue(drone, "T.P.x"), 1.0f);
+}
+
+TEST(AOPLTypeTest, RejectsConflictingUses) {
+    Parser parser;
+    ASSERT_TRUE(parser.Parse(R"(
+        N〈Broken〉: V
+        Set: ⊸ offset 1 2 → ⊸ label "drone"
+        Use: T.P offset → label x+ 1
+    )"));
+    EXPECT_FALSE(parser.Compile());
+
+    const auto& errors = parser.GetErrors();
+    ASSERT_EQ(errors.size(), 2);
+    EXPECT_EQ(errors[0], "line 4: 'T.P' is vec3 but 'offset' is vec2");
+    EXPECT_EQ(errors[1], "line 4: 'label' is string and has no axis 'x'");
+}
+
+TEST(AOPLTypeTest, ReportsAmbiguousSites) {
+    Parser parser;
+    ASSERT_TRUE(parser.Parse(R"(
+        N〈Mixer〉: V
+        On: ⊸ blend true
+        Fade: ⊸ blend 0.5 → V.x blend
+    )"));
+    ASSERT_TRUE(parser.Compile());
+
+    const auto& warnings = parser.GetWarnings();
+    ASSERT_EQ(warnings.size(), 1);
+    EXPECT_EQ(warnings[0], "line 4: 'blend' mixes boolean and numeric values");
+    EXPECT_EQ(FormatType(*parser.GetTypes().Find("blend")), "number");
+
+    // A declared vector whose width nothing determines
+    ASSERT_TRUE(parser.Parse(R"(
+        N〈Steer〉: V ⊢ heading
+        Turn: ⊸ turning true
+    )"));
+    ASSERT_TRUE(parser.Compile());
+    ASSERT_EQ(parser.GetWarnings().size(), 1);
+    EXPECT_EQ(parser.GetWarnings()[0], "line 2: vector width of 'heading' cannot be inferred");
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,206 @@
+#include <gtest/gtest.h>
+#include "gaia_matrix.h"
+#include "../test_utils/onnx_builder.h"
+#include "../test_utils/test_helpers.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+using namespace gaia_matrix;
+using namespace gaia_matrix::neural;
+using gaia_matrix::test::OnnxBuilder;
+using gaia_matrix::test::TestHelpers;
+
+class BatchingTest : public ::testing::Test {
+protected:
+    static void SetUpTestSuite() {
+        NeuralEngine::Initialize();
+    }
+
+    // Doubles every value and counts the runs
+    static InferenceBatcher::RunFunction Doubler(std::atomic<int>& runs) {
+        return [&runs](const float* input, const Shape& shape, std::vector<float>& output, Shape& outputShape) {
+            ++runs;
+            output.assign(input, input + ElementCount(shape));
+            for (float& value : output) {
+                value *= 2.0f;
+            }
+            outputShape = shape;
+            return true;
+        };
+    }
+};
+
+TEST_F(BatchingTest, CoalescesConcurrentRequests) {
+    std::atomic<int> runs{0};
+    const int requests = 64;
+    std::vector<std::future<std::vector<float>>> results(requests);
+    {
+        InferenceBatcher batcher(Doubler(runs), requests, std::chrono::seconds(5));
+        std::vector<std::thread> threads;
+        for (int thread = 0; thread < 8; ++thread) {
+            threads.emplace_back([&, thread]() {
+                for (int i = thread; i < requests; i += 8) {
+                    float value = static_cast<float>(i);
+                    results[i] = batcher.Submit({value, -value}, {1, 2});
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        // The batch fills long before the deadline, so every request runs at once
+        for (int i = 0; i < requests; ++i) {
+            EXPECT_EQ(results[i].get(), std::vector<float>({2.0f * i, -2.0f * i}));
+        }
+        BatchingStats stats = batcher.GetStats();
+        EXPECT_EQ(stats.requests, static_cast<uint64_t>(requests));
+        EXPECT_EQ(stats.batches, 1u);
+        EXPECT_EQ(stats.largestBatch, static_cast<uint32_t>(requests));
+    }
+    EXPECT_EQ(runs, 1);
+}
+
+TEST_F(BatchingTest, FlushesAtDeadlineAndSplitsByShape) {
+    std::atomic<int> runs{0};
+    InferenceBatcher batcher(Doubler(runs), 16, std::chrono::milliseconds(5));
+
+    // A lone request runs once it has waited the maximum wait
+    auto single = batcher.Submit({1.0f, 2.0f, 3.0f, 4.0f}, {2, 2});
+    ASSERT_EQ(single.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_EQ(single.get(), std::vector<float>({2.0f, 4.0f, 6.0f, 8.0f}));
+
+    // Requests with other row shapes are not concatenated
+    auto pair = batcher.Submit({1.0f, 2.0f}, {1, 2});
+    auto triple = batcher.Submit({1.0f, 2.0f, 3.0f}, {1, 3});
+    auto other = batcher.Submit({5.0f, 6.0f}, {1, 2});
+    EXPECT_EQ(pair.get(), std::vector<float>({2.0f, 4.0f}));
+    EXPECT_EQ(triple.get(), std::vector<float>({2.0f, 4.0f, 6.0f}));
+    EXPECT_EQ(other.get(), std::vector<float>({10.0f, 12.0f}));
+    EXPECT_EQ(batcher.GetStats().batches, 3u);
+
+    // Inputs that do not match their shape fail without running
+    EXPECT_TRUE(batcher.Submit({1.0f}, {1, 2}).get().empty());
+    EXPECT_EQ(runs, 3);
+}
+
+TEST_F(BatchingTest, FailedRunsFailEveryRequest) {
+    auto fail = [](const float*, const Shape&, std::vector<float>&, Shape&) { return false; };
+    auto dropRow = [](const float* input, const Shape& shape, std::vector<float>& output, Shape& outputShape) {
+        output.assign(input, input + ElementCount(shape) - shape[1]);
+        outputShape = {shape[0] - 1, shape[1]};
+        return true;
+    };
+    for (const InferenceBatcher::RunFunction& run : {InferenceBatcher::RunFunction(fail),
+                                                     InferenceBatcher::RunFunction(dropRow)}) {
+        InferenceBatcher batcher(run, 2, std::chrono::seconds(5));
+        auto first = batcher.Submit({1.0f}, {1, 1});
+        auto second = batcher.Submit({2.0f}, {1, 1});
+        EXPECT_TRUE(first.get().empty());
+        EXPECT_TRUE(second.get().empty());
+    }
+}
+
+TEST_F(BatchingTest, EngineBatchesSubmittedInference) {
+    NeuralEngine& engine = NeuralEngine::Get();
+    int modelId = engine.LoadModel(TestHelpers::GetTestResourcesPath() + "/test_model.onnx");
+    ASSERT_GE(modelId, 0);
+
+    // Without batching the request runs on the calling thread
+    std::vector<float> input = {1.0f, 2.0f, 3.0f, 4.0f};
+    std::vector<float> expected = engine.RunInference(modelId, input, {1, 4, 1, 1});
+    auto immediate = engine.SubmitInference(modelId, input, {1, 4, 1, 1});
+    ASSERT_EQ(immediate.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+    EXPECT_EQ(immediate.get(), expected);
+
+    const int entities = 32;
+    ASSERT_TRUE(engine.EnableBatching(modelId, entities, std::chrono::seconds(5)));
+    std::vector<std::vector<float>> inputs(entities);
+    std::vector<std::vector<float>> references(entities);
+    std::vector<std::future<std::vector<float>>> results(entities);
+    for (int i = 0; i < entities; ++i) {
+        inputs[i] = {0.1f * i, 1.0f - 0.2f * i, 0.5f, -0.05f * i};
+        references[i] = engine.RunInference(modelId, inputs[i], {1, 4, 1, 1});
+    }
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < 4; ++thread) {
+        threads.emplace_back([&, thread]() {
+            for (int i = thread; i < entities; i += 4) {
+                results[i] = engine.SubmitInference(modelId, inputs[i], {1, 4, 1, 1});
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int i = 0; i < entities; ++i) {
+        std::vector<float> output = results[i].get();
+        ASSERT_EQ(output.size(), 3u);
+        for (size_t j = 0; j < output.size(); ++j) {
+            EXPECT_NEAR(output[j], references[i][j], 1e-5f);
+        }
+    }
+    BatchingStats stats = engine.GetBatchingStats(modelId);
+    EXPECT_EQ(stats.requests, static_cast<uint64_t>(entities));
+    EXPECT_EQ(stats.batches, 1u);
+
+    // Bad inputs fail their own future only
+    EXPECT_TRUE(engine.SubmitInference(modelId, {1.0f, 2.0f, 3.0f}, {1, 3, 1, 1}).get().empty());
+
+    // Disabling runs what is queued before returning
+    auto pending = engine.SubmitInference(modelId, input, {1, 4, 1, 1});
+    engine.DisableBatching(modelId);
+    ASSERT_EQ(pending.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+    EXPECT_EQ(pending.get().size(), 3u);
+    EXPECT_EQ(engine.GetBatchingStats(modelId).requests, 0u);
+    engine.UnloadModel(modelId);
+}
+
+TEST_F(BatchingTest, EnginePlansForFullBatches) {
+    NeuralEngine& engine = NeuralEngine::Get();
+    int modelId = engine.LoadModel(TestHelpers::GetTestResourcesPath() + "/test_model.onnx");
+    ASSERT_GE(modelId, 0);
+    std::vector<float> full(16 * 4, 0.5f);
+    ASSERT_FALSE(engine.RunInference(modelId, full, {16, 4, 1, 1}).empty());
+    size_t fullBytes = engine.GetActivationBytes(modelId);
+    ASSERT_FALSE(engine.RunInference(modelId, {1.0f, 2.0f, 3.0f, 4.0f}, {1, 4, 1, 1}).empty());
+    EXPECT_LT(engine.GetActivationBytes(modelId), fullBytes);
+
+    // Batches of every size up to the maximum run in the plan made when batching starts
+    ASSERT_TRUE(engine.EnableBatching(modelId, 16, std::chrono::microseconds(100)));
+    EXPECT_EQ(engine.GetActivationBytes(modelId), fullBytes);
+    for (int rows : {3, 1, 7}) {
+        std::vector<float> input(static_cast<size_t>(rows) * 4, 0.25f);
+        EXPECT_EQ(engine.SubmitInference(modelId, input, {rows, 4, 1, 1}).get().size(), static_cast<size_t>(rows) * 3);
+        EXPECT_EQ(engine.GetActivationBytes(modelId), fullBytes);
+    }
+    engine.DisableBatching(modelId);
+    engine.UnloadModel(modelId);
+}
+
+TEST_F(BatchingTest, RequiresDynamicBatchDimension) {
+    NeuralEngine& engine = NeuralEngine::Get();
+    EXPECT_FALSE(engine.EnableBatching(-1, 8, std::chrono::milliseconds(1)));
+
+    int modelId = engine.LoadModel(TestHelpers::GetTestResourcesPath() + "/test_model.onnx");
+    ASSERT_GE(modelId, 0);
+    EXPECT_FALSE(engine.EnableBatching(modelId, 0, std::chrono::milliseconds(1)));
+    engine.UnloadModel(modelId);
+
+    // A fixed first dimension cannot be split into requests
+    std::string directory = TestHelpers::CreateTempDirectory();
+    std::string path = OnnxBuilder().Input("x", {2, 4}).Output("y", {2, 4})
+                           .Node("Relu", {"x"}, {"y"}).Save(directory, "fixed.onnx");
+    modelId = engine.LoadModel(path);
+    ASSERT_GE(modelId, 0);
+    EXPECT_FALSE(engine.EnableBatching(modelId, 8, std::chrono::milliseconds(1)));
+    engine.UnloadModel(modelId);
+    TestHelpers::DeleteTempDirectory(directory);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,266 @@
+#include <gtest/gtest.h>
+#include "gaia_matrix.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace gaia_matrix::neural;
+
+class GemmTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        m_DefaultIsa = GetKernelIsa();
+        for (KernelIsa isa : {KernelIsa::Scalar, KernelIsa::Neon, KernelIsa::Avx2, KernelIsa::Avx512}) {
+            if (IsKernelIsaSupported(isa)) {
+                m_Isas.push_back(isa);
+            }
+        }
+    }
+
+    void TearDown() override {
+        SetKernelIsa(m_DefaultIsa);
+    }
+
+    static std::vector<float> Fill(size_t count, int seed) {
+        std::vector<float> values(count);
+        for (size_t i = 0; i < count; ++i) {
+            values[i] = static_cast<float>(static_cast<int>((i * 37 + seed * 11) % 23) - 11) / 8.0f;
+        }
+        return values;
+    }
+
+    // Plain triple loop in double precision
+    static void Reference(bool transA, bool transB, int64_t M, int64_t N, int64_t K, float alpha,
+                          const std::vector<float>& A, int64_t lda, const std::vector<float>& B, int64_t ldb,
+                          float beta, std::vector<float>& C, int64_t ldc) {
+        for (int64_t m = 0; m < M; ++m) {
+            for (int64_t n = 0; n < N; ++n) {
+                double sum = 0.0;
+                for (int64_t k = 0; k < K; ++k) {
+                    sum += static_cast<double>(transA ? A[k * lda + m] : A[m * lda + k]) *
+                           (transB ? B[n * ldb + k] : B[k * ldb + n]);
+                }
+                float& out = C[m * ldc + n];
+                out = static_cast<float>(alpha * sum + (beta == 0.0f ? 0.0 : beta * out));
+            }
+        }
+    }
+
+    KernelIsa m_DefaultIsa = KernelIsa::Scalar;
+    std::vector<KernelIsa> m_Isas;
+};
+
+TEST_F(GemmTest, DetectsInstructionSet) {
+    EXPECT_TRUE(IsKernelIsaSupported(KernelIsa::Scalar));
+    EXPECT_TRUE(IsKernelIsaSupported(GetKernelIsa()));
+    EXPECT_STREQ(GetKernelIsaName(KernelIsa::Avx2), "avx2");
+
+    // The default is the widest supported instruction set
+    EXPECT_EQ(m_DefaultIsa, m_Isas.back());
+    for (KernelIsa isa : {KernelIsa::Neon, KernelIsa::Avx2, KernelIsa::Avx512}) {
+        EXPECT_EQ(SetKernelIsa(isa), IsKernelIsaSupported(isa));
+    }
+}
+
+TEST_F(GemmTest, MatchesReferenceOnEveryInstructionSet) {
+    // Edge sizes around every tile shape, and K past one cache block
+    const int64_t sizes[][3] = {{1, 1, 1}, {5, 7, 3}, {6, 16, 8}, {13, 33, 17}, {8, 32, 300}, {121, 45, 260},
+                                {37, 70, 1}};
+    for (KernelIsa isa : m_Isas) {
+        ASSERT_TRUE(SetKernelIsa(isa));
+        for (const auto& size : sizes) {
+            int64_t M = size[0], N = size[1], K = size[2];
+            for (int trans = 0; trans < 4; ++trans) {
+                bool transA = trans & 1;
+                bool transB = trans & 2;
+                // Padded leading dimensions check that strides are honoured
+                int64_t lda = (transA ? M : K) + 3;
+                int64_t ldb = (transB ? K : N) + 1;
+                int64_t ldc = N + 2;
+                auto A = Fill((transA ? K : M) * lda, 1);
+                auto B = Fill((transB ? N : K) * ldb, 2);
+                auto C = Fill(M * ldc, 3);
+                auto expected = C;
+                Sgemm(transA, transB, M, N, K, 0.5f, A.data(), lda, B.data(), ldb, 2.0f, C.data(), ldc);
+                Reference(transA, transB, M, N, K, 0.5f, A, lda, B, ldb, 2.0f, expected, ldc);
+                for (size_t i = 0; i < C.size(); ++i) {
+                    ASSERT_NEAR(C[i], expected[i], 1e-3f * (1.0f + std::fabs(expected[i])))
+                        << GetKernelIsaName(isa) << " M=" << M << " N=" << N << " K=" << K << " trans=" << trans
+                        << " index " << i;
+                }
+            }
+        }
+    }
+}
+
+TEST_F(GemmTest, ZeroBetaIgnoresOutputContents) {
+    const int64_t M = 9, N = 19, K = 4;
+    auto A = Fill(M * K, 4);
+    auto B = Fill(K * N, 5);
+    for (KernelIsa isa : m_Isas) {
+        ASSERT_TRUE(SetKernelIsa(isa));
+        std::vector<float> C(M * N, std::numeric_limits<float>::quiet_NaN());
+        std::vector<float> expected(M * N, 0.0f);
+        Sgemm(false, false, M, N, K, 1.0f, A.data(), K, B.data(), N, 0.0f, C.data(), N);
+        Reference(false, false, M, N, K, 1.0f, A, K, B, N, 0.0f, expected, N);
+        for (size_t i = 0; i < C.size(); ++i) {
+            ASSERT_NEAR(C[i], expected[i], 1e-4f) << GetKernelIsaName(isa);
+        }
+
+        // K = 0 only scales C
+        Sgemm(false, false, M, N, 0, 1.0f, A.data(), K, B.data(), N, 0.0f, C.data(), N);
+        EXPECT_EQ(C, std::vector<float>(M * N, 0.0f));
+    }
+}
+
+TEST_F(GemmTest, PackedOperandMatchesUnpacked) {
+    const int64_t M = 14, N = 37, K = 290;
+    auto A = Fill(M * K, 6);
+    auto B = Fill(N * K, 7);
+    for (KernelIsa isa : m_Isas) {
+        ASSERT_TRUE(SetKernelIsa(isa));
+        PackedMatrix packed;
+        packed.Pack(true, K, N, B.data(), K);
+        EXPECT_EQ(packed.GetIsa(), isa);
+        EXPECT_EQ(packed.GetRows(), K);
+        EXPECT_EQ(packed.GetColumns(), N);
+
+        // Panels keep the kernel they were packed for, even after a switch
+        SetKernelIsa(KernelIsa::Scalar);
+        std::vector<float> C(M * N, 1.0f);
+        std::vector<float> expected = C;
+        SgemmPacked(false, M, 1.0f, A.data(), K, packed, 1.0f, C.data(), N);
+        Reference(false, true, M, N, K, 1.0f, A, K, B, K, 1.0f, expected, N);
+        for (size_t i = 0; i < C.size(); ++i) {
+            ASSERT_NEAR(C[i], expected[i], 1e-3f * (1.0f + std::fabs(expected[i]))) << GetKernelIsaName(isa);
+        }
+    }
+}
+
+TEST_F(GemmTest, EpilogueAddsBiasAndActivation) {
+    // K spans two blocks, so the epilogue must wait for the last one
+    const int64_t M = 13, N = 21, K = 300;
+    auto A = Fill(M * K, 8);
+    auto B = Fill(K * N, 9);
+    auto rowBias = Fill(M, 10);
+    auto columnBias = Fill(N, 11);
+    for (KernelIsa isa : m_Isas) {
+        ASSERT_TRUE(SetKernelIsa(isa));
+        std::vector<float> product(M * N, 0.0f);
+        Reference(false, false, M, N, K, 1.0f, A, K, B, N, 0.0f, product, N);
+
+        GemmEpilogue epilogue;
+        epilogue.bias = columnBias.data();
+        epilogue.activation = Activation::Relu;
+        std::vector<float> C(M * N);
+        Sgemm(false, false, M, N, K, 1.0f, A.data(), K, B.data(), N, 0.0f, C.data(), N, &epilogue);
+        for (int64_t m = 0; m < M; ++m) {
+            for (int64_t n = 0; n < N; ++n) {
+                float expected = std::max(product[m * N + n] + columnBias[n], 0.0f);
+                ASSERT_NEAR(C[m * N + n], expected, 1e-3f * (1.0f + std::fabs(expected))) << GetKernelIsaName(isa);
+            }
+        }
+
+        PackedMatrix packed;
+        packed.Pack(false, K, N, B.data(), N);
+        epilogue.bias = rowBias.data();
+        epilogue.biasPerRow = true;
+        epilogue.activation = Activation::Tanh;
+        SgemmPacked(false, M, 1.0f, A.data(), K, packed, 0.0f, C.data(), N, &epilogue);
+        for (int64_t m = 0; m < M; ++m) {
+            for (int64_t n = 0; n < N; ++n) {
+                float expected = std::tanh(product[m * N + n] + rowBias[m]);
+                ASSERT_NEAR(C[m * N + n], expected, 1e-4f) << GetKernelIsaName(isa);
+            }
+        }
+    }
+}
+
+TEST_F(GemmTest, HalfConversionsRoundToNearestEven) {
+    struct Case {
+        float value;
+        uint16_t half;
+        uint16_t bfloat;
+    };
+    const Case cases[] = {
+        {1.0f, 0x3C00, 0x3F80},
+        {-2.5f, 0xC100, 0xC020},
+        {0.1f, 0x2E66, 0x3DCD},
+        {65504.0f, 0x7BFF, 0x4780},
+        {65520.0f, 0x7C00, 0x4780},         // Ties past the largest half go to infinity
+        {1.0f + 1.0f / 2048, 0x3C00, 0x3F80},   // Half tie rounds to the even mantissa
+        {1.0f + 3.0f / 2048, 0x3C02, 0x3F80},
+        {1.00390625f, 0x3C04, 0x3F80},      // bf16 tie, even stays
+        {1.01171875f, 0x3C0C, 0x3F82},      // bf16 tie, odd rounds up
+        {5.9604645e-8f, 0x0001, 0x3380},    // Smallest half subnormal
+        {1e-9f, 0x0000, 0x3089},
+        {std::numeric_limits<float>::infinity(), 0x7C00, 0x7F80},
+    };
+    for (KernelIsa isa : m_Isas) {
+        ASSERT_TRUE(SetKernelIsa(isa));
+        // Long enough for the vector paths, with a scalar tail
+        std::vector<float> values;
+        for (int repeat = 0; repeat < 3; ++repeat) {
+            for (const Case& c : cases) {
+                values.push_back(c.value);
+            }
+        }
+        std::vector<uint16_t> half(values.size()), bfloat(values.size());
+        ConvertToHalf(WeightPrecision::Float16, values.data(), half.data(), values.size());
+        ConvertToHalf(WeightPrecision::BFloat16, values.data(), bfloat.data(), values.size());
+        std::vector<float> halfBack(values.size()), bfloatBack(values.size());
+        ConvertFromHalf(WeightPrecision::Float16, half.data(), halfBack.data(), half.size());
+        ConvertFromHalf(WeightPrecision::BFloat16, bfloat.data(), bfloatBack.data(), bfloat.size());
+
+        for (size_t i = 0; i < values.size(); ++i) {
+            const Case& c = cases[i % (sizeof(cases) / sizeof(cases[0]))];
+            EXPECT_EQ(half[i], c.half) << GetKernelIsaName(isa) << " fp16 of " << c.value;
+            // AVX-512 BF16 flushes subnormal inputs, which 1e-9 is not
+            EXPECT_EQ(bfloat[i], c.bfloat) << GetKernelIsaName(isa) << " bf16 of " << c.value;
+        }
+        EXPECT_FLOAT_EQ(halfBack[0], 1.0f);
+        EXPECT_FLOAT_EQ(halfBack[2], 0.0999755859375f);
+        EXPECT_FLOAT_EQ(halfBack[9], 5.9604645e-8f);
+        EXPECT_FLOAT_EQ(bfloatBack[2], 0.10009765625f);
+        EXPECT_FLOAT_EQ(bfloatBack[3], 65536.0f);
+    }
+}
+
+TEST_F(GemmTest, HalfPrecisionPanelsMatchRoundedWeights) {
+    // Two K blocks and edge tiles, with weights rounded the way they are stored
+    const int64_t M = 11, N = 45, K = 300;
+    auto A = Fill(M * K, 8);
+    auto B = Fill(K * N, 9);
+    for (auto& value : B) {
+        value *= 0.3f;
+    }
+    for (WeightPrecision precision : {WeightPrecision::Float16, WeightPrecision::BFloat16}) {
+        std::vector<uint16_t> narrow(B.size());
+        std::vector<float> rounded(B.size());
+        ConvertToHalf(precision, B.data(), narrow.data(), B.size());
+        ConvertFromHalf(precision, narrow.data(), rounded.data(), narrow.size());
+
+        for (KernelIsa isa : m_Isas) {
+            ASSERT_TRUE(SetKernelIsa(isa));
+            PackedMatrix full, packed;
+            full.Pack(false, K, N, B.data(), N);
+            packed.Pack(false, K, N, B.data(), N, precision);
+            EXPECT_EQ(packed.GetPrecision(), precision);
+            EXPECT_EQ(packed.GetByteSize() * 2, full.GetByteSize());
+
+            std::vector<float> C(M * N, 0.5f);
+            std::vector<float> expected = C;
+            SgemmPacked(false, M, 1.0f, A.data(), K, packed, 1.0f, C.data(), N);
+            Reference(false, false, M, N, K, 1.0f, A, K, rounded, N, 1.0f, expected, N);
+            for (size_t i = 0; i < C.size(); ++i) {
+                ASSERT_NEAR(C[i], expected[i], 1e-3f * (1.0f + std::fabs(expected[i])))
+                    << GetWeightPrecisionName(precision) << " " << GetKernelIsaName(isa);
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
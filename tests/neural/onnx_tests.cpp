@@ -0,0 +1,781 @@
+#include <gtest/gtest.h>
+#include "gaia_matrix.h"
+#include "../test_utils/onnx_builder.h"
+#include "../test_utils/test_helpers.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <thread>
+
+using namespace gaia_matrix;
+using namespace gaia_matrix::neural;
+using gaia_matrix::test::OnnxAttribute;
+using gaia_matrix::test::OnnxBuilder;
+using gaia_matrix::test::TestHelpers;
+
+class OnnxTest : public ::testing::Test {
+protected:
+    static void SetUpTestSuite() {
+        NeuralEngine::Initialize();
+    }
+
+    // Parse and prepare a builder model, then run it on one input
+    static bool Run(const OnnxBuilder& builder, const std::vector<float>& input, const Shape& shape,
+                    std::vector<float>& output, Shape& outputShape) {
+        std::string bytes = builder.Build();
+        auto graph = std::make_shared<Graph>();
+        std::string error;
+        if (!ParseOnnxModel(bytes.data(), bytes.size(), *graph, error)) {
+            ADD_FAILURE() << error;
+            return false;
+        }
+        GraphExecutor executor;
+        std::vector<std::string> errors;
+        if (!executor.Prepare(graph, errors)) {
+            ADD_FAILURE() << errors.front();
+            return false;
+        }
+        std::vector<std::vector<float>> outputs;
+        std::vector<Shape> outputShapes;
+        if (!executor.Run({input.data()}, {shape}, outputs, outputShapes, error)) {
+            ADD_FAILURE() << error;
+            return false;
+        }
+        output = outputs[0];
+        outputShape = outputShapes[0];
+        return true;
+    }
+
+    // Forward pass of tests/resources/test_model.onnx, computed directly
+    static std::vector<float> ReferenceModel(const std::vector<float>& input) {
+        std::vector<float> output;
+        for (size_t row = 0; row < input.size() / 4; ++row) {
+            float hidden[8];
+            for (int i = 0; i < 8; ++i) {
+                hidden[i] = (i % 3 - 1) * 0.05f;
+                for (int j = 0; j < 4; ++j) {
+                    hidden[i] += ((i * 4 + j) % 7 - 3) * 0.1f * input[row * 4 + j];
+                }
+                hidden[i] = std::max(hidden[i], 0.0f);
+            }
+            float logits[3] = {0.1f, 0.0f, -0.1f};
+            float sum = 0.0f;
+            for (int i = 0; i < 3; ++i) {
+                for (int j = 0; j < 8; ++j) {
+                    logits[i] += ((i * 8 + j) % 5 - 2) * 0.1f * hidden[j];
+                }
+            }
+            float peak = *std::max_element(logits, logits + 3);
+            for (float& logit : logits) {
+                logit = std::exp(logit - peak);
+                sum += logit;
+            }
+            for (float logit : logits) {
+                output.push_back(logit / sum);
+            }
+        }
+        return output;
+    }
+};
+
+TEST_F(OnnxTest, LoadsTestModel) {
+    Graph graph;
+    std::string error;
+    ASSERT_TRUE(LoadOnnxModel(TestHelpers::GetTestResourcesPath() + "/test_model.onnx", graph, error)) << error;
+
+    EXPECT_EQ(graph.irVersion, 7);
+    EXPECT_EQ(graph.opsetVersion, 13);
+    EXPECT_EQ(graph.producerName, "GAIA_MATRIX_TEST");
+    EXPECT_EQ(graph.producerVersion, "1.0");
+    EXPECT_EQ(graph.domain, "ai.gaia-matrix.test");
+    EXPECT_EQ(graph.modelVersion, 1);
+    EXPECT_EQ(graph.docString, "Test ONNX model for GAIA MATRIX testing");
+
+    ASSERT_EQ(graph.inputs.size(), 1u);
+    EXPECT_EQ(graph.inputs[0].name, "input");
+    EXPECT_EQ(graph.inputs[0].shape, Shape({-1, 4}));
+    ASSERT_EQ(graph.outputs.size(), 1u);
+    EXPECT_EQ(graph.outputs[0].shape, Shape({-1, 3}));
+    EXPECT_EQ(graph.nodes.size(), 4u);
+    ASSERT_NE(graph.FindInitializer("W1"), nullptr);
+    EXPECT_EQ(graph.FindInitializer("W1")->dims, Shape({8, 4}));
+    EXPECT_FLOAT_EQ(graph.FindInitializer("W1")->data[1], -0.2f);
+}
+
+TEST_F(OnnxTest, EngineRunsTestModel) {
+    NeuralEngine& engine = NeuralEngine::Get();
+    int modelId = engine.LoadModel(TestHelpers::GetTestResourcesPath() + "/test_model.onnx");
+    ASSERT_GE(modelId, 0);
+    EXPECT_EQ(engine.GetInputShape(modelId), std::vector<int64_t>({-1, 4}));
+    EXPECT_EQ(engine.GetOutputShape(modelId), std::vector<int64_t>({-1, 3}));
+
+    std::vector<float> input = {1.0f, 2.0f, 3.0f, 4.0f};
+    std::vector<float> output = engine.RunInference(modelId, input, {1, 4, 1, 1});
+    std::vector<float> expected = ReferenceModel(input);
+    ASSERT_EQ(output.size(), 3u);
+    for (size_t i = 0; i < output.size(); ++i) {
+        EXPECT_NEAR(output[i], expected[i], 1e-5f);
+    }
+
+    // The batch dimension is symbolic, so any batch size runs
+    std::vector<float> batch = {1.0f, 2.0f, 3.0f, 4.0f, -1.0f, 0.5f, 2.0f, -3.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    output = engine.RunInference(modelId, batch, {3, 4, 1, 1});
+    expected = ReferenceModel(batch);
+    ASSERT_EQ(output.size(), 9u);
+    for (size_t i = 0; i < output.size(); ++i) {
+        EXPECT_NEAR(output[i], expected[i], 1e-5f);
+    }
+
+    EXPECT_TRUE(engine.RunInference(modelId, {1.0f, 2.0f, 3.0f}, {1, 3, 1, 1}).empty());
+    engine.UnloadModel(modelId);
+}
+
+TEST_F(OnnxTest, RejectsInvalidModels) {
+    std::string directory = TestHelpers::CreateTempDirectory();
+    std::string placeholder = TestHelpers::CreateDummyONNXModel(directory);
+
+    Graph graph;
+    std::string error;
+    EXPECT_FALSE(LoadOnnxModel(placeholder, graph, error));
+    EXPECT_FALSE(error.empty());
+    EXPECT_LT(NeuralEngine::Get().LoadModel(placeholder), 0);
+
+    // Truncated in the middle of the graph
+    std::string bytes = OnnxBuilder().Input("x", {1}).Output("y", {1}).Node("Relu", {"x"}, {"y"}).Build();
+    EXPECT_FALSE(ParseOnnxModel(bytes.data(), bytes.size() - 3, graph, error));
+
+    // Parses, but the executor cannot run it
+    std::string path = OnnxBuilder().Input("x", {1, 4}).Output("y", {1, 4})
+                           .Node("LSTM", {"x"}, {"y"}).Save(directory, "lstm.onnx");
+    ASSERT_TRUE(LoadOnnxModel(path, graph, error)) << error;
+    GraphExecutor executor;
+    std::vector<std::string> errors;
+    EXPECT_FALSE(executor.Prepare(std::make_shared<Graph>(graph), errors));
+    ASSERT_EQ(errors.size(), 1u);
+    EXPECT_NE(errors[0].find("LSTM"), std::string::npos);
+    EXPECT_LT(NeuralEngine::Get().LoadModel(path), 0);
+
+    TestHelpers::DeleteTempDirectory(directory);
+}
+
+TEST_F(OnnxTest, MapsWeightsInPlace) {
+    // weights.bin: W (4 x 3) at an aligned offset, then the bias one byte past alignment
+    std::vector<float> weights(12), bias = {0.5f, -1.0f, 2.0f};
+    for (size_t i = 0; i < weights.size(); ++i) {
+        weights[i] = static_cast<float>(i % 5) * 0.25f - 0.5f;
+    }
+    std::string blob(64, '\0');
+    blob.append(reinterpret_cast<const char*>(weights.data()), weights.size() * sizeof(float));
+    blob.push_back('\0');
+    blob.append(reinterpret_cast<const char*>(bias.data()), bias.size() * sizeof(float));
+
+    std::string directory = TestHelpers::CreateTempDirectory();
+    TestHelpers::CreateTempFile(directory, "weights.bin", blob);
+    OnnxBuilder builder;
+    builder.Input("x", {-1, 4}).Output("y", {-1, 3})
+        .ExternalInitializer("W", {4, 3}, "weights.bin", 64, 48)
+        .ExternalInitializer("B", {3}, "weights.bin", 113)
+        .Node("Gemm", {"x", "W", "B"}, {"y"});
+    std::string path = builder.Save(directory, "external.onnx");
+
+    auto graph = std::make_shared<Graph>();
+    std::string error;
+    ASSERT_TRUE(MapOnnxModel(path, *graph, error)) << error;
+    const Initializer* w = graph->FindInitializer("W");
+    const Initializer* b = graph->FindInitializer("B");
+    ASSERT_NE(w, nullptr);
+    ASSERT_NE(b, nullptr);
+    EXPECT_NE(w->mapped, nullptr);
+    EXPECT_TRUE(w->data.empty());
+    EXPECT_EQ(b->mapped, nullptr);
+    ASSERT_EQ(w->Count(), weights.size());
+    ASSERT_EQ(b->Count(), bias.size());
+    EXPECT_TRUE(std::equal(weights.begin(), weights.end(), w->Values()));
+    EXPECT_TRUE(std::equal(bias.begin(), bias.end(), b->Values()));
+
+    // Copies of the graph share the mapping, which outlives the loader
+    auto copy = std::make_shared<Graph>(*graph);
+    graph.reset();
+    GraphExecutor executor;
+    std::vector<std::string> errors;
+    ASSERT_TRUE(executor.Prepare(copy, errors));
+    std::vector<float> input = {1.0f, -2.0f, 0.5f, 3.0f};
+    std::vector<std::vector<float>> outputs;
+    std::vector<Shape> shapes;
+    ASSERT_TRUE(executor.Run({input.data()}, {{1, 4}}, outputs, shapes, error)) << error;
+    ASSERT_EQ(outputs[0].size(), 3u);
+    for (size_t n = 0; n < 3; ++n) {
+        float expected = bias[n];
+        for (size_t k = 0; k < 4; ++k) {
+            expected += input[k] * weights[k * 3 + n];
+        }
+        EXPECT_NEAR(outputs[0][n], expected, 1e-5f);
+    }
+
+    // LoadOnnxModel resolves the same file but copies every tensor
+    Graph copied;
+    ASSERT_TRUE(LoadOnnxModel(path, copied, error)) << error;
+    EXPECT_EQ(copied.FindInitializer("W")->mapped, nullptr);
+    EXPECT_EQ(copied.FindInitializer("W")->data, weights);
+
+    NeuralEngine& engine = NeuralEngine::Get();
+    int modelId = engine.LoadModel(path);
+    ASSERT_GE(modelId, 0);
+    EXPECT_EQ(engine.RunInference(modelId, input, {1, 4, 1, 1}), outputs[0]);
+    engine.UnloadModel(modelId);
+
+    // Without a file there is nothing to resolve against; locations may not leave the directory
+    std::string bytes = builder.Build();
+    EXPECT_FALSE(ParseOnnxModel(bytes.data(), bytes.size(), copied, error));
+    EXPECT_NE(error.find("external data"), std::string::npos);
+    Graph rejected;
+    path = OnnxBuilder().Input("x", {1, 4}).Output("y", {1, 3})
+               .ExternalInitializer("W", {4, 3}, "../weights.bin", 64, 48)
+               .Node("MatMul", {"x", "W"}, {"y"}).Save(directory, "escapes.onnx");
+    EXPECT_FALSE(MapOnnxModel(path, rejected, error));
+    path = OnnxBuilder().Input("x", {1, 4}).Output("y", {1, 3})
+               .ExternalInitializer("W", {4, 3}, "weights.bin", 100, 48)
+               .Node("MatMul", {"x", "W"}, {"y"}).Save(directory, "truncated.onnx");
+    EXPECT_FALSE(MapOnnxModel(path, rejected, error));
+    EXPECT_NE(error.find("past the end"), std::string::npos);
+
+    TestHelpers::DeleteTempDirectory(directory);
+}
+
+TEST_F(OnnxTest, RefusesWeightsRewrittenInPlace) {
+    // y = x + C, with C read in place from the start of weights.bin
+    auto weights = [](const std::vector<float>& values) {
+        return std::string(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(float));
+    };
+    std::string directory = TestHelpers::CreateTempDirectory();
+    TestHelpers::CreateTempFile(directory, "weights.bin", weights({1.0f}));
+    std::string path = OnnxBuilder().Input("x", {1}).Output("y", {1})
+                           .ExternalInitializer("C", {1}, "weights.bin", 0, 4)
+                           .Node("Add", {"x", "C"}, {"y"}).Save(directory, "offset.onnx");
+
+    Graph graph;
+    std::string error;
+    ASSERT_TRUE(MapOnnxModel(path, graph, error)) << error;
+    ASSERT_NE(graph.FindInitializer("C")->mapped, nullptr);
+    ASSERT_EQ(graph.mappedFiles.size(), 1u);
+    EXPECT_TRUE(CheckMappedFiles(graph, error));
+
+    NeuralEngine& engine = NeuralEngine::Get();
+    int modelId = engine.LoadModel(path);
+    ASSERT_GE(modelId, 0);
+    std::vector<float> input = {0.0f};
+    EXPECT_EQ(engine.RunInference(modelId, input, {1, 1, 1, 1}), std::vector<float>({1.0f}));
+
+    // Rewritten at the same size: the mapping would now read 7, so the model refuses to run.
+    // File times can be as coarse as a scheduler tick, so let one pass first.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    TestHelpers::CreateTempFile(directory, "weights.bin", weights({7.0f}));
+    EXPECT_FALSE(CheckMappedFiles(graph, error));
+    EXPECT_NE(error.find("weights.bin"), std::string::npos);
+    EXPECT_TRUE(engine.RunInference(modelId, input, {1, 1, 1, 1}).empty());
+    int reloadedId = engine.LoadModel(path);
+    ASSERT_GE(reloadedId, 0);
+    EXPECT_NE(reloadedId, modelId);
+    EXPECT_EQ(engine.RunInference(reloadedId, input, {1, 1, 1, 1}), std::vector<float>({7.0f}));
+
+    // Truncated: touching the mapped page would raise SIGBUS
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    TestHelpers::CreateTempFile(directory, "weights.bin", "");
+    EXPECT_TRUE(engine.RunInference(reloadedId, input, {1, 1, 1, 1}).empty());
+    EXPECT_LT(engine.LoadModel(path), 0);
+
+    engine.UnloadModel(modelId);
+    engine.UnloadModel(reloadedId);
+    TestHelpers::DeleteTempDirectory(directory);
+}
+
+TEST_F(OnnxTest, SharesLoadedModels) {
+    auto dense = [](float scale) {
+        return OnnxBuilder().Input("x", {-1, 2}).Output("y", {-1, 2})
+            .Initializer("W", {2, 2}, {scale, 0.0f, 0.0f, scale}).Node("MatMul", {"x", "W"}, {"y"});
+    };
+    std::string directory = TestHelpers::CreateTempDirectory();
+    std::string path = dense(2.0f).Save(directory, "double.onnx");
+    std::string copy = dense(2.0f).Save(directory, "copy.onnx");
+    std::string other = dense(3.0f).Save(directory, "triple.onnx");
+
+    NeuralEngine& engine = NeuralEngine::Get();
+    ModelCacheStats before = engine.GetCacheStats();
+    int modelId = engine.LoadModel(path);
+    ASSERT_GE(modelId, 0);
+    EXPECT_EQ(engine.LoadModel(directory + "/./double.onnx"), modelId);
+    EXPECT_EQ(engine.LoadModel(copy), modelId);
+    int otherId = engine.LoadModel(other);
+    EXPECT_NE(otherId, modelId);
+    ModelCacheStats stats = engine.GetCacheStats();
+    EXPECT_EQ(stats.loads, before.loads + 2);
+    EXPECT_EQ(stats.pathHits, before.pathHits + 1);
+    EXPECT_EQ(stats.contentHits, before.contentHits + 1);
+
+    // Three references: the model runs until the last one is released, then stays cached
+    std::vector<float> input = {1.0f, -1.0f};
+    engine.UnloadModel(modelId);
+    engine.UnloadModel(modelId);
+    EXPECT_EQ(engine.RunInference(modelId, input, {1, 2, 1, 1}), std::vector<float>({2.0f, -2.0f}));
+    engine.UnloadModel(modelId);
+    EXPECT_TRUE(engine.RunInference(modelId, input, {1, 2, 1, 1}).empty());
+    EXPECT_EQ(engine.GetCacheStats().cachedModels, before.cachedModels + 1);
+    EXPECT_EQ(engine.LoadModel(copy), modelId);
+    EXPECT_EQ(engine.GetCacheStats().loads, before.loads + 2);
+
+    // Without a budget, released models go at once and their IDs are not handed out again
+    engine.UnloadModel(modelId);
+    engine.SetCacheBudget(0);
+    EXPECT_EQ(engine.GetCacheStats().cachedModels, 0u);
+    EXPECT_GT(engine.GetCacheStats().evictions, before.evictions);
+    int reloadedId = engine.LoadModel(path);
+    EXPECT_NE(reloadedId, modelId);
+    EXPECT_NE(reloadedId, otherId);
+
+    engine.UnloadModel(reloadedId);
+    engine.UnloadModel(otherId);
+
+    // y = x + C with C read in place from bias.bin, so the model depends on the file after loading
+    auto bias = [&directory](const std::string& filename, float value) {
+        TestHelpers::CreateTempFile(directory, filename, std::string(reinterpret_cast<const char*>(&value), 4));
+    };
+    bias("bias.bin", 1.0f);
+    path = OnnxBuilder().Input("x", {-1, 2}).Output("y", {-1, 2})
+               .ExternalInitializer("C", {1}, "bias.bin", 0, 4)
+               .Node("Add", {"x", "C"}, {"y"}).Save(directory, "offset.onnx");
+    int offsetId = engine.LoadModel(path);
+    ASSERT_GE(offsetId, 0);
+
+    // Replaced by rename: the holder keeps the old weights, and a new load gets the new file
+    bias("bias.tmp", 3.0f);
+    std::filesystem::rename(directory + "/bias.tmp", directory + "/bias.bin");
+    int replacedId = engine.LoadModel(path);
+    EXPECT_NE(replacedId, offsetId);
+    EXPECT_EQ(engine.RunInference(offsetId, input, {1, 2, 1, 1}), std::vector<float>({2.0f, 0.0f}));
+    EXPECT_EQ(engine.RunInference(replacedId, input, {1, 2, 1, 1}), std::vector<float>({4.0f, 2.0f}));
+
+    // Rewritten in place: the holder's weights changed under it, so it stops running.
+    // File times can be as coarse as a scheduler tick, so let one pass first.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    bias("bias.bin", 5.0f);
+    EXPECT_TRUE(engine.RunInference(replacedId, input, {1, 2, 1, 1}).empty());
+    EXPECT_EQ(engine.RunInference(offsetId, input, {1, 2, 1, 1}), std::vector<float>({2.0f, 0.0f}));
+    int rewrittenId = engine.LoadModel(path);
+    EXPECT_NE(rewrittenId, replacedId);
+    EXPECT_EQ(engine.RunInference(rewrittenId, input, {1, 2, 1, 1}), std::vector<float>({6.0f, 4.0f}));
+
+    engine.UnloadModel(offsetId);
+    engine.UnloadModel(replacedId);
+    engine.UnloadModel(rewrittenId);
+    engine.SetCacheBudget(64 * 1024 * 1024);
+    TestHelpers::DeleteTempDirectory(directory);
+}
+
+TEST_F(OnnxTest, ConvolutionMatchesDirectReference) {
+    // Grouped, strided, dilated and padded in one go
+    const int64_t N = 2, C = 4, H = 7, W = 6, M = 6, group = 2, kH = 3, kW = 2;
+    const int64_t stride = 2, dilation = 2, pad = 1;
+    std::vector<float> input(N * C * H * W), weights(M * (C / group) * kH * kW), bias(M);
+    for (size_t i = 0; i < input.size(); ++i) {
+        input[i] = static_cast<float>(static_cast<int>(i * 7 % 11) - 5) * 0.25f;
+    }
+    for (size_t i = 0; i < weights.size(); ++i) {
+        weights[i] = static_cast<float>(static_cast<int>(i * 5 % 9) - 4) * 0.125f;
+    }
+    for (size_t i = 0; i < bias.size(); ++i) {
+        bias[i] = static_cast<float>(i) * 0.5f;
+    }
+
+    OnnxBuilder builder;
+    builder.Input("x", {-1, C, H, W}).Output("y", {})
+        .Initializer("w", {M, C / group, kH, kW}, weights).Initializer("b", {M}, bias)
+        .Node("Conv", {"x", "w", "b"}, {"y"},
+              {OnnxAttribute::Int("group", group), OnnxAttribute::Ints("strides", {stride, stride}),
+               OnnxAttribute::Ints("dilations", {dilation, dilation}),
+               OnnxAttribute::Ints("pads", {pad, pad, pad, pad})});
+    std::vector<float> output;
+    Shape shape;
+    ASSERT_TRUE(Run(builder, input, {N, C, H, W}, output, shape));
+
+    const int64_t outH = (H + 2 * pad - dilation * (kH - 1) - 1) / stride + 1;
+    const int64_t outW = (W + 2 * pad - dilation * (kW - 1) - 1) / stride + 1;
+    ASSERT_EQ(shape, Shape({N, M, outH, outW}));
+    for (int64_t n = 0; n < N; ++n) {
+        for (int64_t m = 0; m < M; ++m) {
+            int64_t g = m / (M / group);
+            for (int64_t oh = 0; oh < outH; ++oh) {
+                for (int64_t ow = 0; ow < outW; ++ow) {
+                    float expected = bias[m];
+                    for (int64_t c = 0; c < C / group; ++c) {
+                        for (int64_t kh = 0; kh < kH; ++kh) {
+                            for (int64_t kw = 0; kw < kW; ++kw) {
+                                int64_t ih = oh * stride - pad + kh * dilation;
+                                int64_t iw = ow * stride - pad + kw * dilation;
+                                if (ih >= 0 && ih < H && iw >= 0 && iw < W) {
+                                    expected += input[((n * C + g * (C / group) + c) * H + ih) * W + iw] *
+                                                weights[((m * (C / group) + c) * kH + kh) * kW + kw];
+                                }
+                            }
+                        }
+                    }
+                    EXPECT_NEAR(output[((n * M + m) * outH + oh) * outW + ow], expected, 1e-4f);
+                }
+            }
+        }
+    }
+}
+
+TEST_F(OnnxTest, HalfPrecisionWeightsTrackFloat) {
+    // Conv filters are exact in 16 bits; the Gemm weights are not
+    const int64_t C = 3, H = 6, W = 6, M = 8, features = M * H * W, outputs = 10;
+    std::vector<float> filters(M * C * 9), dense(outputs * features), input(C * H * W);
+    for (size_t i = 0; i < filters.size(); ++i) {
+        filters[i] = static_cast<float>(static_cast<int>(i * 5 % 9) - 4) * 0.125f;
+    }
+    for (size_t i = 0; i < dense.size(); ++i) {
+        dense[i] = std::sin(static_cast<float>(i)) * 0.05f;
+    }
+    for (size_t i = 0; i < input.size(); ++i) {
+        input[i] = std::cos(static_cast<float>(i) * 0.3f);
+    }
+    OnnxBuilder builder;
+    builder.Input("x", {1, C, H, W}).Output("y", {1, outputs})
+        .Initializer("w", {M, C, 3, 3}, filters).Initializer("d", {outputs, features}, dense)
+        .Node("Conv", {"x", "w"}, {"c"}, {OnnxAttribute::Ints("pads", {1, 1, 1, 1})})
+        .Node("Flatten", {"c"}, {"f"})
+        .Node("Gemm", {"f", "d"}, {"y"}, {OnnxAttribute::Int("transB", 1)});
+    std::string bytes = builder.Build();
+    auto graph = std::make_shared<Graph>();
+    std::string error;
+    ASSERT_TRUE(ParseOnnxModel(bytes.data(), bytes.size(), *graph, error)) << error;
+
+    auto run = [&](WeightPrecision precision, size_t& weightBytes) {
+        GraphExecutor executor;
+        executor.SetWeightPrecision(precision);
+        std::vector<std::string> errors;
+        EXPECT_TRUE(executor.Prepare(graph, errors));
+        std::vector<std::vector<float>> results;
+        std::vector<Shape> shapes;
+        EXPECT_TRUE(executor.Run({input.data()}, {{1, C, H, W}}, results, shapes, error)) << error;
+        weightBytes = executor.GetWeightBytes();
+        return results.empty() ? std::vector<float>() : results[0];
+    };
+    size_t floatBytes = 0, halfBytes = 0, bfloatBytes = 0;
+    auto expected = run(WeightPrecision::Float32, floatBytes);
+    auto half = run(WeightPrecision::Float16, halfBytes);
+    auto bfloat = run(WeightPrecision::BFloat16, bfloatBytes);
+    ASSERT_EQ(half.size(), expected.size());
+    ASSERT_EQ(bfloat.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_NEAR(half[i], expected[i], 2e-3f);
+        EXPECT_NEAR(bfloat[i], expected[i], 2e-2f);
+    }
+    EXPECT_EQ(halfBytes * 2, floatBytes);
+    EXPECT_EQ(bfloatBytes, halfBytes);
+
+    // The engine converts a loaded model in place
+    NeuralEngine& engine = NeuralEngine::Get();
+    int modelId = engine.LoadModel(TestHelpers::GetTestResourcesPath() + "/test_model.onnx");
+    ASSERT_GE(modelId, 0);
+    size_t loadedBytes = engine.GetWeightBytes(modelId);
+    ASSERT_TRUE(engine.SetWeightPrecision(modelId, WeightPrecision::Float16));
+    EXPECT_LT(engine.GetWeightBytes(modelId), loadedBytes);
+    std::vector<float> sample = {1.0f, -2.0f, 0.5f, 3.0f};
+    auto output = engine.RunInference(modelId, sample, {1, 4, 1, 1});
+    auto reference = ReferenceModel(sample);
+    ASSERT_EQ(output.size(), reference.size());
+    for (size_t i = 0; i < output.size(); ++i) {
+        EXPECT_NEAR(output[i], reference[i], 1e-3f);
+    }
+    engine.UnloadModel(modelId);
+}
+
+TEST_F(OnnxTest, PoolingOperators) {
+    std::vector<float> input(16);
+    for (size_t i = 0; i < input.size(); ++i) {
+        input[i] = static_cast<float>(i);
+    }
+    std::vector<float> output;
+    Shape shape;
+
+    OnnxBuilder maxPool;
+    maxPool.Input("x", {1, 1, 4, 4}).Output("y", {})
+        .Node("MaxPool", {"x"}, {"y"},
+              {OnnxAttribute::Ints("kernel_shape", {2, 2}), OnnxAttribute::Ints("strides", {2, 2})});
+    ASSERT_TRUE(Run(maxPool, input, {1, 1, 4, 4}, output, shape));
+    EXPECT_EQ(shape, Shape({1, 1, 2, 2}));
+    EXPECT_EQ(output, std::vector<float>({5.0f, 7.0f, 13.0f, 15.0f}));
+
+    // SAME_UPPER padding; the padded cells are excluded from the average
+    OnnxBuilder averagePool;
+    averagePool.Input("x", {1, 1, 4, 4}).Output("y", {})
+        .Node("AveragePool", {"x"}, {"y"},
+              {OnnxAttribute::Ints("kernel_shape", {3, 3}), OnnxAttribute::Ints("strides", {2, 2}),
+               OnnxAttribute::String("auto_pad", "SAME_UPPER")});
+    ASSERT_TRUE(Run(averagePool, input, {1, 1, 4, 4}, output, shape));
+    EXPECT_EQ(shape, Shape({1, 1, 2, 2}));
+    EXPECT_FLOAT_EQ(output[0], (0 + 1 + 2 + 4 + 5 + 6 + 8 + 9 + 10) / 9.0f);
+    EXPECT_FLOAT_EQ(output[3], (10 + 11 + 14 + 15) / 4.0f);
+
+    OnnxBuilder globalPools;
+    globalPools.Input("x", {1, 2, 2, 4}).Output("avg", {}).Output("max", {})
+        .Node("GlobalAveragePool", {"x"}, {"avg"}).Node("GlobalMaxPool", {"x"}, {"max"});
+    ASSERT_TRUE(Run(globalPools, input, {1, 2, 2, 4}, output, shape));
+    EXPECT_EQ(shape, Shape({1, 2, 1, 1}));
+    EXPECT_EQ(output, std::vector<float>({3.5f, 11.5f}));
+}
+
+TEST_F(OnnxTest, BroadcastingAndShapeOperators) {
+    // x[2,3] -> (x + bias) * 2 -> MatMul [3,2] -> Transpose -> Reshape [-1] -> Concat with itself
+    OnnxBuilder builder;
+    builder.Input("x", {2, 3}).Output("y", {})
+        .Initializer("bias", {3}, {1.0f, 2.0f, 3.0f})
+        .Initializer("two", {}, {2.0f})
+        .Initializer("m", {3, 2}, {1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f})
+        .Initializer("flat", {1}, {-1.0f})
+        .Node("Add", {"x", "bias"}, {"shifted"})
+        .Node("Mul", {"shifted", "two"}, {"scaled"})
+        .Node("MatMul", {"scaled", "m"}, {"product"})
+        .Node("Transpose", {"product"}, {"transposed"})
+        .Node("Reshape", {"transposed", "flat"}, {"reshaped"})
+        .Node("Concat", {"reshaped", "reshaped"}, {"y"}, {OnnxAttribute::Int("axis", -1)});
+    std::vector<float> output;
+    Shape shape;
+    ASSERT_TRUE(Run(builder, {0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f}, {2, 3}, output, shape));
+
+    // scaled = [[2,6,10],[8,12,16]], product = [[12,16],[24,28]], transposed = [[12,24],[16,28]]
+    EXPECT_EQ(shape, Shape({8}));
+    EXPECT_EQ(output, std::vector<float>({12, 24, 16, 28, 12, 24, 16, 28}));
+
+    // Batched MatMul broadcasts the 2-D operand over the batch
+    OnnxBuilder batched;
+    batched.Input("x", {2, 1, 2}).Output("y", {})
+        .Initializer("m", {2, 2}, {1.0f, 2.0f, 3.0f, 4.0f})
+        .Node("MatMul", {"x", "m"}, {"y"});
+    ASSERT_TRUE(Run(batched, {1.0f, 0.0f, 0.0f, 1.0f}, {2, 1, 2}, output, shape));
+    EXPECT_EQ(shape, Shape({2, 1, 2}));
+    EXPECT_EQ(output, std::vector<float>({1, 2, 3, 4}));
+}
+
+TEST_F(OnnxTest, PlansActivationMemory) {
+    // Four elementwise steps in a chain: only a step's input and output are live at once
+    OnnxBuilder builder;
+    builder.Input("x", {-1, 64}).Output("y", {})
+        .Node("Relu", {"x"}, {"a"})
+        .Node("Sigmoid", {"a"}, {"b"})
+        .Node("Tanh", {"b"}, {"c"})
+        .Node("Relu", {"c"}, {"y"});
+
+    std::string bytes = builder.Build();
+    auto graph = std::make_shared<Graph>();
+    std::string error;
+    ASSERT_TRUE(ParseOnnxModel(bytes.data(), bytes.size(), *graph, error)) << error;
+    // Unfused, so each step keeps its own output
+    GraphExecutor executor;
+    executor.SetFusion(false);
+    std::vector<std::string> errors;
+    ASSERT_TRUE(executor.Prepare(graph, errors));
+
+    auto expected = [](float v) { return std::tanh(1.0f / (1.0f + std::exp(-std::max(v, 0.0f)))); };
+    std::vector<std::vector<float>> outputs;
+    std::vector<Shape> shapes;
+    for (int64_t batch : {1, 4, 1}) {
+        std::vector<float> input(static_cast<size_t>(batch * 64));
+        for (size_t i = 0; i < input.size(); ++i) {
+            input[i] = static_cast<float>(i % 7) - 3.0f;
+        }
+        ASSERT_TRUE(executor.Run({input.data()}, {{batch, 64}}, outputs, shapes, error)) << error;
+        EXPECT_EQ(executor.GetActivationBytes(), 2 * input.size() * sizeof(float));
+        ASSERT_EQ(outputs[0].size(), input.size());
+        for (size_t i = 0; i < input.size(); ++i) {
+            EXPECT_NEAR(outputs[0][i], expected(input[i]), 1e-6f);
+        }
+    }
+}
+
+TEST_F(OnnxTest, RunsSmallerShapesInReservedPlan) {
+    OnnxBuilder builder;
+    builder.Input("x", {-1, 64}).Output("y", {})
+        .Node("Relu", {"x"}, {"a"})
+        .Node("Sigmoid", {"a"}, {"b"})
+        .Node("Tanh", {"b"}, {"y"});
+    std::string bytes = builder.Build();
+    auto graph = std::make_shared<Graph>();
+    std::string error;
+    ASSERT_TRUE(ParseOnnxModel(bytes.data(), bytes.size(), *graph, error)) << error;
+    GraphExecutor executor;
+    executor.SetFusion(false);
+    std::vector<std::string> errors;
+    ASSERT_TRUE(executor.Prepare(graph, errors));
+
+    const size_t reserved = 2 * 8 * 64 * sizeof(float);
+    ASSERT_TRUE(executor.ReserveShapes({{8, 64}}, error)) << error;
+    EXPECT_EQ(executor.GetActivationBytes(), reserved);
+
+    // Batch sizes up to the reserved one keep its offsets: the output never moves
+    auto run = [&](int64_t batch) {
+        std::vector<float> input(static_cast<size_t>(batch * 64));
+        for (size_t i = 0; i < input.size(); ++i) {
+            input[i] = static_cast<float>(i % 5) - 2.0f;
+        }
+        EXPECT_TRUE(executor.Run({input.data()}, {{batch, 64}}, error)) << error;
+        EXPECT_EQ(executor.GetOutputShape(0), Shape({batch, 64}));
+        for (size_t i = 0; i < input.size(); ++i) {
+            float expected = std::tanh(1.0f / (1.0f + std::exp(-std::max(input[i], 0.0f))));
+            EXPECT_NEAR(executor.GetOutputData(0)[i], expected, 1e-6f);
+        }
+        return executor.GetOutputData(0);
+    };
+    const float* output = run(3);
+    for (int64_t batch : {8, 1, 5}) {
+        EXPECT_EQ(run(batch), output);
+        EXPECT_EQ(executor.GetActivationBytes(), reserved);
+    }
+
+    // A larger batch is planned on its own; smaller ones return to the reservation
+    run(16);
+    EXPECT_EQ(executor.GetActivationBytes(), 2 * 16 * 64 * sizeof(float));
+    output = run(2);
+    EXPECT_EQ(executor.GetActivationBytes(), reserved);
+    EXPECT_EQ(run(7), output);
+
+    // Preparing again drops the reservation
+    ASSERT_TRUE(executor.Prepare(graph, errors));
+    run(1);
+    EXPECT_EQ(executor.GetActivationBytes(), 2 * 64 * sizeof(float));
+}
+
+TEST_F(OnnxTest, FusesOperators) {
+    // Conv -> BatchNormalization -> Relu -> Flatten -> Gemm -> Add -> Sigmoid -> Mul -> Sub -> Tanh -> Reshape
+    // -> Transpose that only moves a dimension of one; the 1x1 Conv reads its input without im2col scratch
+    const int64_t C = 3, H = 5, W = 5, M = 4, features = M * H * W, outputs = 6;
+    std::vector<float> filters(M * C), dense(outputs * features), input(2 * C * H * W);
+    for (size_t i = 0; i < filters.size(); ++i) {
+        filters[i] = std::sin(static_cast<float>(i) * 0.7f) * 0.3f;
+    }
+    for (size_t i = 0; i < dense.size(); ++i) {
+        dense[i] = std::cos(static_cast<float>(i) * 0.3f) * 0.05f;
+    }
+    for (size_t i = 0; i < input.size(); ++i) {
+        input[i] = std::sin(static_cast<float>(i) * 0.2f);
+    }
+    OnnxBuilder builder;
+    builder.Input("x", {-1, C, H, W}).Output("y", {})
+        .Initializer("w", {M, C, 1, 1}, filters).Initializer("b", {M}, {0.1f, -0.2f, 0.3f, 0.0f})
+        .Initializer("scale", {M}, {1.5f, 0.5f, 2.0f, 1.0f}).Initializer("shift", {M}, {0.0f, 0.2f, -0.1f, 0.4f})
+        .Initializer("mean", {M}, {0.1f, -0.3f, 0.2f, 0.0f}).Initializer("var", {M}, {0.5f, 2.0f, 1.0f, 0.25f})
+        .Initializer("d", {outputs, features}, dense).Initializer("bias", {outputs}, {0.5f, -0.5f, 0, 1, -1, 0.25f})
+        .Initializer("two", {}, {2.0f}).Initializer("one", {}, {1.0f}).Initializer("shape", {2}, {-1.0f, 1.0f})
+        .Node("Conv", {"x", "w", "b"}, {"c"})
+        .Node("BatchNormalization", {"c", "scale", "shift", "mean", "var"}, {"n"})
+        .Node("Relu", {"n"}, {"r"})
+        .Node("Flatten", {"r"}, {"f"})
+        .Node("Gemm", {"f", "d"}, {"g"}, {OnnxAttribute::Int("transB", 1)})
+        .Node("Add", {"bias", "g"}, {"a"})
+        .Node("Sigmoid", {"a"}, {"s"})
+        .Node("Mul", {"s", "two"}, {"m"})
+        .Node("Sub", {"one", "m"}, {"t"})
+        .Node("Tanh", {"t"}, {"h"})
+        .Node("Reshape", {"h", "shape"}, {"column"})
+        .Node("Transpose", {"column"}, {"y"}, {OnnxAttribute::Ints("perm", {1, 0})});
+    std::string bytes = builder.Build();
+    auto graph = std::make_shared<Graph>();
+    std::string error;
+    ASSERT_TRUE(ParseOnnxModel(bytes.data(), bytes.size(), *graph, error)) << error;
+
+    auto run = [&](bool fusion, std::vector<float>& output, Shape& shape) {
+        GraphExecutor executor;
+        executor.SetFusion(fusion);
+        std::vector<std::string> errors;
+        EXPECT_TRUE(executor.Prepare(graph, errors));
+        std::vector<std::vector<float>> results;
+        std::vector<Shape> shapes;
+        EXPECT_TRUE(executor.Run({input.data()}, {{2, C, H, W}}, results, shapes, error)) << error;
+        output = results.empty() ? std::vector<float>() : results[0];
+        shape = shapes.empty() ? Shape() : shapes[0];
+        return executor.GetActivationBytes();
+    };
+    std::vector<float> expected, fused;
+    Shape expectedShape, fusedShape;
+    size_t unfusedBytes = run(false, expected, expectedShape);
+    size_t fusedBytes = run(true, fused, fusedShape);
+    EXPECT_EQ(expectedShape, Shape({1, 2 * outputs}));
+    EXPECT_EQ(fusedShape, expectedShape);
+    ASSERT_EQ(fused.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_NEAR(fused[i], expected[i], 1e-5f);
+    }
+    // The normalized copy of the Conv output is never materialized
+    EXPECT_LT(fusedBytes, unfusedBytes);
+
+    // BatchNormalization of a graph input has nothing to fold into
+    OnnxBuilder normalize;
+    normalize.Input("x", {1, 2, 2}).Output("y", {})
+        .Initializer("scale", {2}, {2.0f, 0.5f}).Initializer("shift", {2}, {1.0f, 0.0f})
+        .Initializer("mean", {2}, {1.0f, -1.0f}).Initializer("var", {2}, {4.0f, 1.0f})
+        .Node("BatchNormalization", {"x", "scale", "shift", "mean", "var"}, {"y"},
+              {OnnxAttribute::Float("epsilon", 0.0f)});
+    std::vector<float> output;
+    Shape shape;
+    ASSERT_TRUE(Run(normalize, {1.0f, 3.0f, 1.0f, -3.0f}, {1, 2, 2}, output, shape));
+    EXPECT_EQ(shape, Shape({1, 2, 2}));
+    EXPECT_EQ(output, std::vector<float>({1.0f, 3.0f, 1.0f, -1.0f}));
+}
+
+TEST_F(OnnxTest, ActivationsAndSoftmax) {
+    OnnxBuilder builder;
+    builder.Input("x", {2, 2}).Output("sigmoid", {}).Output("tanh", {}).Output("softmax", {})
+        .Node("Sigmoid", {"x"}, {"sigmoid"})
+        .Node("Tanh", {"x"}, {"tanh"})
+        .Node("Softmax", {"x"}, {"softmax"}, {OnnxAttribute::Int("axis", 0)});
+
+    std::string bytes = builder.Build();
+    auto graph = std::make_shared<Graph>();
+    std::string error;
+    ASSERT_TRUE(ParseOnnxModel(bytes.data(), bytes.size(), *graph, error)) << error;
+    GraphExecutor executor;
+    std::vector<std::string> errors;
+    ASSERT_TRUE(executor.Prepare(graph, errors));
+
+    std::vector<float> input = {0.0f, 1.0f, 2.0f, -1.0f};
+    std::vector<std::vector<float>> outputs;
+    std::vector<Shape> shapes;
+    ASSERT_TRUE(executor.Run({input.data()}, {{2, 2}}, outputs, shapes, error)) << error;
+    ASSERT_EQ(outputs.size(), 3u);
+    for (size_t i = 0; i < input.size(); ++i) {
+        EXPECT_NEAR(outputs[0][i], 1.0f / (1.0f + std::exp(-input[i])), 1e-6f);
+        EXPECT_NEAR(outputs[1][i], std::tanh(input[i]), 1e-6f);
+    }
+    // Opset 13 softmax normalises each column along axis 0
+    EXPECT_NEAR(outputs[2][0] + outputs[2][2], 1.0f, 1e-6f);
+    EXPECT_NEAR(outputs[2][2], std::exp(2.0f) / (1.0f + std::exp(2.0f)), 1e-6f);
+}
+
+TEST_F(OnnxTest, InfersShapesAndReportsMismatches) {
+    OnnxBuilder builder;
+    builder.Input("x", {-1, 3}).Output("y", {})
+        .Initializer("w", {4, 3}, std::vector<float>(12, 1.0f))
+        .Node("Gemm", {"x", "w"}, {"h"}, {OnnxAttribute::Int("transB", 1)})
+        .Node("Flatten", {"h"}, {"y"}, {OnnxAttribute::Int("axis", 0)});
+    std::string bytes = builder.Build();
+    auto graph = std::make_shared<Graph>();
+    std::string error;
+    ASSERT_TRUE(ParseOnnxModel(bytes.data(), bytes.size(), *graph, error)) << error;
+    GraphExecutor executor;
+    std::vector<std::string> errors;
+    ASSERT_TRUE(executor.Prepare(graph, errors));
+
+    std::vector<Shape> outputShapes;
+    ASSERT_TRUE(executor.InferShapes({{5, 3}}, outputShapes, error)) << error;
+    EXPECT_EQ(outputShapes[0], Shape({1, 20}));
+
+    EXPECT_FALSE(executor.InferShapes({{5, 2}}, outputShapes, error));
+    EXPECT_NE(error.find("[?, 3]"), std::string::npos);
+    EXPECT_FALSE(executor.InferShapes({{5, 3}, {1}}, outputShapes, error));
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
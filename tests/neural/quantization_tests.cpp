@@ -0,0 +1,333 @@
+#include <gtest/gtest.h>
+#include "gaia_matrix.h"
+#include "../test_utils/onnx_builder.h"
+#include "../test_utils/test_helpers.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace gaia_matrix;
+using namespace gaia_matrix::neural;
+using gaia_matrix::test::OnnxAttribute;
+using gaia_matrix::test::OnnxBuilder;
+using gaia_matrix::test::TestHelpers;
+
+namespace {
+
+constexpr int32_t UINT8 = 2;
+constexpr int32_t INT8 = 3;
+constexpr int32_t INT32 = 6;
+
+} // namespace
+
+class QuantizationTest : public ::testing::Test {
+protected:
+    static void SetUpTestSuite() {
+        NeuralEngine::Initialize();
+    }
+
+    void SetUp() override {
+        m_DefaultIsa = GetKernelIsa();
+        for (KernelIsa isa : {KernelIsa::Scalar, KernelIsa::Neon, KernelIsa::Avx2, KernelIsa::Avx512}) {
+            if (IsKernelIsaSupported(isa)) {
+                m_Isas.push_back(isa);
+            }
+        }
+    }
+
+    void TearDown() override {
+        SetKernelIsa(m_DefaultIsa);
+    }
+
+    // Deterministic integers in [low, high]
+    static std::vector<float> Integers(size_t count, int low, int high, int seed) {
+        std::vector<float> values(count);
+        for (size_t i = 0; i < count; ++i) {
+            values[i] = static_cast<float>(low + static_cast<int>((i * 131 + seed * 17) % (high - low + 1)));
+        }
+        return values;
+    }
+
+    static std::shared_ptr<Graph> Parse(const OnnxBuilder& builder) {
+        std::string bytes = builder.Build();
+        auto graph = std::make_shared<Graph>();
+        std::string error;
+        EXPECT_TRUE(ParseOnnxModel(bytes.data(), bytes.size(), *graph, error)) << error;
+        return graph;
+    }
+
+    static std::vector<float> Run(GraphExecutor& executor, const std::vector<float>& input, const Shape& shape) {
+        std::vector<std::vector<float>> outputs;
+        std::vector<Shape> outputShapes;
+        std::string error;
+        EXPECT_TRUE(executor.Run({input.data()}, {shape}, outputs, outputShapes, error)) << error;
+        return outputs.empty() ? std::vector<float>() : outputs[0];
+    }
+
+    static std::vector<float> Run(std::shared_ptr<Graph> graph, const std::vector<float>& input, const Shape& shape) {
+        GraphExecutor executor;
+        std::vector<std::string> errors;
+        EXPECT_TRUE(executor.Prepare(graph, errors)) << (errors.empty() ? "" : errors.front());
+        return Run(executor, input, shape);
+    }
+
+    KernelIsa m_DefaultIsa = KernelIsa::Scalar;
+    std::vector<KernelIsa> m_Isas;
+};
+
+TEST_F(QuantizationTest, QGemmMatchesReferenceOnEveryInstructionSet) {
+    // Edge sizes around every tile shape, K not a multiple of four, and M past one block
+    const int64_t sizes[][3] = {{1, 1, 1}, {3, 5, 7}, {8, 32, 16}, {9, 33, 13}, {130, 40, 70}};
+    for (KernelIsa isa : m_Isas) {
+        ASSERT_TRUE(SetKernelIsa(isa));
+        for (const auto& size : sizes) {
+            int64_t M = size[0], N = size[1], K = size[2];
+            int64_t lda = K + 3;
+            auto a = Integers(M * lda, 0, 255, 1);
+            auto b = Integers(N * K, -128, 127, 2);
+            std::vector<uint8_t> A(a.begin(), a.end());
+            std::vector<int8_t> B(b.begin(), b.end());
+            std::vector<int32_t> zeroPoints(N);
+            std::vector<float> scale(N), offset(N);
+            for (int64_t n = 0; n < N; ++n) {
+                zeroPoints[n] = static_cast<int32_t>(n % 5) - 2;
+                scale[n] = 0.001f * static_cast<float>(n + 1);
+                offset[n] = static_cast<float>(n % 3);
+            }
+            const int32_t aZeroPoint = 131;
+
+            PackedMatrixInt8 packed;
+            packed.Pack(true, K, N, B.data(), K, zeroPoints.data());
+            std::vector<float> C(M * N), quantized(M * N);
+            QGemm(M, A.data(), lda, aZeroPoint, packed, scale.data(), offset.data(), false, 0.0f, 0.0f, C.data(), N);
+            QGemm(M, A.data(), lda, aZeroPoint, packed, scale.data(), offset.data(), true, -20.0f, 20.0f,
+                  quantized.data(), N);
+
+            for (int64_t m = 0; m < M; ++m) {
+                for (int64_t n = 0; n < N; ++n) {
+                    int64_t acc = 0;
+                    for (int64_t k = 0; k < K; ++k) {
+                        acc += (static_cast<int64_t>(A[m * lda + k]) - aZeroPoint) * (B[n * K + k] - zeroPoints[n]);
+                    }
+                    float expected = static_cast<float>(acc) * scale[n] + offset[n];
+                    ASSERT_NEAR(C[m * N + n], expected, 1e-4f * (1.0f + std::fabs(expected)))
+                        << GetKernelIsaName(isa) << " M=" << M << " N=" << N << " K=" << K;
+                    float clamped = std::min(std::max(std::nearbyint(expected), -20.0f), 20.0f);
+                    ASSERT_NEAR(quantized[m * N + n], clamped, 1.0f) << GetKernelIsaName(isa);
+                }
+            }
+        }
+    }
+}
+
+TEST_F(QuantizationTest, QLinearMatMulMatchesReference) {
+    const int64_t M = 6, K = 10, N = 5;
+    auto b = Integers(K * N, -127, 127, 3);
+    std::vector<float> bScale = {0.01f, 0.02f, 0.015f, 0.03f, 0.005f};
+    std::vector<float> bZeroPoint = {0, 1, -2, 0, 3};
+    OnnxBuilder builder;
+    builder.Opset(13)
+        .Input("a", {-1, K})
+        .Output("y", {-1, N})
+        .Initializer("a_scale", {}, {0.05f})
+        .Initializer("a_zero_point", {}, {12}, UINT8)
+        .Initializer("b", {K, N}, b, INT8)
+        .Initializer("b_scale", {N}, bScale)
+        .Initializer("b_zero_point", {N}, bZeroPoint, INT8)
+        .Initializer("y_scale", {}, {0.2f})
+        .Initializer("y_zero_point", {}, {128}, UINT8)
+        .Node("QLinearMatMul", {"a", "a_scale", "a_zero_point", "b", "b_scale", "b_zero_point", "y_scale",
+                                "y_zero_point"},
+              {"y"});
+    auto a = Integers(M * K, 0, 255, 4);
+
+    for (KernelIsa isa : m_Isas) {
+        ASSERT_TRUE(SetKernelIsa(isa));
+        auto y = Run(Parse(builder), a, {M, K});
+        ASSERT_EQ(y.size(), static_cast<size_t>(M * N));
+        for (int64_t m = 0; m < M; ++m) {
+            for (int64_t n = 0; n < N; ++n) {
+                double acc = 0.0;
+                for (int64_t k = 0; k < K; ++k) {
+                    acc += (a[m * K + k] - 12.0) * (b[k * N + n] - bZeroPoint[n]);
+                }
+                double expected = std::clamp(std::nearbyint(acc * 0.05 * bScale[n] / 0.2) + 128.0, 0.0, 255.0);
+                // Ties may round either way after float scaling
+                EXPECT_NEAR(y[m * N + n], expected, 1.0) << GetKernelIsaName(isa);
+            }
+        }
+    }
+}
+
+TEST_F(QuantizationTest, QLinearConvMatchesReference) {
+    // int8 input and output, per-channel weights, padding and an int32 bias
+    const int64_t C = 2, H = 5, W = 5, F = 4;
+    auto w = Integers(F * C * 9, -127, 127, 5);
+    std::vector<float> wScale = {0.01f, 0.02f, 0.005f, 0.03f};
+    std::vector<float> bias = {100, -50, 0, 2000};
+    OnnxBuilder builder;
+    builder.Opset(13)
+        .Input("x", {1, C, H, W})
+        .Output("y", {1, F, H, W})
+        .Initializer("x_scale", {}, {0.1f})
+        .Initializer("x_zero_point", {}, {-3}, INT8)
+        .Initializer("w", {F, C, 3, 3}, w, INT8)
+        .Initializer("w_scale", {F}, wScale)
+        .Initializer("w_zero_point", {F}, {0, 0, 0, 0}, INT8)
+        .Initializer("y_scale", {}, {0.5f})
+        .Initializer("y_zero_point", {}, {5}, INT8)
+        .Initializer("bias", {F}, bias, INT32)
+        .Node("QLinearConv", {"x", "x_scale", "x_zero_point", "w", "w_scale", "w_zero_point", "y_scale",
+                              "y_zero_point", "bias"},
+              {"y"}, {OnnxAttribute::Ints("pads", {1, 1, 1, 1})});
+    auto x = Integers(C * H * W, -128, 127, 6);
+
+    for (KernelIsa isa : m_Isas) {
+        ASSERT_TRUE(SetKernelIsa(isa));
+        auto y = Run(Parse(builder), x, {1, C, H, W});
+        ASSERT_EQ(y.size(), static_cast<size_t>(F * H * W));
+        for (int64_t f = 0; f < F; ++f) {
+            for (int64_t oh = 0; oh < H; ++oh) {
+                for (int64_t ow = 0; ow < W; ++ow) {
+                    double acc = bias[f];
+                    for (int64_t c = 0; c < C; ++c) {
+                        for (int64_t kh = 0; kh < 3; ++kh) {
+                            for (int64_t kw = 0; kw < 3; ++kw) {
+                                int64_t ih = oh + kh - 1, iw = ow + kw - 1;
+                                if (ih >= 0 && ih < H && iw >= 0 && iw < W) {
+                                    acc += (x[(c * H + ih) * W + iw] + 3.0) * w[((f * C + c) * 3 + kh) * 3 + kw];
+                                }
+                            }
+                        }
+                    }
+                    double expected = std::clamp(std::nearbyint(acc * 0.1 * wScale[f] / 0.5) + 5.0, -128.0, 127.0);
+                    EXPECT_NEAR(y[(f * H + oh) * W + ow], expected, 1.0) << GetKernelIsaName(isa);
+                }
+            }
+        }
+    }
+}
+
+TEST_F(QuantizationTest, FusedDequantizedGemmMatchesFloatMath) {
+    // Q/DQ on the activation and DQ on int8 weights around a Gemm run as one int8 product
+    const int64_t M = 7, K = 67, N = 32;
+    auto w = Integers(N * K, -127, 127, 7);
+    std::vector<float> wScale(N), bias(N);
+    for (int64_t n = 0; n < N; ++n) {
+        wScale[n] = 0.002f * static_cast<float>(n + 1);
+        bias[n] = 0.1f * static_cast<float>(n % 4);
+    }
+    OnnxBuilder builder;
+    builder.Opset(13)
+        .Input("x", {-1, K})
+        .Output("y", {-1, N})
+        .Initializer("x_scale", {}, {0.02f})
+        .Initializer("x_zero_point", {}, {100}, UINT8)
+        .Initializer("w", {N, K}, w, INT8)
+        .Initializer("w_scale", {N}, wScale)
+        .Initializer("w_zero_point", {N}, std::vector<float>(N, 0.0f), INT8)
+        .Initializer("bias", {N}, bias)
+        .Node("QuantizeLinear", {"x", "x_scale", "x_zero_point"}, {"x_q"})
+        .Node("DequantizeLinear", {"x_q", "x_scale", "x_zero_point"}, {"x_dq"})
+        .Node("DequantizeLinear", {"w", "w_scale", "w_zero_point"}, {"w_dq"}, {OnnxAttribute::Int("axis", 0)})
+        .Node("Gemm", {"x_dq", "w_dq", "bias"}, {"y"},
+              {OnnxAttribute::Int("transB", 1), OnnxAttribute::Float("alpha", 0.5f)});
+    std::vector<float> x(M * K);
+    for (size_t i = 0; i < x.size(); ++i) {
+        x[i] = std::sin(static_cast<float>(i)) * 1.5f;
+    }
+
+    for (KernelIsa isa : m_Isas) {
+        ASSERT_TRUE(SetKernelIsa(isa));
+        auto graph = Parse(builder);
+        GraphExecutor executor;
+        std::vector<std::string> errors;
+        ASSERT_TRUE(executor.Prepare(graph, errors));
+        auto y = Run(executor, x, {M, K});
+        ASSERT_EQ(y.size(), static_cast<size_t>(M * N));
+        for (int64_t m = 0; m < M; ++m) {
+            for (int64_t n = 0; n < N; ++n) {
+                double sum = 0.0;
+                for (int64_t k = 0; k < K; ++k) {
+                    float q = std::clamp(std::nearbyint(x[m * K + k] / 0.02f) + 100.0f, 0.0f, 255.0f);
+                    sum += (q - 100.0) * 0.02 * w[n * K + k] * wScale[n];
+                }
+                EXPECT_NEAR(y[m * N + n], 0.5 * sum + bias[n], 1e-4) << GetKernelIsaName(isa);
+            }
+        }
+
+        // Only the packed int8 weights stay resident: no float copy and no dequantized copy
+        EXPECT_LT(executor.GetWeightBytes(), static_cast<size_t>(N * K) * sizeof(float) / 3);
+    }
+}
+
+TEST_F(QuantizationTest, PostTrainingQuantizationTracksFloatModel) {
+    Graph graph;
+    std::string error;
+    ASSERT_TRUE(LoadOnnxModel(TestHelpers::GetTestResourcesPath() + "/test_model.onnx", graph, error)) << error;
+
+    std::vector<CalibrationSample> samples;
+    for (int s = 0; s < 4; ++s) {
+        std::vector<float> input(16 * 4);
+        for (size_t i = 0; i < input.size(); ++i) {
+            input[i] = 2.0f * std::sin(static_cast<float>(i * 7 + s * 3));
+        }
+        samples.push_back({{input}, {{16, 4}}});
+    }
+    auto quantized = std::make_shared<Graph>();
+    ASSERT_TRUE(QuantizeGraph(graph, samples, *quantized, error)) << error;
+
+    // Float weights are replaced by int8 initializers
+    EXPECT_EQ(quantized->FindInitializer("W1"), nullptr);
+    ASSERT_NE(quantized->FindInitializer("W1_quantized"), nullptr);
+    EXPECT_EQ(quantized->FindInitializer("W1_quantized")->type, DataType::Int8);
+
+    GraphExecutor floatExecutor, quantizedExecutor;
+    std::vector<std::string> errors;
+    ASSERT_TRUE(floatExecutor.Prepare(std::make_shared<Graph>(graph), errors));
+    ASSERT_TRUE(quantizedExecutor.Prepare(quantized, errors)) << (errors.empty() ? "" : errors.front());
+
+    std::vector<float> input(10 * 4);
+    for (size_t i = 0; i < input.size(); ++i) {
+        input[i] = 1.8f * std::cos(static_cast<float>(i * 5));
+    }
+    auto expected = Run(floatExecutor, input, {10, 4});
+    auto actual = Run(quantizedExecutor, input, {10, 4});
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < actual.size(); ++i) {
+        EXPECT_NEAR(actual[i], expected[i], 0.02f) << "index " << i;
+    }
+    EXPECT_LT(quantizedExecutor.GetWeightBytes() * 3, floatExecutor.GetWeightBytes());
+}
+
+TEST_F(QuantizationTest, EngineQuantizesLoadedModel) {
+    NeuralEngine& engine = NeuralEngine::Get();
+    int modelId = engine.LoadModel(TestHelpers::GetTestResourcesPath() + "/test_model.onnx");
+    ASSERT_GE(modelId, 0);
+
+    std::vector<std::vector<float>> calibration;
+    for (int s = 0; s < 8; ++s) {
+        std::vector<float> sample(4 * 4);
+        for (size_t i = 0; i < sample.size(); ++i) {
+            sample[i] = 2.0f * std::sin(static_cast<float>(i * 3 + s * 11));
+        }
+        calibration.push_back(sample);
+    }
+    std::vector<float> input = {0.5f, -1.0f, 1.5f, 0.25f, -0.75f, 0.0f, 1.0f, -1.5f};
+    auto expected = engine.RunInference(modelId, input, {2, 4, 1, 1});
+
+    ASSERT_TRUE(engine.QuantizeModel(modelId, calibration, {4, 4, 1, 1}));
+    auto actual = engine.RunInference(modelId, input, {2, 4, 1, 1});
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < actual.size(); ++i) {
+        EXPECT_NEAR(actual[i], expected[i], 0.02f);
+    }
+
+    // Calibration data must fit the model input
+    EXPECT_FALSE(engine.QuantizeModel(modelId, {{1.0f, 2.0f, 3.0f}}, {1, 3, 1, 1}));
+    engine.UnloadModel(modelId);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include "gaia_matrix.h"
+#include "../test_utils/onnx_builder.h"
+#include "../test_utils/test_helpers.h"
+#include <cstring>
+
+using namespace gaia_matrix;
+using namespace gaia_matrix::neural;
+using gaia_matrix::test::OnnxBuilder;
+using gaia_matrix::test::TestHelpers;
+
+class TensorTest : public ::testing::Test {
+protected:
+    static void SetUpTestSuite() {
+        NeuralEngine::Initialize();
+    }
+
+    void SetUp() override {
+        m_Directory = TestHelpers::CreateTempDirectory();
+    }
+
+    void TearDown() override {
+        TestHelpers::DeleteTempDirectory(m_Directory);
+    }
+
+    std::string m_Directory;
+};
+
+TEST_F(TensorTest, OwnsAlignedStorage) {
+    Tensor tensor(DataType::Float32, {3, 5}, "x");
+    EXPECT_EQ(tensor.GetByteSize(), 60u);
+    TensorView view = tensor.View();
+    EXPECT_TRUE(view.IsAligned());
+    EXPECT_TRUE(view.IsContiguous());
+    EXPECT_EQ(view.Count(), 15);
+    EXPECT_EQ(view.name, "x");
+    EXPECT_EQ(tensor.Data<float>()[14], 0.0f);
+
+    // Shrinking keeps the storage; growing moves it but stays aligned
+    void* data = tensor.GetData();
+    tensor.Resize({2, 2});
+    EXPECT_EQ(tensor.GetData(), data);
+    tensor.Resize({64, 64});
+    EXPECT_TRUE(tensor.View().IsAligned());
+
+    Tensor moved(std::move(tensor));
+    EXPECT_EQ(moved.GetShape(), Shape({64, 64}));
+    EXPECT_EQ(tensor.GetData(), nullptr);
+    EXPECT_EQ(DataTypeSize(DataType::BFloat16), 2u);
+    EXPECT_EQ(DataTypeSize(DataType::Undefined), 0u);
+}
+
+TEST_F(TensorTest, ConvertsTypesAndLayouts) {
+    // A column-major 2x3 buffer read as a row-major view through strides
+    float columns[6] = {1, 4, 2, 5, 3, 6};
+    TensorView transposed(columns, DataType::Float32, {2, 3}, {1, 2});
+    EXPECT_FALSE(transposed.IsContiguous());
+    float rows[6];
+    ASSERT_TRUE(ReadTensor(transposed, rows));
+    EXPECT_EQ(std::vector<float>(rows, rows + 6), std::vector<float>({1, 2, 3, 4, 5, 6}));
+
+    // Size-1 dimensions may have any stride
+    EXPECT_TRUE(TensorView(columns, DataType::Float32, {1, 6}, {99, 1}).IsContiguous());
+
+    // Integers round and saturate; 16-bit floats round trip
+    float values[4] = {-300.0f, -1.5f, 2.5f, 1000.0f};
+    int8_t bytes[4];
+    ASSERT_TRUE(WriteTensor(values, TensorView(bytes, DataType::Int8, {4})));
+    EXPECT_EQ(std::vector<int8_t>(bytes, bytes + 4), std::vector<int8_t>({-128, -2, 2, 127}));
+    uint16_t halves[4];
+    float widened[4];
+    ASSERT_TRUE(WriteTensor(values, TensorView(halves, DataType::Float16, {2, 2})));
+    ASSERT_TRUE(ReadTensor(TensorView(halves, DataType::Float16, {2, 2}), widened));
+    EXPECT_EQ(std::vector<float>(widened, widened + 4), std::vector<float>(values, values + 4));
+
+    // Every other element of a strided destination
+    float spaced[8] = {};
+    ASSERT_TRUE(WriteTensor(values, TensorView(spaced, DataType::Float32, {4}, {2})));
+    EXPECT_EQ(spaced[6], 1000.0f);
+    EXPECT_EQ(spaced[7], 0.0f);
+
+    EXPECT_FALSE(ReadTensor(TensorView(columns, DataType::Undefined, {6}), rows));
+    EXPECT_FALSE(ReadTensor(TensorView(columns, DataType::Float32, {2, 3}, {1}), rows));
+}
+
+TEST_F(TensorTest, EngineBindsNamedTensors) {
+    std::string path = OnnxBuilder()
+                           .Input("a", {-1, 3})
+                           .Input("b", {-1, 3})
+                           .Output("sum", {-1, 3})
+                           .Output("product", {-1, 3})
+                           .Node("Add", {"a", "b"}, {"sum"})
+                           .Node("Mul", {"a", "b"}, {"product"})
+                           .Save(m_Directory, "two_inputs.onnx");
+    NeuralEngine& engine = NeuralEngine::Get();
+    int modelId = engine.LoadModel(path);
+    ASSERT_GE(modelId, 0);
+    ASSERT_EQ(engine.GetInputInfo(modelId).size(), 2u);
+    EXPECT_EQ(engine.GetInputInfo(modelId)[1].name, "b");
+    EXPECT_EQ(engine.GetOutputInfo(modelId)[1].shape, Shape({-1, 3}));
+
+    // Inputs out of graph order, one fp32 in place and one strided int32
+    std::vector<float> a = {1, 2, 3, 4, 5, 6};
+    int32_t bColumns[6] = {10, 40, 20, 50, 30, 60};
+    std::vector<TensorView> inputs = {TensorView(bColumns, DataType::Int32, {2, 3}, {1, 2}, "b"),
+                                      TensorView(a.data(), {2, 3}, "a")};
+
+    // Outputs into caller buffers, one converted to fp16
+    float product[6];
+    uint16_t sum[6];
+    std::vector<TensorView> outputs = {TensorView(product, {2, 3}, "product"),
+                                       TensorView(sum, DataType::Float16, {2, 3}, {}, "sum")};
+    ASSERT_TRUE(engine.RunInference(modelId, inputs, outputs));
+    EXPECT_EQ(std::vector<float>(product, product + 6), std::vector<float>({10, 40, 90, 160, 250, 360}));
+    float widened[6];
+    ASSERT_TRUE(ReadTensor(outputs[1], widened));
+    EXPECT_EQ(std::vector<float>(widened, widened + 6), std::vector<float>({11, 22, 33, 44, 55, 66}));
+
+    // Output buffers must match the shape this run produces
+    float small[3];
+    std::vector<TensorView> mismatched = {TensorView(small, {1, 3}, "sum")};
+    EXPECT_FALSE(engine.RunInference(modelId, inputs, mismatched));
+    std::vector<TensorView> unknown = {TensorView(product, {2, 3}, "difference")};
+    EXPECT_FALSE(engine.RunInference(modelId, inputs, unknown));
+    EXPECT_FALSE(engine.RunInference(modelId, {inputs[0]}, outputs));
+
+    // The vector interface only serves single-input models
+    EXPECT_TRUE(engine.RunInference(modelId, a, {2, 3, 1, 1}).empty());
+    engine.UnloadModel(modelId);
+}
+
+TEST_F(TensorTest, EngineRunsRankFiveTensors) {
+    std::string path = OnnxBuilder()
+                           .Input("x", {1, 2, 1, 2, 3})
+                           .Output("y", {1, 2, 1, 2, 3})
+                           .Node("Relu", {"x"}, {"y"})
+                           .Save(m_Directory, "rank5.onnx");
+    NeuralEngine& engine = NeuralEngine::Get();
+    int modelId = engine.LoadModel(path);
+    ASSERT_GE(modelId, 0);
+
+    Tensor input(DataType::Float32, {1, 2, 1, 2, 3});
+    Tensor output(DataType::Float32, {1, 2, 1, 2, 3});
+    for (int i = 0; i < 12; ++i) {
+        input.Data<float>()[i] = static_cast<float>(i - 6);
+    }
+    ASSERT_TRUE(engine.RunInference(modelId, {input.View()}, {output.View()}));
+    for (int i = 0; i < 12; ++i) {
+        EXPECT_EQ(output.Data<float>()[i], std::max(0.0f, static_cast<float>(i - 6)));
+    }
+    engine.UnloadModel(modelId);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,222 @@
+#include "onnx_builder.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace gaia_matrix {
+namespace test {
+
+namespace {
+
+void WriteVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+void WriteTag(std::string& out, uint32_t field, uint32_t wire) {
+    WriteVarint(out, (static_cast<uint64_t>(field) << 3) | wire);
+}
+
+void WriteInt(std::string& out, uint32_t field, int64_t value) {
+    WriteTag(out, field, 0);
+    WriteVarint(out, static_cast<uint64_t>(value));
+}
+
+void WriteBytes(std::string& out, uint32_t field, const std::string& bytes) {
+    WriteTag(out, field, 2);
+    WriteVarint(out, bytes.size());
+    out += bytes;
+}
+
+void WriteFloat(std::string& out, uint32_t field, float value) {
+    WriteTag(out, field, 5);
+    char bytes[4];
+    std::memcpy(bytes, &value, 4);
+    out.append(bytes, 4);
+}
+
+std::string ValueInfo(const std::string& name, const std::vector<int64_t>& shape) {
+    std::string dims;
+    for (int64_t dim : shape) {
+        std::string dimension;
+        if (dim < 0) {
+            WriteBytes(dimension, 2, "N");
+        } else {
+            WriteInt(dimension, 1, dim);
+        }
+        WriteBytes(dims, 1, dimension);
+    }
+    std::string tensor;
+    WriteInt(tensor, 1, 1);     // FLOAT
+    WriteBytes(tensor, 2, dims);
+    std::string type;
+    WriteBytes(type, 1, tensor);
+    std::string info;
+    WriteBytes(info, 1, name);
+    WriteBytes(info, 2, type);
+    return info;
+}
+
+} // namespace
+
+OnnxAttribute OnnxAttribute::Int(const std::string& name, int64_t value) {
+    OnnxAttribute attribute;
+    WriteBytes(attribute.encoded, 1, name);
+    WriteInt(attribute.encoded, 3, value);
+    WriteInt(attribute.encoded, 20, 2);
+    return attribute;
+}
+
+OnnxAttribute OnnxAttribute::Float(const std::string& name, float value) {
+    OnnxAttribute attribute;
+    WriteBytes(attribute.encoded, 1, name);
+    WriteFloat(attribute.encoded, 2, value);
+    WriteInt(attribute.encoded, 20, 1);
+    return attribute;
+}
+
+OnnxAttribute OnnxAttribute::Ints(const std::string& name, const std::vector<int64_t>& values) {
+    OnnxAttribute attribute;
+    WriteBytes(attribute.encoded, 1, name);
+    for (int64_t value : values) {
+        WriteInt(attribute.encoded, 8, value);
+    }
+    WriteInt(attribute.encoded, 20, 7);
+    return attribute;
+}
+
+OnnxAttribute OnnxAttribute::String(const std::string& name, const std::string& value) {
+    OnnxAttribute attribute;
+    WriteBytes(attribute.encoded, 1, name);
+    WriteBytes(attribute.encoded, 4, value);
+    WriteInt(attribute.encoded, 20, 3);
+    return attribute;
+}
+
+OnnxBuilder& OnnxBuilder::Opset(int64_t version) {
+    m_Opset = version;
+    return *this;
+}
+
+OnnxBuilder& OnnxBuilder::Metadata(const std::string& producerName, const std::string& producerVersion,
+                                   const std::string& domain, int64_t modelVersion, const std::string& docString) {
+    m_Metadata.clear();
+    WriteBytes(m_Metadata, 2, producerName);
+    WriteBytes(m_Metadata, 3, producerVersion);
+    WriteBytes(m_Metadata, 4, domain);
+    WriteInt(m_Metadata, 5, modelVersion);
+    WriteBytes(m_Metadata, 6, docString);
+    return *this;
+}
+
+OnnxBuilder& OnnxBuilder::Input(const std::string& name, const std::vector<int64_t>& shape) {
+    WriteBytes(m_Inputs, 11, ValueInfo(name, shape));
+    return *this;
+}
+
+OnnxBuilder& OnnxBuilder::Output(const std::string& name, const std::vector<int64_t>& shape) {
+    WriteBytes(m_Outputs, 12, ValueInfo(name, shape));
+    return *this;
+}
+
+OnnxBuilder& OnnxBuilder::Initializer(const std::string& name, const std::vector<int64_t>& dims,
+                                      const std::vector<float>& data, int32_t dataType) {
+    std::string tensor;
+    for (int64_t dim : dims) {
+        WriteInt(tensor, 1, dim);
+    }
+    WriteInt(tensor, 2, dataType);
+    WriteBytes(tensor, 8, name);
+    std::string raw;
+    for (float value : data) {
+        if (dataType == 2 || dataType == 3) {
+            raw.push_back(static_cast<char>(static_cast<int32_t>(value)));
+        } else if (dataType == 6) {
+            auto integer = static_cast<int32_t>(value);
+            raw.append(reinterpret_cast<const char*>(&integer), sizeof(integer));
+        } else {
+            raw.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+    }
+    WriteBytes(tensor, 9, raw);
+    WriteBytes(m_Initializers, 5, tensor);
+    return *this;
+}
+
+OnnxBuilder& OnnxBuilder::ExternalInitializer(const std::string& name, const std::vector<int64_t>& dims,
+                                              const std::string& location, int64_t offset, int64_t length) {
+    std::string tensor;
+    for (int64_t dim : dims) {
+        WriteInt(tensor, 1, dim);
+    }
+    WriteInt(tensor, 2, 1);     // FLOAT
+    WriteBytes(tensor, 8, name);
+    auto entry = [&tensor](const std::string& key, const std::string& value) {
+        std::string pair;
+        WriteBytes(pair, 1, key);
+        WriteBytes(pair, 2, value);
+        WriteBytes(tensor, 13, pair);
+    };
+    entry("location", location);
+    entry("offset", std::to_string(offset));
+    if (length >= 0) {
+        entry("length", std::to_string(length));
+    }
+    WriteInt(tensor, 14, 1);    // EXTERNAL
+    WriteBytes(m_Initializers, 5, tensor);
+    return *this;
+}
+
+OnnxBuilder& OnnxBuilder::Node(const std::string& opType, const std::vector<std::string>& inputs,
+                               const std::vector<std::string>& outputs,
+                               const std::vector<OnnxAttribute>& attributes) {
+    std::string node;
+    for (const auto& input : inputs) {
+        WriteBytes(node, 1, input);
+    }
+    for (const auto& output : outputs) {
+        WriteBytes(node, 2, output);
+    }
+    WriteBytes(node, 3, opType + "_" + std::to_string(m_NodeCount++));
+    WriteBytes(node, 4, opType);
+    for (const auto& attribute : attributes) {
+        WriteBytes(node, 5, attribute.encoded);
+    }
+    WriteBytes(m_Nodes, 1, node);
+    return *this;
+}
+
+std::string OnnxBuilder::Build() const {
+    std::string graph = m_Nodes;
+    WriteBytes(graph, 2, "test_graph");
+    graph += m_Initializers + m_Inputs + m_Outputs;
+
+    std::string opset;
+    WriteBytes(opset, 1, "");
+    WriteInt(opset, 2, m_Opset);
+
+    std::string model;
+    WriteInt(model, 1, 7);
+    model += m_Metadata;
+    WriteBytes(model, 7, graph);
+    WriteBytes(model, 8, opset);
+    return model;
+}
+
+std::string OnnxBuilder::Save(const std::string& directory, const std::string& filename) const {
+    std::string filePath = directory + "/" + filename;
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file) {
+        std::cerr << "Error opening file: " << filePath << std::endl;
+        return "";
+    }
+    std::string bytes = Build();
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    return filePath;
+}
+
+} // namespace test
+} // namespace gaia_matrix
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gaia_matrix {
+namespace test {
+
+/**
+ * @brief Node attribute for OnnxBuilder
+ */
+struct OnnxAttribute {
+    static OnnxAttribute Int(const std::string& name, int64_t value);
+    static OnnxAttribute Float(const std::string& name, float value);
+    static OnnxAttribute Ints(const std::string& name, const std::vector<int64_t>& values);
+    static OnnxAttribute String(const std::string& name, const std::string& value);
+
+    std::string encoded;    // Serialized AttributeProto
+};
+
+/**
+ * @brief Writes small ONNX models in protobuf form for tests
+ *
+ * Only the fields the loader reads are emitted. Shapes use -1 for a
+ * symbolic dimension, written as dim_param "N".
+ */
+class OnnxBuilder {
+public:
+    OnnxBuilder& Opset(int64_t version);
+    OnnxBuilder& Metadata(const std::string& producerName, const std::string& producerVersion,
+                          const std::string& domain, int64_t modelVersion, const std::string& docString);
+    OnnxBuilder& Input(const std::string& name, const std::vector<int64_t>& shape);
+    OnnxBuilder& Output(const std::string& name, const std::vector<int64_t>& shape);
+    /**
+     * @brief Add an initializer; integer types (2 uint8, 3 int8, 6 int32) are written from the float values
+     */
+    OnnxBuilder& Initializer(const std::string& name, const std::vector<int64_t>& dims,
+                             const std::vector<float>& data, int32_t dataType = 1);
+    /**
+     * @brief Add an fp32 initializer whose bytes live in an external data file
+     * @param location File name relative to the model's directory
+     * @param offset Byte offset of the tensor in the file
+     * @param length Byte count, or -1 to omit it so the tensor runs to the end of the file
+     */
+    OnnxBuilder& ExternalInitializer(const std::string& name, const std::vector<int64_t>& dims,
+                                     const std::string& location, int64_t offset, int64_t length = -1);
+    OnnxBuilder& Node(const std::string& opType, const std::vector<std::string>& inputs,
+                      const std::vector<std::string>& outputs, const std::vector<OnnxAttribute>& attributes = {});
+
+    /**
+     * @brief Serialize the model
+     * @return ModelProto bytes
+     */
+    std::string Build() const;
+
+    /**
+     * @brief Serialize the model to a file
+     * @param directory Directory to create the file in
+     * @param filename Name of the file
+     * @return Full path to the file, or empty on failure
+     */
+    std::string Save(const std::string& directory, const std::string& filename) const;
+
+private:
+    int64_t m_Opset = 13;
+    std::string m_Metadata;
+    std::string m_Nodes;
+    std::string m_Initializers;
+    std::string m_Inputs;
+    std::string m_Outputs;
+    int m_NodeCount = 0;
+};
+
+} // namespace test
+} // namespace gaia_matrix
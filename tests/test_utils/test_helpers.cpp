@@ -1,4 +1,5 @@
 #include "test_helpers.h"
+#include <gtest/gtest.h>
 #include <fstream>
 #include <random>
 #include <iostream>
@@ -94,9 +95,20 @@ Move: I.K W → T.P z+ 0.1
 }
 
 std::string TestHelpers::GetTestResourcesPath() {
-    // In a real implementation, this would return the path to test resources
-    // For our demo, we'll just return a placeholder
+#ifdef GAIA_MATRIX_TEST_RESOURCES
+    return GAIA_MATRIX_TEST_RESOURCES;
+#else
     return fs::current_path().string() + "/tests/resources";
+#endif
+}
+
+std::shared_ptr<const aopl::Module> TestHelpers::CompileAOPL(const std::string& source,
+                                                            const aopl::OptimizerConfig& config) {
+    aopl::Parser parser;
+    parser.SetOptimizerConfig(config);
+    EXPECT_TRUE(parser.Parse(source));
+    EXPECT_TRUE(parser.Compile());
+    return parser.GetModule();
 }
 
 } // namespace test
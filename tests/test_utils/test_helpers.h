@@ -1,8 +1,10 @@
 #pragma once
 
+#include "gaia_matrix/aopl.h"
 #include <string>
 #include <vector>
 #include <filesystem>
+#include <memory>
 
 namespace gaia_matrix {
 namespace test {
@@ -65,6 +67,17 @@ public:
      * @return Path to test resources
      */
     static std::string GetTestResourcesPath();
+
+    /**
+     * @brief Parse and compile an AOPL script, failing the current test on errors
+     * @param source Script text
+     * @param config Optimizer passes to run
+     * @return Compiled module, or nullptr if the script did not compile
+     */
+    static std::shared_ptr<const aopl::Module> CompileAOPL(
+        const std::string& source,
+        const aopl::OptimizerConfig& config = aopl::OptimizerConfig()
+    );
 };
 
 } // namespace test